@@ -1,6 +1,12 @@
 -keep class com.aureusapps.android.webpandroid.utils.BitmapUtils {*;}
 -keep class com.aureusapps.android.webpandroid.extensions.UriExtensionsKt {*;}
+-keep class com.aureusapps.android.webpandroid.utils.NativeBufferCleaner {*;}
+-keep class com.aureusapps.android.webpandroid.utils.NativeLoadStats {*;}
 -keep class com.aureusapps.android.webpandroid.decoder.**
 -keep class com.aureusapps.android.webpandroid.decoder.** {*;}
 -keep class com.aureusapps.android.webpandroid.encoder.**
--keep class com.aureusapps.android.webpandroid.encoder.** {*;}
\ No newline at end of file
+-keep class com.aureusapps.android.webpandroid.encoder.** {*;}
+-keep class com.aureusapps.android.webpandroid.transcoder.**
+-keep class com.aureusapps.android.webpandroid.transcoder.** {*;}
+-keep class com.aureusapps.android.webpandroid.mux.**
+-keep class com.aureusapps.android.webpandroid.mux.** {*;}
\ No newline at end of file
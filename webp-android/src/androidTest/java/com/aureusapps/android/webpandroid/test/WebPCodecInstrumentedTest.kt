@@ -4,6 +4,7 @@ import android.content.Context
 import android.graphics.Bitmap
 import android.graphics.BitmapFactory
 import android.graphics.Color
+import android.graphics.Rect
 import android.net.Uri
 import androidx.core.graphics.alpha
 import androidx.core.graphics.blue
@@ -13,16 +14,25 @@ import androidx.core.net.toUri
 import androidx.test.core.app.ApplicationProvider
 import androidx.test.espresso.matcher.ViewMatchers.assertThat
 import androidx.test.ext.junit.runners.AndroidJUnit4
+import com.aureusapps.android.webpandroid.CodecException
+import com.aureusapps.android.webpandroid.CodecResult
 import com.aureusapps.android.webpandroid.decoder.DecoderConfig
+import com.aureusapps.android.webpandroid.decoder.FrameExtractPath
 import com.aureusapps.android.webpandroid.decoder.WebPDecodeListener
 import com.aureusapps.android.webpandroid.decoder.WebPDecoder
 import com.aureusapps.android.webpandroid.decoder.WebPInfo
 import com.aureusapps.android.webpandroid.encoder.WebPAnimEncoder
 import com.aureusapps.android.webpandroid.encoder.WebPAnimEncoderOptions
+import com.aureusapps.android.webpandroid.encoder.WebPBuffer
 import com.aureusapps.android.webpandroid.encoder.WebPConfig
 import com.aureusapps.android.webpandroid.encoder.WebPEncoder
+import com.aureusapps.android.webpandroid.encoder.WebPEncoderOutput
+import com.aureusapps.android.webpandroid.encoder.WebPMemoryPolicy
 import com.aureusapps.android.webpandroid.encoder.WebPMuxAnimParams
+import com.aureusapps.android.webpandroid.encoder.WebPPixelFormat
 import com.aureusapps.android.webpandroid.encoder.WebPPreset
+import com.aureusapps.android.webpandroid.encoder.WebPSeekReport
+import com.aureusapps.android.webpandroid.mux.WebPMuxEditor
 import com.aureusapps.android.webpandroid.test.matchers.inRange
 import com.aureusapps.android.webpandroid.test.utils.getBits
 import com.aureusapps.android.webpandroid.test.utils.nextBytes
@@ -30,7 +40,10 @@ import com.aureusapps.android.webpandroid.test.utils.nextInt
 import com.aureusapps.android.webpandroid.test.utils.nextString
 import com.aureusapps.android.webpandroid.test.utils.putString
 import com.aureusapps.android.webpandroid.test.utils.skipBytes
+import com.aureusapps.android.webpandroid.transcoder.WebPTranscodeOptions
+import com.aureusapps.android.webpandroid.transcoder.WebPTranscoder
 import com.aureusapps.android.webpandroid.utils.BitmapUtils
+import com.aureusapps.android.webpandroid.utils.NativeLoadStats
 import org.junit.Assert.assertEquals
 import org.junit.Assert.assertNotNull
 import org.junit.Assert.assertTrue
@@ -47,6 +60,7 @@ import java.nio.Buffer
 import java.nio.ByteBuffer
 import java.nio.ByteOrder
 import java.nio.file.Files
+import java.util.Random
 
 @RunWith(AndroidJUnit4::class)
 class WebPCodecInstrumentedTest {
@@ -136,6 +150,779 @@ class WebPCodecInstrumentedTest {
         assertEquals(Color.argb(255, 0, 51, 102), decodeResult.frame?.getPixel(0, 0))
     }
 
+    @Test
+    fun test_decodeFrameInPlace() {
+        val colors = listOf(Color.RED, Color.GREEN, Color.BLUE)
+        val encoder = WebPAnimEncoder(context)
+        encoder.configure(config = WebPConfig(lossless = WebPConfig.COMPRESSION_LOSSLESS))
+        colors.forEachIndexed { index, color ->
+            encoder.addFrame(index * 100L, createBitmapImage(16, 16, color))
+        }
+        val buffer = encoder.assembleToBuffer(300)
+        encoder.release()
+
+        val decoder = WebPDecoder(context)
+        decoder.setDataBuffer(buffer)
+        val frame = decoder.currentFrame
+        assertNotNull(frame)
+        colors.forEachIndexed { index, color ->
+            assertTrue(decoder.hasNextFrame())
+            assertEquals(index, decoder.nextFrameIndex())
+            assertEquals((index + 1) * 100, decoder.decodeNextFrameInPlace())
+            assertTrue(frame === decoder.currentFrame)
+            assertEquals(color, frame?.getPixel(8, 8))
+        }
+        assertTrue(!decoder.hasNextFrame())
+        assertEquals(-1, decoder.decodeNextFrameInPlace())
+
+        decoder.reset()
+        val result = decoder.decodeNextFrame()
+        assertEquals(CodecResult.SUCCESS, result.codecResult)
+        assertEquals(0, result.frameIndex)
+        assertEquals(100, result.timestamp)
+        assertTrue(result.frame === frame)
+        decoder.release()
+    }
+
+    @Test
+    fun test_decodeFrameBatch() {
+        val colors = listOf(Color.RED, Color.GREEN, Color.BLUE)
+        val encoder = WebPAnimEncoder(context)
+        encoder.configure(config = WebPConfig(lossless = WebPConfig.COMPRESSION_LOSSLESS))
+        colors.forEachIndexed { index, color ->
+            encoder.addFrame(index * 100L, createBitmapImage(16, 16, color))
+        }
+        val buffer = encoder.assembleToBuffer(300)
+        encoder.release()
+
+        val frameSize = 16 * 16 * 4
+        val stack = ByteBuffer.allocateDirect(2 * frameSize)
+        val decoder = WebPDecoder(context)
+        decoder.setDataBuffer(buffer)
+
+        assertTrue(intArrayOf(100, 200).contentEquals(decoder.decodeFrames(2, stack)))
+        assertEquals(Color.red(Color.RED), stack.get(0).toInt() and 0xFF)
+        assertEquals(Color.green(Color.GREEN), stack.get(frameSize + 1).toInt() and 0xFF)
+        assertEquals(255, stack.get(frameSize + 3).toInt() and 0xFF)
+
+        assertTrue(intArrayOf(300).contentEquals(decoder.decodeFrames(2, stack)))
+        assertEquals(Color.blue(Color.BLUE), stack.get(2).toInt() and 0xFF)
+        assertEquals(0, decoder.decodeFrames(2, stack).size)
+
+        decoder.reset()
+        try {
+            decoder.decodeFrames(3, stack)
+            fail("Expected a too small buffer to be rejected")
+        } catch (e: CodecException) {
+            assertEquals(CodecResult.ERROR_INVALID_FRAME_BUFFER, e.codecResult)
+        }
+        decoder.release()
+    }
+
+    @Test
+    fun test_encodeToBuffer() {
+        val imageColor = Color.argb(255, 0, 0, 255)
+        val encoder = WebPEncoder(context)
+        encoder.configure(
+            config = WebPConfig(
+                lossless = WebPConfig.COMPRESSION_LOSSLESS,
+                quality = 100f
+            )
+        )
+        val buffer = encoder.encodeToBuffer(createBitmapImage(8, 8, imageColor))
+        encoder.release()
+        assertTrue("Expected a direct buffer", buffer.buffer.isDirect)
+        assertEquals(buffer.buffer.capacity(), buffer.size)
+        assertEquals("RIFF", String(buffer.toByteArray(), 0, 4, Charsets.US_ASCII))
+
+        val decoder = WebPDecoder(context)
+        decoder.setDataBuffer(buffer)
+        val decodeResult = decoder.decodeNextFrame()
+        assertNotNull(decodeResult.frame)
+        assertEquals(imageColor, decodeResult.frame?.getPixel(0, 0))
+        decoder.release()
+    }
+
+    @Test
+    fun test_packedConfig() {
+        val config = WebPConfig(
+            lossless = WebPConfig.COMPRESSION_LOSSLESS,
+            quality = 42.5f,
+            exact = true
+        )
+        val packed = config.packed
+        assertEquals(29, packed.size)
+        assertEquals((1 shl 0) or (1 shl 1) or (1 shl 23), packed[0])
+        assertEquals(WebPConfig.COMPRESSION_LOSSLESS, packed[1])
+        assertEquals(42.5f.toRawBits(), packed[2])
+        assertEquals(1, packed[24])
+
+        val options = WebPAnimEncoderOptions(animParams = WebPMuxAnimParams(loopCount = 3))
+        assertEquals(10, options.packed.size)
+        assertEquals(1, options.packed[6])
+        assertEquals(3, options.packed[8])
+
+        // The packed values reach the native encoder
+        val encoder = WebPEncoder(context)
+        encoder.configure(config = config, preset = WebPPreset.WEBP_PRESET_PHOTO)
+        val buffer = encoder.encodeToBuffer(createBitmapImage(8, 8, Color.GREEN))
+        encoder.release()
+        val decoder = WebPDecoder(context)
+        decoder.setDataBuffer(buffer)
+        assertEquals(Color.GREEN, decoder.decodeNextFrame().frame?.getPixel(0, 0))
+        decoder.release()
+    }
+
+    @Test
+    fun test_encodeMultipleSizes() {
+        val largeFile = File.createTempFile("img", null)
+        val smallFile = File.createTempFile("img", null)
+        try {
+            val encoder = WebPEncoder(context)
+            encoder.configure(
+                config = WebPConfig(
+                    lossless = WebPConfig.COMPRESSION_LOSSLESS,
+                    quality = 100f
+                )
+            )
+            encoder.encode(
+                createBitmapImage(40, 20, Color.argb(255, 255, 0, 0)),
+                listOf(
+                    WebPEncoderOutput(largeFile.toUri()),
+                    WebPEncoderOutput(smallFile.toUri(), width = 10)
+                )
+            )
+            encoder.release()
+
+            val largeBitmap = BitmapFactory.decodeFile(largeFile.path)
+            assertEquals(40, largeBitmap.width)
+            assertEquals(20, largeBitmap.height)
+            val smallBitmap = BitmapFactory.decodeFile(smallFile.path)
+            assertEquals(10, smallBitmap.width)
+            assertEquals(5, smallBitmap.height)
+        } finally {
+            largeFile.delete()
+            smallFile.delete()
+        }
+    }
+
+    @Test
+    fun test_boxDownscale() {
+        val srcWidth = 1024
+        val srcHeight = 768
+        val random = Random(7)
+        val srcPixels = IntArray(srcWidth * srcHeight) {
+            Color.argb(255, random.nextInt(256), random.nextInt(256), random.nextInt(256))
+        }
+        val srcBitmap = Bitmap.createBitmap(srcPixels, srcWidth, srcHeight, Bitmap.Config.ARGB_8888)
+        val config = WebPConfig(lossless = WebPConfig.COMPRESSION_LOSSLESS, quality = 0f, method = 0)
+
+        // Integer ratio uses the box filter, its speed against the rescaler is measured in codec_benchmark
+        val boxEncoder = WebPEncoder(context, srcWidth / 2, srcHeight / 2).configure(config)
+        val boxBuffer = boxEncoder.encodeToBuffer(srcBitmap)
+        boxEncoder.release()
+
+        // Compare with the exact 2x2 average
+        val decoder = WebPDecoder(context)
+        decoder.setDataBuffer(boxBuffer)
+        val frame = decoder.decodeNextFrame().frame
+        decoder.release()
+        assertNotNull(frame)
+        for (y in 0 until srcHeight / 2 step 37) {
+            for (x in 0 until srcWidth / 2 step 29) {
+                val block = intArrayOf(
+                    srcPixels[2 * y * srcWidth + 2 * x],
+                    srcPixels[2 * y * srcWidth + 2 * x + 1],
+                    srcPixels[(2 * y + 1) * srcWidth + 2 * x],
+                    srcPixels[(2 * y + 1) * srcWidth + 2 * x + 1],
+                )
+                val pixel = frame!!.getPixel(x, y)
+                assertThat(pixel.red, inRange(block.sumOf { it.red } / 4 - 1, block.sumOf { it.red } / 4 + 1))
+                assertThat(pixel.green, inRange(block.sumOf { it.green } / 4 - 1, block.sumOf { it.green } / 4 + 1))
+                assertThat(pixel.blue, inRange(block.sumOf { it.blue } / 4 - 1, block.sumOf { it.blue } / 4 + 1))
+            }
+        }
+    }
+
+    @Test
+    fun test_parallelAnimEncoder() {
+        val size = 256
+        val frameCount = 24
+        val frames = List(frameCount) { index ->
+            val pixels = IntArray(size * size) { Color.WHITE }
+            // A square moving across a static background
+            for (y in 64 until 96) {
+                for (x in 0 until 32) {
+                    pixels[y * size + (index * 8 + x) % size] = Color.RED
+                }
+            }
+            Bitmap.createBitmap(pixels, size, size, Bitmap.Config.ARGB_8888)
+        }
+
+        val encoder = WebPAnimEncoder(
+            context = context,
+            options = WebPAnimEncoderOptions(kmin = 5, kmax = 10)
+        )
+        encoder.configure(config = WebPConfig(lossless = WebPConfig.COMPRESSION_LOSSLESS))
+        encoder.setParallelEncoding()
+        val finishedFrames = ArrayList<Int>()
+        encoder.addProgressListener { currentFrame, frameProgress ->
+            if (frameProgress == 100) {
+                finishedFrames.add(currentFrame)
+            }
+            true
+        }
+        frames.forEachIndexed { index, frame ->
+            encoder.addFrame(index * 100L, frame)
+        }
+        val parallelBuffer = encoder.assembleToBuffer(frameCount * 100L)
+        encoder.release()
+
+        // Frames finished on the workers are reported in order from the calling thread
+        assertEquals((0 until frameCount).toList(), finishedFrames)
+
+        // Every frame must decode to the source frame
+        val decoder = WebPDecoder(context)
+        decoder.setDataBuffer(parallelBuffer)
+        for (index in 0 until frameCount) {
+            val frame = decoder.decodeNextFrame().frame
+            assertNotNull(frame)
+            assertEquals(frames[index].getPixel((index * 8) % size, 80), frame!!.getPixel((index * 8) % size, 80))
+            assertEquals(Color.WHITE, frame.getPixel((index * 8 + 64) % size, 80))
+        }
+        decoder.release()
+    }
+
+    @Test
+    fun test_streamingAnimEncoder() {
+        val outputFile = File.createTempFile("img", null)
+        try {
+            val colors = listOf(Color.RED, Color.GREEN, Color.BLUE)
+            val encoder = WebPAnimEncoder(context)
+            encoder.configure(config = WebPConfig(lossless = WebPConfig.COMPRESSION_LOSSLESS))
+            encoder.setStreamingOutput(outputFile.toUri())
+            colors.forEachIndexed { index, color ->
+                encoder.addFrame(index * 100L, createBitmapImage(16, 16, color))
+            }
+            encoder.finishStreaming(colors.size * 100L)
+
+            // The stream is closed, a new frame must not start another animation
+            try {
+                encoder.addFrame(colors.size * 100L, createBitmapImage(16, 16, Color.WHITE))
+                fail("Expected frames after finishStreaming to be rejected")
+            } catch (e: CodecException) {
+                assertEquals(CodecResult.ERROR_STREAM_FINISHED, e.codecResult)
+            }
+            encoder.release()
+
+            val decoder = WebPDecoder(context)
+            decoder.setDataSource(outputFile.toUri())
+            for (color in colors) {
+                val frame = decoder.decodeNextFrame().frame
+                assertNotNull(frame)
+                assertEquals(color, frame?.getPixel(8, 8))
+            }
+            decoder.release()
+        } finally {
+            outputFile.delete()
+        }
+    }
+
+    @Test
+    fun test_dropDuplicateFrames() {
+        val encoder = WebPAnimEncoder(context)
+        encoder.configure(config = WebPConfig(lossless = WebPConfig.COMPRESSION_LOSSLESS))
+        encoder.setDuplicateTolerance(2)
+        encoder.addFrame(0L, createBitmapImage(16, 16, Color.rgb(100, 100, 100)))
+        encoder.addFrame(100L, createBitmapImage(16, 16, Color.rgb(100, 100, 100)))
+        encoder.addFrame(200L, createBitmapImage(16, 16, Color.rgb(101, 102, 100)))
+        encoder.addFrame(300L, createBitmapImage(16, 16, Color.rgb(200, 100, 100)))
+        val buffer = encoder.assembleToBuffer(400L)
+        assertEquals(2, encoder.droppedFrameCount)
+        encoder.release()
+
+        val decoder = WebPDecoder(context)
+        decoder.setDataBuffer(buffer)
+        val first = decoder.decodeNextFrame()
+        assertEquals(Color.rgb(100, 100, 100), first.frame?.getPixel(0, 0))
+        assertEquals(300, first.timestamp)
+        val second = decoder.decodeNextFrame()
+        assertEquals(Color.rgb(200, 100, 100), second.frame?.getPixel(0, 0))
+        decoder.release()
+    }
+
+    @Test
+    fun test_sizeBudget() {
+        val size = 256
+        val frameCount = 24
+        val budget = 60 * 1024L
+        val random = Random(0)
+        val frames = List(frameCount) {
+            // Noise does not compress, so quality 90 alone would overshoot the budget
+            val pixels = IntArray(size * size) { Color.rgb(random.nextInt(256), random.nextInt(256), random.nextInt(256)) }
+            Bitmap.createBitmap(pixels, size, size, Bitmap.Config.ARGB_8888)
+        }
+
+        fun encode(sizeBudget: Long?): WebPBuffer {
+            val encoder = WebPAnimEncoder(context)
+            encoder.configure(config = WebPConfig(quality = 90f))
+            if (sizeBudget != null) {
+                encoder.setSizeBudget(sizeBudget, frameCount)
+            }
+            frames.forEachIndexed { index, frame ->
+                encoder.addFrame(index * 100L, frame)
+            }
+            val buffer = encoder.assembleToBuffer(frameCount * 100L)
+            encoder.release()
+            return buffer
+        }
+
+        val unbudgeted = encode(null)
+        assertTrue(
+            "output of ${unbudgeted.size} bytes should overshoot the budget of $budget bytes without rate control",
+            unbudgeted.size > budget
+        )
+        val buffer = encode(budget)
+        assertTrue(
+            "output of ${buffer.size} bytes exceeds the budget of $budget bytes",
+            buffer.size <= budget
+        )
+        assertThat(buffer.size, inRange(1, budget.toInt()))
+
+        val decoder = WebPDecoder(context)
+        decoder.setDataBuffer(buffer)
+        assertEquals(frameCount, decoder.decodeInfo().frameCount)
+        decoder.release()
+    }
+
+    @Test
+    fun test_frameRateResampling() {
+        // 60 fps input, four frames per output frame at 15 fps, the white frame is a short flash
+        val colors = listOf(
+            Color.RED, Color.RED, Color.RED, Color.RED,
+            Color.RED, Color.RED, Color.WHITE, Color.RED,
+            Color.BLUE, Color.BLUE, Color.BLUE, Color.BLUE,
+        )
+        val encoder = WebPAnimEncoder(context)
+        encoder.configure(config = WebPConfig(lossless = WebPConfig.COMPRESSION_LOSSLESS))
+        encoder.setFrameRate(15f)
+        colors.forEachIndexed { index, color ->
+            encoder.addFrame(Math.round(index * 1000.0 / 60), createBitmapImage(16, 16, color))
+        }
+        val buffer = encoder.assembleToBuffer(200)
+        assertEquals(9, encoder.decimatedFrameCount)
+        encoder.release()
+
+        val decoder = WebPDecoder(context)
+        decoder.setDataBuffer(buffer)
+        assertEquals(3, decoder.decodeInfo().frameCount)
+        val expected = listOf(Color.RED to 67, Color.WHITE to 133, Color.BLUE to 200)
+        for ((color, timestamp) in expected) {
+            val result = decoder.decodeNextFrame()
+            assertEquals(color, result.frame?.getPixel(8, 8))
+            assertEquals(timestamp, result.timestamp)
+        }
+        decoder.release()
+    }
+
+    @Test
+    fun test_memoryLimit() {
+        val size = 128
+        val random = Random(0)
+        fun noiseFrame(): Bitmap {
+            val pixels = IntArray(size * size) { Color.rgb(random.nextInt(256), random.nextInt(256), random.nextInt(256)) }
+            return Bitmap.createBitmap(pixels, size, size, Bitmap.Config.ARGB_8888)
+        }
+
+        // Encoded frames stay in memory until assembled, so usage grows with the animation
+        val unlimited = WebPAnimEncoder(context).setParallelEncoding()
+        unlimited.configure(config = WebPConfig(lossless = WebPConfig.COMPRESSION_LOSSLESS))
+        unlimited.addFrame(0, noiseFrame())
+        unlimited.addFrame(100, noiseFrame())
+        val usage = unlimited.memoryUsage
+        unlimited.assembleToBuffer(200)
+        assertTrue(usage > 0)
+        assertTrue(unlimited.peakMemoryUsage >= usage)
+        unlimited.release()
+
+        val limit = 1024 * 1024L
+        val limited = WebPAnimEncoder(context).setMemoryLimit(limit, WebPMemoryPolicy.FAIL)
+        limited.configure(config = WebPConfig(lossless = WebPConfig.COMPRESSION_LOSSLESS))
+        var codecResult: CodecResult? = null
+        try {
+            for (index in 0 until 100) {
+                limited.addFrame(index * 100L, noiseFrame())
+            }
+        } catch (e: CodecException) {
+            codecResult = e.codecResult
+        }
+        assertEquals(CodecResult.ERROR_MEMORY_LIMIT_EXCEEDED, codecResult)
+        assertTrue(limited.peakMemoryUsage > 0)
+        assertTrue(
+            "peak of ${limited.peakMemoryUsage} bytes exceeds the limit of $limit bytes",
+            limited.peakMemoryUsage <= limit
+        )
+        limited.release()
+    }
+
+    @Test
+    fun test_seekOptimizedEncoding() {
+        val size = 128
+        val frameCount = 24
+        fun encode(maxSeekFrames: Int?): Pair<WebPBuffer, WebPSeekReport?> {
+            val encoder = WebPAnimEncoder(
+                context = context,
+                options = WebPAnimEncoderOptions(maxSeekFrames = maxSeekFrames)
+            )
+            encoder.configure(config = WebPConfig(lossless = WebPConfig.COMPRESSION_LOSSLESS))
+            for (index in 0 until frameCount) {
+                val pixels = IntArray(size * size) { Color.WHITE }
+                for (y in 32 until 48) {
+                    for (x in 0 until 16) {
+                        pixels[y * size + (index * 4 + x) % size] = Color.RED
+                    }
+                }
+                encoder.addFrame(index * 100L, Bitmap.createBitmap(pixels, size, size, Bitmap.Config.ARGB_8888))
+            }
+            val buffer = encoder.assembleToBuffer(frameCount * 100L)
+            val report = encoder.seekReport
+            encoder.release()
+            return buffer to report
+        }
+
+        val (sparseBuffer, sparseReport) = encode(null)
+        val (seekBuffer, seekReport) = encode(4)
+        assertNotNull(seekReport)
+        assertEquals(frameCount, seekReport!!.frameCount)
+        assertEquals(0, seekReport.keyFrameIndices.first())
+        assertEquals(0L, seekReport.keyFrameTimestamps.first())
+        assertThat(seekReport.maxSeekFrames, inRange(1, 4))
+        assertTrue(seekReport.keyFrameIndices.size >= frameCount / 4)
+        assertTrue(seekReport.keyFrameBytes + seekReport.deltaFrameBytes <= seekBuffer.size)
+        assertTrue(seekReport.sizeOverhead >= 0)
+
+        // The default keyframe placement is sparser, so seeking decodes more frames
+        assertNotNull(sparseReport)
+        assertEquals(frameCount, sparseReport!!.frameCount)
+        assertTrue(sparseReport.keyFrameBytes + sparseReport.deltaFrameBytes <= sparseBuffer.size)
+        assertTrue(sparseReport.keyFrameIndices.size <= seekReport.keyFrameIndices.size)
+        assertTrue(sparseReport.maxSeekFrames >= seekReport.maxSeekFrames)
+    }
+
+    @Test
+    fun test_appendFrames() {
+        val file = File.createTempFile("img", null)
+        try {
+            val encoder = WebPAnimEncoder(context)
+            encoder.configure(config = WebPConfig(lossless = WebPConfig.COMPRESSION_LOSSLESS))
+            encoder.addFrame(0L, createBitmapImage(16, 16, Color.RED))
+            encoder.addFrame(100L, createBitmapImage(16, 16, Color.GREEN))
+            encoder.assemble(200L, file.toUri())
+            encoder.release()
+            val original = file.readBytes()
+
+            val appendEncoder = WebPAnimEncoder(context)
+            appendEncoder.configure(config = WebPConfig(lossless = WebPConfig.COMPRESSION_LOSSLESS))
+            appendEncoder.appendTo(file.toUri())
+            appendEncoder.addFrame(50L, createBitmapImage(16, 16, Color.BLUE))
+            appendEncoder.assemble(150L, file.toUri())
+            appendEncoder.release()
+
+            // Existing frame bitstreams are copied as they are
+            val originalText = String(original, Charsets.ISO_8859_1)
+            val appendedText = String(file.readBytes(), Charsets.ISO_8859_1)
+            var chunkStart = originalText.indexOf("VP8L")
+            assertTrue(chunkStart > 0)
+            while (chunkStart > 0) {
+                val chunkSize = ByteBuffer.wrap(original, chunkStart + 4, 4).order(ByteOrder.LITTLE_ENDIAN).int
+                val chunkEnd = chunkStart + 8 + chunkSize
+                assertTrue(appendedText.contains(originalText.substring(chunkStart, chunkEnd)))
+                chunkStart = originalText.indexOf("VP8L", chunkEnd)
+            }
+
+            val decoder = WebPDecoder(context)
+            decoder.setDataSource(file.toUri())
+            val expected = listOf(Color.RED to 100, Color.GREEN to 250, Color.BLUE to 350)
+            for ((color, timestamp) in expected) {
+                val result = decoder.decodeNextFrame()
+                assertEquals(color, result.frame?.getPixel(8, 8))
+                assertEquals(timestamp, result.timestamp)
+            }
+            decoder.release()
+        } finally {
+            file.delete()
+        }
+    }
+
+    @Test
+    fun test_editAnimation() {
+        val colors = listOf(Color.RED, Color.GREEN, Color.BLUE, Color.YELLOW)
+        val encoder = WebPAnimEncoder(context, options = WebPAnimEncoderOptions(maxSeekFrames = 1))
+        encoder.configure(config = WebPConfig(lossless = WebPConfig.COMPRESSION_LOSSLESS))
+        colors.forEachIndexed { index, color ->
+            encoder.addFrame(index * 100L, createBitmapImage(16, 16, color))
+        }
+        val buffer = encoder.assembleToBuffer(colors.size * 100L)
+        encoder.release()
+
+        val edited = WebPMuxEditor(context)
+            .setLoopCount(3)
+            .scaleDurations(0.5f)
+            .stripMetadata()
+            .trim(2)
+            .editBuffer(buffer)
+
+        val decoder = WebPDecoder(context)
+        decoder.setDataBuffer(edited)
+        val info = decoder.decodeInfo()
+        assertEquals(2, info.frameCount)
+        assertEquals(3, info.loopCount)
+        val first = decoder.decodeNextFrame()
+        assertEquals(Color.BLUE, first.frame?.getPixel(8, 8))
+        assertEquals(50, first.timestamp)
+        val second = decoder.decodeNextFrame()
+        assertEquals(Color.YELLOW, second.frame?.getPixel(8, 8))
+        assertEquals(100, second.timestamp)
+        decoder.release()
+    }
+
+    @Test
+    fun test_extractFrame() {
+        val first = createBitmapImage(32, 32, Color.RED)
+        val second = createBitmapImage(32, 32, Color.RED).copy(Bitmap.Config.ARGB_8888, true)
+        for (x in 8 until 16) {
+            for (y in 8 until 16) {
+                second.setPixel(x, y, Color.GREEN)
+            }
+        }
+        val encoder = WebPAnimEncoder(context)
+        encoder.configure(config = WebPConfig(lossless = WebPConfig.COMPRESSION_LOSSLESS))
+        encoder.addFrame(0, first)
+        encoder.addFrame(100, second)
+        val buffer = encoder.assembleToBuffer(200)
+        encoder.release()
+
+        val file = File.createTempFile("img", null)
+        try {
+            val decoder = WebPDecoder(context)
+            decoder.setDataBuffer(buffer)
+            // The first frame covers the canvas, the second only holds the changed square
+            assertEquals(FrameExtractPath.COPY, decoder.extractFrame(0, file.toUri()))
+            assertEquals(Color.RED, BitmapFactory.decodeFile(file.path).getPixel(20, 20))
+            assertEquals(FrameExtractPath.REENCODE, decoder.extractFrame(1, file.toUri()))
+            val still = BitmapFactory.decodeFile(file.path)
+            assertEquals(Color.RED, still.getPixel(20, 20))
+            assertEquals(Color.GREEN, still.getPixel(10, 10))
+            decoder.release()
+        } finally {
+            file.delete()
+        }
+    }
+
+    @Test
+    fun test_nativeLoadStats() {
+        // Creating a codec loads the library
+        WebPDecoder(context).release()
+        val onLoadNanos = NativeLoadStats.onLoadNanos
+        val registryLoadNanos = NativeLoadStats.registryLoadNanos
+        assertTrue(onLoadNanos > 0)
+        assertTrue(registryLoadNanos in 0..onLoadNanos)
+
+        // Recorded once, creating more codecs does not load the library again
+        WebPEncoder(context, 1, 1).release()
+        assertEquals(onLoadNanos, NativeLoadStats.onLoadNanos)
+        assertEquals(registryLoadNanos, NativeLoadStats.registryLoadNanos)
+    }
+
+    @Test
+    fun test_addYuvFrameBuffer() {
+        // Gray I420 frame: Y=128, U=V=128
+        val width = 16
+        val height = 16
+        val buffer = ByteBuffer.allocateDirect(width * height * 3 / 2)
+        while (buffer.hasRemaining()) buffer.put(128.toByte())
+        buffer.rewind()
+
+        val encoder = WebPAnimEncoder(context)
+        encoder.configure(config = WebPConfig(lossless = WebPConfig.COMPRESSION_LOSSLESS))
+        encoder.addFrame(0L, buffer, width, height, WebPPixelFormat.I420)
+        val webPBuffer = encoder.assembleToBuffer(100L)
+        encoder.release()
+
+        val decoder = WebPDecoder(context)
+        decoder.setDataBuffer(webPBuffer)
+        val pixel = decoder.decodeNextFrame().frame?.getPixel(8, 8) ?: 0
+        decoder.release()
+        assertThat(Color.red(pixel), inRange(120, 136))
+        assertThat(Color.green(pixel), inRange(120, 136))
+        assertThat(Color.blue(pixel), inRange(120, 136))
+    }
+
+    @Test
+    fun test_transcodeAnimatedImage() {
+        val size = 256
+        val frameCount = 24
+        val srcFile = File.createTempFile("img", null)
+        val javaFile = File.createTempFile("img", null)
+        val nativeFile = File.createTempFile("img", null)
+        try {
+            // 25 fps source with a square moving across it
+            val srcEncoder = WebPAnimEncoder(context)
+            srcEncoder.configure(config = WebPConfig(lossless = WebPConfig.COMPRESSION_LOSSLESS))
+            for (index in 0 until frameCount) {
+                val pixels = IntArray(size * size) { Color.WHITE }
+                for (y in 64 until 96) {
+                    for (x in 0 until 32) {
+                        pixels[y * size + (index * 8 + x) % size] = Color.RED
+                    }
+                }
+                srcEncoder.addFrame(index * 40L, Bitmap.createBitmap(pixels, size, size, Bitmap.Config.ARGB_8888))
+            }
+            srcEncoder.assemble(frameCount * 40L, srcFile.toUri())
+            srcEncoder.release()
+
+            val config = WebPConfig(quality = 75f)
+
+            // Java loop: decode into a bitmap, then add the bitmap to the encoder
+            val decoder = WebPDecoder(context)
+            decoder.setDataSource(srcFile.toUri())
+            val encoder = WebPAnimEncoder(context, size / 2, size / 2)
+            encoder.configure(config = config)
+            var timestamp = 0L
+            while (decoder.hasNextFrame()) {
+                val result = decoder.decodeNextFrame()
+                encoder.addFrame(timestamp, result.frame!!)
+                timestamp = result.timestamp.toLong()
+            }
+            encoder.assemble(timestamp, javaFile.toUri())
+            encoder.release()
+            decoder.release()
+
+            // Native transcode
+            val transcoder = WebPTranscoder(context)
+            transcoder.transcode(
+                srcFile.toUri(),
+                nativeFile.toUri(),
+                config = config,
+                options = WebPTranscodeOptions(width = size / 2)
+            )
+
+            // Same animation as the Java loop, without creating bitmaps
+            val javaDecoder = WebPDecoder(context)
+            javaDecoder.setDataSource(javaFile.toUri())
+            val javaInfo = javaDecoder.decodeInfo()
+            javaDecoder.release()
+            val resizedDecoder = WebPDecoder(context)
+            resizedDecoder.setDataSource(nativeFile.toUri())
+            val info = resizedDecoder.decodeInfo()
+            resizedDecoder.release()
+            assertEquals(size / 2, info.width)
+            assertEquals(size / 2, info.height)
+            assertEquals(frameCount, info.frameCount)
+            assertEquals(javaInfo.width, info.width)
+            assertEquals(javaInfo.height, info.height)
+            assertEquals(javaInfo.frameCount, info.frameCount)
+
+            // Crop the square's row and halve the frame rate
+            transcoder.transcode(
+                srcFile.toUri(),
+                nativeFile.toUri(),
+                config = WebPConfig(lossless = WebPConfig.COMPRESSION_LOSSLESS),
+                options = WebPTranscodeOptions(
+                    cropRect = Rect(0, 64, size, 96),
+                    frameRate = 12.5f
+                )
+            )
+            transcoder.release()
+            val croppedDecoder = WebPDecoder(context)
+            croppedDecoder.setDataSource(nativeFile.toUri())
+            val croppedInfo = croppedDecoder.decodeInfo()
+            assertEquals(size, croppedInfo.width)
+            assertEquals(32, croppedInfo.height)
+            assertEquals(frameCount / 2, croppedInfo.frameCount)
+            croppedDecoder.decodeNextFrame()
+            val second = croppedDecoder.decodeNextFrame()
+            assertEquals(160, second.timestamp)
+            assertEquals(Color.RED, second.frame?.getPixel(16 + 2 * 8, 16))
+            croppedDecoder.release()
+        } finally {
+            srcFile.delete()
+            javaFile.delete()
+            nativeFile.delete()
+        }
+    }
+
+    @Test
+    fun test_transcodeGif() {
+        val srcFile = File.createTempFile("img", ".gif")
+        val dstFile = File.createTempFile("img", null)
+        try {
+            // Red frame for 100 ms, then a green 4x4 square on top of it for 200 ms
+            srcFile.writeBytes(
+                createGifImage(
+                    8, 8,
+                    listOf(Color.RED, Color.GREEN),
+                    listOf(
+                        GifFrame(0, 0, 8, 8, 0, 100),
+                        GifFrame(0, 0, 4, 4, 1, 200)
+                    )
+                )
+            )
+            val transcoder = WebPTranscoder(context)
+            transcoder.transcode(
+                srcFile.toUri(),
+                dstFile.toUri(),
+                config = WebPConfig(lossless = WebPConfig.COMPRESSION_LOSSLESS)
+            )
+            transcoder.release()
+
+            val decoder = WebPDecoder(context)
+            decoder.setDataSource(dstFile.toUri())
+            val info = decoder.decodeInfo()
+            assertEquals(2, info.frameCount)
+            assertEquals(0, info.loopCount)
+            val first = decoder.decodeNextFrame()
+            assertEquals(100, first.timestamp)
+            assertEquals(Color.RED, first.frame?.getPixel(1, 1))
+            val second = decoder.decodeNextFrame()
+            assertEquals(300, second.timestamp)
+            assertEquals(Color.GREEN, second.frame?.getPixel(1, 1))
+            assertEquals(Color.RED, second.frame?.getPixel(6, 6))
+            decoder.release()
+        } finally {
+            srcFile.delete()
+            dstFile.delete()
+        }
+    }
+
+    @Test
+    fun test_transcodeGifLoopCount() {
+        val srcFile = File.createTempFile("img", ".gif")
+        val dstFile = File.createTempFile("img", null)
+        try {
+            // GIF stores the repetitions after the first play, so repeating once plays twice
+            srcFile.writeBytes(
+                createGifImage(
+                    4, 4,
+                    listOf(Color.RED),
+                    listOf(GifFrame(0, 0, 4, 4, 0, 100)),
+                    repetitions = 1
+                )
+            )
+            val transcoder = WebPTranscoder(context)
+            transcoder.transcode(srcFile.toUri(), dstFile.toUri())
+            transcoder.release()
+
+            val decoder = WebPDecoder(context)
+            decoder.setDataSource(dstFile.toUri())
+            assertEquals(2, decoder.decodeInfo().loopCount)
+            decoder.release()
+        } finally {
+            srcFile.delete()
+            dstFile.delete()
+        }
+    }
+
     private fun testEncodeImage(
         srcWidth: Int = 10,
         srcHeight: Int = 10,
@@ -488,6 +1275,80 @@ class WebPCodecInstrumentedTest {
         }
     }
 
+    private data class GifFrame(
+        val left: Int,
+        val top: Int,
+        val width: Int,
+        val height: Int,
+        val colorIndex: Int,
+        val durationMillis: Int,
+    )
+
+    /**
+     * Writes a looping GIF of solid color frames. Codes are kept at 8 bits by
+     * clearing the LZW table every 126 pixels, so no compression is needed.
+     * [repetitions] is the NETSCAPE2.0 repetition count, 0 loops forever.
+     */
+    private fun createGifImage(
+        width: Int,
+        height: Int,
+        palette: List<Int>,
+        frames: List<GifFrame>,
+        repetitions: Int = 0,
+    ): ByteArray {
+        val out = ByteArrayOutputStream()
+        fun writeShort(value: Int) {
+            out.write(value and 0xff)
+            out.write(value shr 8)
+        }
+        out.write("GIF89a".toByteArray())
+        writeShort(width)
+        writeShort(height)
+        out.write(0x86) // global color table of 128 entries
+        out.write(0)
+        out.write(0)
+        for (index in 0 until 128) {
+            val color = palette.getOrElse(index) { Color.BLACK }
+            out.write(Color.red(color))
+            out.write(Color.green(color))
+            out.write(Color.blue(color))
+        }
+        out.write(byteArrayOf(0x21, 0xff.toByte(), 0x0b))
+        out.write("NETSCAPE2.0".toByteArray())
+        out.write(byteArrayOf(0x03, 0x01))
+        writeShort(repetitions)
+        out.write(0)
+        for (frame in frames) {
+            out.write(byteArrayOf(0x21, 0xf9.toByte(), 0x04, 0x00))
+            writeShort(frame.durationMillis / 10)
+            out.write(0)
+            out.write(0)
+            out.write(0x2c)
+            writeShort(frame.left)
+            writeShort(frame.top)
+            writeShort(frame.width)
+            writeShort(frame.height)
+            out.write(0)
+            val codes = ByteArrayOutputStream()
+            val pixelCount = frame.width * frame.height
+            for (index in 0 until pixelCount) {
+                if (index % 126 == 0) codes.write(0x80)
+                codes.write(frame.colorIndex)
+            }
+            codes.write(0x81)
+            val data = codes.toByteArray()
+            out.write(7)
+            for (offset in data.indices step 255) {
+                val length = minOf(255, data.size - offset)
+                out.write(length)
+                out.write(data, offset, length)
+            }
+            out.write(0)
+        }
+        out.write(0x3b)
+        return out.toByteArray()
+    }
+
     private fun createBitmapImage(
         width: Int,
         height: Int,
@@ -0,0 +1,190 @@
+//
+// Created by udara on 10/19/26.
+//
+
+#include <cstring>
+#include <unistd.h>
+
+#include "include/anim_stream_writer.h"
+
+namespace {
+    constexpr size_t CHUNK_HEADER_SIZE = 8;
+    constexpr size_t RIFF_HEADER_SIZE = 12;
+    constexpr size_t VP8X_CHUNK_SIZE = 10;
+    constexpr size_t ANIM_CHUNK_SIZE = 6;
+    constexpr size_t ANMF_HEADER_SIZE = 16;
+    constexpr off_t VP8X_FLAGS_OFFSET = RIFF_HEADER_SIZE + CHUNK_HEADER_SIZE;
+    constexpr uint8_t VP8L_SIGNATURE = 0x2f;
+    // Largest chunk payload libwebp accepts, the RIFF size is a 32 bit field
+    constexpr uint64_t MAX_RIFF_SIZE = 0xfffffff6u;
+
+    void putLE16(uint8_t *dst, uint32_t value) {
+        dst[0] = value & 0xff;
+        dst[1] = (value >> 8) & 0xff;
+    }
+
+    void putLE24(uint8_t *dst, uint32_t value) {
+        putLE16(dst, value);
+        dst[2] = (value >> 16) & 0xff;
+    }
+
+    void putLE32(uint8_t *dst, uint32_t value) {
+        putLE16(dst, value);
+        putLE16(dst + 2, value >> 16);
+    }
+
+    uint32_t getLE32(const uint8_t *src) {
+        return src[0] | (src[1] << 8) | (src[2] << 16) | (static_cast<uint32_t>(src[3]) << 24);
+    }
+
+    void putChunkHeader(uint8_t *dst, const char *fourcc, uint32_t size) {
+        memcpy(dst, fourcc, 4);
+        putLE32(dst + 4, size);
+    }
+}
+
+AnimStreamWriter::AnimStreamWriter(int fd, const WebPMuxAnimParams &anim_params) {
+    this->fd = fd;
+    this->animParams = anim_params;
+    // Content providers may hand out a pipe, which finish could not patch
+    this->seekable = lseek(fd, 0, SEEK_CUR) != -1;
+}
+
+bool AnimStreamWriter::isSeekable() const {
+    return seekable;
+}
+
+ResultCode AnimStreamWriter::writeAll(const uint8_t *data, size_t size) {
+    if (!seekable) {
+        buffer.insert(buffer.end(), data, data + size);
+        bytesWritten += size;
+        return RESULT_SUCCESS;
+    }
+    while (size > 0) {
+        ssize_t written = write(fd, data, size);
+        if (written <= 0) {
+            return ERROR_WRITE_TO_URI_FAILED;
+        }
+        data += written;
+        size -= written;
+        bytesWritten += written;
+    }
+    return RESULT_SUCCESS;
+}
+
+ResultCode AnimStreamWriter::writeHeader(int canvas_width, int canvas_height) {
+    uint8_t header[RIFF_HEADER_SIZE + CHUNK_HEADER_SIZE + VP8X_CHUNK_SIZE + CHUNK_HEADER_SIZE + ANIM_CHUNK_SIZE];
+    memset(header, 0, sizeof(header));
+    uint8_t *p = header;
+
+    // RIFF size is patched in finish
+    putChunkHeader(p, "RIFF", 0);
+    memcpy(p + 8, "WEBP", 4);
+    p += RIFF_HEADER_SIZE;
+
+    putChunkHeader(p, "VP8X", VP8X_CHUNK_SIZE);
+    p[8] = ANIMATION_FLAG;
+    putLE24(p + 12, canvas_width - 1);
+    putLE24(p + 15, canvas_height - 1);
+    p += CHUNK_HEADER_SIZE + VP8X_CHUNK_SIZE;
+
+    putChunkHeader(p, "ANIM", ANIM_CHUNK_SIZE);
+    putLE32(p + 8, animParams.bgcolor);
+    putLE16(p + 12, animParams.loop_count);
+
+    headerWritten = true;
+    return writeAll(header, sizeof(header));
+}
+
+ResultCode AnimStreamWriter::writeFrame(
+        const uint8_t *webp_data,
+        size_t webp_size,
+        int x_offset,
+        int y_offset,
+        int width,
+        int height,
+        int duration,
+        WebPMuxAnimBlend blend,
+        int canvas_width,
+        int canvas_height
+) {
+    if (webp_size < RIFF_HEADER_SIZE || memcmp(webp_data, "RIFF", 4) != 0 || memcmp(webp_data + 8, "WEBP", 4) != 0) {
+        return ERROR_ANIMATION_ASSEMBLE_FAILED;
+    }
+    if (!headerWritten) {
+        ResultCode result = writeHeader(canvas_width, canvas_height);
+        if (result != RESULT_SUCCESS) return result;
+    }
+
+    // Reject the frame before any of it is written, the file stays valid up to the previous frame
+    const uint64_t riff_size = bytesWritten - CHUNK_HEADER_SIZE + CHUNK_HEADER_SIZE + ANMF_HEADER_SIZE +
+                               (webp_size - RIFF_HEADER_SIZE);
+    if (riff_size > MAX_RIFF_SIZE) {
+        return ERROR_FILE_TOO_BIG;
+    }
+
+    // Keep the image chunks of the still, the VP8X chunk is replaced by the ANMF header
+    const uint8_t *image = webp_data + RIFF_HEADER_SIZE;
+    size_t image_size = webp_size - RIFF_HEADER_SIZE;
+    size_t pos = 0;
+    while (pos + CHUNK_HEADER_SIZE <= image_size) {
+        const uint8_t *chunk = image + pos;
+        size_t chunk_size = CHUNK_HEADER_SIZE + ((getLE32(chunk + 4) + 1) & ~1u);
+        if (pos == 0 && memcmp(chunk, "VP8X", 4) == 0) {
+            image += chunk_size;
+            image_size -= chunk_size;
+            continue;
+        }
+        if (memcmp(chunk, "ALPH", 4) == 0) {
+            hasAlpha = true;
+        } else if (memcmp(chunk, "VP8L", 4) == 0 && chunk_size >= CHUNK_HEADER_SIZE + 5 && chunk[8] == VP8L_SIGNATURE) {
+            hasAlpha |= ((getLE32(chunk + 9) >> 28) & 1) != 0;
+        }
+        pos += chunk_size;
+    }
+
+    uint8_t header[CHUNK_HEADER_SIZE + ANMF_HEADER_SIZE];
+    putChunkHeader(header, "ANMF", static_cast<uint32_t>(ANMF_HEADER_SIZE + image_size));
+    putLE24(header + 8, x_offset / 2);
+    putLE24(header + 11, y_offset / 2);
+    putLE24(header + 14, width - 1);
+    putLE24(header + 17, height - 1);
+    putLE24(header + 20, duration < 0 ? 0 : (duration > 0xffffff ? 0xffffff : duration));
+    header[23] = blend == WEBP_MUX_NO_BLEND ? 0x02 : 0x00;
+
+    ResultCode result = writeAll(header, sizeof(header));
+    if (result == RESULT_SUCCESS) {
+        result = writeAll(image, image_size);
+    }
+    return result;
+}
+
+ResultCode AnimStreamWriter::finish() {
+    if (!headerWritten) {
+        return ERROR_ANIMATION_ASSEMBLE_FAILED;
+    }
+    uint8_t riff_size[4];
+    putLE32(riff_size, static_cast<uint32_t>(bytesWritten - CHUNK_HEADER_SIZE));
+    uint8_t flags = ANIMATION_FLAG | (hasAlpha ? ALPHA_FLAG : 0);
+    if (!seekable) {
+        memcpy(buffer.data() + 4, riff_size, sizeof(riff_size));
+        buffer[VP8X_FLAGS_OFFSET] = flags;
+        const uint8_t *data = buffer.data();
+        size_t size = buffer.size();
+        while (size > 0) {
+            ssize_t written = write(fd, data, size);
+            if (written <= 0) {
+                return ERROR_WRITE_TO_URI_FAILED;
+            }
+            data += written;
+            size -= written;
+        }
+        std::vector<uint8_t>().swap(buffer);
+        return RESULT_SUCCESS;
+    }
+    if (pwrite(fd, riff_size, sizeof(riff_size), 4) != sizeof(riff_size) ||
+        pwrite(fd, &flags, 1, VP8X_FLAGS_OFFSET) != 1) {
+        return ERROR_WRITE_TO_URI_FAILED;
+    }
+    return RESULT_SUCCESS;
+}
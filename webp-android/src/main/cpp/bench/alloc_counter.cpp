@@ -0,0 +1,107 @@
+//
+// Created by udara on 10/19/26.
+//
+
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+
+#include "include/alloc_counter.h"
+
+#if defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define WEBPCODEC_HAS_ASAN
+#endif
+#endif
+#if defined(__SANITIZE_ADDRESS__)
+#define WEBPCODEC_HAS_ASAN
+#endif
+
+#if defined(__GLIBC__) && !defined(WEBPCODEC_HAS_ASAN)
+#define WEBPCODEC_COUNT_ALLOCS
+#endif
+
+namespace {
+    std::atomic<uint64_t> allocations{0};
+    std::atomic<uint64_t> allocated_bytes{0};
+
+    inline void countAllocation(size_t size) {
+        allocations.fetch_add(1, std::memory_order_relaxed);
+        allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+    }
+}
+
+#ifdef WEBPCODEC_COUNT_ALLOCS
+
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+void *__libc_memalign(size_t alignment, size_t size);
+void __libc_free(void *ptr);
+
+// operator new and libwebp's WebPSafeMalloc both end up here
+void *malloc(size_t size) {
+    countAllocation(size);
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size) {
+    // An overflowing size fails in glibc, so it is not counted
+    size_t bytes;
+    if (!__builtin_mul_overflow(count, size, &bytes)) {
+        countAllocation(bytes);
+    }
+    return __libc_calloc(count, size);
+}
+
+void *realloc(void *ptr, size_t size) {
+    countAllocation(size);
+    return __libc_realloc(ptr, size);
+}
+
+// Aligned operator new and std::aligned_alloc end up here, valloc and pvalloc are not counted
+void *memalign(size_t alignment, size_t size) {
+    countAllocation(size);
+    return __libc_memalign(alignment, size);
+}
+
+void *aligned_alloc(size_t alignment, size_t size) {
+    countAllocation(size);
+    return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void **ptr, size_t alignment, size_t size) {
+    if (alignment == 0 || alignment % sizeof(void *) != 0 || (alignment & (alignment - 1)) != 0) {
+        return EINVAL;
+    }
+    void *mem = __libc_memalign(alignment, size);
+    if (mem == nullptr) {
+        return ENOMEM;
+    }
+    countAllocation(size);
+    *ptr = mem;
+    return 0;
+}
+
+void free(void *ptr) {
+    __libc_free(ptr);
+}
+}
+
+#endif
+
+bool bench::isAllocCountingEnabled() {
+#ifdef WEBPCODEC_COUNT_ALLOCS
+    return true;
+#else
+    return false;
+#endif
+}
+
+bench::AllocStats bench::getAllocStats() {
+    return {
+            allocations.load(std::memory_order_relaxed),
+            allocated_bytes.load(std::memory_order_relaxed)
+    };
+}
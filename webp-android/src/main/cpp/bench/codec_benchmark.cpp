@@ -0,0 +1,751 @@
+//
+// Created by udara on 10/19/26.
+//
+
+#include <benchmark/benchmark.h>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+#include <webp/encode.h>
+#include <webp/mux.h>
+
+#include "include/alloc_counter.h"
+#include "bitmap_utils.h"
+#include "box_filter.h"
+#include "encoder_helper.h"
+#include "fake_jni.h"
+#include "native_loader.h"
+#include "webp_anim_encoder_core.h"
+#include "webp_decoder.h"
+#include "webp_decoder_core.h"
+#include "webp_encoder_core.h"
+#include "webp_transcoder.h"
+
+/**
+ * Host benchmarks of the codec core and the JNI glue. Run with --benchmark_format=json or
+ * --benchmark_out=<file> for JSON output. Besides time, each benchmark reports MPix/s, bytes/s,
+ * the peak RSS of the process so far and heap allocations per iteration.
+ */
+namespace {
+    constexpr int STILL_WIDTH = 640;
+    constexpr int STILL_HEIGHT = 480;
+    constexpr int ANIM_WIDTH = 320;
+    constexpr int ANIM_HEIGHT = 240;
+    constexpr int ANIM_FRAMES = 24;
+    constexpr int FRAME_DURATION = 40;
+    constexpr float QUALITY = 75.0f;
+
+    /**
+     * Gradient with noise, so that neither the lossy nor the lossless encoder has it too easy.
+     * A square moves across the frames of an animation.
+     */
+    std::vector<uint8_t> makeFrame(int width, int height, int frame_index) {
+        std::vector<uint8_t> pixels(static_cast<size_t>(width) * height * 4);
+        std::mt19937 random(12345);
+        std::uniform_int_distribution<int> noise(0, 15);
+        const int square_size = height / 4;
+        const int square_x = (frame_index * 8) % (width - square_size);
+        const int square_y = height / 3;
+        uint8_t *pixel = pixels.data();
+        for (int y = 0; y < height; y++) {
+            for (int x = 0; x < width; x++) {
+                bool in_square = x >= square_x && x < square_x + square_size &&
+                                 y >= square_y && y < square_y + square_size;
+                if (in_square) {
+                    pixel[0] = 230;
+                    pixel[1] = 40;
+                    pixel[2] = 40;
+                } else {
+                    pixel[0] = static_cast<uint8_t>(x * 255 / width + noise(random));
+                    pixel[1] = static_cast<uint8_t>(y * 255 / height + noise(random));
+                    pixel[2] = static_cast<uint8_t>((x + y) * 127 / (width + height) + noise(random));
+                }
+                pixel[3] = 255;
+                pixel += 4;
+            }
+        }
+        return pixels;
+    }
+
+    const std::vector<uint8_t> &stillFrame() {
+        static const std::vector<uint8_t> frame = makeFrame(STILL_WIDTH, STILL_HEIGHT, 0);
+        return frame;
+    }
+
+    const std::vector<std::vector<uint8_t>> &animFrames() {
+        static const std::vector<std::vector<uint8_t>> frames = [] {
+            std::vector<std::vector<uint8_t>> result;
+            for (int i = 0; i < ANIM_FRAMES; i++) {
+                result.push_back(makeFrame(ANIM_WIDTH, ANIM_HEIGHT, i));
+            }
+            return result;
+        }();
+        return frames;
+    }
+
+    WebPConfig makeConfig(WebPPreset preset, int method) {
+        WebPConfig config;
+        WebPConfigPreset(&config, preset, QUALITY);
+        config.method = method;
+        return config;
+    }
+
+    /**
+     * Encodes the animation frames with the given engine.
+     *
+     * @param thread_count See WebPAnimationEncoderCore::setParallelEncoding.
+     * @param output Receives the animation. Free with WebPDataClear.
+     */
+    ResultCode encodeAnimation(int thread_count, WebPData *output) {
+        WebPAnimEncoderOptions options;
+        WebPAnimEncoderOptionsInit(&options);
+        WebPAnimationEncoderCore encoder(ANIM_WIDTH, ANIM_HEIGHT, options);
+        encoder.configure(makeConfig(WEBP_PRESET_DEFAULT, 4));
+        encoder.setParallelEncoding(thread_count);
+        ResultCode result = RESULT_SUCCESS;
+        long timestamp = 0;
+        for (const auto &pixels: animFrames()) {
+            enc::RawFrame frame = {
+                    pixels.data(),
+                    ANIM_WIDTH,
+                    ANIM_HEIGHT,
+                    enc::PIXEL_FORMAT_RGBA_8888,
+                    0,
+                    0
+            };
+            enc::resolveStrides(&frame);
+            result = encoder.addFrame(frame, ANIM_WIDTH, ANIM_HEIGHT, timestamp);
+            if (result != RESULT_SUCCESS) break;
+            timestamp += FRAME_DURATION;
+        }
+        if (result == RESULT_SUCCESS) {
+            result = encoder.assemble(timestamp, output);
+        }
+        encoder.release();
+        return result;
+    }
+
+    const WebPData &stillWebP() {
+        static const WebPData data = [] {
+            WebPData result;
+            WebPDataInit(&result);
+            uint8_t *output = nullptr;
+            result.size = WebPEncodeRGBA(
+                    stillFrame().data(),
+                    STILL_WIDTH,
+                    STILL_HEIGHT,
+                    STILL_WIDTH * 4,
+                    QUALITY,
+                    &output
+            );
+            result.bytes = output;
+            return result;
+        }();
+        return data;
+    }
+
+    const WebPData &animWebP() {
+        static const WebPData data = [] {
+            WebPData result;
+            WebPDataInit(&result);
+            encodeAnimation(-1, &result);
+            return result;
+        }();
+        return data;
+    }
+
+    /**
+     * @return The value of a kB field of /proc/self/status in bytes, or -1 if it cannot be read.
+     */
+    long readStatusBytes(const char *field) {
+        FILE *file = fopen("/proc/self/status", "r");
+        if (file == nullptr) {
+            return -1;
+        }
+        const size_t field_length = strlen(field);
+        char line[256];
+        long kilobytes = -1;
+        while (fgets(line, sizeof(line), file) != nullptr) {
+            if (strncmp(line, field, field_length) == 0 && line[field_length] == ':') {
+                if (sscanf(line + field_length + 1, "%ld", &kilobytes) != 1) {
+                    kilobytes = -1;
+                }
+                break;
+            }
+        }
+        fclose(file);
+        return kilobytes < 0 ? -1 : kilobytes * 1024;
+    }
+
+    /**
+     * Resets the peak RSS of the process to its current RSS, Linux 4.0 and later.
+     *
+     * @return false if the peak could not be reset.
+     */
+    bool resetPeakRss() {
+        FILE *file = fopen("/proc/self/clear_refs", "w");
+        if (file == nullptr) {
+            return false;
+        }
+        const bool ok = fputs("5", file) >= 0;
+        return fclose(file) == 0 && ok;
+    }
+
+    /**
+     * Measures allocations and RSS growth from construction until report.
+     *
+     * The RSS high-water mark of the process never goes down, so it is reset at construction and peak_rss
+     * and rss_growth only cover this benchmark. Where it cannot be reset, rss_growth is the growth of the
+     * current RSS and peak_rss is left out. Neither is reported without /proc.
+     */
+    class ResourceCounter {
+        bench::AllocStats start_;
+        bool peak_reset_;
+        long start_rss_;
+
+    public:
+        ResourceCounter()
+                : start_(bench::getAllocStats()),
+                  peak_reset_(resetPeakRss()),
+                  start_rss_(readStatusBytes("VmRSS")) {}
+
+        void report(benchmark::State &state) const {
+            if (bench::isAllocCountingEnabled()) {
+                bench::AllocStats end = bench::getAllocStats();
+                state.counters["allocs"] = benchmark::Counter(
+                        static_cast<double>(end.allocations - start_.allocations),
+                        benchmark::Counter::kAvgIterations
+                );
+                state.counters["alloc_bytes"] = benchmark::Counter(
+                        static_cast<double>(end.bytes - start_.bytes),
+                        benchmark::Counter::kAvgIterations,
+                        benchmark::Counter::kIs1024
+                );
+            }
+            const long end_rss = readStatusBytes(peak_reset_ ? "VmHWM" : "VmRSS");
+            if (start_rss_ < 0 || end_rss < 0) {
+                return;
+            }
+            if (peak_reset_) {
+                state.counters["peak_rss"] = benchmark::Counter(
+                        static_cast<double>(end_rss),
+                        benchmark::Counter::kDefaults,
+                        benchmark::Counter::kIs1024
+                );
+            }
+            state.counters["rss_growth"] = benchmark::Counter(
+                    static_cast<double>(end_rss - start_rss_),
+                    benchmark::Counter::kDefaults,
+                    benchmark::Counter::kIs1024
+            );
+        }
+    };
+
+    /**
+     * Reports MPix/s and bytes/s for the given pixels per iteration. Bytes are RGBA bytes.
+     */
+    void reportThroughput(benchmark::State &state, int64_t pixels_per_iteration) {
+        state.counters["MPix/s"] = benchmark::Counter(
+                static_cast<double>(pixels_per_iteration) * static_cast<double>(state.iterations()) / 1e6,
+                benchmark::Counter::kIsRate
+        );
+        state.SetBytesProcessed(pixels_per_iteration * 4 * state.iterations());
+    }
+
+    /**
+     * Downscales RGBA pixels by an integer factor with an exact, alpha weighted area average.
+     *
+     * @return ARGB words of the output image.
+     */
+    std::vector<uint32_t> averageDownscale(const uint8_t *pixels, int width, int height, int factor) {
+        const int dst_width = width / factor;
+        const int dst_height = height / factor;
+        std::vector<uint32_t> argb(static_cast<size_t>(dst_width) * dst_height);
+        for (int y = 0; y < dst_height; y++) {
+            for (int x = 0; x < dst_width; x++) {
+                double sums[4] = {0, 0, 0, 0};
+                for (int j = 0; j < factor; j++) {
+                    const uint8_t *pixel = pixels + ((static_cast<size_t>(y) * factor + j) * width + x * factor) * 4;
+                    for (int i = 0; i < factor; i++, pixel += 4) {
+                        sums[0] += pixel[0] * pixel[3];
+                        sums[1] += pixel[1] * pixel[3];
+                        sums[2] += pixel[2] * pixel[3];
+                        sums[3] += pixel[3];
+                    }
+                }
+                uint32_t channels[4] = {0, 0, 0, 0};
+                if (sums[3] > 0) {
+                    for (int c = 0; c < 3; c++) {
+                        channels[c] = static_cast<uint32_t>(std::lround(sums[c] / sums[3]));
+                    }
+                    channels[3] = static_cast<uint32_t>(std::lround(sums[3] / (factor * factor)));
+                }
+                argb[static_cast<size_t>(y) * dst_width + x] =
+                        (channels[3] << 24) | (channels[0] << 16) | (channels[1] << 8) | channels[2];
+            }
+        }
+        return argb;
+    }
+
+    /**
+     * @return PSNR in dB of the ARGB picture against the reference, over all four channels.
+     */
+    double computePsnr(const WebPPicture &picture, const std::vector<uint32_t> &reference) {
+        double squared_error = 0;
+        for (int y = 0; y < picture.height; y++) {
+            for (int x = 0; x < picture.width; x++) {
+                const uint32_t a = picture.argb[static_cast<size_t>(y) * picture.argb_stride + x];
+                const uint32_t b = reference[static_cast<size_t>(y) * picture.width + x];
+                for (int shift = 0; shift < 32; shift += 8) {
+                    const double diff = static_cast<double>((a >> shift) & 0xFF) - ((b >> shift) & 0xFF);
+                    squared_error += diff * diff;
+                }
+            }
+        }
+        const double mse = squared_error / (static_cast<double>(picture.width) * picture.height * 4);
+        return mse == 0 ? 99.0 : 10 * std::log10(255.0 * 255.0 / mse);
+    }
+
+    void skipWithResult(benchmark::State &state, ResultCode result) {
+        state.SkipWithError(res::parseMessage(result).c_str());
+    }
+
+    /**
+     * Loads the glue into the fake JVM once, as the runtime does when the library is loaded.
+     */
+    JNIEnv *jniEnv() {
+        static JNIEnv *env = [] {
+            JNI_OnLoad(fake::getJavaVM(), nullptr);
+            return fake::getEnv();
+        }();
+        return env;
+    }
+}
+
+static void BM_EncodeStill(benchmark::State &state) {
+    const auto preset = static_cast<WebPPreset>(state.range(0));
+    const int method = static_cast<int>(state.range(1));
+    WebPEncoderCore encoder(STILL_WIDTH, STILL_HEIGHT);
+    encoder.configure(makeConfig(preset, method));
+    const uint8_t *pixels = stillFrame().data();
+
+    ResourceCounter counter;
+    for (auto _: state) {
+        const uint8_t *webp_data = nullptr;
+        size_t webp_size = 0;
+        ResultCode result = encoder.encode(
+                pixels,
+                STILL_WIDTH,
+                STILL_HEIGHT,
+                STILL_WIDTH,
+                STILL_HEIGHT,
+                &webp_data,
+                &webp_size
+        );
+        if (result != RESULT_SUCCESS) {
+            skipWithResult(state, result);
+            break;
+        }
+        WebPFree((void *) webp_data);
+    }
+    counter.report(state);
+    reportThroughput(state, STILL_WIDTH * STILL_HEIGHT);
+    encoder.release();
+}
+
+BENCHMARK(BM_EncodeStill)
+        ->ArgsProduct({{WEBP_PRESET_DEFAULT, WEBP_PRESET_PICTURE, WEBP_PRESET_PHOTO,
+                        WEBP_PRESET_DRAWING, WEBP_PRESET_ICON, WEBP_PRESET_TEXT},
+                       {0, 2, 4, 6}})
+        ->ArgNames({"preset", "method"})
+        ->Unit(benchmark::kMillisecond);
+
+static void BM_EncodeAnimation(benchmark::State &state) {
+    const int thread_count = static_cast<int>(state.range(0));
+    animFrames();
+
+    ResourceCounter counter;
+    size_t output_bytes = 0;
+    for (auto _: state) {
+        WebPData output;
+        WebPDataInit(&output);
+        ResultCode result = encodeAnimation(thread_count, &output);
+        if (result != RESULT_SUCCESS) {
+            skipWithResult(state, result);
+            break;
+        }
+        output_bytes = output.size;
+        WebPDataClear(&output);
+    }
+    counter.report(state);
+    reportThroughput(state, ANIM_WIDTH * ANIM_HEIGHT * ANIM_FRAMES);
+    // The engines diff and merge frames differently, compare sizes along with speed
+    state.counters["output_bytes"] = benchmark::Counter(
+            static_cast<double>(output_bytes),
+            benchmark::Counter::kDefaults,
+            benchmark::Counter::kIs1024
+    );
+}
+
+// -1 is libwebp's sequential encoder, 0 the parallel engine with one thread per core
+BENCHMARK(BM_EncodeAnimation)
+        ->Arg(-1)
+        ->Arg(0)
+        ->ArgName("threads")
+        ->Unit(benchmark::kMillisecond)
+        ->UseRealTime();
+
+/**
+ * Downscales the still frame by an integer factor with the box filter the encoder uses for integer ratios.
+ */
+static void BM_BoxDownscale(benchmark::State &state) {
+    const int factor = static_cast<int>(state.range(0));
+    const int dst_width = STILL_WIDTH / factor;
+    const int dst_height = STILL_HEIGHT / factor;
+    const uint8_t *pixels = stillFrame().data();
+    WebPPicture picture;
+    WebPPictureInit(&picture);
+    picture.use_argb = 1;
+    picture.width = dst_width;
+    picture.height = dst_height;
+    if (!WebPPictureAlloc(&picture)) {
+        skipWithResult(state, ERROR_MEMORY_ERROR);
+        return;
+    }
+
+    ResourceCounter counter;
+    for (auto _: state) {
+        bmp::boxDownscale(pixels, STILL_WIDTH * 4, factor, picture.argb, dst_width, dst_height, picture.argb_stride);
+        benchmark::ClobberMemory();
+    }
+    counter.report(state);
+    reportThroughput(state, STILL_WIDTH * STILL_HEIGHT);
+    state.counters["psnr"] = computePsnr(picture, averageDownscale(pixels, STILL_WIDTH, STILL_HEIGHT, factor));
+    WebPPictureFree(&picture);
+}
+
+BENCHMARK(BM_BoxDownscale)
+        ->Arg(2)
+        ->Arg(4)
+        ->ArgName("factor")
+        ->Unit(benchmark::kMicrosecond);
+
+/**
+ * Downscales the still frame with WebPPictureRescale, the path for other ratios. Includes the import
+ * of the RGBA pixels, which the box filter does not need.
+ */
+static void BM_PictureRescale(benchmark::State &state) {
+    const int factor = static_cast<int>(state.range(0));
+    const int dst_width = STILL_WIDTH / factor;
+    const int dst_height = STILL_HEIGHT / factor;
+    const uint8_t *pixels = stillFrame().data();
+    WebPPicture picture;
+    WebPPictureInit(&picture);
+
+    ResourceCounter counter;
+    for (auto _: state) {
+        WebPPictureFree(&picture);
+        WebPPictureInit(&picture);
+        picture.use_argb = 1;
+        picture.width = STILL_WIDTH;
+        picture.height = STILL_HEIGHT;
+        if (!WebPPictureImportRGBA(&picture, pixels, STILL_WIDTH * 4) ||
+            !WebPPictureRescale(&picture, dst_width, dst_height)) {
+            skipWithResult(state, ERROR_BITMAP_RESIZE_FAILED);
+            break;
+        }
+        benchmark::ClobberMemory();
+    }
+    counter.report(state);
+    reportThroughput(state, STILL_WIDTH * STILL_HEIGHT);
+    if (picture.argb != nullptr && picture.width == dst_width) {
+        state.counters["psnr"] = computePsnr(picture, averageDownscale(pixels, STILL_WIDTH, STILL_HEIGHT, factor));
+    }
+    WebPPictureFree(&picture);
+}
+
+BENCHMARK(BM_PictureRescale)
+        ->Arg(2)
+        ->Arg(4)
+        ->ArgName("factor")
+        ->Unit(benchmark::kMicrosecond);
+
+static void BM_DecodeStill(benchmark::State &state) {
+    const WebPData &data = stillWebP();
+    WebPDecoderCore decoder;
+    ResultCode result = decoder.setData(data.bytes, data.size);
+    if (result != RESULT_SUCCESS) {
+        skipWithResult(state, result);
+        return;
+    }
+
+    ResourceCounter counter;
+    for (auto _: state) {
+        decoder.reset();
+        const uint8_t *pixels = nullptr;
+        int timestamp = 0;
+        result = decoder.decodeNextFrame(&pixels, &timestamp);
+        if (result != RESULT_SUCCESS) {
+            skipWithResult(state, result);
+            break;
+        }
+        benchmark::DoNotOptimize(pixels);
+    }
+    counter.report(state);
+    reportThroughput(state, STILL_WIDTH * STILL_HEIGHT);
+}
+
+BENCHMARK(BM_DecodeStill)->Unit(benchmark::kMicrosecond);
+
+static void BM_DecodeAnimation(benchmark::State &state) {
+    const WebPData &data = animWebP();
+    WebPDecoderCore decoder;
+    ResultCode result = decoder.setData(data.bytes, data.size);
+    if (result != RESULT_SUCCESS) {
+        skipWithResult(state, result);
+        return;
+    }
+
+    ResourceCounter counter;
+    for (auto _: state) {
+        decoder.reset();
+        const uint8_t *pixels = nullptr;
+        int timestamp = 0;
+        while (decoder.hasNextFrame()) {
+            result = decoder.decodeNextFrame(&pixels, &timestamp);
+            if (result != RESULT_SUCCESS) break;
+            benchmark::DoNotOptimize(pixels);
+        }
+        if (result != RESULT_SUCCESS) {
+            skipWithResult(state, result);
+            break;
+        }
+    }
+    counter.report(state);
+    reportThroughput(state, ANIM_WIDTH * ANIM_HEIGHT * ANIM_FRAMES);
+}
+
+BENCHMARK(BM_DecodeAnimation)->Unit(benchmark::kMillisecond);
+
+static void BM_DecodeAnimationBatch(benchmark::State &state) {
+    const int batch_size = static_cast<int>(state.range(0));
+    const WebPData &data = animWebP();
+    WebPDecoderCore decoder;
+    ResultCode result = decoder.setData(data.bytes, data.size);
+    if (result != RESULT_SUCCESS) {
+        skipWithResult(state, result);
+        return;
+    }
+    const size_t frame_size = static_cast<size_t>(ANIM_WIDTH) * ANIM_HEIGHT * 4;
+    std::vector<uint8_t> frame_stack(frame_size * batch_size);
+    std::vector<int> timestamps(batch_size);
+
+    ResourceCounter counter;
+    for (auto _: state) {
+        decoder.reset();
+        int decoded;
+        do {
+            result = decoder.decodeFrameBatch(
+                    batch_size,
+                    frame_stack.data(),
+                    frame_stack.size(),
+                    timestamps.data(),
+                    &decoded
+            );
+        } while (result == RESULT_SUCCESS && decoded > 0);
+        if (result != RESULT_SUCCESS) {
+            skipWithResult(state, result);
+            break;
+        }
+        benchmark::ClobberMemory();
+    }
+    counter.report(state);
+    reportThroughput(state, ANIM_WIDTH * ANIM_HEIGHT * ANIM_FRAMES);
+}
+
+BENCHMARK(BM_DecodeAnimationBatch)
+        ->Arg(1)
+        ->Arg(8)
+        ->ArgName("batch")
+        ->Unit(benchmark::kMillisecond);
+
+/**
+ * Re-encodes the animation frame by frame through the decoder and the sequential encoder, the way
+ * an app without the transcoder does. Compare with BM_Transcode.
+ */
+static void BM_DecodeAndEncode(benchmark::State &state) {
+    const WebPData &data = animWebP();
+    const WebPConfig config = makeConfig(WEBP_PRESET_DEFAULT, 4);
+    WebPAnimEncoderOptions options;
+    WebPAnimEncoderOptionsInit(&options);
+    WebPDecoderCore decoder;
+    ResultCode result = decoder.setData(data.bytes, data.size);
+    if (result != RESULT_SUCCESS) {
+        skipWithResult(state, result);
+        return;
+    }
+
+    ResourceCounter counter;
+    for (auto _: state) {
+        decoder.reset();
+        WebPAnimationEncoderCore encoder(ANIM_WIDTH, ANIM_HEIGHT, options);
+        encoder.configure(config);
+        const uint8_t *pixels = nullptr;
+        int start = 0;
+        int end = 0;
+        while (result == RESULT_SUCCESS && decoder.hasNextFrame()) {
+            result = decoder.decodeNextFrame(&pixels, &end);
+            if (result != RESULT_SUCCESS) break;
+            enc::RawFrame frame = {pixels, ANIM_WIDTH, ANIM_HEIGHT, enc::PIXEL_FORMAT_RGBA_8888, 0, 0};
+            enc::resolveStrides(&frame);
+            result = encoder.addFrame(frame, ANIM_WIDTH, ANIM_HEIGHT, start);
+            start = end;
+        }
+        WebPData output;
+        WebPDataInit(&output);
+        if (result == RESULT_SUCCESS) {
+            result = encoder.assemble(end, &output);
+        }
+        WebPDataClear(&output);
+        encoder.release();
+        if (result != RESULT_SUCCESS) {
+            skipWithResult(state, result);
+            break;
+        }
+    }
+    counter.report(state);
+    reportThroughput(state, ANIM_WIDTH * ANIM_HEIGHT * ANIM_FRAMES);
+}
+
+BENCHMARK(BM_DecodeAndEncode)
+        ->Unit(benchmark::kMillisecond)
+        ->UseRealTime();
+
+/**
+ * Re-encodes the animation with the transcoder, which decodes the next frame while the previous one is encoded.
+ */
+static void BM_Transcode(benchmark::State &state) {
+    const WebPData &data = animWebP();
+    const WebPConfig config = makeConfig(WEBP_PRESET_DEFAULT, 4);
+    WebPAnimEncoderOptions options;
+    WebPAnimEncoderOptionsInit(&options);
+    const trans::TranscodeParams params = {0, 0, 0, 0, 0, 0, 0};
+    WebPTranscoder transcoder;
+
+    ResourceCounter counter;
+    for (auto _: state) {
+        WebPData output;
+        ResultCode result = transcoder.transcode(data, config, options, true, params, &output);
+        WebPDataClear(&output);
+        if (result != RESULT_SUCCESS) {
+            skipWithResult(state, result);
+            break;
+        }
+    }
+    counter.report(state);
+    reportThroughput(state, ANIM_WIDTH * ANIM_HEIGHT * ANIM_FRAMES);
+}
+
+BENCHMARK(BM_Transcode)
+        ->Unit(benchmark::kMillisecond)
+        ->UseRealTime();
+
+/**
+ * Decodes a still image through the Java binding, compare with BM_DecodeStill for the JNI overhead.
+ */
+static void BM_JniDecodeStill(benchmark::State &state) {
+    JNIEnv *env = jniEnv();
+    const WebPData &data = stillWebP();
+    jobject jdecoder = fake::newObject("com/aureusapps/android/webpandroid/decoder/WebPDecoder");
+    env->SetLongField(
+            jdecoder,
+            ClassRegistry::webPDecoderPointerFieldID.get(env),
+            dec::nativeCreate(env, jdecoder)
+    );
+    jobject jbuffer = env->NewDirectByteBuffer(
+            const_cast<uint8_t *>(data.bytes),
+            static_cast<jlong>(data.size)
+    );
+
+    jint result = dec::nativeSetDataBuffer(env, jdecoder, jbuffer);
+    if (result != RESULT_SUCCESS) {
+        skipWithResult(state, static_cast<ResultCode>(result));
+        return;
+    }
+
+    ResourceCounter counter;
+    for (auto _: state) {
+        dec::nativeReset(env, jdecoder);
+        // The result code is packed into the top byte, see WebPDecoder.decodeNextFrame
+        jlong packed = dec::nativeDecodeNextFrame(env, jdecoder);
+        result = static_cast<jint>((static_cast<uint64_t>(packed) >> 56) & 0xFF);
+        if (result != RESULT_SUCCESS) {
+            skipWithResult(state, static_cast<ResultCode>(result));
+            break;
+        }
+    }
+    counter.report(state);
+    reportThroughput(state, STILL_WIDTH * STILL_HEIGHT);
+    dec::nativeRelease(env, jdecoder);
+    fake::releaseObjects();
+}
+
+BENCHMARK(BM_JniDecodeStill)->Unit(benchmark::kMicrosecond);
+
+static void BM_CopyPixels(benchmark::State &state) {
+    JNIEnv *env = jniEnv();
+    jobject jbitmap = fake::newBitmap(STILL_WIDTH, STILL_HEIGHT);
+    const uint8_t *pixels = stillFrame().data();
+
+    ResourceCounter counter;
+    for (auto _: state) {
+        ResultCode result = bmp::copyPixels(env, pixels, jbitmap);
+        if (result != RESULT_SUCCESS) {
+            skipWithResult(state, result);
+            break;
+        }
+        benchmark::ClobberMemory();
+    }
+    counter.report(state);
+    reportThroughput(state, STILL_WIDTH * STILL_HEIGHT);
+    fake::releaseObjects();
+}
+
+BENCHMARK(BM_CopyPixels)->Unit(benchmark::kMicrosecond);
+
+static void BM_BuildWebPConfig(benchmark::State &state) {
+    JNIEnv *env = jniEnv();
+    jobject jconfig = fake::newObject("com/aureusapps/android/webpandroid/encoder/WebPConfig");
+    jint packed[enc::CONFIG_VALUE_COUNT + 1] = {0};
+    float quality = QUALITY;
+    packed[0] = (1 << enc::CONFIG_LOSSLESS) | (1 << enc::CONFIG_QUALITY) | (1 << enc::CONFIG_METHOD) |
+                (1 << enc::CONFIG_USE_SHARP_YUV);
+    packed[1 + enc::CONFIG_LOSSLESS] = 0;
+    std::memcpy(&packed[1 + enc::CONFIG_QUALITY], &quality, sizeof(jint));
+    packed[1 + enc::CONFIG_METHOD] = 4;
+    packed[1 + enc::CONFIG_USE_SHARP_YUV] = 1;
+    jintArray jpacked = env->NewIntArray(enc::CONFIG_VALUE_COUNT + 1);
+    env->SetIntArrayRegion(jpacked, 0, enc::CONFIG_VALUE_COUNT + 1, packed);
+    env->SetObjectField(jconfig, ClassRegistry::webPConfigPackedFieldID.get(env), jpacked);
+    jobject jpreset = fake::newObject("com/aureusapps/android/webpandroid/encoder/WebPPreset");
+    env->SetIntField(jpreset, ClassRegistry::webPPresetOrdinalFieldID.get(env), WEBP_PRESET_PHOTO);
+
+    ResourceCounter counter;
+    for (auto _: state) {
+        WebPConfig config;
+        ResultCode result = enc::buildWebPConfig(env, jconfig, jpreset, &config);
+        if (result != RESULT_SUCCESS) {
+            skipWithResult(state, result);
+            break;
+        }
+        benchmark::DoNotOptimize(config);
+    }
+    counter.report(state);
+    fake::releaseObjects();
+}
+
+BENCHMARK(BM_BuildWebPConfig);
+
+BENCHMARK_MAIN();
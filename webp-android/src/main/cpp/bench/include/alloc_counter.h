@@ -0,0 +1,30 @@
+//
+// Created by udara on 10/19/26.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Counts heap allocations of the benchmark process by replacing malloc, calloc, realloc and the aligned
+ * allocation functions: memalign, aligned_alloc and posix_memalign.
+ * Only available with glibc and without AddressSanitizer, which replaces them itself.
+ */
+namespace bench {
+    typedef struct {
+        uint64_t allocations;
+        uint64_t bytes;
+    } AllocStats;
+
+    /**
+     * @return true if allocations are counted.
+     */
+    bool isAllocCountingEnabled();
+
+    /**
+     * @return Allocations made by all threads since the process started.
+     */
+    AllocStats getAllocStats();
+}
@@ -2,6 +2,7 @@
 // Created by udara on 6/8/23.
 //
 
+#include <cstring>
 #include <stdexcept>
 #include <android/bitmap.h>
 
@@ -114,4 +115,4 @@ void bmp::recycleBitmap(
             jbitmap,
             ClassRegistry::bitmapRecycleMethodID.get(env)
     );
-}
\ No newline at end of file
+}
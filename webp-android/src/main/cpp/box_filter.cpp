@@ -0,0 +1,124 @@
+//
+// Created by udara on 10/19/26.
+//
+
+#include <algorithm>
+#include <vector>
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "include/box_filter.h"
+
+namespace {
+    /**
+     * Adds the alpha weighted channels of a row of RGBA_8888 pixels to the column sums, stored as
+     * {r * a, g * a, b * a, a} per pixel. r * a fits into 16 bits, so two pixels are multiplied
+     * in one 16x8 lane vector and widened into the 32 bit sums.
+     */
+    void accumulateRow(const uint8_t *src, int width, uint32_t *sums) {
+        int x = 0;
+#if defined(__ARM_NEON)
+        // Alpha of each pixel in the color lanes, index 8 is out of range and yields 0 in the alpha lane
+        const uint8x8_t alpha_index = {3, 3, 3, 8, 7, 7, 7, 8};
+        const uint8x8_t alpha_one = {0, 0, 0, 1, 0, 0, 0, 1};
+        for (; x + 2 <= width; x += 2) {
+            const uint8x8_t pixels = vld1_u8(src + x * 4);
+            const uint8x8_t weights = vorr_u8(vtbl1_u8(pixels, alpha_index), alpha_one);
+            const uint16x8_t products = vmull_u8(pixels, weights);
+            uint32_t *sum = sums + x * 4;
+            vst1q_u32(sum, vaddw_u16(vld1q_u32(sum), vget_low_u16(products)));
+            vst1q_u32(sum + 4, vaddw_u16(vld1q_u32(sum + 4), vget_high_u16(products)));
+        }
+#elif defined(__SSE2__)
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i color_mask = _mm_set_epi16(0, -1, -1, -1, 0, -1, -1, -1);
+        const __m128i alpha_one = _mm_set_epi16(1, 0, 0, 0, 1, 0, 0, 0);
+        for (; x + 2 <= width; x += 2) {
+            const __m128i pixels = _mm_unpacklo_epi8(
+                    _mm_loadl_epi64(reinterpret_cast<const __m128i *>(src + x * 4)),
+                    zero
+            );
+            __m128i alpha = _mm_shufflelo_epi16(pixels, _MM_SHUFFLE(3, 3, 3, 3));
+            alpha = _mm_shufflehi_epi16(alpha, _MM_SHUFFLE(3, 3, 3, 3));
+            const __m128i weights = _mm_or_si128(_mm_and_si128(alpha, color_mask), alpha_one);
+            const __m128i products = _mm_mullo_epi16(pixels, weights);
+            auto *sum = reinterpret_cast<__m128i *>(sums + x * 4);
+            _mm_storeu_si128(sum, _mm_add_epi32(_mm_loadu_si128(sum), _mm_unpacklo_epi16(products, zero)));
+            _mm_storeu_si128(sum + 1, _mm_add_epi32(_mm_loadu_si128(sum + 1), _mm_unpackhi_epi16(products, zero)));
+        }
+#endif
+        for (; x < width; x++) {
+            const uint8_t *q = src + x * 4;
+            uint32_t *sum = sums + x * 4;
+            const uint32_t a = q[3];
+            sum[0] += q[0] * a;
+            sum[1] += q[1] * a;
+            sum[2] += q[2] * a;
+            sum[3] += a;
+        }
+    }
+}
+
+int bmp::boxDownscaleFactor(
+        int src_width,
+        int src_height,
+        int dst_width,
+        int dst_height
+) {
+    if (dst_width <= 0 || dst_height <= 0) return 0;
+    if (src_width % dst_width != 0 || src_height % dst_height != 0) return 0;
+    int factor = src_width / dst_width;
+    if (factor != src_height / dst_height) return 0;
+    // 16x16 blocks keep the alpha weighted sums within 32 bits
+    return factor >= 2 && factor <= 16 ? factor : 0;
+}
+
+void bmp::boxDownscale(
+        const uint8_t *src_pixels,
+        int src_stride,
+        int factor,
+        uint32_t *dst_argb,
+        int dst_width,
+        int dst_height,
+        int dst_stride
+) {
+    const uint32_t area = factor * factor;
+    const int src_width = dst_width * factor;
+    std::vector<uint32_t> sums(src_width * 4);
+
+    for (int y = 0; y < dst_height; y++) {
+        std::fill(sums.begin(), sums.end(), 0);
+
+        // Sum the block rows per source column, the bulk of the work
+        for (int row = 0; row < factor; row++) {
+            accumulateRow(src_pixels + (y * factor + row) * src_stride, src_width, sums.data());
+        }
+
+        // Sum the block columns, then normalize and pack
+        uint32_t *dst = dst_argb + y * dst_stride;
+        for (int x = 0; x < dst_width; x++) {
+            const uint32_t *sum = sums.data() + x * factor * 4;
+            uint32_t r = 0, g = 0, b = 0, a = 0;
+            for (int k = 0; k < factor; k++, sum += 4) {
+                r += sum[0];
+                g += sum[1];
+                b += sum[2];
+                a += sum[3];
+            }
+            if (a == 0) {
+                dst[x] = 0;
+                continue;
+            }
+            uint32_t half = a / 2;
+            r = (r + half) / a;
+            g = (g + half) / a;
+            b = (b + half) / a;
+            uint32_t alpha = (a + area / 2) / area;
+            dst[x] = (alpha << 24) | (r << 16) | (g << 8) | b;
+        }
+    }
+}
@@ -0,0 +1,43 @@
+//
+// Created by udara on 10/19/26.
+//
+
+#include <webp/types.h>
+
+#include "include/buffer_utils.h"
+#include "include/native_loader.h"
+#include "include/type_helper.h"
+
+jobject buf::wrapWebPData(
+        JNIEnv *env,
+        const uint8_t *data,
+        size_t size
+) {
+    void *address = const_cast<uint8_t *>(data);
+    jobject jbuffer = env->NewDirectByteBuffer(address, static_cast<jlong>(size));
+    if (type::isObjectNull(env, jbuffer)) {
+        if (env->ExceptionCheck()) {
+            env->ExceptionClear();
+        }
+        WebPFree(address);
+        return nullptr;
+    }
+    jobject jowner = env->CallStaticObjectMethod(
+            ClassRegistry::nativeBufferCleanerClass.get(env),
+            ClassRegistry::nativeBufferCleanerRegisterMethodID.get(env),
+            jbuffer,
+            reinterpret_cast<jlong>(address)
+    );
+    env->DeleteLocalRef(jbuffer);
+    if (env->ExceptionCheck()) {
+        // register throws before the cleaner holds the pointer, so it is still ours to free
+        env->ExceptionClear();
+        WebPFree(address);
+        return nullptr;
+    }
+    return jowner;
+}
+
+void buf::nativeFree(JNIEnv *, jclass, jlong jpointer) {
+    WebPFree(reinterpret_cast<void *>(jpointer));
+}
@@ -31,4 +31,15 @@ void exc::throwCancellationException(JNIEnv *env, const char *format, ...) {
     va_start(args, format);
     throwException(env, ClassRegistry::cancellationExceptionClass.get(env), format, args);
     va_end(args);
-}
\ No newline at end of file
+}
+
+void res::handleResult(JNIEnv *env, ResultCode result) {
+    if (result != RESULT_SUCCESS) {
+        std::string message = parseMessage(result);
+        if (result == ERROR_USER_ABORT) {
+            exc::throwCancellationException(env, message.c_str());
+        } else {
+            exc::throwRuntimeException(env, message.c_str());
+        }
+    }
+}
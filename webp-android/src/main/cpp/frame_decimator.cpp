@@ -0,0 +1,155 @@
+//
+// Created by udara on 10/19/26.
+//
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+#include "include/frame_decimator.h"
+
+namespace {
+    constexpr int SIGNATURE_SIZE = 32;
+}
+
+void FrameDecimator::configure(double frame_duration, bool measure_difference) {
+    frameDuration = frame_duration > 0 ? frame_duration : 0;
+    measureDifference = measure_difference;
+    currentSlot = -1;
+    hasCandidate = false;
+    std::vector<uint8_t>().swap(candidatePixels);
+    keptSignature.clear();
+}
+
+bool FrameDecimator::isEnabled() const {
+    return frameDuration > 0;
+}
+
+bool FrameDecimator::isStarted() const {
+    return currentSlot >= 0 || droppedCount > 0;
+}
+
+long FrameDecimator::slotTime(long slot) const {
+    return std::lround(static_cast<double>(slot) * frameDuration);
+}
+
+void FrameDecimator::computeSignature(const enc::RawFrame &frame, std::vector<uint8_t> *signature) {
+    signature->resize(SIGNATURE_SIZE * SIGNATURE_SIZE);
+    const bool rgba = frame.format == enc::PIXEL_FORMAT_RGBA_8888;
+    for (int j = 0; j < SIGNATURE_SIZE; j++) {
+        const int y = static_cast<int>((static_cast<long>(2 * j + 1) * frame.height) / (2 * SIGNATURE_SIZE));
+        const uint8_t *row = frame.data + static_cast<size_t>(y) * frame.row_stride;
+        for (int i = 0; i < SIGNATURE_SIZE; i++) {
+            const int x = static_cast<int>((static_cast<long>(2 * i + 1) * frame.width) / (2 * SIGNATURE_SIZE));
+            uint8_t luma;
+            if (rgba) {
+                // Integer approximation of BT.601 luma
+                const uint8_t *pixel = row + static_cast<size_t>(x) * 4;
+                luma = static_cast<uint8_t>((pixel[0] * 2 + pixel[1] * 5 + pixel[2]) >> 3);
+            } else {
+                // YUV frames start with the luma plane
+                luma = row[x];
+            }
+            (*signature)[j * SIGNATURE_SIZE + i] = luma;
+        }
+    }
+}
+
+uint32_t FrameDecimator::difference(const std::vector<uint8_t> &a, const std::vector<uint8_t> &b) {
+    if (a.size() != b.size()) {
+        return UINT32_MAX;
+    }
+    uint32_t sum = 0;
+    for (size_t i = 0; i < a.size(); i++) {
+        sum += std::abs(static_cast<int>(a[i]) - static_cast<int>(b[i]));
+    }
+    return sum;
+}
+
+ResultCode FrameDecimator::commitCandidate(const Sink &sink) {
+    if (!hasCandidate) {
+        return RESULT_SUCCESS;
+    }
+    hasCandidate = false;
+    keptSignature.swap(candidateSignature);
+    return sink(candidateFrame, slotTime(currentSlot));
+}
+
+ResultCode FrameDecimator::submit(const enc::RawFrame &frame, long timestamp, const Sink &sink) {
+    // Frames before the start belong to the first output frame
+    timestamp = std::max(timestamp, 0L);
+
+    // Output frame times are rounded, so the slot is the last one whose rounded time is not after the frame
+    auto slot = static_cast<long>(std::floor(timestamp / frameDuration));
+    while (slot > 0 && slotTime(slot) > timestamp) {
+        slot--;
+    }
+    while (slotTime(slot + 1) <= timestamp) {
+        slot++;
+    }
+    if (slot < currentSlot) {
+        // Out of order frames cannot be placed
+        droppedCount++;
+        return RESULT_SUCCESS;
+    }
+    if (!measureDifference) {
+        if (slot == currentSlot) {
+            droppedCount++;
+            return RESULT_SUCCESS;
+        }
+        currentSlot = slot;
+        return sink(frame, slotTime(slot));
+    }
+
+    ResultCode result = RESULT_SUCCESS;
+    if (slot > currentSlot) {
+        result = commitCandidate(sink);
+        currentSlot = slot;
+    }
+    if (result != RESULT_SUCCESS) {
+        return result;
+    }
+
+    // Copy the frame if it changed more than the current candidate
+    std::vector<uint8_t> signature;
+    computeSignature(frame, &signature);
+    const uint32_t score = keptSignature.empty() ? 0 : difference(signature, keptSignature);
+    if (hasCandidate) {
+        droppedCount++;
+        if (score <= candidateScore) {
+            return RESULT_SUCCESS;
+        }
+    }
+    enc::RawFrame packed = {nullptr, frame.width, frame.height, frame.format, 0, 0};
+    enc::resolveStrides(&packed);
+    candidatePixels.resize(enc::rawFrameByteCount(packed));
+    candidateFrame = enc::packRawFrame(frame, candidatePixels.data());
+    candidateSignature.swap(signature);
+    candidateScore = score;
+    hasCandidate = true;
+    return RESULT_SUCCESS;
+}
+
+ResultCode FrameDecimator::flush(const Sink &sink) {
+    return commitCandidate(sink);
+}
+
+long FrameDecimator::endTimestamp(long end) const {
+    if (frameDuration <= 0) {
+        return end;
+    }
+    // The last kept frame lasts at least one output frame
+    long slot = currentSlot + 1;
+    while (slotTime(slot) < end) {
+        slot++;
+    }
+    return slotTime(slot);
+}
+
+int FrameDecimator::getDroppedCount() const {
+    return droppedCount;
+}
+
+size_t FrameDecimator::getRetainedBytes() const {
+    return candidatePixels.capacity();
+}
@@ -0,0 +1,147 @@
+//
+// Created by udara on 10/19/26.
+//
+
+#include <algorithm>
+#include <cstdlib>
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "include/frame_deduplicator.h"
+
+namespace {
+    typedef struct {
+        const uint8_t *data;
+        int stride;
+        int row_size;
+        int rows;
+    } Plane;
+
+    /**
+     * @return true if any byte of a differs from the byte of b by more than the tolerance.
+     */
+    bool exceedsTolerance(const uint8_t *a, const uint8_t *b, size_t size, uint8_t tolerance) {
+        size_t x = 0;
+#if defined(__ARM_NEON)
+        // Absolute differences above the tolerance survive the saturating subtraction
+        const uint8x16_t limit = vdupq_n_u8(tolerance);
+        uint8x16_t excess = vdupq_n_u8(0);
+        for (; x + 16 <= size; x += 16) {
+            const uint8x16_t difference = vabdq_u8(vld1q_u8(a + x), vld1q_u8(b + x));
+            excess = vorrq_u8(excess, vqsubq_u8(difference, limit));
+        }
+        const uint64x2_t lanes = vreinterpretq_u64_u8(excess);
+        if ((vgetq_lane_u64(lanes, 0) | vgetq_lane_u64(lanes, 1)) != 0) {
+            return true;
+        }
+#elif defined(__SSE2__)
+        const __m128i limit = _mm_set1_epi8(static_cast<char>(tolerance));
+        __m128i excess = _mm_setzero_si128();
+        for (; x + 16 <= size; x += 16) {
+            const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + x));
+            const __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + x));
+            const __m128i difference = _mm_or_si128(_mm_subs_epu8(va, vb), _mm_subs_epu8(vb, va));
+            excess = _mm_or_si128(excess, _mm_subs_epu8(difference, limit));
+        }
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(excess, _mm_setzero_si128())) != 0xFFFF) {
+            return true;
+        }
+#endif
+        for (; x < size; x++) {
+            if (std::abs(static_cast<int>(a[x]) - static_cast<int>(b[x])) > tolerance) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * Splits the frame into its luma or RGBA plane and its chroma planes.
+     *
+     * @return the number of planes.
+     */
+    int splitPlanes(const enc::RawFrame &frame, Plane planes[3]) {
+        const int chroma_width = (frame.width + 1) / 2;
+        const int chroma_height = (frame.height + 1) / 2;
+        if (frame.format == enc::PIXEL_FORMAT_RGBA_8888) {
+            planes[0] = {frame.data, frame.row_stride, frame.width * 4, frame.height};
+            return 1;
+        }
+        planes[0] = {frame.data, frame.row_stride, frame.width, frame.height};
+        const uint8_t *chroma = frame.data + static_cast<size_t>(frame.row_stride) * frame.height;
+        if (frame.format == enc::PIXEL_FORMAT_NV21) {
+            planes[1] = {chroma, frame.uv_row_stride, chroma_width * 2, chroma_height};
+            return 2;
+        }
+        planes[1] = {chroma, frame.uv_row_stride, chroma_width, chroma_height};
+        planes[2] = {chroma + static_cast<size_t>(frame.uv_row_stride) * chroma_height, frame.uv_row_stride,
+                     chroma_width, chroma_height};
+        return 3;
+    }
+}
+
+void FrameDeduplicator::setTolerance(int max_difference) {
+    tolerance = max_difference;
+    hasLastFrame = false;
+    lastPixels.clear();
+}
+
+bool FrameDeduplicator::isWithinTolerance(const enc::RawFrame &frame) const {
+    const auto limit = static_cast<uint8_t>(std::min(tolerance, 255));
+    Plane planes[3];
+    Plane last_planes[3];
+    const int plane_count = splitPlanes(frame, planes);
+    splitPlanes(lastFrame, last_planes);
+    for (int i = 0; i < plane_count; i++) {
+        const Plane &plane = planes[i];
+        const Plane &last_plane = last_planes[i];
+        for (int y = 0; y < plane.rows; y++) {
+            if (exceedsTolerance(
+                    plane.data + static_cast<size_t>(y) * plane.stride,
+                    last_plane.data + static_cast<size_t>(y) * last_plane.stride,
+                    plane.row_size,
+                    limit
+            )) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void FrameDeduplicator::keep(const enc::RawFrame &frame) {
+    hasLastFrame = true;
+    enc::RawFrame packed = {nullptr, frame.width, frame.height, frame.format, 0, 0};
+    enc::resolveStrides(&packed);
+    lastPixels.resize(enc::rawFrameByteCount(packed));
+    lastFrame = enc::packRawFrame(frame, lastPixels.data());
+}
+
+bool FrameDeduplicator::isDuplicate(const enc::RawFrame &frame) {
+    if (tolerance < 0) {
+        return false;
+    }
+    bool duplicate = hasLastFrame &&
+                     frame.width == lastFrame.width &&
+                     frame.height == lastFrame.height &&
+                     frame.format == lastFrame.format &&
+                     isWithinTolerance(frame);
+    if (duplicate) {
+        droppedCount++;
+    } else {
+        keep(frame);
+    }
+    return duplicate;
+}
+
+int FrameDeduplicator::getDroppedCount() const {
+    return droppedCount;
+}
+
+size_t FrameDeduplicator::getRetainedBytes() const {
+    return lastPixels.capacity();
+}
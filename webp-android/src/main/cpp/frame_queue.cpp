@@ -0,0 +1,181 @@
+//
+// Created by udara on 10/19/26.
+//
+
+#include "include/frame_queue.h"
+
+FrameQueue::~FrameQueue() {
+    stop();
+}
+
+ResultCode FrameQueue::start(size_t capacity, Consumer consumer, MemoryTracker *tracker, WorkerHooks hooks) {
+    stop();
+    std::unique_lock<std::mutex> lock(mutex_);
+    tracker_ = tracker;
+    capacity_ = capacity < 1 ? 1 : capacity;
+    consumer_ = std::move(consumer);
+    hooks_ = std::move(hooks);
+    // A previous run may have been stopped while a push was copying its frame
+    frames_.clear();
+    busy_ = false;
+    stop_ = false;
+    error_ = RESULT_SUCCESS;
+    attaching_ = true;
+    worker_ = std::thread(&FrameQueue::run, this);
+
+    // A worker that failed to attach has returned, join it so that the queue reads as stopped
+    attached_.wait(lock, [this] { return !attaching_; });
+    if (running_) {
+        return RESULT_SUCCESS;
+    }
+    ResultCode result = error_;
+    lock.unlock();
+    worker_.join();
+    return result;
+}
+
+bool FrameQueue::isStarted() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return running_;
+}
+
+ResultCode FrameQueue::push(const enc::RawFrame &frame, long timestamp) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    not_full_.wait(lock, [this] {
+        return frames_.size() < capacity_ || stop_ || error_ != RESULT_SUCCESS;
+    });
+    if (error_ != RESULT_SUCCESS) {
+        return error_;
+    }
+    if (stop_) {
+        return ERROR_NULL_ENCODER;
+    }
+
+    // Reuse a pooled buffer if available
+    std::vector<uint8_t> buffer;
+    if (!buffer_pool_.empty()) {
+        buffer = std::move(buffer_pool_.back());
+        buffer_pool_.pop_back();
+    }
+    lock.unlock();
+
+    enc::RawFrame packed = {nullptr, frame.width, frame.height, frame.format, 0, 0};
+    enc::resolveStrides(&packed);
+    const size_t pooled_capacity = buffer.capacity();
+    buffer.resize(enc::rawFrameByteCount(packed));
+    if (tracker_ != nullptr && buffer.capacity() > pooled_capacity) {
+        tracker_->allocate(buffer.capacity() - pooled_capacity);
+    }
+    packed = enc::packRawFrame(frame, buffer.data());
+
+    // The queue may have failed or stopped while the frame was copied
+    lock.lock();
+    if (error_ != RESULT_SUCCESS) {
+        buffer_pool_.push_back(std::move(buffer));
+        return error_;
+    }
+    if (stop_) {
+        // The pool may already be released
+        if (tracker_ != nullptr) {
+            tracker_->release(buffer.capacity());
+        }
+        return ERROR_NULL_ENCODER;
+    }
+    frames_.push_back(QueuedFrame{std::move(buffer), packed, timestamp});
+    not_empty_.notify_one();
+    return RESULT_SUCCESS;
+}
+
+ResultCode FrameQueue::drain() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    drained_.wait(lock, [this] {
+        return (frames_.empty() && !busy_) || stop_ || error_ != RESULT_SUCCESS;
+    });
+    return error_;
+}
+
+void FrameQueue::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    while (!frames_.empty()) {
+        buffer_pool_.push_back(std::move(frames_.front().pixels));
+        frames_.pop_front();
+    }
+    not_full_.notify_all();
+    if (!busy_) {
+        drained_.notify_all();
+    }
+}
+
+void FrameQueue::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+        while (!frames_.empty()) {
+            buffer_pool_.push_back(std::move(frames_.front().pixels));
+            frames_.pop_front();
+        }
+        not_empty_.notify_all();
+        not_full_.notify_all();
+        drained_.notify_all();
+    }
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+
+    // The worker has returned its buffer to the pool
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto &buffer: buffer_pool_) {
+        if (tracker_ != nullptr) {
+            tracker_->release(buffer.capacity());
+        }
+    }
+    buffer_pool_.clear();
+}
+
+void FrameQueue::run() {
+    const ResultCode attach_result = hooks_.attach ? hooks_.attach() : RESULT_SUCCESS;
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    attaching_ = false;
+    running_ = attach_result == RESULT_SUCCESS;
+    error_ = attach_result;
+    attached_.notify_all();
+    if (!running_) {
+        return;
+    }
+
+    while (true) {
+        not_empty_.wait(lock, [this] { return !frames_.empty() || stop_; });
+        if (stop_) break;
+
+        QueuedFrame frame = std::move(frames_.front());
+        frames_.pop_front();
+        busy_ = true;
+        not_full_.notify_one();
+        lock.unlock();
+
+        ResultCode result = consumer_(frame);
+
+        lock.lock();
+        busy_ = false;
+        buffer_pool_.push_back(std::move(frame.pixels));
+        if (result != RESULT_SUCCESS && error_ == RESULT_SUCCESS) {
+            // Drop the rest, they cannot be added after a failed frame
+            error_ = result;
+            while (!frames_.empty()) {
+                buffer_pool_.push_back(std::move(frames_.front().pixels));
+                frames_.pop_front();
+            }
+            not_full_.notify_all();
+        }
+        if (frames_.empty()) {
+            drained_.notify_all();
+        }
+    }
+    running_ = false;
+    lock.unlock();
+
+    if (hooks_.detach) {
+        hooks_.detach();
+    }
+}
@@ -0,0 +1,394 @@
+//
+// Created by udara on 10/19/26.
+//
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <webp/encode.h>
+
+#include "include/gif_decoder.h"
+
+namespace {
+    constexpr uint8_t EXTENSION_INTRODUCER = 0x21;
+    constexpr uint8_t IMAGE_SEPARATOR = 0x2c;
+    constexpr uint8_t TRAILER = 0x3b;
+    constexpr uint8_t GRAPHICS_CONTROL_LABEL = 0xf9;
+    constexpr uint8_t APPLICATION_LABEL = 0xff;
+
+    constexpr int DISPOSE_BACKGROUND = 2;
+    constexpr int DISPOSE_PREVIOUS = 3;
+    constexpr int NO_TRANSPARENT_INDEX = -1;
+    constexpr int MAX_CODE_SIZE = 12;
+    constexpr int MAX_CODES = 1 << MAX_CODE_SIZE;
+    constexpr int MAX_LOOP_COUNT = 65535;
+
+    uint16_t readLE16(const uint8_t *data) {
+        return static_cast<uint16_t>(data[0] | (data[1] << 8));
+    }
+
+    /**
+     * Skips a chain of data sub-blocks.
+     *
+     * @return Position after the block terminator, or nullptr if the chain runs past the end.
+     */
+    const uint8_t *skipSubBlocks(const uint8_t *pos, const uint8_t *end) {
+        while (pos < end) {
+            uint8_t block_size = *pos++;
+            if (block_size == 0) return pos;
+            pos += block_size;
+        }
+        return nullptr;
+    }
+
+    /**
+     * Reads LSB first variable length codes across data sub-blocks.
+     */
+    class CodeReader {
+    private:
+        const uint8_t *pos;
+        const uint8_t *end;
+        size_t blockRemaining = 0;
+        uint32_t bits = 0;
+        int bitCount = 0;
+
+    public:
+        CodeReader(const uint8_t *data, const uint8_t *data_end) : pos(data), end(data_end) {}
+
+        bool read(int code_size, int *code) {
+            while (bitCount < code_size) {
+                if (blockRemaining == 0) {
+                    if (pos >= end || *pos == 0) return false;
+                    blockRemaining = *pos++;
+                }
+                if (pos >= end) return false;
+                bits |= static_cast<uint32_t>(*pos++) << bitCount;
+                bitCount += 8;
+                blockRemaining--;
+            }
+            *code = static_cast<int>(bits & ((1u << code_size) - 1));
+            bits >>= code_size;
+            bitCount -= code_size;
+            return true;
+        }
+    };
+}
+
+bool GifDecoder::isGif(const uint8_t *data, size_t size) {
+    return size >= 6 && (memcmp(data, "GIF87a", 6) == 0 || memcmp(data, "GIF89a", 6) == 0);
+}
+
+ResultCode GifDecoder::open(const uint8_t *data, size_t size) {
+    if (!isGif(data, size) || size < 13) {
+        return ERROR_BITSTREAM_ERROR;
+    }
+    const uint8_t *end = data + size;
+    dataEnd = end;
+
+    // Logical screen descriptor
+    canvasWidth = readLE16(data + 6);
+    canvasHeight = readLE16(data + 8);
+    uint8_t screen_flags = data[10];
+    int background_index = data[11];
+    const uint8_t *pos = data + 13;
+    const uint8_t *global_table = nullptr;
+    int global_count = 0;
+    if (screen_flags & 0x80) {
+        global_count = 1 << ((screen_flags & 0x07) + 1);
+        global_table = pos;
+        pos += global_count * 3;
+    }
+    if (canvasWidth == 0 || canvasHeight == 0 || pos > end) {
+        return ERROR_BITSTREAM_ERROR;
+    }
+    if (canvasWidth > WEBP_MAX_DIMENSION || canvasHeight > WEBP_MAX_DIMENSION) {
+        return ERROR_BAD_DIMENSION;
+    }
+
+    // Index frames
+    frames.clear();
+    loopCount = 1;
+    int first_transparent_index = NO_TRANSPARENT_INDEX;
+    int transparent_index = NO_TRANSPARENT_INDEX;
+    int disposal = 0;
+    int duration = 0;
+    while (pos < end && *pos != TRAILER) {
+        uint8_t introducer = *pos++;
+        if (introducer == EXTENSION_INTRODUCER) {
+            if (pos >= end) return ERROR_BITSTREAM_ERROR;
+            uint8_t label = *pos++;
+            if (label == GRAPHICS_CONTROL_LABEL && pos + 5 <= end && pos[0] >= 4) {
+                uint8_t flags = pos[1];
+                disposal = (flags >> 2) & 0x07;
+                duration = readLE16(pos + 2) * 10;
+                transparent_index = (flags & 0x01) ? pos[4] : NO_TRANSPARENT_INDEX;
+            } else if (label == APPLICATION_LABEL && pos + 12 <= end && pos[0] == 11 &&
+                       (memcmp(pos + 1, "NETSCAPE2.0", 11) == 0 || memcmp(pos + 1, "ANIMEXTS1.0", 11) == 0)) {
+                const uint8_t *sub_block = pos + 12;
+                if (sub_block + 4 <= end && sub_block[0] >= 3 && sub_block[1] == 1) {
+                    // GIF stores the repetitions after the first play, WebP the total plays. 0 is infinite in both
+                    int repetitions = readLE16(sub_block + 2);
+                    loopCount = repetitions > 0 && repetitions < MAX_LOOP_COUNT ? repetitions + 1 : repetitions;
+                }
+            }
+            pos = skipSubBlocks(pos, end);
+            if (pos == nullptr) return ERROR_BITSTREAM_ERROR;
+        } else if (introducer == IMAGE_SEPARATOR) {
+            if (pos + 9 > end) return ERROR_BITSTREAM_ERROR;
+            GifFrame frame;
+            frame.left = readLE16(pos);
+            frame.top = readLE16(pos + 2);
+            frame.width = readLE16(pos + 4);
+            frame.height = readLE16(pos + 6);
+            uint8_t image_flags = pos[8];
+            frame.interlaced = (image_flags & 0x40) != 0;
+            pos += 9;
+            if (frame.width > WEBP_MAX_DIMENSION || frame.height > WEBP_MAX_DIMENSION) {
+                return ERROR_BAD_DIMENSION;
+            }
+            if (image_flags & 0x80) {
+                frame.color_count = 1 << ((image_flags & 0x07) + 1);
+                frame.color_table = pos;
+                pos += frame.color_count * 3;
+            } else {
+                frame.color_count = global_count;
+                frame.color_table = global_table;
+            }
+            if (frame.color_table == nullptr || pos >= end) {
+                return ERROR_BITSTREAM_ERROR;
+            }
+            frame.transparent_index = transparent_index;
+            frame.disposal = disposal;
+            frame.duration = duration;
+            frame.image_data = pos;
+            pos = skipSubBlocks(pos + 1, end);
+            if (pos == nullptr) return ERROR_BITSTREAM_ERROR;
+            if (frames.empty()) {
+                first_transparent_index = transparent_index;
+            }
+            frames.push_back(frame);
+
+            // The graphics control extension applies to the next image only
+            transparent_index = NO_TRANSPARENT_INDEX;
+            disposal = 0;
+            duration = 0;
+        } else {
+            return ERROR_BITSTREAM_ERROR;
+        }
+    }
+    if (frames.empty()) {
+        return ERROR_BITSTREAM_ERROR;
+    }
+
+    // Same background color as gif2webp
+    if (first_transparent_index != NO_TRANSPARENT_INDEX && background_index == first_transparent_index) {
+        backgroundColor = 0x00000000;
+    } else if (global_table == nullptr || background_index >= global_count) {
+        backgroundColor = 0xffffffff;
+    } else {
+        const uint8_t *color = global_table + background_index * 3;
+        backgroundColor = 0xff000000u | (color[0] << 16) | (color[1] << 8) | color[2];
+    }
+
+    try {
+        canvas.assign(static_cast<size_t>(canvasWidth) * canvasHeight * 4, 0);
+    } catch (const std::bad_alloc &) {
+        return ERROR_OUT_OF_MEMORY;
+    }
+    previousCanvas.clear();
+    frameIndex = 0;
+    timestamp = 0;
+    return RESULT_SUCCESS;
+}
+
+int GifDecoder::getCanvasWidth() const {
+    return canvasWidth;
+}
+
+int GifDecoder::getCanvasHeight() const {
+    return canvasHeight;
+}
+
+int GifDecoder::getFrameCount() const {
+    return static_cast<int>(frames.size());
+}
+
+int GifDecoder::getLoopCount() const {
+    return loopCount;
+}
+
+uint32_t GifDecoder::getBackgroundColor() const {
+    return backgroundColor;
+}
+
+bool GifDecoder::hasMoreFrames() const {
+    return frameIndex < frames.size();
+}
+
+ResultCode GifDecoder::decodeIndices(const GifFrame &frame) {
+    const size_t pixel_count = static_cast<size_t>(frame.width) * frame.height;
+    decodedPixels = 0;
+    try {
+        indices.resize(pixel_count);
+    } catch (const std::bad_alloc &) {
+        return ERROR_OUT_OF_MEMORY;
+    }
+
+    int min_code_size = frame.image_data[0];
+    if (min_code_size < 1 || min_code_size > 11) {
+        return ERROR_BITSTREAM_ERROR;
+    }
+    const int clear_code = 1 << min_code_size;
+    const int end_code = clear_code + 1;
+
+    uint16_t prefix[MAX_CODES];
+    uint8_t suffix[MAX_CODES];
+    uint8_t stack[MAX_CODES + 1];
+    for (int code = 0; code < clear_code; code++) {
+        prefix[code] = 0;
+        suffix[code] = static_cast<uint8_t>(code);
+    }
+
+    CodeReader reader(frame.image_data + 1, dataEnd);
+    int code_size = min_code_size + 1;
+    int next_code = end_code + 1;
+    int old_code = -1;
+    uint8_t first_byte = 0;
+    size_t written = 0;
+    int code;
+    while (written < pixel_count && reader.read(code_size, &code)) {
+        if (code == clear_code) {
+            code_size = min_code_size + 1;
+            next_code = end_code + 1;
+            old_code = -1;
+            continue;
+        }
+        if (code == end_code) {
+            break;
+        }
+        if (old_code == -1) {
+            if (code >= clear_code) {
+                return ERROR_BITSTREAM_ERROR;
+            }
+            first_byte = static_cast<uint8_t>(code);
+            indices[written++] = first_byte;
+            old_code = code;
+            continue;
+        }
+
+        // Unwind the code into the stack, the KwKwK case repeats the first byte of the previous string
+        int in_code = code;
+        int depth = 0;
+        if (code >= next_code) {
+            if (code > next_code) {
+                return ERROR_BITSTREAM_ERROR;
+            }
+            stack[depth++] = first_byte;
+            code = old_code;
+        }
+        while (code >= clear_code) {
+            stack[depth++] = suffix[code];
+            code = prefix[code];
+        }
+        first_byte = suffix[code];
+        stack[depth++] = first_byte;
+        while (depth > 0 && written < pixel_count) {
+            indices[written++] = stack[--depth];
+        }
+
+        if (next_code < MAX_CODES) {
+            prefix[next_code] = static_cast<uint16_t>(old_code);
+            suffix[next_code] = first_byte;
+            next_code++;
+            if (next_code == (1 << code_size) && code_size < MAX_CODE_SIZE) {
+                code_size++;
+            }
+        }
+        old_code = in_code;
+    }
+    // Truncated image data leaves the remaining pixels untouched, like browsers do
+    decodedPixels = written;
+    return RESULT_SUCCESS;
+}
+
+void GifDecoder::disposeFrame(const GifFrame &frame) {
+    if (frame.disposal == DISPOSE_PREVIOUS && !previousCanvas.empty()) {
+        canvas.swap(previousCanvas);
+        previousCanvas.clear();
+    } else if (frame.disposal == DISPOSE_BACKGROUND) {
+        const int right = std::min(frame.left + frame.width, canvasWidth);
+        const int bottom = std::min(frame.top + frame.height, canvasHeight);
+        for (int y = frame.top; y < bottom; y++) {
+            if (right > frame.left) {
+                uint8_t *row = canvas.data() + (static_cast<size_t>(y) * canvasWidth + frame.left) * 4;
+                memset(row, 0, static_cast<size_t>(right - frame.left) * 4);
+            }
+        }
+    }
+}
+
+void GifDecoder::drawFrame(const GifFrame &frame) {
+    const int visible_width = std::min(frame.width, canvasWidth - frame.left);
+    const int visible_height = std::min(frame.height, canvasHeight - frame.top);
+    int pass = 0;
+    int row = 0;
+    for (int src_row = 0; src_row < frame.height; src_row++) {
+        // Interlaced rows arrive in four passes: every 8th from 0, every 8th from 4, every 4th from 2, every 2nd from 1
+        int dst_row = src_row;
+        if (frame.interlaced) {
+            static const int start[] = {0, 4, 2, 1};
+            static const int step[] = {8, 8, 4, 2};
+            while (row >= frame.height && pass < 3) {
+                pass++;
+                row = start[pass];
+            }
+            dst_row = row;
+            row += step[pass];
+        }
+        if (dst_row >= visible_height) continue;
+
+        const size_t row_offset = static_cast<size_t>(src_row) * frame.width;
+        if (row_offset >= decodedPixels) break;
+        const int row_width = static_cast<int>(std::min<size_t>(visible_width, decodedPixels - row_offset));
+        const uint8_t *src = indices.data() + row_offset;
+        uint8_t *dst = canvas.data() + (static_cast<size_t>(frame.top + dst_row) * canvasWidth + frame.left) * 4;
+        for (int x = 0; x < row_width; x++, dst += 4) {
+            int index = src[x];
+            if (index == frame.transparent_index || index >= frame.color_count) continue;
+            const uint8_t *color = frame.color_table + index * 3;
+            dst[0] = color[0];
+            dst[1] = color[1];
+            dst[2] = color[2];
+            dst[3] = 0xff;
+        }
+    }
+}
+
+ResultCode GifDecoder::getNext(uint8_t **canvas_pixels, int *end_timestamp) {
+    if (frameIndex >= frames.size()) {
+        return ERROR_NO_MORE_FRAMES;
+    }
+    if (frameIndex > 0) {
+        disposeFrame(frames[frameIndex - 1]);
+    }
+    const GifFrame &frame = frames[frameIndex];
+    ResultCode result = decodeIndices(frame);
+    if (result != RESULT_SUCCESS) {
+        return result;
+    }
+    if (frame.disposal == DISPOSE_PREVIOUS) {
+        try {
+            previousCanvas = canvas;
+        } catch (const std::bad_alloc &) {
+            return ERROR_OUT_OF_MEMORY;
+        }
+    }
+    if (frame.left < canvasWidth && frame.top < canvasHeight) {
+        drawFrame(frame);
+    }
+    frameIndex++;
+    timestamp += frame.duration;
+    *canvas_pixels = canvas.data();
+    *end_timestamp = timestamp;
+    return RESULT_SUCCESS;
+}
@@ -0,0 +1,673 @@
+//
+// Created by udara on 10/19/26.
+//
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <android/api-level.h>
+#include <android/bitmap.h>
+
+#include "include/fake_jni.h"
+
+namespace {
+    struct Object;
+
+    struct Member {
+        Object *clazz;
+        std::string name;
+        std::string signature;
+        fake::MethodHandler handler;
+    };
+
+    struct Object {
+        // Null for classes
+        Object *clazz = nullptr;
+        // Class name, string contents or exception message
+        std::string name;
+        // Instance fields, or static fields of a class
+        std::map<const Member *, jvalue> fields;
+        std::vector<jvalue> arguments;
+        // Primitive array elements and bitmap pixels
+        std::vector<uint8_t> bytes;
+        std::vector<jobject> elements;
+        jsize length = 0;
+        void *address = nullptr;
+        jlong capacity = -1;
+        bool is_bitmap = false;
+        AndroidBitmapInfo bitmap_info{};
+        // Natives registered on a class, by name and signature
+        std::map<std::string, void *> natives;
+    };
+
+    std::recursive_mutex heap_mutex;
+    std::map<std::string, std::unique_ptr<Object>> classes;
+    std::map<std::string, std::unique_ptr<Member>> members;
+    std::deque<std::unique_ptr<Object>> objects;
+    std::atomic<int> device_api_level{__ANDROID_API_O__};
+    std::atomic<jint> attach_result{JNI_OK};
+    std::string missing_class;
+
+    JavaVM java_vm;
+    thread_local JNIEnv thread_env;
+    thread_local Object *pending_exception = nullptr;
+
+    Object *toObject(jobject obj) {
+        return reinterpret_cast<Object *>(obj);
+    }
+
+    template<typename T = jobject>
+    T toHandle(Object *object) {
+        return reinterpret_cast<T>(object);
+    }
+
+    Object *findClass(const std::string &name) {
+        std::lock_guard<std::recursive_mutex> lock(heap_mutex);
+        auto &clazz = classes[name];
+        if (clazz == nullptr) {
+            clazz = std::make_unique<Object>();
+            clazz->name = name;
+        }
+        return clazz.get();
+    }
+
+    Object *newObject(Object *clazz) {
+        std::lock_guard<std::recursive_mutex> lock(heap_mutex);
+        objects.push_back(std::make_unique<Object>());
+        Object *object = objects.back().get();
+        object->clazz = clazz;
+        return object;
+    }
+
+    Object *newArray(const char *class_name, jsize length, size_t element_size) {
+        Object *array = newObject(findClass(class_name));
+        array->length = length;
+        array->bytes.resize(static_cast<size_t>(length) * element_size);
+        return array;
+    }
+
+    Member *findMember(Object *clazz, const char *name, const char *signature) {
+        std::lock_guard<std::recursive_mutex> lock(heap_mutex);
+        // Java does not allow a static and an instance member with the same name and signature
+        auto &member = members[clazz->name + "." + name + signature];
+        if (member == nullptr) {
+            member = std::make_unique<Member>();
+            member->clazz = clazz;
+            member->name = name;
+            member->signature = signature;
+        }
+        return member.get();
+    }
+
+    Member *toMember(jfieldID field_id) {
+        return reinterpret_cast<Member *>(field_id);
+    }
+
+    Member *toMember(jmethodID method_id) {
+        return reinterpret_cast<Member *>(method_id);
+    }
+
+    size_t skipType(const std::string &signature, size_t index) {
+        while (signature[index] == '[') index++;
+        if (signature[index] == 'L') index = signature.find(';', index);
+        return index + 1;
+    }
+
+    std::vector<jvalue> readArguments(const std::string &signature, va_list args) {
+        std::vector<jvalue> values;
+        size_t index = 1;
+        while (index < signature.size() && signature[index] != ')') {
+            jvalue value{};
+            switch (signature[index]) {
+                case 'Z':
+                    value.z = static_cast<jboolean>(va_arg(args, int));
+                    break;
+                case 'B':
+                    value.b = static_cast<jbyte>(va_arg(args, int));
+                    break;
+                case 'C':
+                    value.c = static_cast<jchar>(va_arg(args, int));
+                    break;
+                case 'S':
+                    value.s = static_cast<jshort>(va_arg(args, int));
+                    break;
+                case 'I':
+                    value.i = va_arg(args, jint);
+                    break;
+                case 'J':
+                    value.j = va_arg(args, jlong);
+                    break;
+                case 'F':
+                    value.f = static_cast<jfloat>(va_arg(args, double));
+                    break;
+                case 'D':
+                    value.d = va_arg(args, double);
+                    break;
+                default:
+                    value.l = va_arg(args, jobject);
+                    break;
+            }
+            values.push_back(value);
+            index = skipType(signature, index);
+        }
+        return values;
+    }
+
+    jvalue callMethod(jobject obj, jmethodID method_id, va_list args) {
+        Member *method = toMember(method_id);
+        std::vector<jvalue> values = readArguments(method->signature, args);
+        if (method->handler) {
+            return method->handler(obj, values);
+        }
+        jvalue result{};
+        if (method->signature.back() == 'Z') {
+            result.z = JNI_TRUE;
+        }
+        return result;
+    }
+
+    jvalue getField(jobject obj, jfieldID field_id) {
+        Object *object = toObject(obj);
+        auto it = object->fields.find(toMember(field_id));
+        return it != object->fields.end() ? it->second : jvalue{};
+    }
+
+    void setField(jobject obj, jfieldID field_id, jvalue value) {
+        toObject(obj)->fields[toMember(field_id)] = value;
+    }
+
+    template<typename T>
+    void getRegion(jarray array, jsize start, jsize len, T *buf) {
+        memcpy(buf, toObject(array)->bytes.data() + start * sizeof(T), len * sizeof(T));
+    }
+
+    template<typename T>
+    void setRegion(jarray array, jsize start, jsize len, const T *buf) {
+        memcpy(toObject(array)->bytes.data() + start * sizeof(T), buf, len * sizeof(T));
+    }
+
+    bool installDefaultHandlers() {
+        fake::setMethodHandler(
+                "android/graphics/Bitmap",
+                "createBitmap",
+                "(IILandroid/graphics/Bitmap$Config;)Landroid/graphics/Bitmap;",
+                [](jobject, const std::vector<jvalue> &args) {
+                    jvalue result{};
+                    result.l = fake::newBitmap(args[0].i, args[1].i);
+                    return result;
+                }
+        );
+        fake::setMethodHandler(
+                "com/aureusapps/android/webpandroid/utils/NativeBufferCleaner",
+                "register",
+                "(Ljava/nio/ByteBuffer;J)Lcom/aureusapps/android/webpandroid/encoder/WebPBuffer;",
+                [](jobject, const std::vector<jvalue> &args) {
+                    JNIEnv *env = fake::getEnv();
+                    jvalue result{};
+                    result.l = fake::newObject("com/aureusapps/android/webpandroid/encoder/WebPBuffer");
+                    jclass clazz = env->GetObjectClass(result.l);
+                    env->SetObjectField(result.l, env->GetFieldID(clazz, "buffer", "Ljava/nio/ByteBuffer;"), args[0].l);
+                    return result;
+                }
+        );
+        return true;
+    }
+
+    const bool default_handlers_installed = installDefaultHandlers();
+}
+
+jint JNIEnv::GetVersion() {
+    return JNI_VERSION_1_6;
+}
+
+jclass JNIEnv::FindClass(const char *name) {
+    {
+        std::lock_guard<std::recursive_mutex> lock(heap_mutex);
+        if (missing_class == name) {
+            pending_exception = newObject(findClass("java/lang/NoClassDefFoundError"));
+            pending_exception->name = name;
+            return nullptr;
+        }
+    }
+    return toHandle<jclass>(findClass(name));
+}
+
+jclass JNIEnv::GetObjectClass(jobject obj) {
+    return toHandle<jclass>(toObject(obj)->clazz);
+}
+
+jboolean JNIEnv::IsInstanceOf(jobject obj, jclass clazz) {
+    return obj == nullptr || toObject(obj)->clazz == toObject(clazz);
+}
+
+jboolean JNIEnv::IsSameObject(jobject ref1, jobject ref2) {
+    return ref1 == ref2;
+}
+
+jint JNIEnv::ThrowNew(jclass clazz, const char *message) {
+    pending_exception = newObject(toObject(clazz));
+    pending_exception->name = message != nullptr ? message : "";
+    return JNI_OK;
+}
+
+jboolean JNIEnv::ExceptionCheck() {
+    return pending_exception != nullptr;
+}
+
+void JNIEnv::ExceptionDescribe() {
+    if (pending_exception != nullptr) {
+        fprintf(stderr, "%s: %s\n", pending_exception->clazz->name.c_str(), pending_exception->name.c_str());
+    }
+}
+
+void JNIEnv::ExceptionClear() {
+    pending_exception = nullptr;
+}
+
+jobject JNIEnv::NewGlobalRef(jobject obj) {
+    return obj;
+}
+
+void JNIEnv::DeleteGlobalRef(jobject) {}
+
+jobject JNIEnv::NewLocalRef(jobject ref) {
+    return ref;
+}
+
+void JNIEnv::DeleteLocalRef(jobject) {}
+
+jmethodID JNIEnv::GetMethodID(jclass clazz, const char *name, const char *sig) {
+    return reinterpret_cast<jmethodID>(findMember(toObject(clazz), name, sig));
+}
+
+jmethodID JNIEnv::GetStaticMethodID(jclass clazz, const char *name, const char *sig) {
+    return reinterpret_cast<jmethodID>(findMember(toObject(clazz), name, sig));
+}
+
+jfieldID JNIEnv::GetFieldID(jclass clazz, const char *name, const char *sig) {
+    return reinterpret_cast<jfieldID>(findMember(toObject(clazz), name, sig));
+}
+
+jfieldID JNIEnv::GetStaticFieldID(jclass clazz, const char *name, const char *sig) {
+    return reinterpret_cast<jfieldID>(findMember(toObject(clazz), name, sig));
+}
+
+jobject JNIEnv::NewObject(jclass clazz, jmethodID method_id, ...) {
+    va_list args;
+    va_start(args, method_id);
+    Object *object = newObject(toObject(clazz));
+    object->arguments = readArguments(toMember(method_id)->signature, args);
+    va_end(args);
+    if (toMember(method_id)->handler) {
+        toMember(method_id)->handler(toHandle(object), object->arguments);
+    }
+    return toHandle(object);
+}
+
+jobject JNIEnv::CallObjectMethod(jobject obj, jmethodID method_id, ...) {
+    va_list args;
+    va_start(args, method_id);
+    jvalue result = callMethod(obj, method_id, args);
+    va_end(args);
+    return result.l;
+}
+
+jboolean JNIEnv::CallBooleanMethod(jobject obj, jmethodID method_id, ...) {
+    va_list args;
+    va_start(args, method_id);
+    jvalue result = callMethod(obj, method_id, args);
+    va_end(args);
+    return result.z;
+}
+
+jint JNIEnv::CallIntMethod(jobject obj, jmethodID method_id, ...) {
+    va_list args;
+    va_start(args, method_id);
+    jvalue result = callMethod(obj, method_id, args);
+    va_end(args);
+    return result.i;
+}
+
+jlong JNIEnv::CallLongMethod(jobject obj, jmethodID method_id, ...) {
+    va_list args;
+    va_start(args, method_id);
+    jvalue result = callMethod(obj, method_id, args);
+    va_end(args);
+    return result.j;
+}
+
+void JNIEnv::CallVoidMethod(jobject obj, jmethodID method_id, ...) {
+    va_list args;
+    va_start(args, method_id);
+    callMethod(obj, method_id, args);
+    va_end(args);
+}
+
+jobject JNIEnv::CallStaticObjectMethod(jclass clazz, jmethodID method_id, ...) {
+    va_list args;
+    va_start(args, method_id);
+    jvalue result = callMethod(clazz, method_id, args);
+    va_end(args);
+    return result.l;
+}
+
+void JNIEnv::CallStaticVoidMethod(jclass clazz, jmethodID method_id, ...) {
+    va_list args;
+    va_start(args, method_id);
+    callMethod(clazz, method_id, args);
+    va_end(args);
+}
+
+jobject JNIEnv::GetObjectField(jobject obj, jfieldID field_id) {
+    return getField(obj, field_id).l;
+}
+
+jboolean JNIEnv::GetBooleanField(jobject obj, jfieldID field_id) {
+    return getField(obj, field_id).z;
+}
+
+jchar JNIEnv::GetCharField(jobject obj, jfieldID field_id) {
+    return getField(obj, field_id).c;
+}
+
+jint JNIEnv::GetIntField(jobject obj, jfieldID field_id) {
+    return getField(obj, field_id).i;
+}
+
+jlong JNIEnv::GetLongField(jobject obj, jfieldID field_id) {
+    return getField(obj, field_id).j;
+}
+
+jfloat JNIEnv::GetFloatField(jobject obj, jfieldID field_id) {
+    return getField(obj, field_id).f;
+}
+
+void JNIEnv::SetObjectField(jobject obj, jfieldID field_id, jobject value) {
+    jvalue field{};
+    field.l = value;
+    setField(obj, field_id, field);
+}
+
+void JNIEnv::SetBooleanField(jobject obj, jfieldID field_id, jboolean value) {
+    jvalue field{};
+    field.z = value;
+    setField(obj, field_id, field);
+}
+
+void JNIEnv::SetIntField(jobject obj, jfieldID field_id, jint value) {
+    jvalue field{};
+    field.i = value;
+    setField(obj, field_id, field);
+}
+
+void JNIEnv::SetLongField(jobject obj, jfieldID field_id, jlong value) {
+    jvalue field{};
+    field.j = value;
+    setField(obj, field_id, field);
+}
+
+void JNIEnv::SetFloatField(jobject obj, jfieldID field_id, jfloat value) {
+    jvalue field{};
+    field.f = value;
+    setField(obj, field_id, field);
+}
+
+jobject JNIEnv::GetStaticObjectField(jclass clazz, jfieldID field_id) {
+    Object *object = toObject(clazz);
+    Member *field = toMember(field_id);
+    auto it = object->fields.find(field);
+    if (it != object->fields.end()) {
+        return it->second.l;
+    }
+    // Constants such as enum entries and Uri.EMPTY are distinct objects of the field type
+    const std::string &sig = field->signature;
+    jvalue value{};
+    if (sig.size() > 2 && sig.front() == 'L') {
+        value.l = toHandle(newObject(findClass(sig.substr(1, sig.size() - 2))));
+    }
+    object->fields[field] = value;
+    return value.l;
+}
+
+void JNIEnv::SetStaticObjectField(jclass clazz, jfieldID field_id, jobject value) {
+    jvalue field{};
+    field.l = value;
+    setField(clazz, field_id, field);
+}
+
+jstring JNIEnv::NewStringUTF(const char *bytes) {
+    Object *string = newObject(findClass("java/lang/String"));
+    string->name = bytes;
+    return toHandle<jstring>(string);
+}
+
+const char *JNIEnv::GetStringUTFChars(jstring string, jboolean *is_copy) {
+    if (is_copy != nullptr) *is_copy = JNI_FALSE;
+    return toObject(string)->name.c_str();
+}
+
+void JNIEnv::ReleaseStringUTFChars(jstring, const char *) {}
+
+jsize JNIEnv::GetArrayLength(jarray array) {
+    return toObject(array)->length;
+}
+
+jobjectArray JNIEnv::NewObjectArray(jsize length, jclass, jobject initial_element) {
+    Object *array = newArray("[Ljava/lang/Object;", length, 0);
+    array->elements.assign(length, initial_element);
+    return toHandle<jobjectArray>(array);
+}
+
+jobject JNIEnv::GetObjectArrayElement(jobjectArray array, jsize index) {
+    return toObject(array)->elements[index];
+}
+
+void JNIEnv::SetObjectArrayElement(jobjectArray array, jsize index, jobject value) {
+    toObject(array)->elements[index] = value;
+}
+
+jbyteArray JNIEnv::NewByteArray(jsize length) {
+    return toHandle<jbyteArray>(newArray("[B", length, sizeof(jbyte)));
+}
+
+jintArray JNIEnv::NewIntArray(jsize length) {
+    return toHandle<jintArray>(newArray("[I", length, sizeof(jint)));
+}
+
+jlongArray JNIEnv::NewLongArray(jsize length) {
+    return toHandle<jlongArray>(newArray("[J", length, sizeof(jlong)));
+}
+
+jfloatArray JNIEnv::NewFloatArray(jsize length) {
+    return toHandle<jfloatArray>(newArray("[F", length, sizeof(jfloat)));
+}
+
+void JNIEnv::GetByteArrayRegion(jbyteArray array, jsize start, jsize len, jbyte *buf) {
+    getRegion(array, start, len, buf);
+}
+
+void JNIEnv::SetByteArrayRegion(jbyteArray array, jsize start, jsize len, const jbyte *buf) {
+    setRegion(array, start, len, buf);
+}
+
+void JNIEnv::GetIntArrayRegion(jintArray array, jsize start, jsize len, jint *buf) {
+    getRegion(array, start, len, buf);
+}
+
+void JNIEnv::SetIntArrayRegion(jintArray array, jsize start, jsize len, const jint *buf) {
+    setRegion(array, start, len, buf);
+}
+
+void JNIEnv::GetLongArrayRegion(jlongArray array, jsize start, jsize len, jlong *buf) {
+    getRegion(array, start, len, buf);
+}
+
+void JNIEnv::SetLongArrayRegion(jlongArray array, jsize start, jsize len, const jlong *buf) {
+    setRegion(array, start, len, buf);
+}
+
+void JNIEnv::GetFloatArrayRegion(jfloatArray array, jsize start, jsize len, jfloat *buf) {
+    getRegion(array, start, len, buf);
+}
+
+void JNIEnv::SetFloatArrayRegion(jfloatArray array, jsize start, jsize len, const jfloat *buf) {
+    setRegion(array, start, len, buf);
+}
+
+void *JNIEnv::GetPrimitiveArrayCritical(jarray array, jboolean *is_copy) {
+    if (is_copy != nullptr) *is_copy = JNI_FALSE;
+    return toObject(array)->bytes.data();
+}
+
+void JNIEnv::ReleasePrimitiveArrayCritical(jarray, void *, jint) {}
+
+jobject JNIEnv::NewDirectByteBuffer(void *address, jlong capacity) {
+    Object *buffer = newObject(findClass("java/nio/DirectByteBuffer"));
+    buffer->address = address;
+    buffer->capacity = capacity;
+    return toHandle(buffer);
+}
+
+void *JNIEnv::GetDirectBufferAddress(jobject buf) {
+    return toObject(buf)->address;
+}
+
+jlong JNIEnv::GetDirectBufferCapacity(jobject buf) {
+    return toObject(buf)->capacity;
+}
+
+jint JNIEnv::RegisterNatives(jclass clazz, const JNINativeMethod *methods, jint method_count) {
+    std::lock_guard<std::recursive_mutex> lock(heap_mutex);
+    for (jint i = 0; i < method_count; i++) {
+        toObject(clazz)->natives[std::string(methods[i].name) + methods[i].signature] = methods[i].fnPtr;
+    }
+    return JNI_OK;
+}
+
+jint JNIEnv::GetJavaVM(JavaVM **vm) {
+    *vm = &java_vm;
+    return JNI_OK;
+}
+
+jint JavaVM::DestroyJavaVM() {
+    return JNI_OK;
+}
+
+jint JavaVM::AttachCurrentThread(JNIEnv **env, void *) {
+    jint result = attach_result.load(std::memory_order_relaxed);
+    *env = result == JNI_OK ? &thread_env : nullptr;
+    return result;
+}
+
+jint JavaVM::DetachCurrentThread() {
+    return JNI_OK;
+}
+
+jint JavaVM::GetEnv(void **env, jint) {
+    *env = &thread_env;
+    return JNI_OK;
+}
+
+int android_get_device_api_level() {
+    return device_api_level.load(std::memory_order_relaxed);
+}
+
+int AndroidBitmap_getInfo(JNIEnv *, jobject jbitmap, AndroidBitmapInfo *info) {
+    Object *bitmap = toObject(jbitmap);
+    if (bitmap == nullptr || !bitmap->is_bitmap) {
+        return ANDROID_BITMAP_RESULT_BAD_PARAMETER;
+    }
+    *info = bitmap->bitmap_info;
+    return ANDROID_BITMAP_RESULT_SUCCESS;
+}
+
+int AndroidBitmap_lockPixels(JNIEnv *, jobject jbitmap, void **addr_ptr) {
+    Object *bitmap = toObject(jbitmap);
+    if (bitmap == nullptr || !bitmap->is_bitmap) {
+        return ANDROID_BITMAP_RESULT_BAD_PARAMETER;
+    }
+    *addr_ptr = bitmap->bytes.data();
+    return ANDROID_BITMAP_RESULT_SUCCESS;
+}
+
+int AndroidBitmap_unlockPixels(JNIEnv *, jobject jbitmap) {
+    Object *bitmap = toObject(jbitmap);
+    if (bitmap == nullptr || !bitmap->is_bitmap) {
+        return ANDROID_BITMAP_RESULT_BAD_PARAMETER;
+    }
+    return ANDROID_BITMAP_RESULT_SUCCESS;
+}
+
+JavaVM *fake::getJavaVM() {
+    return &java_vm;
+}
+
+JNIEnv *fake::getEnv() {
+    return &thread_env;
+}
+
+jobject fake::newObject(const char *class_name) {
+    return toHandle(::newObject(findClass(class_name)));
+}
+
+jobject fake::newBitmap(int width, int height) {
+    Object *bitmap = ::newObject(findClass("android/graphics/Bitmap"));
+    bitmap->is_bitmap = true;
+    bitmap->bitmap_info.width = static_cast<uint32_t>(width);
+    bitmap->bitmap_info.height = static_cast<uint32_t>(height);
+    bitmap->bitmap_info.stride = static_cast<uint32_t>(width) * 4;
+    bitmap->bitmap_info.format = ANDROID_BITMAP_FORMAT_RGBA_8888;
+    bitmap->bytes.resize(static_cast<size_t>(width) * height * 4);
+    return toHandle(bitmap);
+}
+
+void fake::setMethodHandler(
+        const char *class_name,
+        const char *name,
+        const char *signature,
+        MethodHandler handler
+) {
+    findMember(findClass(class_name), name, signature)->handler = std::move(handler);
+}
+
+void *fake::findNative(const char *class_name, const char *name, const char *signature) {
+    std::lock_guard<std::recursive_mutex> lock(heap_mutex);
+    auto &natives = findClass(class_name)->natives;
+    auto it = natives.find(std::string(name) + signature);
+    return it != natives.end() ? it->second : nullptr;
+}
+
+const std::vector<jvalue> &fake::getConstructorArguments(jobject object) {
+    return toObject(object)->arguments;
+}
+
+std::string fake::getExceptionMessage() {
+    return pending_exception != nullptr ? pending_exception->name : std::string();
+}
+
+void fake::setDeviceApiLevel(int level) {
+    device_api_level.store(level, std::memory_order_relaxed);
+}
+
+void fake::setAttachResult(jint result) {
+    attach_result.store(result, std::memory_order_relaxed);
+}
+
+void fake::setMissingClass(const std::string &name) {
+    std::lock_guard<std::recursive_mutex> lock(heap_mutex);
+    missing_class = name;
+}
+
+void fake::releaseObjects() {
+    std::lock_guard<std::recursive_mutex> lock(heap_mutex);
+    // Constants handed out for static fields are objects too
+    for (auto &entry: classes) {
+        entry.second->fields.clear();
+    }
+    objects.clear();
+    pending_exception = nullptr;
+}
@@ -0,0 +1,13 @@
+//
+// Created by udara on 10/19/26.
+//
+
+#pragma once
+
+/**
+ * Host stand-in for the NDK api-level.h. The reported level is set with fake::setDeviceApiLevel.
+ */
+
+#define __ANDROID_API_O__ 26
+
+int android_get_device_api_level();
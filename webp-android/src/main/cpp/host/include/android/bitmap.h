@@ -0,0 +1,39 @@
+//
+// Created by udara on 10/19/26.
+//
+
+#pragma once
+
+/**
+ * Host stand-in for the NDK bitmap.h. Works on bitmaps created with fake::newBitmap or by
+ * Bitmap.createBitmap calls of the glue, which are RGBA_8888 and backed by heap memory.
+ */
+
+#include <cstdint>
+#include <jni.h>
+
+enum {
+    ANDROID_BITMAP_RESULT_SUCCESS = 0,
+    ANDROID_BITMAP_RESULT_BAD_PARAMETER = -1,
+    ANDROID_BITMAP_RESULT_JNI_EXCEPTION = -2,
+    ANDROID_BITMAP_RESULT_ALLOCATION_FAILED = -3
+};
+
+enum AndroidBitmapFormat {
+    ANDROID_BITMAP_FORMAT_NONE = 0,
+    ANDROID_BITMAP_FORMAT_RGBA_8888 = 1
+};
+
+typedef struct {
+    uint32_t width;
+    uint32_t height;
+    uint32_t stride;
+    int32_t format;
+    uint32_t flags;
+} AndroidBitmapInfo;
+
+int AndroidBitmap_getInfo(JNIEnv *env, jobject jbitmap, AndroidBitmapInfo *info);
+
+int AndroidBitmap_lockPixels(JNIEnv *env, jobject jbitmap, void **addr_ptr);
+
+int AndroidBitmap_unlockPixels(JNIEnv *env, jobject jbitmap);
@@ -0,0 +1,90 @@
+//
+// Created by udara on 10/19/26.
+//
+
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+#include <jni.h>
+
+/**
+ * Fake JVM that runs the JNI glue on the host, for profiling and sanitizer builds.
+ *
+ * Classes, fields and methods are created on first lookup, so any name resolves. Objects keep their
+ * field values, arrays and strings keep their contents and direct buffers wrap the given memory.
+ * Java methods are not run. Calls return the value of the handler set for the method, otherwise a
+ * zero value, or true for boolean methods so that observers let the work continue. Bitmap.createBitmap
+ * creates fake bitmaps and NativeBufferCleaner.register wraps the buffer it is given in a WebPBuffer,
+ * whose memory is never freed.
+ *
+ * Every thread is attached unless setAttachResult is given an error. Objects live until releaseObjects, references are not counted.
+ */
+namespace fake {
+    typedef std::function<jvalue(jobject thiz, const std::vector<jvalue> &args)> MethodHandler;
+
+    JavaVM *getJavaVM();
+
+    /**
+     * @return The JNI environment of the calling thread.
+     */
+    JNIEnv *getEnv();
+
+    /**
+     * Creates an object of the given class without running a constructor.
+     *
+     * @param class_name Binary name of the class, such as "android/graphics/Bitmap".
+     */
+    jobject newObject(const char *class_name);
+
+    /**
+     * Creates an RGBA_8888 bitmap with zeroed pixels.
+     */
+    jobject newBitmap(int width, int height);
+
+    /**
+     * Runs the handler when the glue calls the method or constructor, instead of returning a default value.
+     */
+    void setMethodHandler(
+            const char *class_name,
+            const char *name,
+            const char *signature,
+            MethodHandler handler
+    );
+
+    /**
+     * @return The function registered for the method with RegisterNatives, or null.
+     */
+    void *findNative(const char *class_name, const char *name, const char *signature);
+
+    /**
+     * @return The arguments NewObject created the object with.
+     */
+    const std::vector<jvalue> &getConstructorArguments(jobject object);
+
+    /**
+     * @return The message of the pending exception of the calling thread, or an empty string.
+     */
+    std::string getExceptionMessage();
+
+    /**
+     * Sets the level returned by android_get_device_api_level. Defaults to __ANDROID_API_O__.
+     */
+    void setDeviceApiLevel(int level);
+
+    /**
+     * Sets the value returned by AttachCurrentThread, to simulate a failed attach. Defaults to JNI_OK.
+     */
+    void setAttachResult(jint result);
+
+    /**
+     * Makes FindClass fail for the class, as for a class removed by code shrinking. Empty to find every class again.
+     */
+    void setMissingClass(const std::string &name);
+
+    /**
+     * Frees all objects except classes. Handles held by the glue must not be used afterwards.
+     */
+    void releaseObjects();
+}
@@ -0,0 +1,233 @@
+//
+// Created by udara on 10/19/26.
+//
+
+#pragma once
+
+/**
+ * Minimal stand-in for the NDK jni.h, used to build the JNI glue on the host.
+ * Declares the subset of JNIEnv and JavaVM the glue calls. The functions are implemented by the fake
+ * runtime in fake_jni.cpp, see fake_jni.h.
+ */
+
+#include <cstdarg>
+#include <cstdint>
+
+typedef uint8_t jboolean;
+typedef int8_t jbyte;
+typedef uint16_t jchar;
+typedef int16_t jshort;
+typedef int32_t jint;
+typedef int64_t jlong;
+typedef float jfloat;
+typedef double jdouble;
+typedef jint jsize;
+
+class _jobject {};
+class _jclass : public _jobject {};
+class _jstring : public _jobject {};
+class _jthrowable : public _jobject {};
+class _jarray : public _jobject {};
+class _jobjectArray : public _jarray {};
+class _jbyteArray : public _jarray {};
+class _jintArray : public _jarray {};
+class _jlongArray : public _jarray {};
+class _jfloatArray : public _jarray {};
+
+typedef _jobject *jobject;
+typedef _jclass *jclass;
+typedef _jstring *jstring;
+typedef _jthrowable *jthrowable;
+typedef _jarray *jarray;
+typedef _jobjectArray *jobjectArray;
+typedef _jbyteArray *jbyteArray;
+typedef _jintArray *jintArray;
+typedef _jlongArray *jlongArray;
+typedef _jfloatArray *jfloatArray;
+typedef jobject jweak;
+
+struct _jfieldID;
+typedef struct _jfieldID *jfieldID;
+struct _jmethodID;
+typedef struct _jmethodID *jmethodID;
+
+typedef union jvalue {
+    jboolean z;
+    jbyte b;
+    jchar c;
+    jshort s;
+    jint i;
+    jlong j;
+    jfloat f;
+    jdouble d;
+    jobject l;
+} jvalue;
+
+typedef struct {
+    const char *name;
+    const char *signature;
+    void *fnPtr;
+} JNINativeMethod;
+
+#define JNI_FALSE 0
+#define JNI_TRUE 1
+
+#define JNI_VERSION_1_6 0x00010006
+
+#define JNI_OK (0)
+#define JNI_ERR (-1)
+#define JNI_EDETACHED (-2)
+#define JNI_EVERSION (-3)
+
+#define JNI_COMMIT 1
+#define JNI_ABORT 2
+
+#define JNIIMPORT
+#define JNIEXPORT __attribute__ ((visibility ("default")))
+#define JNICALL
+
+struct JavaVM;
+
+struct JNIEnv {
+    jint GetVersion();
+
+    jclass FindClass(const char *name);
+
+    jclass GetObjectClass(jobject obj);
+
+    jboolean IsInstanceOf(jobject obj, jclass clazz);
+
+    jboolean IsSameObject(jobject ref1, jobject ref2);
+
+    jint ThrowNew(jclass clazz, const char *message);
+
+    jboolean ExceptionCheck();
+
+    void ExceptionDescribe();
+
+    void ExceptionClear();
+
+    jobject NewGlobalRef(jobject obj);
+
+    void DeleteGlobalRef(jobject global_ref);
+
+    jobject NewLocalRef(jobject ref);
+
+    void DeleteLocalRef(jobject local_ref);
+
+    jmethodID GetMethodID(jclass clazz, const char *name, const char *sig);
+
+    jmethodID GetStaticMethodID(jclass clazz, const char *name, const char *sig);
+
+    jfieldID GetFieldID(jclass clazz, const char *name, const char *sig);
+
+    jfieldID GetStaticFieldID(jclass clazz, const char *name, const char *sig);
+
+    jobject NewObject(jclass clazz, jmethodID method_id, ...);
+
+    jobject CallObjectMethod(jobject obj, jmethodID method_id, ...);
+
+    jboolean CallBooleanMethod(jobject obj, jmethodID method_id, ...);
+
+    jint CallIntMethod(jobject obj, jmethodID method_id, ...);
+
+    jlong CallLongMethod(jobject obj, jmethodID method_id, ...);
+
+    void CallVoidMethod(jobject obj, jmethodID method_id, ...);
+
+    jobject CallStaticObjectMethod(jclass clazz, jmethodID method_id, ...);
+
+    void CallStaticVoidMethod(jclass clazz, jmethodID method_id, ...);
+
+    jobject GetObjectField(jobject obj, jfieldID field_id);
+
+    jboolean GetBooleanField(jobject obj, jfieldID field_id);
+
+    jchar GetCharField(jobject obj, jfieldID field_id);
+
+    jint GetIntField(jobject obj, jfieldID field_id);
+
+    jlong GetLongField(jobject obj, jfieldID field_id);
+
+    jfloat GetFloatField(jobject obj, jfieldID field_id);
+
+    void SetObjectField(jobject obj, jfieldID field_id, jobject value);
+
+    void SetBooleanField(jobject obj, jfieldID field_id, jboolean value);
+
+    void SetIntField(jobject obj, jfieldID field_id, jint value);
+
+    void SetLongField(jobject obj, jfieldID field_id, jlong value);
+
+    void SetFloatField(jobject obj, jfieldID field_id, jfloat value);
+
+    jobject GetStaticObjectField(jclass clazz, jfieldID field_id);
+
+    void SetStaticObjectField(jclass clazz, jfieldID field_id, jobject value);
+
+    jstring NewStringUTF(const char *bytes);
+
+    const char *GetStringUTFChars(jstring string, jboolean *is_copy);
+
+    void ReleaseStringUTFChars(jstring string, const char *utf);
+
+    jsize GetArrayLength(jarray array);
+
+    jobjectArray NewObjectArray(jsize length, jclass element_class, jobject initial_element);
+
+    jobject GetObjectArrayElement(jobjectArray array, jsize index);
+
+    void SetObjectArrayElement(jobjectArray array, jsize index, jobject value);
+
+    jbyteArray NewByteArray(jsize length);
+
+    jintArray NewIntArray(jsize length);
+
+    jlongArray NewLongArray(jsize length);
+
+    jfloatArray NewFloatArray(jsize length);
+
+    void GetByteArrayRegion(jbyteArray array, jsize start, jsize len, jbyte *buf);
+
+    void SetByteArrayRegion(jbyteArray array, jsize start, jsize len, const jbyte *buf);
+
+    void GetIntArrayRegion(jintArray array, jsize start, jsize len, jint *buf);
+
+    void SetIntArrayRegion(jintArray array, jsize start, jsize len, const jint *buf);
+
+    void GetLongArrayRegion(jlongArray array, jsize start, jsize len, jlong *buf);
+
+    void SetLongArrayRegion(jlongArray array, jsize start, jsize len, const jlong *buf);
+
+    void GetFloatArrayRegion(jfloatArray array, jsize start, jsize len, jfloat *buf);
+
+    void SetFloatArrayRegion(jfloatArray array, jsize start, jsize len, const jfloat *buf);
+
+    void *GetPrimitiveArrayCritical(jarray array, jboolean *is_copy);
+
+    void ReleasePrimitiveArrayCritical(jarray array, void *carray, jint mode);
+
+    jobject NewDirectByteBuffer(void *address, jlong capacity);
+
+    void *GetDirectBufferAddress(jobject buf);
+
+    jlong GetDirectBufferCapacity(jobject buf);
+
+    jint RegisterNatives(jclass clazz, const JNINativeMethod *methods, jint method_count);
+
+    jint GetJavaVM(JavaVM **vm);
+};
+
+struct JavaVM {
+    jint DestroyJavaVM();
+
+    jint AttachCurrentThread(JNIEnv **env, void *args);
+
+    jint DetachCurrentThread();
+
+    jint GetEnv(void **env, jint version);
+};
+
+extern "C" {
+JNIEXPORT jint JNICALL JNI_OnLoad(JavaVM *vm, void *reserved);
+}
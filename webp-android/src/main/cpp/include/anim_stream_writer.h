@@ -0,0 +1,86 @@
+//
+// Created by udara on 10/19/26.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <webp/mux.h>
+
+#include "result_codes.h"
+
+/**
+ * Writes an animated WebP container to a file descriptor one frame at a time.
+ *
+ * The RIFF header, VP8X and ANIM chunks are written before the first frame. Each frame is appended
+ * as an ANMF chunk as soon as it is written, and finish seeks back to patch the RIFF size and the
+ * alpha flag. Only the frame being written is held in memory.
+ *
+ * Pipes and sockets cannot be patched, so for those the container is buffered and written by finish.
+ */
+class AnimStreamWriter {
+
+private:
+    int fd;
+    WebPMuxAnimParams animParams;
+    bool headerWritten = false;
+    bool hasAlpha = false;
+    bool seekable;
+    uint64_t bytesWritten = 0;
+    std::vector<uint8_t> buffer;
+
+    ResultCode writeAll(const uint8_t *data, size_t size);
+
+    ResultCode writeHeader(int canvas_width, int canvas_height);
+
+public:
+    /**
+     * @param fd File descriptor opened for writing. Not closed by the writer.
+     * @param anim_params Background color and loop count of the animation.
+     */
+    AnimStreamWriter(int fd, const WebPMuxAnimParams &anim_params);
+
+    /**
+     * @return false if the file descriptor cannot seek and the animation is buffered until finish.
+     */
+    bool isSeekable() const;
+
+    /**
+     * Appends a frame.
+     *
+     * @param webp_data A still WebP image as produced by WebPEncode.
+     * @param webp_size Size of the WebP image.
+     * @param x_offset The x offset of the frame on the canvas. Must be even.
+     * @param y_offset The y offset of the frame on the canvas. Must be even.
+     * @param width The width of the frame.
+     * @param height The height of the frame.
+     * @param duration The duration of the frame in milliseconds.
+     * @param blend The blend method of the frame.
+     * @param canvas_width The canvas width, written with the first frame.
+     * @param canvas_height The canvas height, written with the first frame.
+     *
+     * @return 0 if success, ERROR_FILE_TOO_BIG if the frame would take the container past the
+     * RIFF size limit of 4 GiB, otherwise error code.
+     */
+    ResultCode writeFrame(
+            const uint8_t *webp_data,
+            size_t webp_size,
+            int x_offset,
+            int y_offset,
+            int width,
+            int height,
+            int duration,
+            WebPMuxAnimBlend blend,
+            int canvas_width,
+            int canvas_height
+    );
+
+    /**
+     * Patches the RIFF size and the alpha flag, and writes the buffered animation if not seekable.
+     *
+     * @return 0 if success, otherwise error code.
+     */
+    ResultCode finish();
+};
@@ -0,0 +1,50 @@
+//
+// Created by udara on 10/19/26.
+//
+
+#pragma once
+
+#include <cstdint>
+
+namespace bmp {
+    /**
+     * Returns the integer factor between the source and output sizes if the output can be produced
+     * with a box filter, otherwise 0.
+     *
+     * @param src_width The width of the source image.
+     * @param src_height The height of the source image.
+     * @param dst_width The width of the output image.
+     * @param dst_height The height of the output image.
+     *
+     * @return The downscale factor in [2..16], or 0 if the ratio is not a supported integer.
+     */
+    int boxDownscaleFactor(
+            int src_width,
+            int src_height,
+            int dst_width,
+            int dst_height
+    );
+
+    /**
+     * Downscales RGBA_8888 pixels by an integer factor with an alpha weighted box filter and
+     * writes the result as ARGB words, the layout used by WebPPicture. The block rows are summed
+     * with NEON or SSE2 where available.
+     *
+     * @param src_pixels The source pixels in RGBA_8888 format.
+     * @param src_stride The number of bytes between two source rows.
+     * @param factor The downscale factor returned by boxDownscaleFactor.
+     * @param dst_argb The output ARGB pixels.
+     * @param dst_width The width of the output image.
+     * @param dst_height The height of the output image.
+     * @param dst_stride The number of ARGB words between two output rows.
+     */
+    void boxDownscale(
+            const uint8_t *src_pixels,
+            int src_stride,
+            int factor,
+            uint32_t *dst_argb,
+            int dst_width,
+            int dst_height,
+            int dst_stride
+    );
+}
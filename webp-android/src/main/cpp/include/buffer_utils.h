@@ -0,0 +1,29 @@
+//
+// Created by udara on 10/19/26.
+//
+
+#pragma once
+
+#include <jni.h>
+
+namespace buf {
+    /**
+     * Wraps memory allocated by libwebp in a direct ByteBuffer without copying, owned by a WebPBuffer.
+     * The memory is released with WebPFree once the WebPBuffer is garbage collected. Views of the
+     * ByteBuffer do not keep the WebPBuffer reachable.
+     *
+     * @param env Pointer to the JNI environment.
+     * @param data Pointer to the memory allocated by libwebp. Ownership is transferred to the WebPBuffer,
+     * or the memory is freed if it could not be created.
+     * @param size Size of the memory in bytes.
+     *
+     * @return The WebPBuffer or nullptr if it could not be created. No exception is pending.
+     */
+    jobject wrapWebPData(
+            JNIEnv *env,
+            const uint8_t *data,
+            size_t size
+    );
+
+    void nativeFree(JNIEnv *env, jclass clazz, jlong jpointer);
+}
@@ -8,6 +8,10 @@
 #include <webp/encode.h>
 #include <webp/mux.h>
 
+#include "result_codes.h"
+#include "picture_import.h"
+#include "type_helper.h"
+
 namespace enc {
     /**
      * Parses the WebPPreset enum value from a Java preset enum.
@@ -23,29 +27,84 @@ namespace enc {
     );
 
     /**
-     * Applies java webp config to the given WebPConfig.
+     * Indices of the WebPConfig fields packed by the Kotlin WebPConfig class, in packing order.
+     */
+    enum WebPConfigValue {
+        CONFIG_LOSSLESS = 0,
+        CONFIG_QUALITY,
+        CONFIG_METHOD,
+        CONFIG_TARGET_SIZE,
+        CONFIG_TARGET_PSNR,
+        CONFIG_SEGMENTS,
+        CONFIG_SNS_STRENGTH,
+        CONFIG_FILTER_STRENGTH,
+        CONFIG_FILTER_SHARPNESS,
+        CONFIG_FILTER_TYPE,
+        CONFIG_AUTO_FILTER,
+        CONFIG_ALPHA_COMPRESSION,
+        CONFIG_ALPHA_FILTERING,
+        CONFIG_ALPHA_QUALITY,
+        CONFIG_PASS,
+        CONFIG_SHOW_COMPRESSED,
+        CONFIG_PREPROCESSING,
+        CONFIG_PARTITIONS,
+        CONFIG_PARTITION_LIMIT,
+        CONFIG_EMULATE_JPEG_SIZE,
+        CONFIG_THREAD_LEVEL,
+        CONFIG_LOW_MEMORY,
+        CONFIG_NEAR_LOSSLESS,
+        CONFIG_EXACT,
+        CONFIG_USE_DELTA_PALETTE,
+        CONFIG_USE_SHARP_YUV,
+        CONFIG_QMIN,
+        CONFIG_QMAX,
+        CONFIG_VALUE_COUNT
+    };
+
+    /**
+     * Indices of the options packed by the Kotlin WebPAnimEncoderOptions class, in packing order.
+     * The animation parameters are flattened into the options, OPTIONS_ANIM_PARAMS tells if they were given.
+     */
+    enum AnimEncoderOptionsValue {
+        OPTIONS_MINIMIZE_SIZE = 0,
+        OPTIONS_KMIN,
+        OPTIONS_KMAX,
+        OPTIONS_ALLOW_MIXED,
+        OPTIONS_VERBOSE,
+        OPTIONS_ANIM_PARAMS,
+        OPTIONS_BACKGROUND_COLOR,
+        OPTIONS_LOOP_COUNT,
+        OPTIONS_MAX_SEEK_FRAMES,
+        OPTIONS_VALUE_COUNT
+    };
+
+    /**
+     * Applies the present values of a packed java webp config to the given WebPConfig.
      *
-     * @param env Pointer to the JNI environment.
-     * @param jconfig Pointer to the Java config object representing the WebPConfig.
+     * @param packed The packed values of the Java config object.
      * @param config Pointer to the WebPConfig struct to be populated.
      */
     void applyWebPConfig(
-            JNIEnv *env,
-            jobject jconfig,
+            const type::PackedValues &packed,
             WebPConfig *config
     );
 
     /**
-     * Parses the WebP quality value from a Java webp config object.
+     * Builds a WebPConfig from an optional Java config and an optional Java preset.
+     * The preset is applied first, then the non-null fields of the config are applied on top of it.
      *
      * @param env Pointer to the JNI environment.
-     * @param jconfig Pointer to the Java object representing the WebP configuration.
+     * @param jconfig The Java WebPConfig object or null.
+     * @param jpreset The Java WebPPreset object or null.
+     * @param config Pointer to the WebPConfig struct to be populated.
      *
-     * @return The parsed WebP quality value as a float.
+     * @return RESULT_SUCCESS if the resulting config is valid, otherwise the error code.
      */
-    float parseWebPQuality(
+    ResultCode buildWebPConfig(
             JNIEnv *env,
-            jobject jconfig
+            jobject jconfig,
+            jobject jpreset,
+            WebPConfig *config
     );
 
     /**
@@ -54,10 +113,12 @@ namespace enc {
      * @param env A pointer to the JNI environment.
      * @param joptions A pointer to the Java object representing the options.
      * @param options A pointer to the WebP animation encoder options structure.
+     * @param has_anim_params If not null, receives whether the options carry animation parameters.
      */
     void parseEncoderOptions(
             JNIEnv *env,
             jobject joptions,
-            WebPAnimEncoderOptions *options
+            WebPAnimEncoderOptions *options,
+            bool *has_anim_params = nullptr
     );
 }
\ No newline at end of file
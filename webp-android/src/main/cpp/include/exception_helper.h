@@ -6,9 +6,17 @@
 
 #include <jni.h>
 
+#include "result_codes.h"
+
 namespace exc {
     void throwRuntimeException(JNIEnv *env, const char *format, ...);
 
     void throwCancellationException(JNIEnv *env, const char *format, ...);
 }
 
+namespace res {
+    /**
+     * Throws the Java exception matching a failed result. Does nothing on success.
+     */
+    void handleResult(JNIEnv *env, ResultCode result);
+}
@@ -0,0 +1,99 @@
+//
+// Created by udara on 10/19/26.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "result_codes.h"
+#include "picture_import.h"
+
+/**
+ * Resamples added frames onto a fixed frame rate before they are imported.
+ *
+ * Output frame times are multiples of the frame duration, rounded to milliseconds. Each frame belongs
+ * to the output frame time at or before its timestamp, and one frame per output frame time is kept
+ * with its timestamp moved to that time. Without difference measuring the first frame of each output frame is kept and
+ * later ones are dropped without copying. With difference measuring, the frame that changed the most
+ * from the last kept frame wins, so a short change inside one output frame is not lost. The leading
+ * candidate is copied and kept until a frame of a later output frame arrives or the animation ends.
+ * Frames are compared by a grid of luma samples.
+ */
+class FrameDecimator {
+
+public:
+    /**
+     * Receives a kept frame with its resampled timestamp.
+     */
+    typedef std::function<ResultCode(const enc::RawFrame &, long)> Sink;
+
+private:
+    double frameDuration = 0;
+    bool measureDifference = false;
+    long currentSlot = -1;
+    bool hasCandidate = false;
+    std::vector<uint8_t> candidatePixels;
+    enc::RawFrame candidateFrame{};
+    std::vector<uint8_t> candidateSignature;
+    uint32_t candidateScore = 0;
+    std::vector<uint8_t> keptSignature;
+    int droppedCount = 0;
+
+    long slotTime(long slot) const;
+
+    ResultCode commitCandidate(const Sink &sink);
+
+    static void computeSignature(const enc::RawFrame &frame, std::vector<uint8_t> *signature);
+
+    static uint32_t difference(const std::vector<uint8_t> &a, const std::vector<uint8_t> &b);
+
+public:
+    /**
+     * @param frame_duration Output frame duration in milliseconds, or 0 to keep every frame.
+     * @param measure_difference If true, the frame that changed the most is kept instead of the first one.
+     */
+    void configure(double frame_duration, bool measure_difference);
+
+    bool isEnabled() const;
+
+    /**
+     * @return true once a frame was submitted.
+     */
+    bool isStarted() const;
+
+    /**
+     * Passes the frame to the sink if it is kept. May first pass the kept frame of an earlier output frame.
+     *
+     * @param frame The frame to resample. Strides must be resolved.
+     * @param timestamp The timestamp of the frame in milliseconds. Negative timestamps are treated as 0.
+     * @param sink Receives the kept frames.
+     *
+     * @return 0 if success or the error returned by the sink.
+     */
+    ResultCode submit(const enc::RawFrame &frame, long timestamp, const Sink &sink);
+
+    /**
+     * Passes the kept frame of the last output frame to the sink.
+     */
+    ResultCode flush(const Sink &sink);
+
+    /**
+     * @param end End timestamp of the animation in milliseconds.
+     *
+     * @return The end timestamp rounded up to an output frame time.
+     */
+    long endTimestamp(long end) const;
+
+    /**
+     * @return the number of frames dropped so far.
+     */
+    int getDroppedCount() const;
+
+    /**
+     * @return the number of bytes held by the copy of the candidate frame.
+     */
+    size_t getRetainedBytes() const;
+};
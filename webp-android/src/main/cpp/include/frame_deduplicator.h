@@ -0,0 +1,59 @@
+//
+// Created by udara on 10/19/26.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "picture_import.h"
+
+/**
+ * Detects frames that repeat the previously kept frame.
+ *
+ * The last kept frame is copied. Every channel of the new frame must be within the tolerance, compared
+ * row by row with NEON or SSE2 where available, so that a changed frame usually stops at its first
+ * changed row. YUV frames compare their chroma planes as well as the luma plane. Comparing against
+ * the last kept frame rather than the last seen one prevents slow drift from being dropped frame by frame.
+ */
+class FrameDeduplicator {
+
+private:
+    int tolerance = -1;
+    bool hasLastFrame = false;
+    enc::RawFrame lastFrame{};
+    std::vector<uint8_t> lastPixels;
+    int droppedCount = 0;
+
+    bool isWithinTolerance(const enc::RawFrame &frame) const;
+
+    void keep(const enc::RawFrame &frame);
+
+public:
+    /**
+     * @param max_difference Maximum per channel difference of a duplicate, 0 for exact duplicates
+     * or a negative value to keep all frames.
+     */
+    void setTolerance(int max_difference);
+
+    /**
+     * Checks the frame against the last kept frame. If the frame is kept, it becomes the new reference.
+     *
+     * @param frame The frame to check. Strides must be resolved.
+     *
+     * @return true if the frame should be dropped.
+     */
+    bool isDuplicate(const enc::RawFrame &frame);
+
+    /**
+     * @return the number of frames dropped so far.
+     */
+    int getDroppedCount() const;
+
+    /**
+     * @return the number of bytes held by the copy of the last kept frame.
+     */
+    size_t getRetainedBytes() const;
+};
@@ -0,0 +1,128 @@
+//
+// Created by udara on 10/19/26.
+//
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "result_codes.h"
+#include "picture_import.h"
+#include "memory_tracker.h"
+
+/**
+ * Frame copied out of a locked bitmap and waiting to be encoded.
+ */
+typedef struct {
+    std::vector<uint8_t> pixels;
+    enc::RawFrame frame;
+    long timestamp;
+} QueuedFrame;
+
+/**
+ * Functions run on the worker thread before its first frame and after its last, for example to
+ * attach it to the JVM. Either may be empty.
+ */
+typedef struct {
+    /**
+     * @return 0 to start encoding, otherwise the error that stops the worker.
+     */
+    std::function<ResultCode()> attach;
+    std::function<void()> detach;
+} WorkerHooks;
+
+/**
+ * Bounded queue of frames drained by a single native worker thread.
+ *
+ * Frame buffers are pooled so that a steady stream of same sized frames does not allocate.
+ * push blocks while the queue holds capacity frames. The first error returned by the consumer
+ * is kept, the remaining frames are dropped and the error is reported by the next push or drain.
+ * Queued and pooled buffers are reported to the memory tracker until the queue is stopped.
+ */
+class FrameQueue {
+
+public:
+    /**
+     * Encodes one frame on the worker thread.
+     */
+    typedef std::function<ResultCode(const QueuedFrame &)> Consumer;
+
+private:
+    mutable std::mutex mutex_;
+    std::condition_variable not_full_;
+    std::condition_variable not_empty_;
+    std::condition_variable drained_;
+    std::condition_variable attached_;
+    std::deque<QueuedFrame> frames_;
+    std::vector<std::vector<uint8_t>> buffer_pool_;
+    size_t capacity_ = 0;
+    bool busy_ = false;
+    bool attaching_ = false;
+    bool running_ = false;
+    bool stop_ = false;
+    ResultCode error_ = RESULT_SUCCESS;
+    MemoryTracker *tracker_ = nullptr;
+    Consumer consumer_;
+    WorkerHooks hooks_;
+    std::thread worker_;
+
+    void run();
+
+public:
+    ~FrameQueue();
+
+    /**
+     * Starts the worker thread and waits until its attach hook has run.
+     *
+     * @param capacity Maximum number of frames waiting to be encoded.
+     * @param consumer Function that encodes a frame.
+     * @param tracker If not null, receives the bytes of the frame buffers. Must outlive the queue.
+     * @param hooks Functions run on the worker thread around the frames it encodes.
+     *
+     * @return 0 if the worker is running, otherwise the error that stopped it.
+     */
+    ResultCode start(
+            size_t capacity,
+            Consumer consumer,
+            MemoryTracker *tracker = nullptr,
+            WorkerHooks hooks = {}
+    );
+
+    /**
+     * @return true if the worker thread is running, from a successful start until stop.
+     */
+    bool isStarted() const;
+
+    /**
+     * Copies the frame into a pooled buffer and queues it.
+     * Blocks while the queue is full.
+     *
+     * @param frame The frame to copy. Strides must be resolved.
+     * @param timestamp The timestamp of the frame in milliseconds.
+     *
+     * @return 0 if queued, otherwise the error of a previously queued frame.
+     */
+    ResultCode push(const enc::RawFrame &frame, long timestamp);
+
+    /**
+     * Waits until every queued frame has been encoded.
+     *
+     * @return 0 if all frames were encoded, otherwise the first error.
+     */
+    ResultCode drain();
+
+    /**
+     * Drops the queued frames that have not been started yet.
+     */
+    void clear();
+
+    /**
+     * Drops the queued frames and stops the worker thread.
+     */
+    void stop();
+};
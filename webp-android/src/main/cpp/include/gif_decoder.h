@@ -0,0 +1,101 @@
+//
+// Created by udara on 10/19/26.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "result_codes.h"
+
+/**
+ * Minimal GIF decoder that renders frames onto an RGBA canvas.
+ *
+ * Disposal and transparency follow gif2webp: the canvas starts transparent, transparent indices keep the
+ * canvas pixel, DISPOSE_BACKGROUND clears the frame rectangle to transparent and DISPOSE_PREVIOUS restores
+ * the canvas drawn before the frame. The GIF data must stay valid while the decoder is in use.
+ */
+class GifDecoder {
+
+private:
+    typedef struct {
+        int left;
+        int top;
+        int width;
+        int height;
+        bool interlaced;
+        const uint8_t *color_table;
+        int color_count;
+        int transparent_index;
+        int disposal;
+        int duration;
+        const uint8_t *image_data;
+    } GifFrame;
+
+    const uint8_t *dataEnd = nullptr;
+    int canvasWidth = 0;
+    int canvasHeight = 0;
+    int loopCount = 1;
+    uint32_t backgroundColor = 0xffffffff;
+    std::vector<GifFrame> frames;
+    std::vector<uint8_t> canvas;
+    std::vector<uint8_t> previousCanvas;
+    std::vector<uint8_t> indices;
+    size_t decodedPixels = 0;
+    size_t frameIndex = 0;
+    int timestamp = 0;
+
+    ResultCode decodeIndices(const GifFrame &frame);
+
+    void disposeFrame(const GifFrame &frame);
+
+    void drawFrame(const GifFrame &frame);
+
+public:
+    /**
+     * @return true if the data starts with a GIF signature.
+     */
+    static bool isGif(const uint8_t *data, size_t size);
+
+    /**
+     * Parses the GIF structure and indexes its frames. Pixel data is decoded lazily by getNext.
+     *
+     * @param data The GIF data.
+     * @param size The size of the GIF data in bytes.
+     *
+     * @return 0 if success, ERROR_BAD_DIMENSION if the canvas or a frame is larger than a WebP image can be,
+     * or error code if the data is not a valid GIF.
+     */
+    ResultCode open(const uint8_t *data, size_t size);
+
+    int getCanvasWidth() const;
+
+    int getCanvasHeight() const;
+
+    int getFrameCount() const;
+
+    /**
+     * @return The number of times the animation plays, 0 for infinite, or 1 if the GIF has no NETSCAPE2.0 loop
+     * extension. Like gif2webp -loop_compatible, a stored repetition count n plays n + 1 times.
+     */
+    int getLoopCount() const;
+
+    /**
+     * @return The background color in the byte order of WebPMuxAnimParams.
+     */
+    uint32_t getBackgroundColor() const;
+
+    bool hasMoreFrames() const;
+
+    /**
+     * Renders the next frame onto the canvas.
+     *
+     * @param canvas Receives the RGBA canvas, valid until the next call.
+     * @param end_timestamp Receives the end timestamp of the frame in milliseconds.
+     *
+     * @return 0 if success or error code if the frame data is corrupt.
+     */
+    ResultCode getNext(uint8_t **canvas, int *end_timestamp);
+};
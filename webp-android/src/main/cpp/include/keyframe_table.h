@@ -0,0 +1,86 @@
+//
+// Created by udara on 10/19/26.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include <webp/demux.h>
+
+/**
+ * Lists the keyframes of an animated WebP image, as WebPAnimDecoder detects them.
+ *
+ * A keyframe can be decoded without the frames before it, so reaching any frame costs decoding
+ * it and the frames back to the previous keyframe.
+ */
+class KeyFrameTable {
+
+private:
+    std::vector<bool> keyFrameFlags;
+    std::vector<long> frameTimestamps;
+    std::vector<size_t> frameSizes;
+
+public:
+    /**
+     * Reads the frames of the image.
+     *
+     * @param data The WebP image.
+     *
+     * @return false if the image could not be parsed.
+     */
+    bool parse(const WebPData &data);
+
+    int getFrameCount() const;
+
+    /**
+     * @param index Zero based frame index.
+     *
+     * @return true if the frame can be decoded without the previous frames.
+     */
+    bool isKeyFrame(int index) const;
+
+    /**
+     * @return the start timestamp of the frame in milliseconds.
+     */
+    long getTimestamp(int index) const;
+
+    /**
+     * @return the zero based indices of the keyframes.
+     */
+    std::vector<int> getKeyFrames() const;
+
+    /**
+     * @return the largest number of frames decoded to display any frame.
+     */
+    int getMaxSeekFrames() const;
+
+    /**
+     * @return the total bitstream size of the keyframes in bytes.
+     */
+    size_t getKeyFrameBytes() const;
+
+    /**
+     * @return the total bitstream size of the other frames in bytes.
+     */
+    size_t getDeltaFrameBytes() const;
+
+    /**
+     * Estimates the bytes spent on keyframes after the first one, as the difference between their size
+     * and the average size of a delta frame. This is what the image would save with a single keyframe.
+     *
+     * @return the estimated overhead in bytes, or 0 if the image has no delta frames to compare with.
+     */
+    size_t estimateKeyFrameOverhead() const;
+
+    /**
+     * @return true if the frame is a keyframe, using the rules of WebPAnimDecoder.
+     */
+    static bool isKeyFrame(
+            const WebPIterator &frame,
+            const WebPIterator &previous,
+            bool previous_is_key_frame,
+            int canvas_width,
+            int canvas_height
+    );
+};
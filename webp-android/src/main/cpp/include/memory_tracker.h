@@ -0,0 +1,59 @@
+//
+// Created by udara on 10/19/26.
+//
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <webp/encode.h>
+
+/**
+ * What the animation encoder does when a frame would take it over its memory limit.
+ * Mirrors the Kotlin WebPMemoryPolicy enum.
+ */
+enum MemoryPolicy {
+    MEMORY_POLICY_FAIL = 0,
+    MEMORY_POLICY_REDUCE
+};
+
+/**
+ * Counts the bytes an encoder keeps resident and the peak of that count.
+ *
+ * libwebp has no allocation hooks, so owners report the buffers they allocate or receive from libwebp:
+ * pictures, encoded frames, canvases and queued frame copies. Counters are atomic because frames are
+ * encoded on worker threads.
+ */
+class MemoryTracker {
+
+private:
+    std::atomic<size_t> currentBytes{0};
+    std::atomic<size_t> peakBytes{0};
+    std::atomic<size_t> limitBytes{0};
+
+public:
+    /**
+     * @param limit_bytes Maximum resident bytes, or 0 for no limit.
+     */
+    void setLimit(size_t limit_bytes);
+
+    size_t getLimit() const;
+
+    /**
+     * @return true if the bytes can be allocated without going over the limit.
+     */
+    bool fits(size_t bytes) const;
+
+    void allocate(size_t bytes);
+
+    void release(size_t bytes);
+
+    size_t getCurrent() const;
+
+    size_t getPeak() const;
+
+    /**
+     * @return the number of bytes of the ARGB or YUVA planes held by the picture.
+     */
+    static size_t pictureByteCount(const WebPPicture &picture);
+};
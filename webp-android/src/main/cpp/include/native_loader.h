@@ -6,97 +6,155 @@
 
 #include <jni.h>
 
-#include <functional>
-#include <utility>
+#include <atomic>
+#include <mutex>
+
+/**
+ * A JNI class, field or method of the registry.
+ *
+ * Entries link themselves in definition order. By default ClassRegistry::load resolves all of them once
+ * in JNI_OnLoad, classes first, and get is a plain load that is safe from any thread afterwards. When
+ * WEBPCODEC_LAZY_JNI_REGISTRY is defined, each entry is resolved on its first get under a mutex, and
+ * resolved again on the first get after reset.
+ *
+ * Entries are objects rather than one plain table filled by a single resolve function, so that lazy mode
+ * only resolves the entries a call uses, and can resolve them again after JNI_OnUnload released them,
+ * which a std::call_once flag cannot be reset for.
+ */
+class RegistryEntry {
+private:
+    RegistryEntry *next = nullptr;
+    const bool isClass;
+
+    static RegistryEntry *first;
+    static RegistryEntry *last;
 
-template<typename T>
-class Lazy {
 protected:
-    std::function<T(JNIEnv *)> initializer;
-    T value;
+    explicit RegistryEntry(bool is_class);
 
 public:
-    explicit Lazy(std::function<T(JNIEnv *)> init) : initializer(std::move(init)), value(nullptr) {}
+    RegistryEntry(const RegistryEntry &) = delete;
+
+    RegistryEntry &operator=(const RegistryEntry &) = delete;
+
+    /**
+     * @return false if the entry resolved to null.
+     */
+    virtual bool load(JNIEnv *env) = 0;
+
+    virtual void reset(JNIEnv *env) = 0;
+
+    /**
+     * Resolves the classes, then the fields and methods.
+     *
+     * @return false if a class could not be found.
+     */
+    static bool loadAll(JNIEnv *env);
 
-    T get(JNIEnv *env) {
-        if (value == nullptr) {
-            value = initializer(env);
+    static void resetAll(JNIEnv *env);
+};
+
+template<typename T>
+class Lazy : public RegistryEntry {
+protected:
+    T value = nullptr;
+#ifdef WEBPCODEC_LAZY_JNI_REGISTRY
+    std::atomic<bool> resolved{false};
+    std::mutex resolveMutex;
+#endif
+
+    virtual T resolve(JNIEnv *env) = 0;
+
+public:
+    explicit Lazy(bool is_class) : RegistryEntry(is_class) {}
+
+    T get([[maybe_unused]] JNIEnv *env) {
+#ifdef WEBPCODEC_LAZY_JNI_REGISTRY
+        if (!resolved.load(std::memory_order_acquire)) {
+            std::lock_guard<std::mutex> lock(resolveMutex);
+            if (!resolved.load(std::memory_order_relaxed)) {
+                value = resolve(env);
+                resolved.store(true, std::memory_order_release);
+            }
         }
+#endif
         return value;
     }
 
-    virtual void reset(JNIEnv *env) {
+    bool load(JNIEnv *env) override {
+#ifdef WEBPCODEC_LAZY_JNI_REGISTRY
+        return get(env) != nullptr;
+#else
+        value = resolve(env);
+        return value != nullptr;
+#endif
+    }
+
+    void reset([[maybe_unused]] JNIEnv *env) override {
+#ifdef WEBPCODEC_LAZY_JNI_REGISTRY
+        std::lock_guard<std::mutex> lock(resolveMutex);
+        resolved.store(false, std::memory_order_relaxed);
+#endif
         value = nullptr;
     }
 };
 
 class LazyClass : public Lazy<jclass> {
-public:
-    explicit LazyClass(const char *name) : Lazy([name](JNIEnv *env) {
+private:
+    const char *name;
+
+protected:
+    jclass resolve(JNIEnv *env) override {
         jclass clazz = env->FindClass(name);
         if (env->ExceptionCheck()) {
             env->ExceptionClear();
+            return nullptr;
         }
-        return reinterpret_cast<jclass>(env->NewGlobalRef(clazz));
-    }) {}
+        auto global = reinterpret_cast<jclass>(env->NewGlobalRef(clazz));
+        env->DeleteLocalRef(clazz);
+        return global;
+    }
+
+public:
+    explicit LazyClass(const char *name) : Lazy(true), name(name) {}
 
     void reset(JNIEnv *env) override {
-        env->DeleteGlobalRef(value);
-        value = nullptr;
+        if (value != nullptr) {
+            env->DeleteGlobalRef(value);
+        }
+        Lazy::reset(env);
     }
 };
 
-class LazyField : public Lazy<jfieldID> {
-public:
-    LazyField(Lazy<jclass> &clazz, const char *name, const char *sig) : Lazy(
-            [&clazz, name, sig](JNIEnv *env) {
-                jclass c = clazz.get(env);
-                jfieldID fieldID = env->GetFieldID(c, name, sig);
-                if (env->ExceptionCheck()) {
-                    env->ExceptionClear();
-                }
-                return fieldID;
-            }) {}
-};
+/**
+ * A field or method of a registry class, looked up with the given JNI function.
+ */
+template<typename T, T (JNIEnv::*lookup)(jclass, const char *, const char *)>
+class LazyMember : public Lazy<T> {
+private:
+    Lazy<jclass> &clazz;
+    const char *name;
+    const char *sig;
 
-class LazyStaticField : public Lazy<jfieldID> {
-public:
-    LazyStaticField(Lazy<jclass> &clazz, const char *name, const char *sig) : Lazy(
-            [&clazz, name, sig](JNIEnv *env) {
-                jclass c = clazz.get(env);
-                jfieldID fieldID = env->GetStaticFieldID(c, name, sig);
-                if (env->ExceptionCheck()) {
-                    env->ExceptionClear();
-                }
-                return fieldID;
-            }) {}
-};
+protected:
+    T resolve(JNIEnv *env) override {
+        T id = (env->*lookup)(clazz.get(env), name, sig);
+        if (env->ExceptionCheck()) {
+            env->ExceptionClear();
+            return nullptr;
+        }
+        return id;
+    }
 
-class LazyMethod : public Lazy<jmethodID> {
 public:
-    LazyMethod(Lazy<jclass> &clazz, const char *name, const char *sig) : Lazy(
-            [&clazz, name, sig](JNIEnv *env) {
-                jclass c = clazz.get(env);
-                jmethodID methodID = env->GetMethodID(c, name, sig);
-                if (env->ExceptionCheck()) {
-                    env->ExceptionClear();
-                }
-                return methodID;
-            }) {}
+    LazyMember(Lazy<jclass> &clazz, const char *name, const char *sig)
+            : Lazy<T>(false), clazz(clazz), name(name), sig(sig) {}
 };
 
-class LazyStaticMethod : public Lazy<jmethodID> {
-public:
-    LazyStaticMethod(Lazy<jclass> &clazz, const char *name, const char *sig) : Lazy(
-            [&clazz, name, sig](JNIEnv *env) {
-                jclass c = clazz.get(env);
-                jmethodID methodID = env->GetStaticMethodID(c, name, sig);
-                if (env->ExceptionCheck()) {
-                    env->ExceptionClear();
-                }
-                return methodID;
-            }) {}
-};
+typedef LazyMember<jfieldID, &JNIEnv::GetFieldID> LazyField;
+typedef LazyMember<jfieldID, &JNIEnv::GetStaticFieldID> LazyStaticField;
+typedef LazyMember<jmethodID, &JNIEnv::GetMethodID> LazyMethod;
+typedef LazyMember<jmethodID, &JNIEnv::GetStaticMethodID> LazyStaticMethod;
 
 class ClassRegistry {
 public:
@@ -105,14 +163,13 @@ public:
     static LazyClass bitmapCompressFormatClass;
     static LazyClass bitmapConfigClass;
     static LazyClass bitmapUtilsClass;
-    static LazyClass booleanClass;
     static LazyClass cancellationExceptionClass;
     static LazyClass contentResolverClass;
     static LazyClass contextClass;
-    static LazyClass floatClass;
-    static LazyClass frameDecodeResultClass;
+    static LazyClass frameExtractResultClass;
     static LazyClass infoDecodeResultClass;
-    static LazyClass integerClass;
+    static LazyClass nativeBufferCleanerClass;
+    static LazyClass nativeLoadStatsClass;
     static LazyClass parcelFileDescriptorClass;
     static LazyClass runtimeExceptionClass;
     static LazyClass uriClass;
@@ -121,57 +178,30 @@ public:
     static LazyClass webPAnimEncoderOptionsClass;
     static LazyClass webPConfigClass;
     static LazyClass webPDecoderClass;
+    static LazyClass webPDecoderCriticalNativesClass;
     static LazyClass webPDecoderConfigClass;
     static LazyClass webPEncoderClass;
+    static LazyClass webPEncoderOutputClass;
     static LazyClass webPInfoClass;
-    static LazyClass webPMuxAnimParamsClass;
+    static LazyClass webPMuxEditorClass;
     static LazyClass webPPresetClass;
+    static LazyClass webPSeekReportClass;
+    static LazyClass webPTranscoderClass;
 
-    static LazyField decoderConfigCompressFormatFieldID;
-    static LazyField decoderConfigCompressQualityFieldID;
     static LazyField decoderConfigNamePrefixFieldID;
-    static LazyField decoderConfigRepeatCharacterCountFieldID;
-    static LazyField decoderConfigRepeatCharacterFieldID;
+    static LazyField decoderConfigPackedFieldID;
     static LazyField encoderPointerFieldID;
-    static LazyField webPAnimEncoderOptionsAllowMixedFieldID;
-    static LazyField webPAnimEncoderOptionsAnimParamsFieldID;
-    static LazyField webPAnimEncoderOptionsKMaxFieldID;
-    static LazyField webPAnimEncoderOptionsKMinFieldID;
-    static LazyField webPAnimEncoderOptionsMinimizeSizeFieldID;
-    static LazyField webPAnimEncoderOptionsVerboseFieldID;
     static LazyField webPAnimEncoderPointerFieldID;
-    static LazyField webPConfigAlphaCompressionFieldID;
-    static LazyField webPConfigAlphaFilteringFieldID;
-    static LazyField webPConfigAlphaQualityFieldID;
-    static LazyField webPConfigAutoFilterFieldID;
-    static LazyField webPConfigEmulateJPEGSizeFieldID;
-    static LazyField webPConfigExactFieldID;
-    static LazyField webPConfigFilterSharpnessFieldID;
-    static LazyField webPConfigFilterStrengthFieldID;
-    static LazyField webPConfigFilterTypeFieldID;
-    static LazyField webPConfigLosslessFieldID;
-    static LazyField webPConfigLowMemoryFieldID;
-    static LazyField webPConfigMethodFieldID;
-    static LazyField webPConfigNearLosslessFieldID;
-    static LazyField webPConfigPartitionLimitFieldID;
-    static LazyField webPConfigPartitionsFieldID;
-    static LazyField webPConfigPassFieldID;
-    static LazyField webPConfigPreprocessingFieldID;
-    static LazyField webPConfigQMaxFieldID;
-    static LazyField webPConfigQMinFieldID;
-    static LazyField webPConfigQualityFieldID;
-    static LazyField webPConfigSegmentsFieldID;
-    static LazyField webPConfigShowCompressedFieldID;
-    static LazyField webPConfigSnsStrengthFieldID;
-    static LazyField webPConfigTargetPSNRFieldID;
-    static LazyField webPConfigTargetSizeFieldID;
-    static LazyField webPConfigThreadLevelFieldID;
-    static LazyField webPConfigUseDeltaPaletteFieldID;
-    static LazyField webPConfigUseSharpYUVFieldID;
+    static LazyField webPAnimEncoderOptionsPackedFieldID;
+    static LazyField webPConfigPackedFieldID;
     static LazyField webPDecoderPointerFieldID;
-    static LazyField webPMuxAnimParamsBgColorFieldID;
-    static LazyField webPMuxAnimParamsLoopCountFieldID;
+    static LazyField webPEncoderOutputConfigFieldID;
+    static LazyField webPEncoderOutputDstUriFieldID;
+    static LazyField webPEncoderOutputHeightFieldID;
+    static LazyField webPEncoderOutputPresetFieldID;
+    static LazyField webPEncoderOutputWidthFieldID;
     static LazyField webPPresetOrdinalFieldID;
+    static LazyField webPTranscoderPointerFieldID;
 
     static LazyStaticField bitmapConfigARGB8888FieldID;
     static LazyStaticField compressFormatJPEGFieldID;
@@ -182,27 +212,33 @@ public:
     static LazyStaticField uriEmptyFieldID;
 
     static LazyMethod animEncoderNotifyProgressMethodID;
-    static LazyMethod bitmapCompressFormatOrdinalMethodID;
     static LazyMethod bitmapRecycleMethodID;
-    static LazyMethod booleanValueMethodID;
     static LazyMethod contentResolverOpenFileDescriptorMethodID;
     static LazyMethod contextGetContentResolverMethodID;
     static LazyMethod decoderNotifyFrameDecodedMethodID;
     static LazyMethod decoderNotifyInfoDecodedMethodID;
+    static LazyMethod encoderNotifyDeadlineMissedMethodID;
     static LazyMethod encoderNotifyProgressMethodID;
-    static LazyMethod floatValueMethodID;
-    static LazyMethod frameDecodeResultConstructorID;
+    static LazyMethod frameExtractResultConstructorID;
     static LazyMethod infoDecodeResultConstructorID;
-    static LazyMethod integerValueMethodID;
     static LazyMethod parcelFileDescriptorCloseMethodID;
     static LazyMethod parcelFileDescriptorCloseWithErrorMethodID;
     static LazyMethod parcelFileDescriptorGetFdMethodID;
     static LazyMethod webPInfoConstructorID;
+    static LazyMethod webPSeekReportConstructorID;
 
     static LazyStaticMethod bitmapCreateMethodID;
     static LazyStaticMethod bitmapUtilsSaveInDirectoryMethodID;
+    static LazyStaticMethod nativeBufferCleanerRegisterMethodID;
     static LazyStaticMethod uriExtensionsFindFileMethodID;
     static LazyStaticMethod uriExtensionsReadToBufferMethodID;
 
+    /**
+     * Resolves every entry. Called from JNI_OnLoad, does nothing with WEBPCODEC_LAZY_JNI_REGISTRY.
+     *
+     * @return false if a class could not be found.
+     */
+    static bool load(JNIEnv *env);
+
     static void release(JNIEnv *env);
 };
\ No newline at end of file
@@ -0,0 +1,206 @@
+//
+// Created by udara on 10/19/26.
+//
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <webp/encode.h>
+#include <webp/mux.h>
+
+#include "result_codes.h"
+#include "progress_reporter.h"
+#include "anim_stream_writer.h"
+#include "rate_controller.h"
+#include "memory_tracker.h"
+
+/**
+ * Animation encoder that encodes frames concurrently and muxes them in order.
+ *
+ * Frame rectangles, blending and keyframes are decided by a sequential diff against the previous
+ * frame when the frame is added. Each frame is then encoded as a standalone still image on a worker
+ * pool, and assemble pushes the encoded frames to a WebPMux in timestamp order.
+ *
+ * With a rate controller, lossy frames get their quality from the controller and their pictures are kept
+ * until assemble, which re-encodes them at a lower quality if the animation is over the budget.
+ *
+ * With a base animation, new frames continue it and assemble pushes them after its frames, which are
+ * copied without decoding.
+ *
+ * Frame pictures, encoded frames and the previous canvas are reported to the memory tracker.
+ */
+class ParallelAnimEncoder {
+
+private:
+    typedef struct {
+        int index;
+        long timestamp;
+        int x_offset;
+        int y_offset;
+        int width;
+        int height;
+        bool keyframe;
+        WebPMuxAnimBlend blend;
+        WebPConfig config;
+        size_t predicted_bytes;
+        WebPPicture picture;
+        size_t picture_bytes;
+        WebPMemoryWriter writer;
+        ResultCode result;
+        bool done;
+        ProgressReporter *reporter;
+    } Frame;
+
+    int canvasWidth;
+    int canvasHeight;
+    WebPAnimEncoderOptions options;
+    ProgressReporter *progressReporter;
+    AnimStreamWriter *streamWriter;
+    RateController *rateController;
+    MemoryTracker *memoryTracker;
+    bool retainPictures;
+    const WebPData *baseAnimation = nullptr;
+    size_t flushedCount = 0;
+    size_t reportedCount = 0;
+
+    std::vector<uint32_t> previousCanvas;
+    int framesSinceKeyframe = 0;
+
+    std::vector<std::unique_ptr<Frame>> frames;
+    std::deque<Frame *> pendingFrames;
+    size_t runningCount = 0;
+    size_t maxInFlight;
+    bool stopWorkers = false;
+    std::mutex mutex;
+    std::condition_variable workAvailable;
+    std::condition_variable workFinished;
+    std::vector<std::thread> workers;
+
+    void runWorker();
+
+    void reportFinishedFrames();
+
+    void trackPicture(Frame *frame);
+
+    void freePicture(Frame *frame);
+
+    void clearWriter(Frame *frame);
+
+    bool isKeyframe(int rect_width, int rect_height) const;
+
+    int frameDuration(size_t index, long end_timestamp) const;
+
+    ResultCode flushFrames(bool final, long end_timestamp);
+
+    ResultCode waitForFrames();
+
+    ResultCode muxFrames(long end_timestamp, WebPData *data);
+
+    bool reencodeFrames(size_t excess_bytes);
+
+    static int checkCancelled(int percent, const WebPPicture *picture);
+
+public:
+    /**
+     * @param width The canvas width.
+     * @param height The canvas height.
+     * @param options Animation options. kmin and kmax control keyframe placement.
+     * @param thread_count Number of worker threads, or 0 to use one per core.
+     * @param reporter Receives 100 percent for each encoded frame, in frame order. Delivered from
+     * addFrame, assemble and finish, on the thread the reporter is attached to. Workers only read
+     * its cancel state.
+     * @param stream_writer If not null, frames are written to it in order as soon as they are
+     * encoded and their duration is known, and finish must be used instead of assemble.
+     * @param rate_controller If enabled, picks the quality of lossy frames to stay under its budget.
+     * @param memory_tracker If not null, receives the bytes held by this encoder. Must outlive it.
+     */
+    ParallelAnimEncoder(
+            int width,
+            int height,
+            const WebPAnimEncoderOptions &options,
+            int thread_count,
+            ProgressReporter *reporter,
+            AnimStreamWriter *stream_writer = nullptr,
+            RateController *rate_controller = nullptr,
+            MemoryTracker *memory_tracker = nullptr
+    );
+
+    ~ParallelAnimEncoder();
+
+    /**
+     * Continues an existing animation. Must be called before the first frame is added.
+     * Timestamps of new frames are relative to the end of the base animation, and its last frame
+     * is shown until the first new frame.
+     *
+     * @param base The existing animation of the same canvas size. Must outlive this encoder.
+     * @param last_canvas The ARGB canvas after the last frame of the base animation. The first new
+     * frame is diffed against it, or is a keyframe if it is empty.
+     * @param frames_since_keyframe Number of base frames after its last keyframe.
+     */
+    void setBaseAnimation(
+            const WebPData *base,
+            const std::vector<uint32_t> &last_canvas,
+            int frames_since_keyframe
+    );
+
+    /**
+     * Lowers the memory use of the remaining frames. Waits for the queued frames, frees the pictures
+     * kept for rate control corrections and encodes the following frames one at a time.
+     *
+     * @return false if memory use was already reduced.
+     */
+    bool reduceMemory();
+
+    /**
+     * @return The number of frames queued or being encoded, whose encoded output is not reported yet.
+     */
+    size_t getEncodingCount();
+
+    /**
+     * Waits until no frame is queued or being encoded.
+     */
+    void waitForEncodes();
+
+    /**
+     * Diffs the frame against the previous one and queues the changed rectangle for encoding.
+     * Blocks while too many frames are waiting to be encoded.
+     *
+     * @param picture ARGB picture of the full canvas size.
+     * @param timestamp The timestamp of the frame in milliseconds.
+     * @param config The encoding config of the frame.
+     * @param frame_index The index reported to the progress reporter.
+     *
+     * @return 0 if success, otherwise error code.
+     */
+    ResultCode addFrame(
+            const WebPPicture *picture,
+            long timestamp,
+            const WebPConfig &config,
+            int frame_index
+    );
+
+    /**
+     * Waits for all frames and muxes them into an animation.
+     * Over a rate controller budget, lossy frames are re-encoded at most twice before giving up.
+     *
+     * @param end_timestamp The end timestamp of the last frame in milliseconds.
+     * @param data Receives the assembled animation. Must be released with WebPDataClear.
+     *
+     * @return 0 if success, otherwise error code.
+     */
+    ResultCode assemble(long end_timestamp, WebPData *data);
+
+    /**
+     * Waits for all frames and writes the remaining ones to the stream writer.
+     *
+     * @param end_timestamp The end timestamp of the last frame in milliseconds.
+     *
+     * @return 0 if success, otherwise error code.
+     */
+    ResultCode finish(long end_timestamp);
+};
@@ -0,0 +1,101 @@
+//
+// Created by udara on 10/19/26.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <webp/encode.h>
+
+#include "result_codes.h"
+
+namespace enc {
+    /**
+     * Pixel layouts accepted for raw frames. Mirrors the Kotlin WebPPixelFormat enum.
+     */
+    enum PixelFormat {
+        PIXEL_FORMAT_RGBA_8888 = 0,
+        PIXEL_FORMAT_NV21,
+        PIXEL_FORMAT_I420
+    };
+
+    /**
+     * Frame pixels in one of the supported layouts.
+     * NV21 stores the Y plane followed by interleaved V and U samples. I420 stores the Y, U and V
+     * planes one after another. Chroma planes are subsampled by two in both directions.
+     */
+    typedef struct {
+        const uint8_t *data;
+        int width;
+        int height;
+        PixelFormat format;
+        int row_stride;
+        int uv_row_stride;
+    } RawFrame;
+
+    /**
+     * Replaces zero strides with the strides of a tightly packed frame.
+     *
+     * @param frame The frame to update.
+     */
+    void resolveStrides(RawFrame *frame);
+
+    /**
+     * @return the number of bytes the frame spans, including row padding.
+     */
+    size_t rawFrameByteCount(const RawFrame &frame);
+
+    /**
+     * Copies the frame into tightly packed memory of size rawFrameByteCount of the packed frame.
+     *
+     * @param frame The frame to copy.
+     * @param dst Destination memory.
+     *
+     * @return the packed frame pointing at dst.
+     */
+    RawFrame packRawFrame(const RawFrame &frame, uint8_t *dst);
+
+    /**
+     * Imports a raw frame into a picture of the output size. YUV frames are written to the Y, U and V
+     * planes of the picture without conversion to ARGB.
+     *
+     * @param frame The frame to import.
+     * @param output_width The width of the output picture.
+     * @param output_height The height of the output picture.
+     * @param pic Initialized picture to import into. Must be released with WebPPictureFree.
+     *
+     * @return 0 if success, otherwise error code.
+     */
+    ResultCode importRawFrame(
+            const RawFrame &frame,
+            int output_width,
+            int output_height,
+            WebPPicture *pic
+    );
+
+    /**
+     * Imports RGBA_8888 pixels into a picture of the output size. Integer downscales are filtered
+     * while importing so that the full resolution picture is never allocated, other sizes are
+     * imported at full resolution and rescaled.
+     *
+     * @param pixels Pointer to the input pixel data from Android bitmap.
+     * @param image_width The width of the input image.
+     * @param image_height The height of the input image.
+     * @param stride The number of bytes between two rows of the input image.
+     * @param output_width The width of the output picture.
+     * @param output_height The height of the output picture.
+     * @param pic Initialized picture to import into. Must be released with WebPPictureFree.
+     *
+     * @return 0 if success, otherwise error code.
+     */
+    ResultCode importPicture(
+            const uint8_t *pixels,
+            int image_width,
+            int image_height,
+            int stride,
+            int output_width,
+            int output_height,
+            WebPPicture *pic
+    );
+}
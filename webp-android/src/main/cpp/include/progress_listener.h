@@ -0,0 +1,28 @@
+//
+// Created by udara on 10/19/26.
+//
+
+#pragma once
+
+#include <jni.h>
+
+#include "progress_reporter.h"
+
+namespace prog {
+    /**
+     * Creates a progress listener that forwards to a Java observer.
+     *
+     * @param env Pointer to the JNI environment of the thread running the encode.
+     * @param observer Java object that receives the progress callbacks.
+     * @param notify_method_id Observer method called with (percent) or (frame index, percent).
+     * @param frame_progress If true, the frame index is passed to the observer method.
+     *
+     * @return The listener to attach to a ProgressReporter.
+     */
+    ProgressReporter::Listener javaListener(
+            JNIEnv *env,
+            jobject observer,
+            jmethodID notify_method_id,
+            bool frame_progress
+    );
+}
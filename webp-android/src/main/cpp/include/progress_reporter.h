@@ -0,0 +1,85 @@
+//
+// Created by udara on 10/19/26.
+//
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <thread>
+
+/**
+ * Coalesces libwebp progress ticks and delivers them to a listener, the Java observer on device.
+ *
+ * libwebp may invoke the progress hook from its worker threads. Those ticks only update an atomic
+ * value. The value is delivered from the thread that started the encode (which is already
+ * attached to the JVM), at most once per configured interval or percent step. Only that thread
+ * touches the listener, the others see the atomic attached flag and owner thread id.
+ */
+class ProgressReporter {
+
+public:
+    /**
+     * Receives (frame index, percent) on the attaching thread. Returns false to abort the encode.
+     */
+    typedef std::function<bool(int, int)> Listener;
+
+private:
+    std::atomic<uint64_t> progress_{0};
+    std::atomic<bool> cancel_flag_{false};
+    std::atomic<bool> abort_flag_{false};
+
+    long interval_millis_ = 0;
+    int percent_step_ = 1;
+
+    std::atomic<bool> attached_{false};
+    std::atomic<std::thread::id> owner_thread_id_;
+    Listener listener_;
+    uint64_t last_progress_ = 0;
+    bool has_delivered_ = false;
+    std::chrono::steady_clock::time_point last_delivery_time_;
+
+    void deliver(uint64_t progress);
+
+public:
+    /**
+     * Sets how often progress is delivered to the listener.
+     *
+     * @param interval_millis Minimum time between two deliveries in milliseconds.
+     * @param percent_step Minimum change in percent between two deliveries.
+     */
+    void setInterval(long interval_millis, int percent_step);
+
+    /**
+     * Starts reporting to the given listener. Must be called from the thread running the encode.
+     *
+     * @param listener Receives the progress callbacks.
+     */
+    void attach(Listener listener);
+
+    /**
+     * Delivers the last pending progress value and stops reporting.
+     */
+    void detach();
+
+    /**
+     * Records a progress tick. Safe to call from any thread.
+     *
+     * @param frame_index Index of the frame being encoded.
+     * @param percent Progress of the frame in percent.
+     *
+     * @return 1 to continue encoding, 0 to abort.
+     */
+    int update(int frame_index, int percent);
+
+    /**
+     * Requests the ongoing and all following encodes to abort.
+     */
+    void cancel();
+
+    /**
+     * @return true if cancelled by the user or aborted by the observer.
+     */
+    bool isCancelled() const;
+};
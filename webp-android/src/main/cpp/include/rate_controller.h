@@ -0,0 +1,67 @@
+//
+// Created by udara on 10/19/26.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <mutex>
+
+/**
+ * Picks a lossy quality per frame so that an animation lands under a total byte budget in one pass.
+ *
+ * Frame size is modelled as bytes_per_pixel = exp(offset + SLOPE * quality). The slope is fixed and the
+ * offset follows the measured frames, so the model adapts to the content as frames are encoded.
+ * The bytes left in the budget are shared between the remaining frames in proportion to their area,
+ * which gives keyframes more room than small sub-frames. Frames still being encoded count with their
+ * predicted size until their real size is known.
+ */
+class RateController {
+
+private:
+    std::mutex mutex;
+    size_t budgetBytes = 0;
+    int expectedFrames = 0;
+    int startedFrames = 0;
+    long startedPixels = 0;
+    size_t spentBytes = 0;
+    size_t pendingBytes = 0;
+    double offset;
+
+public:
+    RateController();
+
+    /**
+     * @param budget_bytes Total size of the assembled animation, or 0 to disable rate control.
+     * @param expected_frames Expected number of frames. Frames past this count share what is left.
+     */
+    void setBudget(size_t budget_bytes, int expected_frames);
+
+    bool isEnabled();
+
+    size_t getBudget();
+
+    /**
+     * Reserves the budget of a frame about to be encoded.
+     *
+     * @param pixel_count Number of pixels of the frame rectangle.
+     * @param max_quality The configured quality, used as the upper bound.
+     * @param predicted_bytes Receives the reserved size, to be passed to finishFrame.
+     *
+     * @return The quality to encode the frame with.
+     */
+    float startFrame(long pixel_count, float max_quality, size_t *predicted_bytes);
+
+    /**
+     * Replaces the reservation of a frame with its encoded size and updates the model.
+     */
+    void finishFrame(float quality, long pixel_count, size_t predicted_bytes, size_t encoded_bytes);
+
+    /**
+     * @param quality The quality a frame was encoded with.
+     * @param scale The wanted ratio of the new size to the current size.
+     *
+     * @return The quality expected to scale the frame size by the given ratio.
+     */
+    static float scaleQuality(float quality, double scale);
+};
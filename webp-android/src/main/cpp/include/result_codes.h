@@ -5,7 +5,6 @@
 #pragma once
 
 #include <string>
-#include <jni.h>
 #include <webp/encode.h>
 #include <webp/decode.h>
 
@@ -51,14 +50,18 @@ enum ResultCode {
     ERROR_ANIM_INFO_GET_FAILED,
     ERROR_SET_DATA_SOURCE_FAILED,
     ERROR_DATA_SOURCE_NOT_SET,
-    ERROR_NO_MORE_FRAMES
+    ERROR_NO_MORE_FRAMES,
+    ERROR_INVALID_FRAME_BUFFER,
+    ERROR_SIZE_BUDGET_EXCEEDED,
+    ERROR_NOT_AN_ANIMATION,
+    ERROR_INVALID_FRAME_RANGE,
+    ERROR_MEMORY_LIMIT_EXCEEDED,
+    ERROR_STREAM_FINISHED
 };
 
 namespace res {
     std::string parseMessage(ResultCode result_code);
 
-    void handleResult(JNIEnv *env, ResultCode result);
-
     ResultCode encodingErrorToResultCode(WebPEncodingError error_code);
 
     ResultCode vp8StatusCodeToResultCode(VP8StatusCode status_code);
@@ -0,0 +1,69 @@
+//
+// Created by udara on 10/19/26.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <webp/encode.h>
+
+namespace speed {
+
+    constexpr int METHOD_COUNT = 7;
+    constexpr int MODEL_SIZE = 2 * METHOD_COUNT;
+
+    typedef struct {
+        int method;
+        float quality;
+        double predicted_millis;
+    } DeadlinePlan;
+
+    /**
+     * Encodes a synthetic picture with every lossy and lossless method and stores the measured
+     * throughput as the process wide speed model.
+     */
+    void calibrate();
+
+    /**
+     * @return true if the speed model was calibrated or loaded.
+     */
+    bool isCalibrated();
+
+    /**
+     * Copies the speed model to the given array.
+     *
+     * @param model Array of MODEL_SIZE values. Nanoseconds per pixel for lossy methods 0..6
+     * followed by lossless methods 0..6.
+     */
+    void getModel(float *model);
+
+    /**
+     * Replaces the speed model with a previously calibrated one.
+     *
+     * @param model Array of MODEL_SIZE values in the layout returned by getModel.
+     */
+    void setModel(const float *model);
+
+    /**
+     * Picks the highest method, and for lossless the highest quality, that is expected to encode
+     * the given number of pixels within the deadline. The method in the config is the upper bound.
+     *
+     * @param config The configured encoder options.
+     * @param pixel_count Number of pixels to encode.
+     * @param deadline_millis Time budget in milliseconds.
+     *
+     * @return the chosen method and quality.
+     */
+    DeadlinePlan planForDeadline(const WebPConfig &config, size_t pixel_count, long deadline_millis);
+
+    /**
+     * Refines the speed model with the time measured for a real encode.
+     *
+     * @param lossless True if the encode was lossless.
+     * @param method The method used.
+     * @param pixel_count Number of pixels encoded.
+     * @param elapsed_millis Measured encoding time.
+     */
+    void observe(bool lossless, int method, size_t pixel_count, double elapsed_millis);
+
+}
@@ -4,50 +4,62 @@
 
 #pragma once
 
+#include <cstdint>
 #include <jni.h>
 
 namespace type {
     /**
-     * @brief Retrieves the integer value from a Java object.
-     *
-     * This function extracts the integer value from a Java object of type Integer and returns it as an int.
-     *
-     * @param env A pointer to the JNI environment.
-     * @param object The Java object from which to retrieve the integer value.
-     *
-     * @return The integer value extracted from the Java object.
-     *
-     * @throws std::runtime_error if the given object is not of type Integer.
+     * Largest number of values a config class packs.
      */
-    int getIntegerValue(JNIEnv *env, jobject object);
+    constexpr int MAX_PACKED_VALUES = 31;
 
     /**
-     * @brief Retrieves the boolean value from a Java object.
+     * The fields of a Kotlin config class as packed by ConfigPacker.
      *
-     * This function extracts the boolean value from a Java object of type Boolean and returns it as a bool.
-     *
-     * @param env A pointer to the JNI environment.
-     * @param object The Java object from which to retrieve the boolean value.
-     *
-     * @return The boolean value extracted from the Java object.
-     *
-     * @throws std::runtime_error if the given object is not of type Boolean.
+     * Bit i of the mask is set if value i is present. Floats are stored as their raw bits
+     * and booleans as 0 or 1.
      */
-    bool getBooleanValue(JNIEnv *env, jobject object);
+    typedef struct {
+        uint32_t mask;
+        jint values[MAX_PACKED_VALUES];
+    } PackedValues;
 
     /**
-     * @brief Retrieves the float value from a Java object.
+     * @brief Reads the packed fields of a Kotlin config object.
      *
-     * This function extracts the float value from a Java object of type Float and returns it as a float.
+     * The packed array is copied out with a single GetPrimitiveArrayCritical, so a config costs one
+     * field read and one array access however many fields it has.
      *
      * @param env A pointer to the JNI environment.
-     * @param object The Java object from which to retrieve the float value.
-     *
-     * @return The float value extracted from the Java object.
+     * @param object The config object.
+     * @param field_id The ID of its packed int array field.
+     * @param value_count The number of values the class packs.
+     * @param packed Receives the values.
      *
-     * @throws std::runtime_error if the given object is not of type Float.
+     * @throws std::runtime_error if the array does not hold value_count values.
+     */
+    void readPackedValues(
+            JNIEnv *env,
+            jobject object,
+            jfieldID field_id,
+            int value_count,
+            PackedValues *packed
+    );
+
+    /**
+     * @return true if the packed value at the given index is present.
+     */
+    bool hasPackedValue(const PackedValues &packed, int index);
+
+    /**
+     * @brief Stores the packed value at the given index in value if it is present.
+     */
+    void unpackInt(const PackedValues &packed, int index, int *value);
+
+    /**
+     * @brief Stores the packed value at the given index in value if it is present.
      */
-    float getFloatValue(JNIEnv *env, jobject object);
+    void unpackFloat(const PackedValues &packed, int index, float *value);
 
     /**
      * @brief Checks if a Java object is null.
@@ -9,80 +9,44 @@
 #include <webp/mux.h>
 
 #include "result_codes.h"
+#include "encoder_helper.h"
+#include "frame_queue.h"
+#include "webp_anim_encoder_core.h"
+
+class WebPAnimationEncoder : public WebPAnimationEncoderCore {
 
-class WebPAnimationEncoder {
 private:
-    inline static JavaVM *jvm = nullptr;
-    inline static jweak progressObserver = nullptr;
-    inline static bool cancelFlag = false;
+    FrameQueue frameQueue;
+    jobject streamParcelFd = nullptr;
+    bool streamFinished = false;
+    jobject asyncObserver = nullptr;
 
-    int imageWidth;
-    int imageHeight;
-    int frameCount;
-    WebPAnimEncoderOptions encoderOptions{};
-    WebPAnimEncoder *webPAnimEncoder;
-    WebPConfig webPConfig{};
+    void stopFrameQueue(JNIEnv *env);
 
-public:
-    /**
-     * Constructs a new instance of the WebPAnimationEncoder class with the specified width, height, and options.
-     *
-     * @param jvm The Java virtual machine pointer.
-     * @param width The width of the animation frames in pixels.
-     * @param height The height of the animation frames in pixels.
-     * @param options The options for configuring the WebP animation encoder.
-     */
-    WebPAnimationEncoder(int width, int height, WebPAnimEncoderOptions options);
-
-    /**
-     * Configures the WebP encoder with the specified configuration.
-     *
-     * @param config The WebPConfig object containing the configuration settings.
-     */
-    void configure(WebPConfig config);
-
-    /**
-     * Adds a frame to the animation sequence with the specified pixel data, bitmap dimensions, and timestamp.
-     *
-     * @param pixels Pointer to the pixel data of the frame.
-     * @param image_width The width of the bitmap in pixels.
-     * @param image_height The height of the bitmap in pixels.
-     * @param output_width The width of the output frame in pixels.
-     * @param output_height The height of the output frame in pixels.
-     * @param timestamp The timestamp of the frame in milliseconds.
-     *
-     * @return 0 if success or error code if failed.
-     */
-    ResultCode addFrame(
-            uint8_t *pixels,
-            int image_width,
-            int image_height,
-            int output_width,
-            int output_height,
+    void closeStream(JNIEnv *env, ResultCode result);
+
+    static ResultCode addRawFrame(
+            JNIEnv *env,
+            jobject thiz,
+            WebPAnimationEncoder *encoder,
+            const enc::RawFrame &frame,
             long timestamp
     );
 
-    /**
-     * Assembles the animation with the provided timestamp and saves it to the specified output path.
-     *
-     * @param timestamp The timestamp to assign to the assembled animation in milliseconds.
-     * @param webp_data Pointer to the output buffer for the WebP data.
-     * @param webp_size Pointer to store the size of the WebP data.
-     */
-    ResultCode assemble(long timestamp, WebPData *data);
-
-    /**
-     * Release resources associated with this encoder.
-     */
-    void release();
-
-    static WebPAnimationEncoder *getInstance(JNIEnv *env, jobject jencoder);
+    static ResultCode addSampledFrame(
+            JNIEnv *env,
+            jobject thiz,
+            WebPAnimationEncoder *encoder,
+            const enc::RawFrame &frame,
+            long timestamp
+    );
 
-    static void setProgressNotifier(JNIEnv *env, jobject jencoder);
+    static ResultCode finishFrames(JNIEnv *env, jobject thiz, WebPAnimationEncoder *encoder);
 
-    static int notifyProgressChanged(int percent, const WebPPicture *picture);
+public:
+    using WebPAnimationEncoderCore::WebPAnimationEncoderCore;
 
-    static void clearProgressNotifier(JNIEnv *env);
+    static WebPAnimationEncoder *getInstance(JNIEnv *env, jobject jencoder);
 
     static jlong nativeCreate(
             JNIEnv *env,
@@ -96,6 +60,18 @@ public:
 
     static void nativeAddFrame(JNIEnv *env, jobject thiz, jlong jtimestamp, jobject jsrc_bitmap);
 
+    static void nativeAddFrameBuffer(
+            JNIEnv *env,
+            jobject thiz,
+            jlong jtimestamp,
+            jobject jbuffer,
+            jint jwidth,
+            jint jheight,
+            jint jformat,
+            jint jrow_stride,
+            jint juv_row_stride
+    );
+
     static void nativeAssemble(
             JNIEnv *env,
             jobject thiz,
@@ -104,6 +80,69 @@ public:
             jobject jdst_uri
     );
 
+    static jobject nativeAssembleToBuffer(JNIEnv *env, jobject thiz, jlong jtimestamp);
+
+    static void nativeSetParallelEncoding(JNIEnv *env, jobject thiz, jint jthread_count);
+
+    static void nativeSetSizeBudget(
+            JNIEnv *env,
+            jobject thiz,
+            jlong jbudget_bytes,
+            jint jexpected_frames
+    );
+
+    static jobject nativeGetSeekReport(JNIEnv *env, jobject thiz);
+
+    static void nativeSetMemoryLimit(
+            JNIEnv *env,
+            jobject thiz,
+            jlong jlimit_bytes,
+            jint jpolicy
+    );
+
+    static jlong nativeGetMemoryUsage(JNIEnv *env, jobject thiz);
+
+    static jlong nativeGetPeakMemoryUsage(JNIEnv *env, jobject thiz);
+
+    static void nativeSetAppendSource(
+            JNIEnv *env,
+            jobject thiz,
+            jobject jcontext,
+            jobject jsrc_uri,
+            jboolean jreuse_last_canvas
+    );
+
+    static void nativeSetStreamingOutput(
+            JNIEnv *env,
+            jobject thiz,
+            jobject jcontext,
+            jobject jdst_uri
+    );
+
+    static void nativeFinishStreaming(JNIEnv *env, jobject thiz, jlong jtimestamp);
+
+    static void nativeSetDuplicateTolerance(JNIEnv *env, jobject thiz, jint jtolerance);
+
+    static void nativeSetFrameResampling(
+            JNIEnv *env,
+            jobject thiz,
+            jfloat jframe_duration,
+            jboolean jmeasure_difference
+    );
+
+    static jint nativeGetDecimatedFrameCount(JNIEnv *env, jobject thiz);
+
+    static jint nativeGetDroppedFrameCount(JNIEnv *env, jobject thiz);
+
+    static void nativeSetAsyncQueue(JNIEnv *env, jobject thiz, jint jcapacity);
+
+    static void nativeSetProgressInterval(
+            JNIEnv *env,
+            jobject thiz,
+            jlong jinterval_millis,
+            jint jpercent_step
+    );
+
     static void nativeCancel(JNIEnv *env, jobject thiz);
 
     static void nativeRelease(JNIEnv *env, jobject thiz);
@@ -0,0 +1,158 @@
+//
+// Created by udara on 10/19/26.
+//
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <webp/encode.h>
+#include <webp/mux.h>
+
+#include "result_codes.h"
+#include "picture_import.h"
+#include "progress_reporter.h"
+#include "parallel_anim_encoder.h"
+#include "anim_stream_writer.h"
+#include "frame_deduplicator.h"
+#include "frame_decimator.h"
+#include "rate_controller.h"
+#include "keyframe_table.h"
+#include "memory_tracker.h"
+
+/**
+ * Animation encoding without JNI. WebPAnimationEncoder adds the Java bindings on top of it.
+ */
+class WebPAnimationEncoderCore {
+
+protected:
+    int imageWidth;
+    int imageHeight;
+    int frameCount;
+    // Frames given to the encoder, counted on the calling thread before they are queued
+    std::atomic<int> submittedFrameCount{0};
+    WebPAnimEncoderOptions encoderOptions{};
+    WebPAnimEncoder *webPAnimEncoder;
+    // Charged to the memory tracker when webPAnimEncoder was created
+    size_t sequentialCanvasBytes = 0;
+    WebPConfig webPConfig{};
+    MemoryTracker memoryTracker;
+    MemoryPolicy memoryPolicy = MEMORY_POLICY_FAIL;
+    ProgressReporter progressReporter;
+    FrameDeduplicator frameDeduplicator;
+    FrameDecimator frameDecimator;
+    RateController rateController;
+    KeyFrameTable keyFrameTable;
+    bool hasKeyFrameTable = false;
+    WebPData appendBase{};
+    std::vector<uint32_t> appendCanvas;
+    int appendFramesSinceKeyframe = 0;
+    int parallelThreadCount = -1;
+    std::unique_ptr<ParallelAnimEncoder> parallelEncoder;
+    std::unique_ptr<AnimStreamWriter> streamWriter;
+
+    /**
+     * @param bytes The bytes the frame needs, including its encoded output.
+     * @param output_bytes The largest encoded output of a frame.
+     */
+    ResultCode reserveMemory(size_t bytes, size_t output_bytes);
+
+public:
+    /**
+     * Constructs an animation encoder with the specified width, height, and options.
+     *
+     * @param width The width of the animation frames in pixels.
+     * @param height The height of the animation frames in pixels.
+     * @param options The options for configuring the WebP animation encoder.
+     */
+    WebPAnimationEncoderCore(int width, int height, WebPAnimEncoderOptions options);
+
+    /**
+     * Configures the WebP encoder with the specified configuration.
+     *
+     * @param config The WebPConfig object containing the configuration settings.
+     */
+    void configure(WebPConfig config);
+
+    /**
+     * Selects the encoding engine. Must be called before the first frame is added.
+     *
+     * @param thread_count Number of threads of the parallel engine, 0 to use one per core,
+     * or a negative value to use libwebp's sequential WebPAnimEncoder.
+     *
+     * @return true if the engine was changed.
+     */
+    bool setParallelEncoding(int thread_count);
+
+    /**
+     * Enables rate control of lossy frames. Must be called before the first frame is added.
+     * Selects the parallel engine with one thread per core if the sequential engine is selected,
+     * since per-frame sizes are only known on the parallel engine.
+     *
+     * @param budget_bytes Maximum size of the assembled animation, or 0 to disable rate control.
+     * @param expected_frames Expected number of frames.
+     *
+     * @return true if the budget was set.
+     */
+    bool setSizeBudget(size_t budget_bytes, int expected_frames);
+
+    /**
+     * Limits the bytes this encoder keeps resident. Must be called before the first frame is added.
+     * Selects the parallel engine with one thread per core if the sequential engine is selected,
+     * since the frames held by libwebp's WebPAnimEncoder cannot be measured.
+     *
+     * @param limit_bytes Maximum resident bytes, or 0 to remove the limit.
+     * @param policy What to do when a frame would exceed the limit.
+     *
+     * @return true if the limit was set.
+     */
+    bool setMemoryLimit(size_t limit_bytes, MemoryPolicy policy);
+
+    /**
+     * Continues an existing animated WebP image instead of starting a new one. Must be called before
+     * the first frame is added. Selects the parallel engine and the canvas size of the existing image.
+     * Its frames are copied into the assembled animation without decoding or re-encoding them.
+     *
+     * @param data The existing animation.
+     * @param reuse_last_canvas If true, the existing frames are decoded once to rebuild the last canvas
+     * and the first new frame is diffed against it. Otherwise the first new frame is a keyframe.
+     *
+     * @return 0 if success or error code if failed.
+     */
+    ResultCode setAppendSource(const WebPData &data, bool reuse_last_canvas);
+
+    /**
+     * Adds a frame to the animation sequence with the specified pixel data and timestamp.
+     *
+     * @param frame The pixels of the frame. Strides must be resolved.
+     * @param output_width The width of the output frame in pixels.
+     * @param output_height The height of the output frame in pixels.
+     * @param timestamp The timestamp of the frame in milliseconds.
+     *
+     * @return 0 if success or error code if failed.
+     */
+    ResultCode addFrame(
+            const enc::RawFrame &frame,
+            int output_width,
+            int output_height,
+            long timestamp
+    );
+
+    /**
+     * Assembles the animation with the provided timestamp and saves it to the specified output path.
+     * The keyframes of the assembled animation are kept for the seek report.
+     *
+     * @param timestamp The timestamp to assign to the assembled animation in milliseconds.
+     * @param webp_data Pointer to the output buffer for the WebP data.
+     * @param webp_size Pointer to store the size of the WebP data.
+     */
+    ResultCode assemble(long timestamp, WebPData *data);
+
+    /**
+     * Release resources associated with this encoder.
+     */
+    void release();
+
+    static int notifyProgressChanged(int percent, const WebPPicture *picture);
+};
@@ -7,10 +7,24 @@
 #include <string>
 #include <jni.h>
 #include <webp/demux.h>
+#include <webp/encode.h>
 
 #include "result_codes.h"
+#include "webp_decoder_core.h"
 
 namespace dec {
+    /**
+     * Indices of the fields packed by the Kotlin DecoderConfig class, in packing order.
+     * The name prefix is a string and is read separately.
+     */
+    enum DecoderConfigValue {
+        DECODER_CONFIG_REPEAT_CHARACTER = 0,
+        DECODER_CONFIG_REPEAT_CHARACTER_COUNT,
+        DECODER_CONFIG_COMPRESS_FORMAT,
+        DECODER_CONFIG_COMPRESS_QUALITY,
+        DECODER_CONFIG_VALUE_COUNT
+    };
+
     typedef struct DecoderConfig {
         std::string name_prefix = "IMG_";
         char repeat_character = '0';
@@ -41,11 +55,23 @@ namespace dec {
 
     jobject nativeDecodeInfo(JNIEnv *env, jobject jdecoder);
 
-    jboolean nativeHasNextFrame(JNIEnv *env, jobject jdecoder);
+    /**
+     * Packs a frame decode result into a jlong so that no result object is allocated per frame.
+     * Bits 0-31 hold the timestamp, bits 32-55 the frame index plus one and bits 56-63 the result code.
+     */
+    jlong packFrameDecodeResult(const FrameDecodeResult &result);
+
+    jboolean criticalHasNextFrame(jlong jpointer);
+
+    jint criticalNextFrameIndex(jlong jpointer);
+
+    jboolean nativeHasNextFrame(JNIEnv *env, jclass clazz, jlong jpointer);
+
+    jint nativeNextFrameIndex(JNIEnv *env, jclass clazz, jlong jpointer);
 
-    jint nativeNextFrameIndex(JNIEnv *env, jobject jdecoder);
+    jlong nativeDecodeNextFrame(JNIEnv *env, jobject jdecoder);
 
-    jobject nativeDecodeNextFrame(JNIEnv *env, jobject jdecoder);
+    jobject nativeGetFrameBitmap(JNIEnv *env, jobject jdecoder);
 
     jint nativeDecodeFrames(
             JNIEnv *env,
@@ -54,6 +80,27 @@ namespace dec {
             jobject jdst_uri
     );
 
+    /**
+     * @return The number of decoded frames in bits 0-31 and the result code in bits 32-63.
+     */
+    jlong nativeDecodeFrameBatch(
+            JNIEnv *env,
+            jobject jdecoder,
+            jint jcount,
+            jobject jdst_buffer,
+            jintArray jtimestamps
+    );
+
+    jobject nativeExtractFrame(
+            JNIEnv *env,
+            jobject jdecoder,
+            jobject jcontext,
+            jint jindex,
+            jobject jdst_uri,
+            jobject jconfig,
+            jobject jpreset
+    );
+
     void nativeReset(JNIEnv *env, jobject jdecoder);
 
     void nativeCancel(JNIEnv *env, jobject jdecoder);
@@ -61,31 +108,34 @@ namespace dec {
     void nativeRelease(JNIEnv *env, jobject jdecoder);
 }
 
-class WebPDecoder {
+class WebPDecoder : public WebPDecoderCore {
 
 private:
     dec::DecoderConfig decoder_config_{};
-    bool cancel_flag_ = false;
     jobject data_buffer_ = nullptr;
     jobject bitmap_frame_ = nullptr;
-    WebPAnimDecoder *decoder_ = nullptr;
-    WebPBitstreamFeatures webp_features_ = {0};
-    WebPAnimInfo anim_info_ = {0};
-    int current_frame_index_ = 0;
 
 public:
     static WebPDecoder *getInstance(JNIEnv *env, jobject jdecoder);
 
     void configure(dec::DecoderConfig *config);
 
+    /**
+     * Sets a direct buffer as the data source. A global reference keeps the buffer alive while decoding.
+     */
     ResultCode setDataBuffer(JNIEnv *env, jobject jbuffer);
 
     dec::InfoDecodeResult decodeWebPInfo(JNIEnv *env);
 
-    int nextFrameIndex();
-
-    bool hasNextFrame();
+    /**
+     * @return A local reference to the bitmap every frame is decoded into, or null if no data source is set.
+     * The bitmap is replaced when the data source changes.
+     */
+    jobject getFrameBitmap(JNIEnv *env);
 
+    /**
+     * Decodes the next frame into the frame bitmap.
+     */
     dec::FrameDecodeResult decodeNextFrame(JNIEnv *env);
 
     ResultCode decodeFrames(
@@ -95,9 +145,5 @@ public:
             jobject jdst_uri
     );
 
-    void reset();
-
     void fullReset(JNIEnv *env);
-
-    void cancel();
-};
\ No newline at end of file
+};
@@ -0,0 +1,108 @@
+//
+// Created by udara on 10/19/26.
+//
+
+#pragma once
+
+#include <vector>
+#include <webp/demux.h>
+#include <webp/encode.h>
+
+#include "result_codes.h"
+
+/**
+ * WebP decoding without JNI. WebPDecoder adds the Java bindings and the frame bitmap on top of it.
+ * Frames are decoded as non-premultiplied RGBA rows of canvas width * 4 bytes.
+ */
+class WebPDecoderCore {
+
+protected:
+    bool cancel_flag_ = false;
+    const uint8_t *data_ = nullptr;
+    size_t data_size_ = 0;
+    WebPAnimDecoder *decoder_ = nullptr;
+    WebPBitstreamFeatures webp_features_ = {0};
+    WebPAnimInfo anim_info_ = {0};
+    std::vector<uint8_t> still_frame_;
+    int current_frame_index_ = 0;
+
+public:
+    ~WebPDecoderCore();
+
+    /**
+     * Reads the features of the image and prepares the decoder. The data is not copied and must stay
+     * valid until it is replaced or cleared.
+     *
+     * @param data The WebP file contents.
+     * @param size Size of the data in bytes.
+     *
+     * @return 0 if success or error code if failed.
+     */
+    ResultCode setData(const uint8_t *data, size_t size);
+
+    /**
+     * Releases the decoder and forgets the data.
+     */
+    void clearData();
+
+    const WebPBitstreamFeatures &getFeatures() const;
+
+    const WebPAnimInfo &getAnimInfo() const;
+
+    int nextFrameIndex();
+
+    bool hasNextFrame();
+
+    /**
+     * Decodes the next frame.
+     *
+     * @param pixels Receives the canvas holding the frame, valid until the next decode or reset.
+     * @param timestamp Receives the end timestamp of the frame, 0 for still images.
+     *
+     * @return 0 if success or error code if failed.
+     */
+    ResultCode decodeNextFrame(const uint8_t **pixels, int *timestamp);
+
+    /**
+     * Decodes consecutive frames straight into a frame stack.
+     * Frame i is stored at dst + i * frame_size, where frame_size is canvas width * canvas height * 4.
+     *
+     * @param count Maximum number of frames to decode. Fewer are decoded at the end of the content.
+     * @param dst The frame stack.
+     * @param dst_size Size of the frame stack in bytes. Must hold count frames.
+     * @param timestamps Receives the end timestamps of the decoded frames.
+     * @param decoded Receives the number of decoded frames, 0 if there are no more frames.
+     *
+     * @return 0 if success or error code if failed.
+     */
+    ResultCode decodeFrameBatch(
+            int count,
+            uint8_t *dst,
+            size_t dst_size,
+            int *timestamps,
+            int *decoded
+    );
+
+    /**
+     * Writes a frame as a still WebP image, with the ICC profile of the source. A frame that covers the
+     * whole canvas and replaces it, or is the first frame, is copied without decoding. Other frames are
+     * composed on the canvas with a separate decoder and encoded, so the state of this decoder does not change.
+     *
+     * @param index Zero based index of the frame.
+     * @param config The encoding configuration used if the frame cannot be copied.
+     * @param output Receives the still image. Free with WebPDataClear.
+     * @param copied Set to true if the frame bitstream was copied.
+     *
+     * @return 0 if success or error code if failed.
+     */
+    ResultCode extractFrame(
+            int index,
+            const WebPConfig &config,
+            WebPData *output,
+            bool *copied
+    );
+
+    void reset();
+
+    void cancel();
+};
@@ -8,70 +8,24 @@
 #include <webp/encode.h>
 
 #include "result_codes.h"
+#include "webp_encoder_core.h"
 
-class WebPEncoder {
+class WebPEncoder : public WebPEncoderCore {
 
 private:
-    inline static JavaVM *jvm = nullptr;
-    inline static jweak progressObserver = nullptr;
-    inline static bool cancelFlag = false;
-
-    int imageWidth;
-    int imageHeight;
-    WebPConfig webPConfig{};
-
-public:
-    /**
-     * Constructs a WebPEncoder object with the specified width and height.
-     *
-     * @param width The width of the output image.
-     * @param height The height of the output image.
-     */
-    WebPEncoder(int width, int height);
-
-    /**
-     * Configures the WebP encoding parameters.
-     *
-     * @param config The WebP configuration.
-     */
-    void configure(WebPConfig config);
-
-    /**
-     * Encodes the image into WebP format.
-     *
-     * @param pixels Pointer to the input pixel data from Android bitmap.
-     * @param image_width The width of the input image.
-     * @param image_height The height of the input image.
-     * @param output_width The width the output image.
-     * @param output_height The height of the output image.
-     * @param webp_data Pointer to the output buffer for the WebP data.
-     * @param webp_size Pointer to store the size of the WebP data.
-     *
-     * @return 0 if success, otherwise error code.
-     */
-    ResultCode encode(
-            const uint8_t *pixels,
-            int image_width,
-            int image_height,
-            int output_width,
-            int output_height,
+    static ResultCode encodeBitmap(
+            JNIEnv *env,
+            jobject thiz,
+            jobject jsrc_bitmap,
             const uint8_t **webp_data,
             size_t *webp_size
     );
 
-    /**
-    * Releases any resources held by the WebPEncoder object.
-    */
-    void release();
+public:
+    using WebPEncoderCore::WebPEncoderCore;
 
     static WebPEncoder *getInstance(JNIEnv *env, jobject jencoder);
 
-    static void setProgressNotifier(JNIEnv *env, jobject jencoder);
-
-    static int notifyProgressChanged(int percent, const WebPPicture *);
-
-    static void clearProgressNotifier(JNIEnv *env);
-
     static jlong nativeCreate(
             JNIEnv *env,
             jobject thiz,
@@ -94,9 +48,47 @@ public:
             jobject jdst_uri
     );
 
+    static jobject nativeEncodeToBuffer(
+            JNIEnv *env,
+            jobject thiz,
+            jobject jsrc_bitmap
+    );
+
+    static void nativeEncodeMultiple(
+            JNIEnv *env,
+            jobject thiz,
+            jobject jcontext,
+            jobject jsrc_bitmap,
+            jobjectArray joutputs
+    );
+
+    static jfloatArray nativeCalibrate(
+            JNIEnv *env,
+            jobject thiz
+    );
+
+    static void nativeSetSpeedModel(
+            JNIEnv *env,
+            jobject thiz,
+            jfloatArray jmodel
+    );
+
+    static void nativeSetDeadline(
+            JNIEnv *env,
+            jobject thiz,
+            jlong jdeadline_millis
+    );
+
+    static void nativeSetProgressInterval(
+            JNIEnv *env,
+            jobject thiz,
+            jlong jinterval_millis,
+            jint jpercent_step
+    );
+
     static void nativeCancel(
             JNIEnv *env,
-            jobject
+            jobject thiz
     );
 
     static void nativeRelease(
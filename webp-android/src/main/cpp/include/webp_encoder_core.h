@@ -0,0 +1,120 @@
+//
+// Created by udara on 10/19/26.
+//
+
+#pragma once
+
+#include <vector>
+#include <webp/encode.h>
+
+#include "result_codes.h"
+#include "progress_reporter.h"
+#include "worker_pool.h"
+
+namespace enc {
+    typedef struct {
+        int width;
+        int height;
+        WebPConfig config;
+        ResultCode result_code;
+        const uint8_t *webp_data;
+        size_t webp_size;
+    } EncodeTarget;
+}
+
+/**
+ * Still image encoding without JNI. WebPEncoder adds the Java bindings on top of it.
+ */
+class WebPEncoderCore {
+
+protected:
+    int imageWidth;
+    int imageHeight;
+    WebPConfig webPConfig{};
+    ProgressReporter progressReporter;
+    long deadlineMillis = 0;
+    long lastEncodeMillis = 0;
+    int lastEncodeMethod = 0;
+    WorkerPool workerPool;
+
+public:
+    /**
+     * Constructs an encoder with the specified width and height.
+     *
+     * @param width The width of the output image.
+     * @param height The height of the output image.
+     */
+    WebPEncoderCore(int width, int height);
+
+    /**
+     * Configures the WebP encoding parameters.
+     *
+     * @param config The WebP configuration.
+     */
+    void configure(WebPConfig config);
+
+    /**
+     * Sets the time budget for encode. When set, the encode method and lossless quality are lowered
+     * according to the speed model so that the encode fits into the budget. The speed model is
+     * calibrated here if it was not calibrated or loaded before.
+     *
+     * @param deadline_millis Time budget in milliseconds, 0 to disable.
+     */
+    void setDeadline(long deadline_millis);
+
+    /**
+     * @return true if a deadline is set and the last encode took longer.
+     */
+    bool isDeadlineMissed() const;
+
+    /**
+     * Encodes the image into WebP format.
+     *
+     * @param pixels Pointer to the input pixel data from Android bitmap.
+     * @param image_width The width of the input image.
+     * @param image_height The height of the input image.
+     * @param output_width The width the output image.
+     * @param output_height The height of the output image.
+     * @param webp_data Pointer to the output buffer for the WebP data.
+     * @param webp_size Pointer to store the size of the WebP data.
+     *
+     * @return 0 if success, otherwise error code.
+     */
+    ResultCode encode(
+            const uint8_t *pixels,
+            int image_width,
+            int image_height,
+            int output_width,
+            int output_height,
+            const uint8_t **webp_data,
+            size_t *webp_size
+    );
+
+    /**
+     * Encodes the image into several WebP outputs of different sizes.
+     * The pixels are imported once, each smaller size is downscaled from the closest larger one,
+     * and the outputs are encoded in parallel on a worker pool that is kept for later calls.
+     * Progress is the combined progress of all outputs, weighted by their pixel counts.
+     *
+     * @param pixels Pointer to the input pixel data from Android bitmap.
+     * @param image_width The width of the input image.
+     * @param image_height The height of the input image.
+     * @param targets Output sizes and configs. On success, webp_data and webp_size of each target
+     * point to the encoded data, which must be released with WebPFree.
+     *
+     * @return 0 if all outputs were encoded, otherwise the first error code.
+     */
+    ResultCode encodeMultiple(
+            const uint8_t *pixels,
+            int image_width,
+            int image_height,
+            std::vector<enc::EncodeTarget> &targets
+    );
+
+    /**
+    * Releases any resources held by the WebPEncoder object.
+    */
+    void release();
+
+    static int notifyProgressChanged(int percent, const WebPPicture *picture);
+};
@@ -0,0 +1,71 @@
+//
+// Created by udara on 10/19/26.
+//
+
+#pragma once
+
+#include <jni.h>
+#include <webp/mux.h>
+
+#include "result_codes.h"
+
+namespace edit {
+    /**
+     * Container level changes applied to a WebP image.
+     */
+    typedef struct {
+        int loop_count;
+        bool set_bg_color;
+        uint32_t bg_color;
+        float duration_scale;
+        bool strip_metadata;
+        int trim_start;
+        int trim_end;
+    } EditParams;
+}
+
+/**
+ * Edits WebP images at the container level with WebPMux. Frame bitstreams are copied as they are,
+ * so edits run in the time it takes to read and write the image.
+ */
+class WebPMuxEditor {
+public:
+    /**
+     * Applies the edits to the image.
+     *
+     * @param data The source WebP image.
+     * @param params The edits. Loop count, background color, durations and trimming need an animated image.
+     * @param output Receives the edited image. Free with WebPDataClear.
+     *
+     * @return 0 if success or error code if failed.
+     */
+    static ResultCode edit(const WebPData &data, const edit::EditParams &params, WebPData *output);
+
+    static void nativeEdit(
+            JNIEnv *env,
+            jobject thiz,
+            jobject jcontext,
+            jobject jsrc_uri,
+            jobject jdst_uri,
+            jint jloop_count,
+            jboolean jset_bg_color,
+            jint jbg_color,
+            jfloat jduration_scale,
+            jboolean jstrip_metadata,
+            jint jtrim_start,
+            jint jtrim_end
+    );
+
+    static jobject nativeEditBuffer(
+            JNIEnv *env,
+            jobject thiz,
+            jobject jbuffer,
+            jint jloop_count,
+            jboolean jset_bg_color,
+            jint jbg_color,
+            jfloat jduration_scale,
+            jboolean jstrip_metadata,
+            jint jtrim_start,
+            jint jtrim_end
+    );
+};
@@ -0,0 +1,97 @@
+//
+// Created by udara on 10/19/26.
+//
+
+#pragma once
+
+#include <atomic>
+#include <jni.h>
+#include <webp/encode.h>
+#include <webp/mux.h>
+
+#include "result_codes.h"
+
+namespace trans {
+    /**
+     * Geometry and timing changes applied while transcoding.
+     */
+    typedef struct {
+        int width;
+        int height;
+        int crop_left;
+        int crop_top;
+        int crop_width;
+        int crop_height;
+        float frame_rate;
+    } TranscodeParams;
+}
+
+/**
+ * Re-encodes animated WebP and GIF images natively.
+ * Decoded canvases go straight from WebPAnimDecoder into WebPAnimEncoder without Java bitmaps.
+ * Decoding runs on the calling thread and encoding on a worker thread, so the two overlap.
+ */
+class WebPTranscoder {
+private:
+    std::atomic<bool> cancelFlag{false};
+
+    ResultCode transcodeFrames(
+            const WebPData &data,
+            const WebPConfig &config,
+            WebPAnimEncoderOptions options,
+            bool keep_anim_params,
+            const trans::TranscodeParams &params,
+            WebPData *output
+    );
+
+public:
+    /**
+     * Transcodes an animated or still WebP image, or a GIF image.
+     * Fails with ERROR_USER_ABORT if cancel was called since the previous transcode finished.
+     *
+     * @param data The source WebP or GIF data.
+     * @param config The encoding configuration of the output frames.
+     * @param options The animation encoder options. Loop count and background color are replaced by the source values if keep_anim_params is true.
+     * @param keep_anim_params If true, the output keeps the loop count and background color of the source.
+     * @param params The geometry and timing changes to apply.
+     * @param output Receives the assembled WebP data. Free with WebPDataClear.
+     *
+     * @return 0 if success or error code if failed.
+     */
+    ResultCode transcode(
+            const WebPData &data,
+            const WebPConfig &config,
+            WebPAnimEncoderOptions options,
+            bool keep_anim_params,
+            const trans::TranscodeParams &params,
+            WebPData *output
+    );
+
+    void cancel();
+
+    static WebPTranscoder *getInstance(JNIEnv *env, jobject jtranscoder);
+
+    static jlong nativeCreate(JNIEnv *env, jobject thiz);
+
+    static void nativeTranscode(
+            JNIEnv *env,
+            jobject thiz,
+            jobject jcontext,
+            jobject jsrc_uri,
+            jobject jdst_uri,
+            jobject jconfig,
+            jobject jpreset,
+            jobject joptions,
+            jint jwidth,
+            jint jheight,
+            jint jcrop_left,
+            jint jcrop_top,
+            jint jcrop_width,
+            jint jcrop_height,
+            jfloat jframe_rate
+    );
+
+    static void nativeCancel(JNIEnv *env, jobject thiz);
+
+    static void nativeRelease(JNIEnv *env, jobject thiz);
+};
@@ -0,0 +1,52 @@
+//
+// Created by udara on 10/19/26.
+//
+
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Threads that run the jobs of one batch at a time. The calling thread takes part in each batch.
+ * Threads are started by the first batch with more than one job and reused until the pool is destroyed.
+ */
+class WorkerPool {
+
+private:
+    const size_t threadCount;
+    const std::function<void(size_t)> *job = nullptr;
+    size_t jobCount = 0;
+    size_t nextJob = 0;
+    size_t runningCount = 0;
+    bool stopWorkers = false;
+    std::mutex mutex;
+    std::condition_variable workAvailable;
+    std::condition_variable workFinished;
+    std::vector<std::thread> workers;
+
+    void runWorker();
+
+    void runJobs(std::unique_lock<std::mutex> &lock);
+
+public:
+    /**
+     * @param thread_count Number of threads besides the calling thread, or 0 to use one per core.
+     */
+    explicit WorkerPool(size_t thread_count = 0);
+
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool &) = delete;
+
+    WorkerPool &operator=(const WorkerPool &) = delete;
+
+    /**
+     * Runs job(0) to job(job_count - 1) and returns when all of them are done.
+     * Must not be called by two threads at once.
+     */
+    void run(size_t job_count, const std::function<void(size_t)> &job);
+};
@@ -0,0 +1,127 @@
+//
+// Created by udara on 10/19/26.
+//
+
+#include "include/keyframe_table.h"
+
+bool KeyFrameTable::parse(const WebPData &data) {
+    keyFrameFlags.clear();
+    frameTimestamps.clear();
+    frameSizes.clear();
+
+    WebPDemuxer *demuxer = WebPDemux(&data);
+    if (demuxer == nullptr) {
+        return false;
+    }
+    const int canvas_width = static_cast<int>(WebPDemuxGetI(demuxer, WEBP_FF_CANVAS_WIDTH));
+    const int canvas_height = static_cast<int>(WebPDemuxGetI(demuxer, WEBP_FF_CANVAS_HEIGHT));
+
+    WebPIterator frame;
+    WebPIterator previous;
+    bool has_previous = false;
+    long timestamp = 0;
+    if (WebPDemuxGetFrame(demuxer, 1, &frame)) {
+        do {
+            bool key_frame = !has_previous || isKeyFrame(
+                    frame,
+                    previous,
+                    keyFrameFlags.back(),
+                    canvas_width,
+                    canvas_height
+            );
+            keyFrameFlags.push_back(key_frame);
+            frameTimestamps.push_back(timestamp);
+            frameSizes.push_back(frame.fragment.size);
+            timestamp += frame.duration;
+            if (has_previous) {
+                WebPDemuxReleaseIterator(&previous);
+            }
+            previous = frame;
+            has_previous = true;
+        } while (WebPDemuxGetFrame(demuxer, previous.frame_num + 1, &frame));
+        WebPDemuxReleaseIterator(&previous);
+    }
+    WebPDemuxDelete(demuxer);
+    return !keyFrameFlags.empty();
+}
+
+int KeyFrameTable::getFrameCount() const {
+    return static_cast<int>(keyFrameFlags.size());
+}
+
+bool KeyFrameTable::isKeyFrame(int index) const {
+    return keyFrameFlags[index];
+}
+
+long KeyFrameTable::getTimestamp(int index) const {
+    return frameTimestamps[index];
+}
+
+std::vector<int> KeyFrameTable::getKeyFrames() const {
+    std::vector<int> key_frames;
+    for (int i = 0; i < getFrameCount(); i++) {
+        if (keyFrameFlags[i]) {
+            key_frames.push_back(i);
+        }
+    }
+    return key_frames;
+}
+
+int KeyFrameTable::getMaxSeekFrames() const {
+    int max_frames = 0;
+    int frames = 0;
+    for (bool key_frame: keyFrameFlags) {
+        frames = key_frame ? 1 : frames + 1;
+        if (frames > max_frames) {
+            max_frames = frames;
+        }
+    }
+    return max_frames;
+}
+
+size_t KeyFrameTable::getKeyFrameBytes() const {
+    size_t bytes = 0;
+    for (int i = 0; i < getFrameCount(); i++) {
+        if (keyFrameFlags[i]) bytes += frameSizes[i];
+    }
+    return bytes;
+}
+
+size_t KeyFrameTable::getDeltaFrameBytes() const {
+    size_t bytes = 0;
+    for (int i = 0; i < getFrameCount(); i++) {
+        if (!keyFrameFlags[i]) bytes += frameSizes[i];
+    }
+    return bytes;
+}
+
+size_t KeyFrameTable::estimateKeyFrameOverhead() const {
+    const size_t delta_count = getFrameCount() - getKeyFrames().size();
+    if (delta_count == 0) {
+        return 0;
+    }
+    const size_t average_delta = getDeltaFrameBytes() / delta_count;
+    size_t overhead = 0;
+    // The first frame is always a keyframe and costs nothing extra
+    for (int i = 1; i < getFrameCount(); i++) {
+        if (keyFrameFlags[i] && frameSizes[i] > average_delta) {
+            overhead += frameSizes[i] - average_delta;
+        }
+    }
+    return overhead;
+}
+
+bool KeyFrameTable::isKeyFrame(
+        const WebPIterator &frame,
+        const WebPIterator &previous,
+        bool previous_is_key_frame,
+        int canvas_width,
+        int canvas_height
+) {
+    const bool full_frame = frame.width == canvas_width && frame.height == canvas_height;
+    if ((!frame.has_alpha || frame.blend_method == WEBP_MUX_NO_BLEND) && full_frame) {
+        return true;
+    }
+    const bool previous_full_frame = previous.width == canvas_width && previous.height == canvas_height;
+    return previous.dispose_method == WEBP_MUX_DISPOSE_BACKGROUND && (previous_full_frame || previous_is_key_frame);
+}
@@ -0,0 +1,53 @@
+//
+// Created by udara on 10/19/26.
+//
+
+#include "include/memory_tracker.h"
+
+void MemoryTracker::setLimit(size_t limit_bytes) {
+    limitBytes = limit_bytes;
+}
+
+size_t MemoryTracker::getLimit() const {
+    return limitBytes;
+}
+
+bool MemoryTracker::fits(size_t bytes) const {
+    const size_t limit = limitBytes;
+    return limit == 0 || currentBytes + bytes <= limit;
+}
+
+void MemoryTracker::allocate(size_t bytes) {
+    const size_t current = currentBytes.fetch_add(bytes) + bytes;
+    size_t peak = peakBytes;
+    while (current > peak && !peakBytes.compare_exchange_weak(peak, current)) {}
+}
+
+void MemoryTracker::release(size_t bytes) {
+    currentBytes.fetch_sub(bytes);
+}
+
+size_t MemoryTracker::getCurrent() const {
+    return currentBytes;
+}
+
+size_t MemoryTracker::getPeak() const {
+    return peakBytes;
+}
+
+size_t MemoryTracker::pictureByteCount(const WebPPicture &picture) {
+    const auto width = static_cast<size_t>(picture.width);
+    const auto height = static_cast<size_t>(picture.height);
+    size_t bytes = 0;
+    if (picture.argb != nullptr) {
+        bytes += width * height * 4;
+    }
+    if (picture.y != nullptr) {
+        const size_t uv_size = ((width + 1) / 2) * ((height + 1) / 2);
+        bytes += width * height + 2 * uv_size;
+        if (picture.a != nullptr) {
+            bytes += width * height;
+        }
+    }
+    return bytes;
+}
@@ -6,19 +6,57 @@
 #include "include/webp_encoder.h"
 #include "include/webp_anim_encoder.h"
 #include "include/webp_decoder.h"
+#include "include/webp_transcoder.h"
+#include "include/webp_mux_editor.h"
+#include "include/buffer_utils.h"
+
+#include <chrono>
+#include <android/api-level.h>
+
+RegistryEntry *RegistryEntry::first = nullptr;
+RegistryEntry *RegistryEntry::last = nullptr;
+
+RegistryEntry::RegistryEntry(bool is_class) : isClass(is_class) {
+    if (last == nullptr) {
+        first = this;
+    } else {
+        last->next = this;
+    }
+    last = this;
+}
+
+bool RegistryEntry::loadAll(JNIEnv *env) {
+    bool loaded = true;
+    for (RegistryEntry *entry = first; entry != nullptr; entry = entry->next) {
+        if (entry->isClass) loaded &= entry->load(env);
+    }
+    // Members cannot be looked up on a missing class
+    if (!loaded) {
+        return false;
+    }
+    for (RegistryEntry *entry = first; entry != nullptr; entry = entry->next) {
+        if (!entry->isClass) entry->load(env);
+    }
+    return true;
+}
+
+void RegistryEntry::resetAll(JNIEnv *env) {
+    for (RegistryEntry *entry = first; entry != nullptr; entry = entry->next) {
+        entry->reset(env);
+    }
+}
 
 LazyClass ClassRegistry::bitmapClass = LazyClass("android/graphics/Bitmap");
 LazyClass ClassRegistry::bitmapCompressFormatClass = LazyClass("android/graphics/Bitmap$CompressFormat");
 LazyClass ClassRegistry::bitmapConfigClass = LazyClass("android/graphics/Bitmap$Config");
 LazyClass ClassRegistry::bitmapUtilsClass = LazyClass("com/aureusapps/android/webpandroid/utils/BitmapUtils");
-LazyClass ClassRegistry::booleanClass = LazyClass("java/lang/Boolean");
 LazyClass ClassRegistry::cancellationExceptionClass = LazyClass("java/util/concurrent/CancellationException");
 LazyClass ClassRegistry::contentResolverClass = LazyClass("android/content/ContentResolver");
 LazyClass ClassRegistry::contextClass = LazyClass("android/content/Context");
-LazyClass ClassRegistry::floatClass = LazyClass("java/lang/Float");
-LazyClass ClassRegistry::frameDecodeResultClass = LazyClass("com/aureusapps/android/webpandroid/decoder/InternalFrameDecodeResult");
+LazyClass ClassRegistry::frameExtractResultClass = LazyClass("com/aureusapps/android/webpandroid/decoder/InternalFrameExtractResult");
 LazyClass ClassRegistry::infoDecodeResultClass = LazyClass("com/aureusapps/android/webpandroid/decoder/InfoDecodeResult");
-LazyClass ClassRegistry::integerClass = LazyClass("java/lang/Integer");
+LazyClass ClassRegistry::nativeBufferCleanerClass = LazyClass("com/aureusapps/android/webpandroid/utils/NativeBufferCleaner");
+LazyClass ClassRegistry::nativeLoadStatsClass = LazyClass("com/aureusapps/android/webpandroid/utils/NativeLoadStats");
 LazyClass ClassRegistry::parcelFileDescriptorClass = LazyClass("android/os/ParcelFileDescriptor");
 LazyClass ClassRegistry::runtimeExceptionClass = LazyClass("java/lang/RuntimeException");
 LazyClass ClassRegistry::uriClass = LazyClass("android/net/Uri");
@@ -27,237 +65,86 @@ LazyClass ClassRegistry::webPAnimEncoderClass = LazyClass("com/aureusapps/androi
 LazyClass ClassRegistry::webPAnimEncoderOptionsClass = LazyClass("com/aureusapps/android/webpandroid/encoder/WebPAnimEncoderOptions");
 LazyClass ClassRegistry::webPConfigClass = LazyClass("com/aureusapps/android/webpandroid/encoder/WebPConfig");
 LazyClass ClassRegistry::webPDecoderClass = LazyClass("com/aureusapps/android/webpandroid/decoder/WebPDecoder");
+LazyClass ClassRegistry::webPDecoderCriticalNativesClass = LazyClass("com/aureusapps/android/webpandroid/decoder/WebPDecoder$CriticalNatives");
 LazyClass ClassRegistry::webPDecoderConfigClass = LazyClass("com/aureusapps/android/webpandroid/decoder/DecoderConfig");
 LazyClass ClassRegistry::webPEncoderClass = LazyClass("com/aureusapps/android/webpandroid/encoder/WebPEncoder");
+LazyClass ClassRegistry::webPEncoderOutputClass = LazyClass("com/aureusapps/android/webpandroid/encoder/WebPEncoderOutput");
 LazyClass ClassRegistry::webPInfoClass = LazyClass("com/aureusapps/android/webpandroid/decoder/WebPInfo");
-LazyClass ClassRegistry::webPMuxAnimParamsClass = LazyClass("com/aureusapps/android/webpandroid/encoder/WebPMuxAnimParams");
+LazyClass ClassRegistry::webPMuxEditorClass = LazyClass("com/aureusapps/android/webpandroid/mux/WebPMuxEditor");
 LazyClass ClassRegistry::webPPresetClass = LazyClass("com/aureusapps/android/webpandroid/encoder/WebPPreset");
+LazyClass ClassRegistry::webPSeekReportClass = LazyClass("com/aureusapps/android/webpandroid/encoder/WebPSeekReport");
+LazyClass ClassRegistry::webPTranscoderClass = LazyClass("com/aureusapps/android/webpandroid/transcoder/WebPTranscoder");
 
-LazyField ClassRegistry::decoderConfigCompressFormatFieldID = LazyField(
-        webPDecoderConfigClass,
-        "compressFormat",
-        "Landroid/graphics/Bitmap$CompressFormat;"
-);
-LazyField ClassRegistry::decoderConfigCompressQualityFieldID = LazyField(
-        webPDecoderConfigClass,
-        "compressQuality",
-        "I"
-);
 LazyField ClassRegistry::decoderConfigNamePrefixFieldID = LazyField(
         webPDecoderConfigClass,
         "namePrefix",
         "Ljava/lang/String;"
 );
-LazyField ClassRegistry::decoderConfigRepeatCharacterCountFieldID = LazyField(
-        webPDecoderConfigClass,
-        "repeatCharacterCount",
-        "I"
-);
-LazyField ClassRegistry::decoderConfigRepeatCharacterFieldID = LazyField(
+LazyField ClassRegistry::decoderConfigPackedFieldID = LazyField(
         webPDecoderConfigClass,
-        "repeatCharacter",
-        "C"
+        "packed",
+        "[I"
 );
 LazyField ClassRegistry::encoderPointerFieldID = LazyField(
         webPEncoderClass,
         "nativePointer",
         "J"
 );
-LazyField ClassRegistry::webPAnimEncoderOptionsAllowMixedFieldID = LazyField(
-        webPAnimEncoderOptionsClass,
-        "allowMixed",
-        "Ljava/lang/Boolean;"
-);
-LazyField ClassRegistry::webPAnimEncoderOptionsAnimParamsFieldID = LazyField(
-        webPAnimEncoderOptionsClass,
-        "animParams",
-        "Lcom/aureusapps/android/webpandroid/encoder/WebPMuxAnimParams;"
-);
-LazyField ClassRegistry::webPAnimEncoderOptionsKMaxFieldID = LazyField(
-        webPAnimEncoderOptionsClass,
-        "kmax",
-        "Ljava/lang/Integer;"
-);
-LazyField ClassRegistry::webPAnimEncoderOptionsKMinFieldID = LazyField(
-        webPAnimEncoderOptionsClass,
-        "kmin",
-        "Ljava/lang/Integer;"
-);
-LazyField ClassRegistry::webPAnimEncoderOptionsMinimizeSizeFieldID = LazyField(
-        webPAnimEncoderOptionsClass,
-        "minimizeSize",
-        "Ljava/lang/Boolean;"
-);
-LazyField ClassRegistry::webPAnimEncoderOptionsVerboseFieldID = LazyField(
-        webPAnimEncoderOptionsClass,
-        "verbose",
-        "Ljava/lang/Boolean;"
-);
 LazyField ClassRegistry::webPAnimEncoderPointerFieldID = LazyField(
         webPAnimEncoderClass,
         "nativePointer",
         "J"
 );
-LazyField ClassRegistry::webPConfigAlphaCompressionFieldID = LazyField(
-        webPConfigClass,
-        "alphaCompression",
-        "Ljava/lang/Integer;"
-);
-LazyField ClassRegistry::webPConfigAlphaFilteringFieldID = LazyField(
-        webPConfigClass,
-        "alphaFiltering",
-        "Ljava/lang/Integer;"
-);
-LazyField ClassRegistry::webPConfigAlphaQualityFieldID = LazyField(
-        webPConfigClass,
-        "alphaQuality",
-        "Ljava/lang/Integer;"
-);
-LazyField ClassRegistry::webPConfigAutoFilterFieldID = LazyField(
-        webPConfigClass,
-        "autoFilter",
-        "Ljava/lang/Boolean;"
-);
-LazyField ClassRegistry::webPConfigEmulateJPEGSizeFieldID = LazyField(
-        webPConfigClass,
-        "emulateJPEGSize",
-        "Ljava/lang/Boolean;"
-);
-LazyField ClassRegistry::webPConfigExactFieldID = LazyField(
-        webPConfigClass,
-        "exact",
-        "Ljava/lang/Boolean;"
-);
-LazyField ClassRegistry::webPConfigFilterSharpnessFieldID = LazyField(
-        webPConfigClass,
-        "filterSharpness",
-        "Ljava/lang/Integer;"
-);
-LazyField ClassRegistry::webPConfigFilterStrengthFieldID = LazyField(
-        webPConfigClass,
-        "filterStrength",
-        "Ljava/lang/Integer;"
-);
-LazyField ClassRegistry::webPConfigFilterTypeFieldID = LazyField(
-        webPConfigClass,
-        "filterType",
-        "Ljava/lang/Integer;"
-);
-LazyField ClassRegistry::webPConfigLosslessFieldID = LazyField(
-        webPConfigClass,
-        "lossless",
-        "Ljava/lang/Integer;"
-);
-LazyField ClassRegistry::webPConfigLowMemoryFieldID = LazyField(
-        webPConfigClass,
-        "lowMemory",
-        "Ljava/lang/Boolean;"
-);
-LazyField ClassRegistry::webPConfigMethodFieldID = LazyField(
-        webPConfigClass,
-        "method",
-        "Ljava/lang/Integer;"
-);
-LazyField ClassRegistry::webPConfigNearLosslessFieldID = LazyField(
-        webPConfigClass,
-        "nearLossless",
-        "Ljava/lang/Integer;"
-);
-LazyField ClassRegistry::webPConfigPartitionLimitFieldID = LazyField(
-        webPConfigClass,
-        "partitionLimit",
-        "Ljava/lang/Integer;"
-);
-LazyField ClassRegistry::webPConfigPartitionsFieldID = LazyField(
-        webPConfigClass,
-        "partitions",
-        "Ljava/lang/Integer;"
-);
-LazyField ClassRegistry::webPConfigPassFieldID = LazyField(
-        webPConfigClass,
-        "pass",
-        "Ljava/lang/Integer;"
-);
-LazyField ClassRegistry::webPConfigPreprocessingFieldID = LazyField(
-        webPConfigClass,
-        "preprocessing",
-        "Ljava/lang/Integer;"
-);
-LazyField ClassRegistry::webPConfigQMaxFieldID = LazyField(
-        webPConfigClass,
-        "qmax",
-        "Ljava/lang/Integer;"
-);
-LazyField ClassRegistry::webPConfigQMinFieldID = LazyField(
-        webPConfigClass,
-        "qmin",
-        "Ljava/lang/Integer;"
-);
-LazyField ClassRegistry::webPConfigQualityFieldID = LazyField(
-        webPConfigClass,
-        "quality",
-        "Ljava/lang/Float;"
-);
-LazyField ClassRegistry::webPConfigSegmentsFieldID = LazyField(
-        webPConfigClass,
-        "segments",
-        "Ljava/lang/Integer;"
-);
-LazyField ClassRegistry::webPConfigShowCompressedFieldID = LazyField(
-        webPConfigClass,
-        "showCompressed",
-        "Ljava/lang/Boolean;"
-);
-LazyField ClassRegistry::webPConfigSnsStrengthFieldID = LazyField(
-        webPConfigClass,
-        "snsStrength",
-        "Ljava/lang/Integer;"
-);
-LazyField ClassRegistry::webPConfigTargetPSNRFieldID = LazyField(
-        webPConfigClass,
-        "targetPSNR",
-        "Ljava/lang/Float;"
-);
-LazyField ClassRegistry::webPConfigTargetSizeFieldID = LazyField(
-        webPConfigClass,
-        "targetSize",
-        "Ljava/lang/Integer;"
-);
-LazyField ClassRegistry::webPConfigThreadLevelFieldID = LazyField(
-        webPConfigClass,
-        "threadLevel",
-        "Ljava/lang/Integer;"
-);
-LazyField ClassRegistry::webPConfigUseDeltaPaletteFieldID = LazyField(
-        webPConfigClass,
-        "useDeltaPalette",
-        "Ljava/lang/Boolean;"
+LazyField ClassRegistry::webPAnimEncoderOptionsPackedFieldID = LazyField(
+        webPAnimEncoderOptionsClass,
+        "packed",
+        "[I"
 );
-LazyField ClassRegistry::webPConfigUseSharpYUVFieldID = LazyField(
+LazyField ClassRegistry::webPConfigPackedFieldID = LazyField(
         webPConfigClass,
-        "useSharpYUV",
-        "Ljava/lang/Boolean;"
+        "packed",
+        "[I"
 );
 LazyField ClassRegistry::webPDecoderPointerFieldID = LazyField(
         webPDecoderClass,
         "nativePointer",
         "J"
 );
-LazyField ClassRegistry::webPMuxAnimParamsBgColorFieldID = LazyField(
-        webPMuxAnimParamsClass,
-        "backgroundColor",
-        "Ljava/lang/Integer;"
+LazyField ClassRegistry::webPEncoderOutputConfigFieldID = LazyField(
+        webPEncoderOutputClass,
+        "config",
+        "Lcom/aureusapps/android/webpandroid/encoder/WebPConfig;"
+);
+LazyField ClassRegistry::webPEncoderOutputDstUriFieldID = LazyField(
+        webPEncoderOutputClass,
+        "dstUri",
+        "Landroid/net/Uri;"
+);
+LazyField ClassRegistry::webPEncoderOutputHeightFieldID = LazyField(
+        webPEncoderOutputClass,
+        "height",
+        "I"
+);
+LazyField ClassRegistry::webPEncoderOutputPresetFieldID = LazyField(
+        webPEncoderOutputClass,
+        "preset",
+        "Lcom/aureusapps/android/webpandroid/encoder/WebPPreset;"
 );
-LazyField ClassRegistry::webPMuxAnimParamsLoopCountFieldID = LazyField(
-        webPMuxAnimParamsClass,
-        "loopCount",
-        "Ljava/lang/Integer;"
+LazyField ClassRegistry::webPEncoderOutputWidthFieldID = LazyField(
+        webPEncoderOutputClass,
+        "width",
+        "I"
 );
 LazyField ClassRegistry::webPPresetOrdinalFieldID = LazyField(
         webPPresetClass,
         "value",
         "I"
 );
+LazyField ClassRegistry::webPTranscoderPointerFieldID = LazyField(
+        webPTranscoderClass,
+        "nativePointer",
+        "J"
+);
 
 LazyStaticField ClassRegistry::bitmapConfigARGB8888FieldID = LazyStaticField(
         bitmapConfigClass,
@@ -301,21 +188,11 @@ LazyMethod ClassRegistry::animEncoderNotifyProgressMethodID = LazyMethod(
         "notifyProgressChanged",
         "(II)Z"
 );
-LazyMethod ClassRegistry::bitmapCompressFormatOrdinalMethodID = LazyMethod(
-        bitmapCompressFormatClass,
-        "ordinal",
-        "()I"
-);
 LazyMethod ClassRegistry::bitmapRecycleMethodID = LazyMethod(
         bitmapClass,
         "recycle",
         "()V"
 );
-LazyMethod ClassRegistry::booleanValueMethodID = LazyMethod(
-        booleanClass,
-        "booleanValue",
-        "()Z"
-);
 LazyMethod ClassRegistry::contentResolverOpenFileDescriptorMethodID = LazyMethod(
         contentResolverClass,
         "openFileDescriptor",
@@ -336,31 +213,26 @@ LazyMethod ClassRegistry::decoderNotifyInfoDecodedMethodID = LazyMethod(
         "notifyInfoDecoded",
         "(Lcom/aureusapps/android/webpandroid/decoder/WebPInfo;)V"
 );
+LazyMethod ClassRegistry::encoderNotifyDeadlineMissedMethodID = LazyMethod(
+        webPEncoderClass,
+        "notifyDeadlineMissed",
+        "(JJI)V"
+);
 LazyMethod ClassRegistry::encoderNotifyProgressMethodID = LazyMethod(
         webPEncoderClass,
         "notifyProgressChanged",
         "(I)Z"
 );
-LazyMethod ClassRegistry::floatValueMethodID = LazyMethod(
-        floatClass,
-        "floatValue",
-        "()F"
-);
-LazyMethod ClassRegistry::frameDecodeResultConstructorID = LazyMethod(
-        frameDecodeResultClass,
+LazyMethod ClassRegistry::frameExtractResultConstructorID = LazyMethod(
+        frameExtractResultClass,
         "<init>",
-        "(Landroid/graphics/Bitmap;II)V"
+        "(ZI)V"
 );
 LazyMethod ClassRegistry::infoDecodeResultConstructorID = LazyMethod(
         infoDecodeResultClass,
         "<init>",
         "(Lcom/aureusapps/android/webpandroid/decoder/WebPInfo;I)V"
 );
-LazyMethod ClassRegistry::integerValueMethodID = LazyMethod(
-        integerClass,
-        "intValue",
-        "()I"
-);
 LazyMethod ClassRegistry::parcelFileDescriptorCloseMethodID = LazyMethod(
         parcelFileDescriptorClass,
         "close",
@@ -381,6 +253,11 @@ LazyMethod ClassRegistry::webPInfoConstructorID = LazyMethod(
         "<init>",
         "(IIZZIII)V"
 );
+LazyMethod ClassRegistry::webPSeekReportConstructorID = LazyMethod(
+        webPSeekReportClass,
+        "<init>",
+        "([I[JIIJJJ)V"
+);
 
 LazyStaticMethod ClassRegistry::bitmapCreateMethodID = LazyStaticMethod(
         bitmapClass,
@@ -393,6 +270,11 @@ LazyStaticMethod ClassRegistry::bitmapUtilsSaveInDirectoryMethodID = LazyStaticM
         "saveInDirectory",
         "(Landroid/content/Context;Landroid/graphics/Bitmap;Landroid/net/Uri;Ljava/lang/String;Landroid/graphics/Bitmap$CompressFormat;I)Landroid/net/Uri;"
 );
+LazyStaticMethod ClassRegistry::nativeBufferCleanerRegisterMethodID = LazyStaticMethod(
+        nativeBufferCleanerClass,
+        "register",
+        "(Ljava/nio/ByteBuffer;J)Lcom/aureusapps/android/webpandroid/encoder/WebPBuffer;"
+);
 LazyStaticMethod ClassRegistry::uriExtensionsFindFileMethodID = LazyStaticMethod(
         uriExtensionsClass,
         "findFile",
@@ -404,32 +286,16 @@ LazyStaticMethod ClassRegistry::uriExtensionsReadToBufferMethodID = LazyStaticMe
         "(Landroid/net/Uri;Landroid/content/Context;)Ljava/nio/ByteBuffer;"
 );
 
+bool ClassRegistry::load([[maybe_unused]] JNIEnv *env) {
+#ifdef WEBPCODEC_LAZY_JNI_REGISTRY
+    return true;
+#else
+    return RegistryEntry::loadAll(env);
+#endif
+}
+
 void ClassRegistry::release(JNIEnv *env) {
-    bitmapClass.reset(env);
-    bitmapCompressFormatClass.reset(env);
-    bitmapConfigClass.reset(env);
-    bitmapUtilsClass.reset(env);
-    booleanClass.reset(env);
-    cancellationExceptionClass.reset(env);
-    contentResolverClass.reset(env);
-    contextClass.reset(env);
-    floatClass.reset(env);
-    frameDecodeResultClass.reset(env);
-    infoDecodeResultClass.reset(env);
-    integerClass.reset(env);
-    parcelFileDescriptorClass.reset(env);
-    runtimeExceptionClass.reset(env);
-    uriClass.reset(env);
-    uriExtensionsClass.reset(env);
-    webPAnimEncoderClass.reset(env);
-    webPAnimEncoderOptionsClass.reset(env);
-    webPConfigClass.reset(env);
-    webPDecoderClass.reset(env);
-    webPDecoderConfigClass.reset(env);
-    webPEncoderClass.reset(env);
-    webPInfoClass.reset(env);
-    webPMuxAnimParamsClass.reset(env);
-    webPPresetClass.reset(env);
+    RegistryEntry::resetAll(env);
 }
 
 static const JNINativeMethod encoderMethods[] = {
@@ -448,6 +314,36 @@ static const JNINativeMethod encoderMethods[] = {
                 "(Landroid/content/Context;Landroid/graphics/Bitmap;Landroid/net/Uri;)V",
                 reinterpret_cast<void *>(WebPEncoder::nativeEncode)
         },
+        {
+                "nativeEncodeMultiple",
+                "(Landroid/content/Context;Landroid/graphics/Bitmap;[Lcom/aureusapps/android/webpandroid/encoder/WebPEncoderOutput;)V",
+                reinterpret_cast<void *>(WebPEncoder::nativeEncodeMultiple)
+        },
+        {
+                "nativeEncodeToBuffer",
+                "(Landroid/graphics/Bitmap;)Lcom/aureusapps/android/webpandroid/encoder/WebPBuffer;",
+                reinterpret_cast<void *>(WebPEncoder::nativeEncodeToBuffer)
+        },
+        {
+                "nativeCalibrate",
+                "()[F",
+                reinterpret_cast<void *>(WebPEncoder::nativeCalibrate)
+        },
+        {
+                "nativeSetSpeedModel",
+                "([F)V",
+                reinterpret_cast<void *>(WebPEncoder::nativeSetSpeedModel)
+        },
+        {
+                "nativeSetDeadline",
+                "(J)V",
+                reinterpret_cast<void *>(WebPEncoder::nativeSetDeadline)
+        },
+        {
+                "nativeSetProgressInterval",
+                "(JI)V",
+                reinterpret_cast<void *>(WebPEncoder::nativeSetProgressInterval)
+        },
         {
                 "nativeCancel",
                 "()V",
@@ -476,11 +372,96 @@ static const JNINativeMethod animEncoderMethods[] = {
                 "(JLandroid/graphics/Bitmap;)V",
                 reinterpret_cast<void *>(WebPAnimationEncoder::nativeAddFrame)
         },
+        {
+                "nativeAddFrameBuffer",
+                "(JLjava/nio/ByteBuffer;IIIII)V",
+                reinterpret_cast<void *>(WebPAnimationEncoder::nativeAddFrameBuffer)
+        },
         {
                 "nativeAssemble",
                 "(Landroid/content/Context;JLandroid/net/Uri;)V",
                 reinterpret_cast<void *>(WebPAnimationEncoder::nativeAssemble)
         },
+        {
+                "nativeAssembleToBuffer",
+                "(J)Lcom/aureusapps/android/webpandroid/encoder/WebPBuffer;",
+                reinterpret_cast<void *>(WebPAnimationEncoder::nativeAssembleToBuffer)
+        },
+        {
+                "nativeSetParallelEncoding",
+                "(I)V",
+                reinterpret_cast<void *>(WebPAnimationEncoder::nativeSetParallelEncoding)
+        },
+        {
+                "nativeSetSizeBudget",
+                "(JI)V",
+                reinterpret_cast<void *>(WebPAnimationEncoder::nativeSetSizeBudget)
+        },
+        {
+                "nativeSetAppendSource",
+                "(Landroid/content/Context;Landroid/net/Uri;Z)V",
+                reinterpret_cast<void *>(WebPAnimationEncoder::nativeSetAppendSource)
+        },
+        {
+                "nativeGetSeekReport",
+                "()Lcom/aureusapps/android/webpandroid/encoder/WebPSeekReport;",
+                reinterpret_cast<void *>(WebPAnimationEncoder::nativeGetSeekReport)
+        },
+        {
+                "nativeSetMemoryLimit",
+                "(JI)V",
+                reinterpret_cast<void *>(WebPAnimationEncoder::nativeSetMemoryLimit)
+        },
+        {
+                "nativeGetMemoryUsage",
+                "()J",
+                reinterpret_cast<void *>(WebPAnimationEncoder::nativeGetMemoryUsage)
+        },
+        {
+                "nativeGetPeakMemoryUsage",
+                "()J",
+                reinterpret_cast<void *>(WebPAnimationEncoder::nativeGetPeakMemoryUsage)
+        },
+        {
+                "nativeSetStreamingOutput",
+                "(Landroid/content/Context;Landroid/net/Uri;)V",
+                reinterpret_cast<void *>(WebPAnimationEncoder::nativeSetStreamingOutput)
+        },
+        {
+                "nativeFinishStreaming",
+                "(J)V",
+                reinterpret_cast<void *>(WebPAnimationEncoder::nativeFinishStreaming)
+        },
+        {
+                "nativeSetDuplicateTolerance",
+                "(I)V",
+                reinterpret_cast<void *>(WebPAnimationEncoder::nativeSetDuplicateTolerance)
+        },
+        {
+                "nativeSetFrameResampling",
+                "(FZ)V",
+                reinterpret_cast<void *>(WebPAnimationEncoder::nativeSetFrameResampling)
+        },
+        {
+                "nativeGetDecimatedFrameCount",
+                "()I",
+                reinterpret_cast<void *>(WebPAnimationEncoder::nativeGetDecimatedFrameCount)
+        },
+        {
+                "nativeGetDroppedFrameCount",
+                "()I",
+                reinterpret_cast<void *>(WebPAnimationEncoder::nativeGetDroppedFrameCount)
+        },
+        {
+                "nativeSetAsyncQueue",
+                "(I)V",
+                reinterpret_cast<void *>(WebPAnimationEncoder::nativeSetAsyncQueue)
+        },
+        {
+                "nativeSetProgressInterval",
+                "(JI)V",
+                reinterpret_cast<void *>(WebPAnimationEncoder::nativeSetProgressInterval)
+        },
         {
                 "nativeCancel",
                 "()V",
@@ -519,26 +500,31 @@ static const JNINativeMethod decoderMethods[] = {
                 "()Lcom/aureusapps/android/webpandroid/decoder/InfoDecodeResult;",
                 reinterpret_cast<void *>(dec::nativeDecodeInfo)
         },
-        {
-                "nativeHasNextFrame",
-                "()Z",
-                reinterpret_cast<void *>(dec::nativeHasNextFrame)
-        },
-        {
-                "nativeNextFrameIndex",
-                "()I",
-                reinterpret_cast<void *>(dec::nativeNextFrameIndex)
-        },
         {
                 "nativeDecodeNextFrame",
-                "()Lcom/aureusapps/android/webpandroid/decoder/InternalFrameDecodeResult;",
+                "()J",
                 reinterpret_cast<void *>(dec::nativeDecodeNextFrame)
         },
+        {
+                "nativeGetFrameBitmap",
+                "()Landroid/graphics/Bitmap;",
+                reinterpret_cast<void *>(dec::nativeGetFrameBitmap)
+        },
         {
                 "nativeDecodeFrames",
                 "(Landroid/content/Context;Landroid/net/Uri;)I",
                 reinterpret_cast<void *>(dec::nativeDecodeFrames)
         },
+        {
+                "nativeDecodeFrameBatch",
+                "(ILjava/nio/ByteBuffer;[I)J",
+                reinterpret_cast<void *>(dec::nativeDecodeFrameBatch)
+        },
+        {
+                "nativeExtractFrame",
+                "(Landroid/content/Context;ILandroid/net/Uri;Lcom/aureusapps/android/webpandroid/encoder/WebPConfig;Lcom/aureusapps/android/webpandroid/encoder/WebPPreset;)Lcom/aureusapps/android/webpandroid/decoder/InternalFrameExtractResult;",
+                reinterpret_cast<void *>(dec::nativeExtractFrame)
+        },
         {
                 "nativeReset",
                 "()V",
@@ -556,37 +542,217 @@ static const JNINativeMethod decoderMethods[] = {
         },
 };
 
+// @CriticalNative methods are called without JNIEnv and class from Android 8.0
+static const JNINativeMethod decoderCriticalMethods[] = {
+        {
+                "nativeHasNextFrame",
+                "(J)Z",
+                reinterpret_cast<void *>(dec::criticalHasNextFrame)
+        },
+        {
+                "nativeNextFrameIndex",
+                "(J)I",
+                reinterpret_cast<void *>(dec::criticalNextFrameIndex)
+        },
+};
+
+// Before Android 8.0 the annotation is ignored and the same methods use the regular calling convention
+static const JNINativeMethod decoderCriticalFallbackMethods[] = {
+        {
+                "nativeHasNextFrame",
+                "(J)Z",
+                reinterpret_cast<void *>(dec::nativeHasNextFrame)
+        },
+        {
+                "nativeNextFrameIndex",
+                "(J)I",
+                reinterpret_cast<void *>(dec::nativeNextFrameIndex)
+        },
+};
+
+static const JNINativeMethod transcoderMethods[] = {
+        {
+                "nativeCreate",
+                "()J",
+                reinterpret_cast<void *>(WebPTranscoder::nativeCreate)
+        },
+        {
+                "nativeTranscode",
+                "(Landroid/content/Context;Landroid/net/Uri;Landroid/net/Uri;Lcom/aureusapps/android/webpandroid/encoder/WebPConfig;Lcom/aureusapps/android/webpandroid/encoder/WebPPreset;Lcom/aureusapps/android/webpandroid/encoder/WebPAnimEncoderOptions;IIIIIIF)V",
+                reinterpret_cast<void *>(WebPTranscoder::nativeTranscode)
+        },
+        {
+                "nativeCancel",
+                "()V",
+                reinterpret_cast<void *>(WebPTranscoder::nativeCancel)
+        },
+        {
+                "nativeRelease",
+                "()V",
+                reinterpret_cast<void *>(WebPTranscoder::nativeRelease)
+        },
+};
+
+static const JNINativeMethod muxEditorMethods[] = {
+        {
+                "nativeEdit",
+                "(Landroid/content/Context;Landroid/net/Uri;Landroid/net/Uri;IZIFZII)V",
+                reinterpret_cast<void *>(WebPMuxEditor::nativeEdit)
+        },
+        {
+                "nativeEditBuffer",
+                "(Ljava/nio/ByteBuffer;IZIFZII)Lcom/aureusapps/android/webpandroid/encoder/WebPBuffer;",
+                reinterpret_cast<void *>(WebPMuxEditor::nativeEditBuffer)
+        },
+};
+
+namespace {
+    jlong registryLoadNanos = 0;
+    jlong onLoadNanos = 0;
+
+    jlong nativeGetRegistryLoadNanos(JNIEnv *, jclass) {
+        return registryLoadNanos;
+    }
+
+    jlong nativeGetOnLoadNanos(JNIEnv *, jclass) {
+        return onLoadNanos;
+    }
+
+    jlong elapsedNanos(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+static const JNINativeMethod loadStatsMethods[] = {
+        {
+                "nativeGetRegistryLoadNanos",
+                "()J",
+                reinterpret_cast<void *>(nativeGetRegistryLoadNanos)
+        },
+        {
+                "nativeGetOnLoadNanos",
+                "()J",
+                reinterpret_cast<void *>(nativeGetOnLoadNanos)
+        },
+};
+
+static const JNINativeMethod bufferCleanerMethods[] = {
+        {
+                "nativeFree",
+                "(J)V",
+                reinterpret_cast<void *>(buf::nativeFree)
+        },
+};
+
+/**
+ * Registers the native methods of a registry class.
+ *
+ * @return JNI_ERR if the class could not be found, otherwise the result of RegisterNatives.
+ */
+static jint registerNatives(JNIEnv *env, LazyClass &clazz, const JNINativeMethod *methods, jint count) {
+    jclass resolved = clazz.get(env);
+    if (resolved == nullptr) {
+        return JNI_ERR;
+    }
+    return env->RegisterNatives(resolved, methods, count);
+}
+
 JNIEXPORT jint JNI_OnLoad(JavaVM *vm, void *) {
     JNIEnv *env;
     if (vm->GetEnv(reinterpret_cast<void **>(&env), JNI_VERSION_1_6) != JNI_OK) {
         return JNI_ERR;
     }
 
+    // resolve classes, fields and methods
+    const auto start = std::chrono::steady_clock::now();
+    if (!ClassRegistry::load(env)) {
+        return JNI_ERR;
+    }
+    registryLoadNanos = elapsedNanos(start);
+
     // register native methods
     // encoder methods
-    int result = env->RegisterNatives(
-            ClassRegistry::webPEncoderClass.get(env),
+    int result = registerNatives(
+            env,
+            ClassRegistry::webPEncoderClass,
             encoderMethods,
             sizeof(encoderMethods) / sizeof(JNINativeMethod)
     );
     if (result != JNI_OK) return result;
 
     // anim encoder methods
-    result = env->RegisterNatives(
-            ClassRegistry::webPAnimEncoderClass.get(env),
+    result = registerNatives(
+            env,
+            ClassRegistry::webPAnimEncoderClass,
             animEncoderMethods,
             sizeof(animEncoderMethods) / sizeof(JNINativeMethod)
     );
     if (result != JNI_OK) return result;
 
     // decoder methods
-    result = env->RegisterNatives(
-            ClassRegistry::webPDecoderClass.get(env),
+    result = registerNatives(
+            env,
+            ClassRegistry::webPDecoderClass,
             decoderMethods,
             sizeof(decoderMethods) / sizeof(JNINativeMethod)
     );
     if (result != JNI_OK) return result;
 
+    // decoder critical methods
+    if (android_get_device_api_level() >= __ANDROID_API_O__) {
+        result = registerNatives(
+                env,
+                ClassRegistry::webPDecoderCriticalNativesClass,
+                decoderCriticalMethods,
+                sizeof(decoderCriticalMethods) / sizeof(JNINativeMethod)
+        );
+    } else {
+        result = registerNatives(
+                env,
+                ClassRegistry::webPDecoderCriticalNativesClass,
+                decoderCriticalFallbackMethods,
+                sizeof(decoderCriticalFallbackMethods) / sizeof(JNINativeMethod)
+        );
+    }
+    if (result != JNI_OK) return result;
+
+    // transcoder methods
+    result = registerNatives(
+            env,
+            ClassRegistry::webPTranscoderClass,
+            transcoderMethods,
+            sizeof(transcoderMethods) / sizeof(JNINativeMethod)
+    );
+    if (result != JNI_OK) return result;
+
+    // mux editor methods
+    result = registerNatives(
+            env,
+            ClassRegistry::webPMuxEditorClass,
+            muxEditorMethods,
+            sizeof(muxEditorMethods) / sizeof(JNINativeMethod)
+    );
+    if (result != JNI_OK) return result;
+
+    // buffer cleaner methods
+    result = registerNatives(
+            env,
+            ClassRegistry::nativeBufferCleanerClass,
+            bufferCleanerMethods,
+            sizeof(bufferCleanerMethods) / sizeof(JNINativeMethod)
+    );
+    if (result != JNI_OK) return result;
+
+    // load stats methods
+    result = registerNatives(
+            env,
+            ClassRegistry::nativeLoadStatsClass,
+            loadStatsMethods,
+            sizeof(loadStatsMethods) / sizeof(JNINativeMethod)
+    );
+    if (result != JNI_OK) return result;
+
+    onLoadNanos = elapsedNanos(start);
     return JNI_VERSION_1_6;
 }
 
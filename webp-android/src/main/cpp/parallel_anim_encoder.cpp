@@ -0,0 +1,528 @@
+//
+// Created by udara on 10/19/26.
+//
+
+#include <algorithm>
+#include <cstring>
+
+#include "include/parallel_anim_encoder.h"
+
+namespace {
+    constexpr int MAX_CORRECTION_PASSES = 2;
+
+    // Aim a little under the budget so one correction pass is usually enough
+    constexpr double CORRECTION_MARGIN = 0.97;
+
+    bool extendLastFrame(WebPMux *mux, int duration) {
+        if (duration <= 0) {
+            return true;
+        }
+        // Frames cannot be edited in place, the last one is replaced by a copy with the new duration
+        WebPMuxFrameInfo info;
+        if (WebPMuxGetFrame(mux, 0, &info) != WEBP_MUX_OK) {
+            return false;
+        }
+        info.duration += duration;
+        bool ok = WebPMuxDeleteFrame(mux, 0) == WEBP_MUX_OK &&
+                  WebPMuxPushFrame(mux, &info, 1) == WEBP_MUX_OK;
+        WebPDataClear(&info.bitstream);
+        return ok;
+    }
+}
+
+ParallelAnimEncoder::ParallelAnimEncoder(
+        int width,
+        int height,
+        const WebPAnimEncoderOptions &options,
+        int thread_count,
+        ProgressReporter *reporter,
+        AnimStreamWriter *stream_writer,
+        RateController *rate_controller,
+        MemoryTracker *memory_tracker
+) {
+    this->canvasWidth = width;
+    this->canvasHeight = height;
+    this->options = options;
+    this->progressReporter = reporter;
+    this->streamWriter = stream_writer;
+    this->rateController = rate_controller != nullptr && rate_controller->isEnabled() ? rate_controller : nullptr;
+    this->memoryTracker = memory_tracker;
+    // Streamed frames are written as soon as they are encoded and cannot be corrected
+    this->retainPictures = this->rateController != nullptr && stream_writer == nullptr;
+    if (thread_count <= 0) {
+        thread_count = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    }
+    // Keep the workers busy without holding too many full frames in memory
+    maxInFlight = static_cast<size_t>(thread_count) * 2;
+    for (int i = 0; i < thread_count; i++) {
+        workers.emplace_back(&ParallelAnimEncoder::runWorker, this);
+    }
+}
+
+ParallelAnimEncoder::~ParallelAnimEncoder() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopWorkers = true;
+        workAvailable.notify_all();
+    }
+    for (auto &worker: workers) {
+        worker.join();
+    }
+    for (auto &frame: frames) {
+        freePicture(frame.get());
+        clearWriter(frame.get());
+    }
+    if (memoryTracker != nullptr) {
+        memoryTracker->release(previousCanvas.size() * sizeof(uint32_t));
+    }
+}
+
+void ParallelAnimEncoder::trackPicture(Frame *frame) {
+    // Lossy encoding adds YUV(A) planes to the ARGB picture, only the difference is new
+    const size_t bytes = MemoryTracker::pictureByteCount(frame->picture);
+    if (memoryTracker != nullptr) {
+        if (bytes > frame->picture_bytes) {
+            memoryTracker->allocate(bytes - frame->picture_bytes);
+        } else {
+            memoryTracker->release(frame->picture_bytes - bytes);
+        }
+    }
+    frame->picture_bytes = bytes;
+}
+
+void ParallelAnimEncoder::freePicture(Frame *frame) {
+    if (memoryTracker != nullptr) {
+        memoryTracker->release(frame->picture_bytes);
+    }
+    frame->picture_bytes = 0;
+    WebPPictureFree(&frame->picture);
+}
+
+void ParallelAnimEncoder::clearWriter(Frame *frame) {
+    if (memoryTracker != nullptr) {
+        memoryTracker->release(frame->writer.max_size);
+    }
+    WebPMemoryWriterClear(&frame->writer);
+}
+
+bool ParallelAnimEncoder::reduceMemory() {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (maxInFlight == 1 && !retainPictures) {
+        return false;
+    }
+    maxInFlight = 1;
+    retainPictures = false;
+    workFinished.wait(lock, [this] {
+        return pendingFrames.empty() && runningCount == 0;
+    });
+    for (auto &frame: frames) {
+        freePicture(frame.get());
+    }
+    return true;
+}
+
+void ParallelAnimEncoder::setBaseAnimation(
+        const WebPData *base,
+        const std::vector<uint32_t> &last_canvas,
+        int frames_since_keyframe
+) {
+    baseAnimation = base;
+    previousCanvas = last_canvas;
+    if (memoryTracker != nullptr) {
+        memoryTracker->allocate(previousCanvas.size() * sizeof(uint32_t));
+    }
+    framesSinceKeyframe = frames_since_keyframe;
+}
+
+int ParallelAnimEncoder::checkCancelled(int, const WebPPicture *picture) {
+    auto *frame = reinterpret_cast<Frame *>(picture->user_data);
+    return frame->reporter->isCancelled() ? 0 : 1;
+}
+
+void ParallelAnimEncoder::reportFinishedFrames() {
+    // Frames are only added by this thread, workers finish them in any order
+    while (reportedCount < frames.size()) {
+        Frame *frame = frames[reportedCount].get();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!frame->done) return;
+        }
+        reportedCount++;
+        if (frame->result == RESULT_SUCCESS) {
+            progressReporter->update(frame->index, 100);
+        }
+    }
+}
+
+bool ParallelAnimEncoder::isKeyframe(int rect_width, int rect_height) const {
+    const int distance = framesSinceKeyframe + 1;
+    const long rect_area = static_cast<long>(rect_width) * rect_height;
+    const long canvas_area = static_cast<long>(canvasWidth) * canvasHeight;
+    if (options.kmax == 1 || rect_area == canvas_area) {
+        return true;
+    }
+    if (options.kmax > 1 && distance >= options.kmax) {
+        return true;
+    }
+    // A sub-frame covering most of the canvas saves little, restart from a keyframe instead
+    return options.kmax > 1 && distance >= options.kmin && rect_area * 4 >= canvas_area * 3;
+}
+
+ResultCode ParallelAnimEncoder::addFrame(
+        const WebPPicture *picture,
+        long timestamp,
+        const WebPConfig &config,
+        int frame_index
+) {
+    const uint32_t *argb = picture->argb;
+    const int stride = picture->argb_stride;
+    const bool first = previousCanvas.empty();
+
+    // Find the rectangle that changed since the previous frame
+    int left = canvasWidth, top = canvasHeight, right = -1, bottom = -1;
+    if (!first) {
+        for (int y = 0; y < canvasHeight; y++) {
+            const uint32_t *row = argb + y * stride;
+            const uint32_t *prev = previousCanvas.data() + y * canvasWidth;
+            if (memcmp(row, prev, canvasWidth * sizeof(uint32_t)) == 0) continue;
+            int x0 = 0;
+            while (row[x0] == prev[x0]) x0++;
+            int x1 = canvasWidth - 1;
+            while (row[x1] == prev[x1]) x1--;
+            left = std::min(left, x0);
+            right = std::max(right, x1);
+            top = std::min(top, y);
+            bottom = y;
+        }
+        if (right < 0) {
+            // Identical frame, the previous frame is shown until the next timestamp
+            return RESULT_SUCCESS;
+        }
+        // Frame offsets are stored divided by two
+        left &= ~1;
+        top &= ~1;
+    }
+
+    auto frame = std::make_unique<Frame>();
+    frame->index = frame_index;
+    frame->timestamp = timestamp;
+    frame->config = config;
+    frame->predicted_bytes = 0;
+    frame->picture_bytes = 0;
+    frame->result = RESULT_SUCCESS;
+    frame->done = false;
+    frame->reporter = progressReporter;
+    frame->keyframe = first || isKeyframe(right - left + 1, bottom - top + 1);
+    if (frame->keyframe) {
+        left = 0;
+        top = 0;
+        right = canvasWidth - 1;
+        bottom = canvasHeight - 1;
+    }
+    frame->x_offset = left;
+    frame->y_offset = top;
+    const int rect_width = right - left + 1;
+    const int rect_height = bottom - top + 1;
+    frame->width = rect_width;
+    frame->height = rect_height;
+    if (rateController != nullptr && !config.lossless) {
+        frame->config.quality = rateController->startFrame(
+                static_cast<long>(rect_width) * rect_height,
+                config.quality,
+                &frame->predicted_bytes
+        );
+    }
+
+    // Blending lets unchanged pixels be transparent, which is only exact for opaque lossless pixels
+    bool blend = !frame->keyframe && config.lossless;
+    for (int y = top; y <= bottom && blend; y++) {
+        const uint32_t *row = argb + y * stride;
+        for (int x = left; x <= right; x++) {
+            if ((row[x] >> 24) != 0xFF) {
+                blend = false;
+                break;
+            }
+        }
+    }
+    frame->blend = blend ? WEBP_MUX_BLEND : WEBP_MUX_NO_BLEND;
+
+    // Copy the rectangle into the frame picture
+    WebPPicture *pic = &frame->picture;
+    if (!WebPPictureInit(pic)) {
+        return ERROR_VERSION_MISMATCH;
+    }
+    pic->use_argb = true;
+    pic->width = rect_width;
+    pic->height = rect_height;
+    if (!WebPPictureAlloc(pic)) {
+        return ERROR_MEMORY_ERROR;
+    }
+    trackPicture(frame.get());
+    for (int y = 0; y < rect_height; y++) {
+        const uint32_t *src = argb + (top + y) * stride + left;
+        uint32_t *dst = pic->argb + y * pic->argb_stride;
+        if (blend) {
+            const uint32_t *prev = previousCanvas.data() + (top + y) * canvasWidth + left;
+            for (int x = 0; x < rect_width; x++) {
+                dst[x] = src[x] == prev[x] ? 0 : src[x];
+            }
+        } else {
+            memcpy(dst, src, rect_width * sizeof(uint32_t));
+        }
+    }
+    pic->user_data = frame.get();
+    pic->progress_hook = &checkCancelled;
+    WebPMemoryWriterInit(&frame->writer);
+    pic->writer = WebPMemoryWrite;
+    pic->custom_ptr = &frame->writer;
+
+    // Remember the canvas for the next diff
+    if (first && memoryTracker != nullptr) {
+        memoryTracker->allocate(static_cast<size_t>(canvasWidth) * canvasHeight * sizeof(uint32_t));
+    }
+    previousCanvas.resize(static_cast<size_t>(canvasWidth) * canvasHeight);
+    for (int y = 0; y < canvasHeight; y++) {
+        memcpy(previousCanvas.data() + y * canvasWidth, argb + y * stride, canvasWidth * sizeof(uint32_t));
+    }
+    framesSinceKeyframe = frame->keyframe ? 0 : framesSinceKeyframe + 1;
+
+    // Queue for encoding
+    std::unique_lock<std::mutex> lock(mutex);
+    if (streamWriter != nullptr) {
+        // Encoded frames stay in memory until written, so they count towards the limit
+        while (true) {
+            lock.unlock();
+            reportFinishedFrames();
+            ResultCode result = flushFrames(false, 0);
+            lock.lock();
+            if (result != RESULT_SUCCESS) {
+                freePicture(frame.get());
+                return result;
+            }
+            if (frames.size() - flushedCount < maxInFlight) break;
+            workFinished.wait(lock);
+        }
+    } else {
+        while (true) {
+            lock.unlock();
+            reportFinishedFrames();
+            lock.lock();
+            if (pendingFrames.size() + runningCount < maxInFlight) break;
+            workFinished.wait(lock);
+        }
+    }
+    pendingFrames.push_back(frame.get());
+    frames.push_back(std::move(frame));
+    workAvailable.notify_one();
+    return RESULT_SUCCESS;
+}
+
+void ParallelAnimEncoder::runWorker() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        workAvailable.wait(lock, [this] { return stopWorkers || !pendingFrames.empty(); });
+        if (stopWorkers) break;
+        Frame *frame = pendingFrames.front();
+        pendingFrames.pop_front();
+        runningCount++;
+        lock.unlock();
+
+        ResultCode result = RESULT_SUCCESS;
+        if (!WebPEncode(&frame->config, &frame->picture)) {
+            result = res::encodingErrorToResultCode(frame->picture.error_code);
+        }
+        if (memoryTracker != nullptr) {
+            memoryTracker->allocate(frame->writer.max_size);
+        }
+        if (frame->predicted_bytes > 0) {
+            rateController->finishFrame(
+                    frame->config.quality,
+                    static_cast<long>(frame->width) * frame->height,
+                    frame->predicted_bytes,
+                    frame->writer.size
+            );
+            frame->predicted_bytes = 0;
+        }
+
+        lock.lock();
+        if (retainPictures) {
+            trackPicture(frame);
+        } else {
+            freePicture(frame);
+        }
+        frame->result = result;
+        frame->done = true;
+        runningCount--;
+        workFinished.notify_all();
+    }
+}
+
+int ParallelAnimEncoder::frameDuration(size_t index, long end_timestamp) const {
+    long next_timestamp = index + 1 < frames.size() ? frames[index + 1]->timestamp : end_timestamp;
+    return static_cast<int>(std::max(0L, next_timestamp - frames[index]->timestamp));
+}
+
+ResultCode ParallelAnimEncoder::flushFrames(bool final, long end_timestamp) {
+    while (flushedCount < frames.size()) {
+        // The last frame's duration is only known at the end
+        if (!final && flushedCount + 1 == frames.size()) break;
+        Frame *frame = frames[flushedCount].get();
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            if (!frame->done && !final) break;
+            workFinished.wait(lock, [frame] { return frame->done; });
+        }
+        reportFinishedFrames();
+        if (frame->result != RESULT_SUCCESS) {
+            return frame->result;
+        }
+        ResultCode result = streamWriter->writeFrame(
+                frame->writer.mem,
+                frame->writer.size,
+                frame->x_offset,
+                frame->y_offset,
+                frame->width,
+                frame->height,
+                frameDuration(flushedCount, end_timestamp),
+                frame->blend,
+                canvasWidth,
+                canvasHeight
+        );
+        clearWriter(frame);
+        if (result != RESULT_SUCCESS) {
+            return result;
+        }
+        flushedCount++;
+    }
+    return RESULT_SUCCESS;
+}
+
+ResultCode ParallelAnimEncoder::finish(long end_timestamp) {
+    if (streamWriter == nullptr || frames.empty()) {
+        return ERROR_ANIMATION_ASSEMBLE_FAILED;
+    }
+    ResultCode result = flushFrames(true, end_timestamp);
+    if (result == RESULT_SUCCESS) {
+        result = streamWriter->finish();
+    }
+    return result;
+}
+
+size_t ParallelAnimEncoder::getEncodingCount() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return pendingFrames.size() + runningCount;
+}
+
+void ParallelAnimEncoder::waitForEncodes() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!pendingFrames.empty() || runningCount > 0) {
+        workFinished.wait(lock);
+        lock.unlock();
+        reportFinishedFrames();
+        lock.lock();
+    }
+    lock.unlock();
+    reportFinishedFrames();
+}
+
+ResultCode ParallelAnimEncoder::waitForFrames() {
+    waitForEncodes();
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto &frame: frames) {
+        if (frame->result != RESULT_SUCCESS) {
+            return frame->result;
+        }
+    }
+    return RESULT_SUCCESS;
+}
+
+ResultCode ParallelAnimEncoder::muxFrames(long end_timestamp, WebPData *data) {
+    WebPMux *mux = baseAnimation != nullptr ? WebPMuxCreate(baseAnimation, 1) : WebPMuxNew();
+    if (mux == nullptr) {
+        return ERROR_MEMORY_ERROR;
+    }
+    bool ok;
+    if (baseAnimation != nullptr) {
+        // The base keeps its frames, canvas and animation parameters
+        const long first_timestamp = frames.empty() ? end_timestamp : frames[0]->timestamp;
+        ok = extendLastFrame(mux, static_cast<int>(first_timestamp));
+    } else {
+        ok = WebPMuxSetCanvasSize(mux, canvasWidth, canvasHeight) == WEBP_MUX_OK &&
+             WebPMuxSetAnimationParams(mux, &options.anim_params) == WEBP_MUX_OK;
+    }
+    for (size_t i = 0; i < frames.size() && ok; i++) {
+        const Frame *frame = frames[i].get();
+        WebPMuxFrameInfo info;
+        memset(&info, 0, sizeof(info));
+        info.bitstream.bytes = frame->writer.mem;
+        info.bitstream.size = frame->writer.size;
+        info.x_offset = frame->x_offset;
+        info.y_offset = frame->y_offset;
+        info.duration = frameDuration(i, end_timestamp);
+        info.id = WEBP_CHUNK_ANMF;
+        info.dispose_method = WEBP_MUX_DISPOSE_NONE;
+        info.blend_method = frame->blend;
+        ok = WebPMuxPushFrame(mux, &info, 0) == WEBP_MUX_OK;
+    }
+    WebPDataInit(data);
+    ok = ok && WebPMuxAssemble(mux, data) == WEBP_MUX_OK;
+    WebPMuxDelete(mux);
+    return ok ? RESULT_SUCCESS : ERROR_ANIMATION_ASSEMBLE_FAILED;
+}
+
+bool ParallelAnimEncoder::reencodeFrames(size_t excess_bytes) {
+    // Only lossy frames that kept their picture can shrink, so they give up the excess between them
+    size_t lossy_bytes = 0;
+    for (auto &frame: frames) {
+        if (!frame->config.lossless && frame->picture.argb != nullptr) {
+            lossy_bytes += frame->writer.size;
+        }
+    }
+    if (lossy_bytes <= excess_bytes) {
+        return false;
+    }
+    const double scale = CORRECTION_MARGIN * static_cast<double>(lossy_bytes - excess_bytes) / lossy_bytes;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    bool queued = false;
+    for (auto &frame: frames) {
+        if (frame->config.lossless || frame->config.quality <= 0 || frame->picture.argb == nullptr) continue;
+        frame->config.quality = RateController::scaleQuality(frame->config.quality, scale);
+        clearWriter(frame.get());
+        WebPMemoryWriterInit(&frame->writer);
+        frame->done = false;
+        pendingFrames.push_back(frame.get());
+        queued = true;
+    }
+    workAvailable.notify_all();
+    return queued;
+}
+
+ResultCode ParallelAnimEncoder::assemble(long end_timestamp, WebPData *data) {
+    if (streamWriter != nullptr) {
+        return ERROR_ANIMATION_ASSEMBLE_FAILED;
+    }
+    ResultCode result = waitForFrames();
+    if (result != RESULT_SUCCESS) {
+        return result;
+    }
+    if (frames.empty() && baseAnimation == nullptr) {
+        return ERROR_ANIMATION_ASSEMBLE_FAILED;
+    }
+    result = muxFrames(end_timestamp, data);
+
+    // Re-encode lossy frames at a lower quality while the animation is over the budget
+    const size_t budget = rateController != nullptr ? rateController->getBudget() : 0;
+    for (int pass = 0; result == RESULT_SUCCESS && budget > 0 && data->size > budget; pass++) {
+        const size_t excess_bytes = data->size - budget;
+        WebPDataClear(data);
+        if (pass == MAX_CORRECTION_PASSES || !reencodeFrames(excess_bytes)) {
+            return ERROR_SIZE_BUDGET_EXCEEDED;
+        }
+        result = waitForFrames();
+        if (result == RESULT_SUCCESS) {
+            result = muxFrames(end_timestamp, data);
+        }
+    }
+    return result;
+}
@@ -0,0 +1,169 @@
+//
+// Created by udara on 10/19/26.
+//
+
+#include <cstring>
+
+#include "include/picture_import.h"
+#include "include/box_filter.h"
+
+ResultCode enc::importPicture(
+        const uint8_t *pixels,
+        int image_width,
+        int image_height,
+        int stride,
+        int output_width,
+        int output_height,
+        WebPPicture *pic
+) {
+    pic->use_argb = true;
+
+    // Box filter integer downscales during import
+    int factor = bmp::boxDownscaleFactor(image_width, image_height, output_width, output_height);
+    if (factor > 0) {
+        pic->width = output_width;
+        pic->height = output_height;
+        if (!WebPPictureAlloc(pic)) {
+            return ERROR_MEMORY_ERROR;
+        }
+        bmp::boxDownscale(
+                pixels,
+                stride,
+                factor,
+                pic->argb,
+                output_width,
+                output_height,
+                pic->argb_stride
+        );
+        return RESULT_SUCCESS;
+    }
+
+    pic->width = image_width;
+    pic->height = image_height;
+    if (!WebPPictureAlloc(pic)) {
+        return ERROR_MEMORY_ERROR;
+    }
+    if (!WebPPictureImportRGBA(pic, pixels, stride)) {
+        return ERROR_MEMORY_ERROR;
+    }
+    if ((image_width != output_width || image_height != output_height) && !WebPPictureRescale(pic, output_width, output_height)) {
+        return ERROR_BITMAP_RESIZE_FAILED;
+    }
+    return RESULT_SUCCESS;
+}
+
+void enc::resolveStrides(RawFrame *frame) {
+    const int chroma_width = (frame->width + 1) / 2;
+    switch (frame->format) {
+        case PIXEL_FORMAT_RGBA_8888:
+            if (frame->row_stride <= 0) frame->row_stride = frame->width * 4;
+            frame->uv_row_stride = 0;
+            break;
+        case PIXEL_FORMAT_NV21:
+            if (frame->row_stride <= 0) frame->row_stride = frame->width;
+            if (frame->uv_row_stride <= 0) frame->uv_row_stride = chroma_width * 2;
+            break;
+        case PIXEL_FORMAT_I420:
+            if (frame->row_stride <= 0) frame->row_stride = frame->width;
+            if (frame->uv_row_stride <= 0) frame->uv_row_stride = chroma_width;
+            break;
+    }
+}
+
+size_t enc::rawFrameByteCount(const RawFrame &frame) {
+    const size_t chroma_height = (frame.height + 1) / 2;
+    const size_t luma_size = static_cast<size_t>(frame.row_stride) * frame.height;
+    switch (frame.format) {
+        case PIXEL_FORMAT_NV21:
+            return luma_size + static_cast<size_t>(frame.uv_row_stride) * chroma_height;
+        case PIXEL_FORMAT_I420:
+            return luma_size + 2 * static_cast<size_t>(frame.uv_row_stride) * chroma_height;
+        default:
+            return luma_size;
+    }
+}
+
+namespace {
+    void copyPlane(const uint8_t *src, int src_stride, uint8_t *dst, int dst_stride, int row_size, int rows) {
+        for (int y = 0; y < rows; y++) {
+            memcpy(dst + static_cast<size_t>(y) * dst_stride, src + static_cast<size_t>(y) * src_stride, row_size);
+        }
+    }
+}
+
+enc::RawFrame enc::packRawFrame(const RawFrame &frame, uint8_t *dst) {
+    RawFrame packed = {dst, frame.width, frame.height, frame.format, 0, 0};
+    resolveStrides(&packed);
+    const int chroma_height = (frame.height + 1) / 2;
+    const int row_size = frame.format == PIXEL_FORMAT_RGBA_8888 ? frame.width * 4 : frame.width;
+    copyPlane(frame.data, frame.row_stride, dst, packed.row_stride, row_size, frame.height);
+    const uint8_t *src_chroma = frame.data + static_cast<size_t>(frame.row_stride) * frame.height;
+    uint8_t *dst_chroma = dst + static_cast<size_t>(packed.row_stride) * frame.height;
+    if (frame.format == PIXEL_FORMAT_NV21) {
+        copyPlane(src_chroma, frame.uv_row_stride, dst_chroma, packed.uv_row_stride, packed.uv_row_stride, chroma_height);
+    } else if (frame.format == PIXEL_FORMAT_I420) {
+        for (int plane = 0; plane < 2; plane++) {
+            copyPlane(
+                    src_chroma + static_cast<size_t>(plane) * frame.uv_row_stride * chroma_height,
+                    frame.uv_row_stride,
+                    dst_chroma + static_cast<size_t>(plane) * packed.uv_row_stride * chroma_height,
+                    packed.uv_row_stride,
+                    packed.uv_row_stride,
+                    chroma_height
+            );
+        }
+    }
+    return packed;
+}
+
+ResultCode enc::importRawFrame(
+        const RawFrame &frame,
+        int output_width,
+        int output_height,
+        WebPPicture *pic
+) {
+    if (frame.format == PIXEL_FORMAT_RGBA_8888) {
+        return importPicture(
+                frame.data,
+                frame.width,
+                frame.height,
+                frame.row_stride,
+                output_width,
+                output_height,
+                pic
+        );
+    }
+
+    // Write the samples straight into the YUV planes
+    pic->use_argb = false;
+    pic->colorspace = WEBP_YUV420;
+    pic->width = frame.width;
+    pic->height = frame.height;
+    if (!WebPPictureAlloc(pic)) {
+        return ERROR_MEMORY_ERROR;
+    }
+    const int chroma_width = (frame.width + 1) / 2;
+    const int chroma_height = (frame.height + 1) / 2;
+    copyPlane(frame.data, frame.row_stride, pic->y, pic->y_stride, frame.width, frame.height);
+    const uint8_t *chroma = frame.data + static_cast<size_t>(frame.row_stride) * frame.height;
+    if (frame.format == PIXEL_FORMAT_NV21) {
+        for (int y = 0; y < chroma_height; y++) {
+            const uint8_t *vu = chroma + static_cast<size_t>(y) * frame.uv_row_stride;
+            uint8_t *u = pic->u + y * pic->uv_stride;
+            uint8_t *v = pic->v + y * pic->uv_stride;
+            for (int x = 0; x < chroma_width; x++) {
+                v[x] = vu[2 * x];
+                u[x] = vu[2 * x + 1];
+            }
+        }
+    } else {
+        const size_t plane_size = static_cast<size_t>(frame.uv_row_stride) * chroma_height;
+        copyPlane(chroma, frame.uv_row_stride, pic->u, pic->uv_stride, chroma_width, chroma_height);
+        copyPlane(chroma + plane_size, frame.uv_row_stride, pic->v, pic->uv_stride, chroma_width, chroma_height);
+    }
+
+    if ((frame.width != output_width || frame.height != output_height) && !WebPPictureRescale(pic, output_width, output_height)) {
+        return ERROR_BITMAP_RESIZE_FAILED;
+    }
+    return RESULT_SUCCESS;
+}
@@ -0,0 +1,22 @@
+//
+// Created by udara on 10/19/26.
+//
+
+#include "include/progress_listener.h"
+
+ProgressReporter::Listener prog::javaListener(
+        JNIEnv *env,
+        jobject observer,
+        jmethodID notify_method_id,
+        bool frame_progress
+) {
+    return [env, observer, notify_method_id, frame_progress](int frame_index, int percent) {
+        jboolean proceed;
+        if (frame_progress) {
+            proceed = env->CallBooleanMethod(observer, notify_method_id, frame_index, percent);
+        } else {
+            proceed = env->CallBooleanMethod(observer, notify_method_id, percent);
+        }
+        return proceed != JNI_FALSE;
+    };
+}
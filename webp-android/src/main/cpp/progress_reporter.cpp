@@ -0,0 +1,93 @@
+//
+// Created by udara on 10/19/26.
+//
+
+#include "include/progress_reporter.h"
+
+namespace {
+    constexpr uint64_t NO_PROGRESS = UINT64_MAX;
+
+    uint64_t packProgress(int frame_index, int percent) {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(frame_index)) << 32) |
+               static_cast<uint32_t>(percent);
+    }
+
+    int unpackFrameIndex(uint64_t progress) {
+        return static_cast<int>(static_cast<uint32_t>(progress >> 32));
+    }
+
+    int unpackPercent(uint64_t progress) {
+        return static_cast<int>(static_cast<uint32_t>(progress));
+    }
+}
+
+void ProgressReporter::setInterval(long interval_millis, int percent_step) {
+    interval_millis_ = interval_millis < 0 ? 0 : interval_millis;
+    percent_step_ = percent_step < 1 ? 1 : percent_step;
+}
+
+void ProgressReporter::attach(Listener listener) {
+    attached_.store(false, std::memory_order_release);
+    listener_ = std::move(listener);
+    has_delivered_ = false;
+    progress_.store(NO_PROGRESS, std::memory_order_relaxed);
+    abort_flag_.store(false, std::memory_order_relaxed);
+    owner_thread_id_.store(std::this_thread::get_id(), std::memory_order_relaxed);
+    attached_.store(true, std::memory_order_release);
+}
+
+void ProgressReporter::detach() {
+    if (!attached_.load(std::memory_order_acquire)) return;
+    attached_.store(false, std::memory_order_release);
+    owner_thread_id_.store(std::thread::id(), std::memory_order_relaxed);
+    if (!isCancelled()) {
+        uint64_t progress = progress_.load(std::memory_order_relaxed);
+        if (progress != NO_PROGRESS && (!has_delivered_ || progress != last_progress_)) {
+            deliver(progress);
+        }
+    }
+    listener_ = nullptr;
+}
+
+int ProgressReporter::update(int frame_index, int percent) {
+    uint64_t progress = packProgress(frame_index, percent);
+    progress_.store(progress, std::memory_order_relaxed);
+
+    // Ticks from libwebp worker threads are picked up by the owner thread.
+    if (attached_.load(std::memory_order_acquire) &&
+        owner_thread_id_.load(std::memory_order_relaxed) == std::this_thread::get_id()) {
+        bool due;
+        if (!has_delivered_ || unpackFrameIndex(progress) != unpackFrameIndex(last_progress_)) {
+            due = true;
+        } else {
+            int step = unpackPercent(progress) - unpackPercent(last_progress_);
+            due = step >= percent_step_ || (percent == 100 && step > 0);
+            if (due && interval_millis_ > 0) {
+                auto elapsed = std::chrono::steady_clock::now() - last_delivery_time_;
+                due = percent == 100 || elapsed >= std::chrono::milliseconds(interval_millis_);
+            }
+        }
+        if (due) {
+            deliver(progress);
+        }
+    }
+    return isCancelled() ? 0 : 1;
+}
+
+void ProgressReporter::deliver(uint64_t progress) {
+    if (!listener_(unpackFrameIndex(progress), unpackPercent(progress))) {
+        abort_flag_.store(true, std::memory_order_relaxed);
+    }
+    last_progress_ = progress;
+    last_delivery_time_ = std::chrono::steady_clock::now();
+    has_delivered_ = true;
+}
+
+void ProgressReporter::cancel() {
+    cancel_flag_.store(true, std::memory_order_relaxed);
+}
+
+bool ProgressReporter::isCancelled() const {
+    return cancel_flag_.load(std::memory_order_relaxed) ||
+           abort_flag_.load(std::memory_order_relaxed);
+}
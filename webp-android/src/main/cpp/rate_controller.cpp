@@ -0,0 +1,87 @@
+//
+// Created by udara on 10/19/26.
+//
+
+#include <algorithm>
+#include <cmath>
+
+#include "include/rate_controller.h"
+
+namespace {
+    // Lossy frames roughly double in size for every 20 quality points
+    const double SLOPE = std::log(2.0) / 20.0;
+
+    // About one bit per pixel at quality 75 before any frame is measured
+    const double INITIAL_OFFSET = std::log(0.125) - SLOPE * 75.0;
+
+    constexpr double MODEL_ADAPTATION = 0.3;
+
+    // RIFF, VP8X and ANIM chunks, then ANMF and bitstream chunk headers per frame
+    constexpr size_t CONTAINER_BYTES = 64;
+    constexpr size_t FRAME_HEADER_BYTES = 32;
+}
+
+RateController::RateController() : offset(INITIAL_OFFSET) {}
+
+void RateController::setBudget(size_t budget_bytes, int expected_frames) {
+    std::lock_guard<std::mutex> lock(mutex);
+    budgetBytes = budget_bytes;
+    expectedFrames = std::max(1, expected_frames);
+    startedFrames = 0;
+    startedPixels = 0;
+    spentBytes = 0;
+    pendingBytes = 0;
+    offset = INITIAL_OFFSET;
+}
+
+bool RateController::isEnabled() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return budgetBytes > 0;
+}
+
+size_t RateController::getBudget() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return budgetBytes;
+}
+
+float RateController::startFrame(long pixel_count, float max_quality, size_t *predicted_bytes) {
+    std::lock_guard<std::mutex> lock(mutex);
+    pixel_count = std::max(1L, pixel_count);
+
+    // Share what is left between this frame and the remaining ones, weighted by area
+    const size_t overhead = CONTAINER_BYTES + FRAME_HEADER_BYTES * std::max(expectedFrames, startedFrames + 1);
+    const size_t used = overhead + spentBytes + pendingBytes;
+    const double remaining = budgetBytes > used ? static_cast<double>(budgetBytes - used) : 0.0;
+    const int remaining_frames = std::max(1, expectedFrames - startedFrames);
+    const double average_pixels = startedFrames > 0
+                                  ? static_cast<double>(startedPixels) / startedFrames
+                                  : static_cast<double>(pixel_count);
+    const double share = pixel_count / (pixel_count + (remaining_frames - 1) * average_pixels);
+    const double target_bytes = remaining * share;
+
+    float quality = 0.0f;
+    if (target_bytes > 0) {
+        quality = static_cast<float>((std::log(target_bytes / pixel_count) - offset) / SLOPE);
+    }
+    quality = std::max(0.0f, std::min(max_quality, quality));
+
+    *predicted_bytes = static_cast<size_t>(std::exp(offset + SLOPE * quality) * pixel_count);
+    pendingBytes += *predicted_bytes;
+    startedFrames++;
+    startedPixels += pixel_count;
+    return quality;
+}
+
+void RateController::finishFrame(float quality, long pixel_count, size_t predicted_bytes, size_t encoded_bytes) {
+    std::lock_guard<std::mutex> lock(mutex);
+    pendingBytes -= std::min(pendingBytes, predicted_bytes);
+    spentBytes += encoded_bytes;
+    if (encoded_bytes > 0 && pixel_count > 0) {
+        const double residual = std::log(static_cast<double>(encoded_bytes) / pixel_count) - (offset + SLOPE * quality);
+        offset += MODEL_ADAPTATION * residual;
+    }
+}
+
+float RateController::scaleQuality(float quality, double scale) {
+    return std::max(0.0f, static_cast<float>(quality + std::log(scale) / SLOPE));
+}
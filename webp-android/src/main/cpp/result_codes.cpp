@@ -3,7 +3,6 @@
 //
 
 #include "include/result_codes.h"
-#include "include/exception_helper.h"
 
 std::string res::parseMessage(ResultCode result_code) {
     switch (result_code) {
@@ -75,22 +74,23 @@ std::string res::parseMessage(ResultCode result_code) {
             return "Failed to set decoder data";
         case ERROR_DATA_SOURCE_NOT_SET:
             return "Decoder data source not set";
+        case ERROR_INVALID_FRAME_BUFFER:
+            return "Frame buffer does not match the declared size or format";
+        case ERROR_SIZE_BUDGET_EXCEEDED:
+            return "Animation does not fit in the size budget";
+        case ERROR_NOT_AN_ANIMATION:
+            return "Source is not an animated WebP image";
+        case ERROR_INVALID_FRAME_RANGE:
+            return "Frame range is empty or does not start at a keyframe";
+        case ERROR_MEMORY_LIMIT_EXCEEDED:
+            return "Encoder memory limit exceeded";
+        case ERROR_STREAM_FINISHED:
+            return "Streaming output is finished";
         default:
             return "Remove ";
     }
 }
 
-void res::handleResult(JNIEnv *env, ResultCode result) {
-    if (result != RESULT_SUCCESS) {
-        std::string message = parseMessage(result);
-        if (result == ERROR_USER_ABORT) {
-            exc::throwCancellationException(env, message.c_str());
-        } else {
-            exc::throwRuntimeException(env, message.c_str());
-        }
-    }
-}
-
 ResultCode res::encodingErrorToResultCode(WebPEncodingError error_code) {
     switch (error_code) {
         case VP8_ENC_OK:
@@ -0,0 +1,149 @@
+//
+// Created by udara on 10/19/26.
+//
+
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+
+#include "include/speed_model.h"
+
+namespace {
+    constexpr int CALIBRATION_SIZE = 160;
+    constexpr float CALIBRATION_QUALITY = 75.0f;
+    constexpr double OBSERVATION_WEIGHT = 0.3;
+
+    std::mutex model_mutex;
+    float ns_per_pixel[speed::MODEL_SIZE];
+    bool calibrated = false;
+
+    int modelIndex(bool lossless, int method) {
+        return (lossless ? speed::METHOD_COUNT : 0) + std::clamp(method, 0, speed::METHOD_COUNT - 1);
+    }
+
+    /**
+     * Fills the picture with gradients and noise so that each method has real work to do.
+     */
+    void fillSyntheticPicture(WebPPicture *pic) {
+        uint32_t seed = 0x9E3779B9u;
+        for (int y = 0; y < pic->height; y++) {
+            uint32_t *row = pic->argb + y * pic->argb_stride;
+            for (int x = 0; x < pic->width; x++) {
+                seed ^= seed << 13;
+                seed ^= seed >> 17;
+                seed ^= seed << 5;
+                uint32_t noise = (x / 8 + y / 8) % 2 == 0 ? (seed & 0x1F) : 0;
+                uint32_t r = (x * 255 / pic->width + noise) & 0xFF;
+                uint32_t g = (y * 255 / pic->height + noise) & 0xFF;
+                uint32_t b = ((x + y) * 127 / pic->width) & 0xFF;
+                row[x] = 0xFF000000u | (r << 16) | (g << 8) | b;
+            }
+        }
+    }
+
+    double encodeMillis(const WebPPicture *source, bool lossless, int method) {
+        WebPConfig config;
+        if (!WebPConfigInit(&config)) return -1;
+        config.lossless = lossless;
+        config.method = method;
+        config.quality = CALIBRATION_QUALITY;
+        config.thread_level = 1;
+
+        WebPPicture pic;
+        if (!WebPPictureInit(&pic) || !WebPPictureCopy(source, &pic)) return -1;
+        WebPMemoryWriter wtr;
+        WebPMemoryWriterInit(&wtr);
+        pic.writer = WebPMemoryWrite;
+        pic.custom_ptr = &wtr;
+
+        auto start = std::chrono::steady_clock::now();
+        int ok = WebPEncode(&config, &pic);
+        auto elapsed = std::chrono::steady_clock::now() - start;
+
+        WebPMemoryWriterClear(&wtr);
+        WebPPictureFree(&pic);
+        if (!ok) return -1;
+        return std::chrono::duration<double, std::milli>(elapsed).count();
+    }
+}
+
+void speed::calibrate() {
+    WebPPicture source;
+    if (!WebPPictureInit(&source)) return;
+    source.use_argb = true;
+    source.width = CALIBRATION_SIZE;
+    source.height = CALIBRATION_SIZE;
+    if (!WebPPictureAlloc(&source)) return;
+    fillSyntheticPicture(&source);
+
+    // Warm up caches and lazily initialized dsp tables
+    encodeMillis(&source, false, 0);
+
+    float model[MODEL_SIZE];
+    const double pixel_count = CALIBRATION_SIZE * CALIBRATION_SIZE;
+    bool ok = true;
+    for (int lossless = 0; lossless <= 1 && ok; lossless++) {
+        for (int method = 0; method < METHOD_COUNT && ok; method++) {
+            double millis = encodeMillis(&source, lossless, method);
+            ok = millis >= 0;
+            model[modelIndex(lossless, method)] = static_cast<float>(millis * 1e6 / pixel_count);
+        }
+    }
+    WebPPictureFree(&source);
+
+    if (ok) {
+        setModel(model);
+    }
+}
+
+bool speed::isCalibrated() {
+    std::lock_guard<std::mutex> lock(model_mutex);
+    return calibrated;
+}
+
+void speed::getModel(float *model) {
+    std::lock_guard<std::mutex> lock(model_mutex);
+    std::copy(ns_per_pixel, ns_per_pixel + MODEL_SIZE, model);
+}
+
+void speed::setModel(const float *model) {
+    std::lock_guard<std::mutex> lock(model_mutex);
+    std::copy(model, model + MODEL_SIZE, ns_per_pixel);
+    calibrated = true;
+}
+
+speed::DeadlinePlan speed::planForDeadline(
+        const WebPConfig &config,
+        size_t pixel_count,
+        long deadline_millis
+) {
+    std::lock_guard<std::mutex> lock(model_mutex);
+    DeadlinePlan plan = {config.method, config.quality, 0};
+    if (!calibrated) return plan;
+
+    // Methods are roughly ordered by cost, so the first one that fits is the best one
+    const bool lossless = config.lossless != 0;
+    for (int method = std::clamp(config.method, 0, METHOD_COUNT - 1); method >= 0; method--) {
+        plan.method = method;
+        plan.predicted_millis = ns_per_pixel[modelIndex(lossless, method)] * pixel_count / 1e6;
+        if (plan.predicted_millis <= deadline_millis) {
+            return plan;
+        }
+    }
+
+    // Lossless quality controls the compression effort, scale it down to the remaining budget
+    if (lossless && plan.predicted_millis > 0) {
+        double ratio = deadline_millis / plan.predicted_millis;
+        plan.quality = static_cast<float>(std::max(0.0, config.quality * ratio));
+    }
+    return plan;
+}
+
+void speed::observe(bool lossless, int method, size_t pixel_count, double elapsed_millis) {
+    if (pixel_count == 0) return;
+    std::lock_guard<std::mutex> lock(model_mutex);
+    if (!calibrated) return;
+    float &value = ns_per_pixel[modelIndex(lossless, method)];
+    double measured = elapsed_millis * 1e6 / static_cast<double>(pixel_count);
+    value = static_cast<float>(value * (1 - OBSERVATION_WEIGHT) + measured * OBSERVATION_WEIGHT);
+}
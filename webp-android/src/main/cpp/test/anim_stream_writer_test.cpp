@@ -0,0 +1,109 @@
+//
+// Created by udara on 10/19/26.
+//
+
+#include <cstdio>
+#include <cstring>
+#include <gtest/gtest.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "anim_stream_writer.h"
+
+namespace {
+    /**
+     * A still image with a 5 byte VP8L chunk, the writer only looks at the chunk headers.
+     */
+    std::vector<uint8_t> makeStill(bool alpha) {
+        std::vector<uint8_t> still = {
+                'R', 'I', 'F', 'F', 18, 0, 0, 0, 'W', 'E', 'B', 'P',
+                'V', 'P', '8', 'L', 5, 0, 0, 0, 0x2f, 0, 0, 0, 0, 0
+        };
+        // Alpha hint bit of the VP8L header
+        still[24] = alpha ? 0x10 : 0x00;
+        return still;
+    }
+
+    ResultCode writeAnimation(AnimStreamWriter *writer) {
+        for (int i = 0; i < 3; i++) {
+            std::vector<uint8_t> still = makeStill(i == 1);
+            ResultCode result = writer->writeFrame(
+                    still.data(), still.size(), 0, 0, 4, 4, 100, WEBP_MUX_NO_BLEND, 4, 4
+            );
+            if (result != RESULT_SUCCESS) return result;
+        }
+        return writer->finish();
+    }
+
+    std::vector<uint8_t> readAll(int fd) {
+        std::vector<uint8_t> bytes;
+        uint8_t chunk[256];
+        ssize_t count;
+        while ((count = read(fd, chunk, sizeof(chunk))) > 0) {
+            bytes.insert(bytes.end(), chunk, chunk + count);
+        }
+        return bytes;
+    }
+
+    WebPMuxAnimParams makeAnimParams() {
+        WebPMuxAnimParams params;
+        params.bgcolor = 0xFFFFFFFF;
+        params.loop_count = 0;
+        return params;
+    }
+}
+
+TEST(AnimStreamWriterTest, PipeMatchesFile) {
+    // Seekable output, patched in place
+    FILE *file = tmpfile();
+    ASSERT_NE(nullptr, file);
+    AnimStreamWriter file_writer(fileno(file), makeAnimParams());
+    EXPECT_TRUE(file_writer.isSeekable());
+    ASSERT_EQ(RESULT_SUCCESS, writeAnimation(&file_writer));
+    ASSERT_EQ(0, lseek(fileno(file), 0, SEEK_SET));
+    std::vector<uint8_t> expected = readAll(fileno(file));
+    fclose(file);
+
+    // Pipe output, buffered until finish
+    int fds[2];
+    ASSERT_EQ(0, pipe(fds));
+    std::vector<uint8_t> actual;
+    std::thread reader([&actual, fds] { actual = readAll(fds[0]); });
+    AnimStreamWriter pipe_writer(fds[1], makeAnimParams());
+    EXPECT_FALSE(pipe_writer.isSeekable());
+    EXPECT_EQ(RESULT_SUCCESS, writeAnimation(&pipe_writer));
+    close(fds[1]);
+    reader.join();
+    close(fds[0]);
+
+    ASSERT_GT(expected.size(), 30u);
+    EXPECT_EQ(expected, actual);
+    // RIFF size and alpha flag were patched
+    EXPECT_EQ(expected.size() - 8, expected[4] | (expected[5] << 8u));
+    EXPECT_EQ(ANIMATION_FLAG | ALPHA_FLAG, expected[20]);
+}
+
+TEST(AnimStreamWriterTest, RejectsFrameBeyondRiffLimit) {
+    FILE *file = tmpfile();
+    ASSERT_NE(nullptr, file);
+    AnimStreamWriter writer(fileno(file), makeAnimParams());
+    std::vector<uint8_t> still = makeStill(false);
+    ASSERT_EQ(RESULT_SUCCESS, writer.writeFrame(
+            still.data(), still.size(), 0, 0, 4, 4, 100, WEBP_MUX_NO_BLEND, 4, 4
+    ));
+    const off_t frame_end = lseek(fileno(file), 0, SEEK_CUR);
+
+    // Only the RIFF header of the oversized frame is read, it is rejected before anything is written
+    EXPECT_EQ(ERROR_FILE_TOO_BIG, writer.writeFrame(
+            still.data(), UINT32_MAX, 0, 0, 4, 4, 100, WEBP_MUX_NO_BLEND, 4, 4
+    ));
+    EXPECT_EQ(frame_end, lseek(fileno(file), 0, SEEK_CUR));
+
+    // The frames written so far still form a valid container
+    ASSERT_EQ(RESULT_SUCCESS, writer.finish());
+    ASSERT_EQ(0, lseek(fileno(file), 0, SEEK_SET));
+    std::vector<uint8_t> bytes = readAll(fileno(file));
+    fclose(file);
+    EXPECT_EQ(bytes.size() - 8, bytes[4] | (bytes[5] << 8u));
+}
@@ -0,0 +1,70 @@
+//
+// Created by udara on 10/19/26.
+//
+
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+
+#include "box_filter.h"
+
+namespace {
+    /**
+     * Alpha weighted average of one block, the definition boxDownscale implements.
+     */
+    uint32_t averageBlock(const std::vector<uint8_t> &pixels, int stride, int factor, int x, int y) {
+        uint32_t r = 0, g = 0, b = 0, a = 0;
+        for (int row = 0; row < factor; row++) {
+            for (int col = 0; col < factor; col++) {
+                const uint8_t *p = pixels.data() + (y * factor + row) * stride + (x * factor + col) * 4;
+                r += p[0] * p[3];
+                g += p[1] * p[3];
+                b += p[2] * p[3];
+                a += p[3];
+            }
+        }
+        if (a == 0) return 0;
+        const uint32_t area = factor * factor;
+        return ((a + area / 2) / area) << 24 | ((r + a / 2) / a) << 16 | ((g + a / 2) / a) << 8 | (b + a / 2) / a;
+    }
+}
+
+TEST(BoxFilterTest, DownscaleFactor) {
+    EXPECT_EQ(2, bmp::boxDownscaleFactor(1024, 768, 512, 384));
+    EXPECT_EQ(16, bmp::boxDownscaleFactor(160, 160, 10, 10));
+    EXPECT_EQ(0, bmp::boxDownscaleFactor(1024, 768, 511, 383));
+    EXPECT_EQ(0, bmp::boxDownscaleFactor(1024, 768, 512, 192));
+    EXPECT_EQ(0, bmp::boxDownscaleFactor(64, 64, 64, 64));
+    EXPECT_EQ(0, bmp::boxDownscaleFactor(340, 340, 10, 10));
+}
+
+TEST(BoxFilterTest, MatchesBlockAverage) {
+    std::mt19937 random(7);
+    for (int factor: {2, 3, 4, 8, 16}) {
+        // Odd output widths leave a pixel for the scalar tail after the vector loop
+        for (int dst_width: {1, 5, 16}) {
+            const int dst_height = 3;
+            const int stride = dst_width * factor * 4 + 8;
+            std::vector<uint8_t> pixels(stride * dst_height * factor);
+            for (auto &value: pixels) value = static_cast<uint8_t>(random());
+            // Fully transparent and fully opaque blocks
+            for (int row = 0; row < factor; row++) {
+                for (int col = 0; col < factor; col++) {
+                    pixels[row * stride + col * 4 + 3] = 0;
+                    pixels[(factor + row) * stride + col * 4 + 3] = 255;
+                }
+            }
+
+            const int dst_stride = dst_width + 1;
+            std::vector<uint32_t> argb(dst_stride * dst_height);
+            bmp::boxDownscale(pixels.data(), stride, factor, argb.data(), dst_width, dst_height, dst_stride);
+            for (int y = 0; y < dst_height; y++) {
+                for (int x = 0; x < dst_width; x++) {
+                    ASSERT_EQ(averageBlock(pixels, stride, factor, x, y), argb[y * dst_stride + x])
+                                                << "factor " << factor << " at " << x << "," << y;
+                }
+            }
+            EXPECT_EQ(0u, argb[0]);
+        }
+    }
+}
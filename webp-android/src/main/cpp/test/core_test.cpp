@@ -0,0 +1,175 @@
+//
+// Created by udara on 10/19/26.
+//
+
+#include <cstring>
+#include <gtest/gtest.h>
+#include <webp/encode.h>
+#include <webp/mux.h>
+
+#include "include/test_images.h"
+#include "webp_anim_encoder_core.h"
+#include "webp_decoder_core.h"
+#include "webp_encoder_core.h"
+
+namespace {
+    constexpr int WIDTH = 64;
+    constexpr int HEIGHT = 48;
+
+    WebPConfig losslessConfig() {
+        WebPConfig config;
+        WebPConfigInit(&config);
+        config.lossless = 1;
+        config.exact = 1;
+        return config;
+    }
+
+    /**
+     * Exposes the memory tracker of the encoder.
+     */
+    class TrackedAnimationEncoder : public WebPAnimationEncoderCore {
+    public:
+        using WebPAnimationEncoderCore::WebPAnimationEncoderCore;
+
+        size_t getResidentBytes() const {
+            return memoryTracker.getCurrent();
+        }
+    };
+}
+
+TEST(CoreTest, EncodeDecodeStillImage) {
+    std::vector<uint8_t> pixels = test::makeGradient(WIDTH, HEIGHT);
+    WebPEncoderCore encoder(WIDTH, HEIGHT);
+    encoder.configure(losslessConfig());
+    const uint8_t *webp_data = nullptr;
+    size_t webp_size = 0;
+    ASSERT_EQ(RESULT_SUCCESS, encoder.encode(pixels.data(), WIDTH, HEIGHT, WIDTH, HEIGHT, &webp_data, &webp_size));
+    encoder.release();
+
+    WebPDecoderCore decoder;
+    ASSERT_EQ(RESULT_SUCCESS, decoder.setData(webp_data, webp_size));
+    EXPECT_EQ(WIDTH, decoder.getFeatures().width);
+    EXPECT_EQ(HEIGHT, decoder.getFeatures().height);
+    EXPECT_FALSE(decoder.getFeatures().has_animation);
+
+    const uint8_t *decoded = nullptr;
+    int timestamp = -1;
+    ASSERT_TRUE(decoder.hasNextFrame());
+    ASSERT_EQ(RESULT_SUCCESS, decoder.decodeNextFrame(&decoded, &timestamp));
+    EXPECT_EQ(0, timestamp);
+    EXPECT_EQ(0, std::memcmp(pixels.data(), decoded, pixels.size()));
+    EXPECT_FALSE(decoder.hasNextFrame());
+
+    decoder.clearData();
+    WebPFree((void *) webp_data);
+}
+
+TEST(CoreTest, EncodeDecodeAnimation) {
+    constexpr int FRAME_COUNT = 3;
+    constexpr int FRAME_DURATION = 100;
+    WebPAnimEncoderOptions options;
+    WebPAnimEncoderOptionsInit(&options);
+    WebPAnimationEncoderCore encoder(WIDTH, HEIGHT, options);
+    encoder.configure(losslessConfig());
+
+    std::vector<std::vector<uint8_t>> frames;
+    for (int i = 0; i < FRAME_COUNT; i++) {
+        frames.push_back(test::makeGradient(WIDTH, HEIGHT, i));
+        enc::RawFrame frame = {frames[i].data(), WIDTH, HEIGHT, enc::PIXEL_FORMAT_RGBA_8888, 0, 0};
+        enc::resolveStrides(&frame);
+        ASSERT_EQ(RESULT_SUCCESS, encoder.addFrame(frame, WIDTH, HEIGHT, i * FRAME_DURATION));
+    }
+    WebPData animation;
+    WebPDataInit(&animation);
+    ASSERT_EQ(RESULT_SUCCESS, encoder.assemble(FRAME_COUNT * FRAME_DURATION, &animation));
+    encoder.release();
+
+    WebPDecoderCore decoder;
+    ASSERT_EQ(RESULT_SUCCESS, decoder.setData(animation.bytes, animation.size));
+    ASSERT_EQ(FRAME_COUNT, static_cast<int>(decoder.getAnimInfo().frame_count));
+    for (int i = 0; i < FRAME_COUNT; i++) {
+        const uint8_t *decoded = nullptr;
+        int timestamp = 0;
+        ASSERT_EQ(RESULT_SUCCESS, decoder.decodeNextFrame(&decoded, &timestamp));
+        EXPECT_EQ((i + 1) * FRAME_DURATION, timestamp);
+        EXPECT_EQ(0, std::memcmp(frames[i].data(), decoded, frames[i].size()));
+    }
+    EXPECT_FALSE(decoder.hasNextFrame());
+
+    decoder.clearData();
+    WebPDataClear(&animation);
+}
+
+TEST(CoreTest, SequentialEncoderReleasesItsCharge) {
+    WebPAnimEncoderOptions options;
+    WebPAnimEncoderOptionsInit(&options);
+    // Frames are encoded at a larger output size than the encoder was created with
+    TrackedAnimationEncoder encoder(WIDTH / 2, HEIGHT / 2, options);
+    encoder.configure(losslessConfig());
+    std::vector<uint8_t> pixels = test::makeGradient(WIDTH, HEIGHT);
+    enc::RawFrame frame = {pixels.data(), WIDTH, HEIGHT, enc::PIXEL_FORMAT_RGBA_8888, 0, 0};
+    enc::resolveStrides(&frame);
+    ASSERT_EQ(RESULT_SUCCESS, encoder.addFrame(frame, WIDTH, HEIGHT, 0));
+    EXPECT_GT(encoder.getResidentBytes(), 0u);
+
+    encoder.release();
+    EXPECT_EQ(0u, encoder.getResidentBytes());
+}
+
+TEST(CoreTest, ExtractFrameKeepsIccProfile) {
+    constexpr int PATCH_SIZE = 8;
+    // Translucent frames blend, the first one onto the transparent canvas
+    std::vector<uint8_t> first = test::makeGradient(WIDTH, HEIGHT);
+    std::vector<uint8_t> patch = test::makeGradient(PATCH_SIZE, PATCH_SIZE, 1);
+    for (size_t i = 3; i < first.size(); i += 4) first[i] = 128;
+    for (size_t i = 3; i < patch.size(); i += 4) patch[i] = 128;
+    WebPData first_bitstream;
+    WebPData patch_bitstream;
+    ASSERT_TRUE(test::encodeLossless(first, WIDTH, HEIGHT, &first_bitstream));
+    ASSERT_TRUE(test::encodeLossless(patch, PATCH_SIZE, PATCH_SIZE, &patch_bitstream));
+
+    WebPMux *mux = WebPMuxNew();
+    ASSERT_NE(nullptr, mux);
+    WebPMuxFrameInfo frame;
+    std::memset(&frame, 0, sizeof(frame));
+    frame.id = WEBP_CHUNK_ANMF;
+    frame.duration = 100;
+    frame.blend_method = WEBP_MUX_BLEND;
+    frame.bitstream = first_bitstream;
+    ASSERT_EQ(WEBP_MUX_OK, WebPMuxPushFrame(mux, &frame, 1));
+    frame.bitstream = patch_bitstream;
+    frame.x_offset = PATCH_SIZE;
+    frame.y_offset = PATCH_SIZE;
+    ASSERT_EQ(WEBP_MUX_OK, WebPMuxPushFrame(mux, &frame, 1));
+    const uint8_t icc_bytes[] = {'t', 'e', 's', 't', 'i', 'c', 'c', '0'};
+    const WebPData icc_profile = {icc_bytes, sizeof(icc_bytes)};
+    ASSERT_EQ(WEBP_MUX_OK, WebPMuxSetChunk(mux, "ICCP", &icc_profile, 1));
+    ASSERT_EQ(WEBP_MUX_OK, WebPMuxSetCanvasSize(mux, WIDTH, HEIGHT));
+    WebPData animation;
+    WebPDataInit(&animation);
+    ASSERT_EQ(WEBP_MUX_OK, WebPMuxAssemble(mux, &animation));
+    WebPMuxDelete(mux);
+    WebPDataClear(&first_bitstream);
+    WebPDataClear(&patch_bitstream);
+
+    WebPDecoderCore decoder;
+    ASSERT_EQ(RESULT_SUCCESS, decoder.setData(animation.bytes, animation.size));
+    for (int index = 0; index < 2; index++) {
+        WebPData still;
+        bool copied = false;
+        ASSERT_EQ(RESULT_SUCCESS, decoder.extractFrame(index, losslessConfig(), &still, &copied));
+        EXPECT_EQ(index == 0, copied);
+
+        WebPMux *still_mux = WebPMuxCreate(&still, 0);
+        ASSERT_NE(nullptr, still_mux);
+        WebPData still_icc;
+        ASSERT_EQ(WEBP_MUX_OK, WebPMuxGetChunk(still_mux, "ICCP", &still_icc));
+        ASSERT_EQ(sizeof(icc_bytes), still_icc.size);
+        EXPECT_EQ(0, std::memcmp(icc_bytes, still_icc.bytes, sizeof(icc_bytes)));
+        WebPMuxDelete(still_mux);
+        WebPDataClear(&still);
+    }
+
+    decoder.clearData();
+    WebPDataClear(&animation);
+}
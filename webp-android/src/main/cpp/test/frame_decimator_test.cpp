@@ -0,0 +1,97 @@
+//
+// Created by udara on 10/19/26.
+//
+
+#include <cmath>
+#include <gtest/gtest.h>
+#include <utility>
+#include <vector>
+
+#include "frame_decimator.h"
+
+namespace {
+    constexpr int SIZE = 16;
+
+    std::vector<uint8_t> makeSolid(uint8_t red, uint8_t green, uint8_t blue) {
+        std::vector<uint8_t> pixels(SIZE * SIZE * 4);
+        for (size_t i = 0; i < pixels.size(); i += 4) {
+            pixels[i] = red;
+            pixels[i + 1] = green;
+            pixels[i + 2] = blue;
+            pixels[i + 3] = 255;
+        }
+        return pixels;
+    }
+
+    enc::RawFrame makeFrame(const std::vector<uint8_t> &pixels) {
+        enc::RawFrame frame = {pixels.data(), SIZE, SIZE, enc::PIXEL_FORMAT_RGBA_8888, 0, 0};
+        enc::resolveStrides(&frame);
+        return frame;
+    }
+}
+
+TEST(FrameDecimatorTest, PlacesRoundedTimestampsInTheirOutputFrame) {
+    // 60 fps input resampled to 15 fps, 133 ms is the rounded time of the third output frame
+    FrameDecimator decimator;
+    decimator.configure(1000.0 / 15, false);
+    std::vector<std::pair<long, uint8_t>> kept;
+    auto sink = [&kept](const enc::RawFrame &frame, long timestamp) {
+        kept.emplace_back(timestamp, frame.data[0]);
+        return RESULT_SUCCESS;
+    };
+    for (int i = 0; i < 12; i++) {
+        // The red channel holds the input frame index
+        std::vector<uint8_t> pixels = makeSolid(static_cast<uint8_t>(i), 0, 0);
+        ASSERT_EQ(RESULT_SUCCESS, decimator.submit(makeFrame(pixels), std::lround(i * 1000.0 / 60), sink));
+    }
+    const std::vector<std::pair<long, uint8_t>> expected = {{0, 0}, {67, 4}, {133, 8}};
+    EXPECT_EQ(expected, kept);
+    EXPECT_EQ(9, decimator.getDroppedCount());
+    EXPECT_EQ(200, decimator.endTimestamp(200));
+}
+
+TEST(FrameDecimatorTest, KeepsShortFlash) {
+    FrameDecimator decimator;
+    decimator.configure(1000.0 / 15, true);
+    const std::vector<uint8_t> red = makeSolid(255, 0, 0);
+    const std::vector<uint8_t> white = makeSolid(255, 255, 255);
+    const std::vector<uint8_t> blue = makeSolid(0, 0, 255);
+    const std::vector<const std::vector<uint8_t> *> frames = {
+            &red, &red, &red, &red,
+            &red, &red, &white, &red,
+            &blue, &blue, &blue, &blue,
+    };
+    std::vector<std::pair<long, uint8_t>> kept;
+    auto sink = [&kept](const enc::RawFrame &frame, long timestamp) {
+        kept.emplace_back(timestamp, frame.data[1]);
+        return RESULT_SUCCESS;
+    };
+    for (size_t i = 0; i < frames.size(); i++) {
+        ASSERT_EQ(RESULT_SUCCESS, decimator.submit(makeFrame(*frames[i]), std::lround(i * 1000.0 / 60), sink));
+    }
+    ASSERT_EQ(RESULT_SUCCESS, decimator.flush(sink));
+    ASSERT_EQ(3u, kept.size());
+    EXPECT_EQ(std::make_pair(0L, static_cast<uint8_t>(0)), kept[0]);
+    EXPECT_EQ(std::make_pair(67L, static_cast<uint8_t>(255)), kept[1]);
+    EXPECT_EQ(std::make_pair(133L, static_cast<uint8_t>(0)), kept[2]);
+    EXPECT_EQ(9, decimator.getDroppedCount());
+}
+
+TEST(FrameDecimatorTest, PlacesNegativeTimestampsInFirstOutputFrame) {
+    FrameDecimator decimator;
+    decimator.configure(100, false);
+    std::vector<std::pair<long, uint8_t>> kept;
+    auto sink = [&kept](const enc::RawFrame &frame, long timestamp) {
+        kept.emplace_back(timestamp, frame.data[0]);
+        return RESULT_SUCCESS;
+    };
+    const std::vector<uint8_t> first = makeSolid(1, 0, 0);
+    const std::vector<uint8_t> second = makeSolid(2, 0, 0);
+    const std::vector<uint8_t> third = makeSolid(3, 0, 0);
+    ASSERT_EQ(RESULT_SUCCESS, decimator.submit(makeFrame(first), -50, sink));
+    ASSERT_EQ(RESULT_SUCCESS, decimator.submit(makeFrame(second), 0, sink));
+    ASSERT_EQ(RESULT_SUCCESS, decimator.submit(makeFrame(third), 100, sink));
+    const std::vector<std::pair<long, uint8_t>> expected = {{0, 1}, {100, 3}};
+    EXPECT_EQ(expected, kept);
+    EXPECT_EQ(1, decimator.getDroppedCount());
+}
@@ -0,0 +1,103 @@
+//
+// Created by udara on 10/19/26.
+//
+
+#include <gtest/gtest.h>
+#include <vector>
+
+#include "frame_deduplicator.h"
+
+namespace {
+    // Rows of 13 pixels leave a tail after the 16 byte vector loop
+    constexpr int WIDTH = 13;
+    constexpr int HEIGHT = 5;
+    constexpr int STRIDE = WIDTH * 4 + 12;
+
+    std::vector<uint8_t> makeFrame(uint8_t value) {
+        std::vector<uint8_t> pixels(STRIDE * HEIGHT, value);
+        // Row padding must not take part in the comparison
+        for (int y = 0; y < HEIGHT; y++) {
+            pixels[y * STRIDE + WIDTH * 4] = static_cast<uint8_t>(y);
+        }
+        return pixels;
+    }
+
+    enc::RawFrame rgba(const std::vector<uint8_t> &pixels) {
+        return {pixels.data(), WIDTH, HEIGHT, enc::PIXEL_FORMAT_RGBA_8888, STRIDE, 0};
+    }
+}
+
+TEST(FrameDeduplicatorTest, KeepsAllFramesByDefault) {
+    FrameDeduplicator deduplicator;
+    std::vector<uint8_t> frame = makeFrame(100);
+    EXPECT_FALSE(deduplicator.isDuplicate(rgba(frame)));
+    EXPECT_FALSE(deduplicator.isDuplicate(rgba(frame)));
+    EXPECT_EQ(0, deduplicator.getDroppedCount());
+}
+
+TEST(FrameDeduplicatorTest, DropsExactDuplicates) {
+    FrameDeduplicator deduplicator;
+    deduplicator.setTolerance(0);
+    std::vector<uint8_t> frame = makeFrame(100);
+    EXPECT_FALSE(deduplicator.isDuplicate(rgba(frame)));
+    std::vector<uint8_t> copy = frame;
+    copy[STRIDE + WIDTH * 4 + 1] = 7;
+    EXPECT_TRUE(deduplicator.isDuplicate(rgba(copy)));
+
+    // A single channel in the last pixel of the last row
+    copy[(HEIGHT - 1) * STRIDE + WIDTH * 4 - 1] ^= 1;
+    EXPECT_FALSE(deduplicator.isDuplicate(rgba(copy)));
+    EXPECT_EQ(1, deduplicator.getDroppedCount());
+    EXPECT_EQ(static_cast<size_t>(WIDTH * HEIGHT * 4), deduplicator.getRetainedBytes());
+}
+
+TEST(FrameDeduplicatorTest, ComparesWithinTolerance) {
+    FrameDeduplicator deduplicator;
+    deduplicator.setTolerance(2);
+    std::vector<uint8_t> frame = makeFrame(100);
+    EXPECT_FALSE(deduplicator.isDuplicate(rgba(frame)));
+
+    // Differences of 2 in the vector part and in the tail
+    std::vector<uint8_t> near = frame;
+    near[0] = 102;
+    near[WIDTH * 4 - 1] = 98;
+    EXPECT_TRUE(deduplicator.isDuplicate(rgba(near)));
+
+    for (int offset: {5, WIDTH * 4 - 2}) {
+        std::vector<uint8_t> far = frame;
+        far[2 * STRIDE + offset] = 97;
+        EXPECT_FALSE(deduplicator.isDuplicate(rgba(far))) << "offset " << offset;
+        // The kept frame is the new reference
+        EXPECT_FALSE(deduplicator.isDuplicate(rgba(frame)));
+    }
+    EXPECT_EQ(1, deduplicator.getDroppedCount());
+}
+
+TEST(FrameDeduplicatorTest, ComparesAgainstLastKeptFrame) {
+    FrameDeduplicator deduplicator;
+    deduplicator.setTolerance(1);
+    std::vector<uint8_t> frame = makeFrame(100);
+    EXPECT_FALSE(deduplicator.isDuplicate(rgba(frame)));
+    std::vector<uint8_t> drift = makeFrame(101);
+    EXPECT_TRUE(deduplicator.isDuplicate(rgba(drift)));
+    drift = makeFrame(102);
+    EXPECT_FALSE(deduplicator.isDuplicate(rgba(drift)));
+}
+
+TEST(FrameDeduplicatorTest, ComparesChromaPlanes) {
+    for (enc::PixelFormat format: {enc::PIXEL_FORMAT_NV21, enc::PIXEL_FORMAT_I420}) {
+        FrameDeduplicator deduplicator;
+        deduplicator.setTolerance(0);
+        enc::RawFrame frame = {nullptr, WIDTH, HEIGHT, format, 0, 0};
+        enc::resolveStrides(&frame);
+        std::vector<uint8_t> pixels(enc::rawFrameByteCount(frame), 100);
+        frame.data = pixels.data();
+        EXPECT_FALSE(deduplicator.isDuplicate(frame)) << format;
+        EXPECT_TRUE(deduplicator.isDuplicate(frame)) << format;
+
+        // Same luma, the last chroma sample changed
+        pixels.back() = 101;
+        EXPECT_FALSE(deduplicator.isDuplicate(frame)) << format;
+        EXPECT_EQ(pixels.size(), deduplicator.getRetainedBytes()) << format;
+    }
+}
@@ -0,0 +1,103 @@
+//
+// Created by udara on 10/19/26.
+//
+
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+#include "frame_queue.h"
+
+namespace {
+    constexpr int WIDTH = 8;
+    constexpr int HEIGHT = 4;
+
+    enc::RawFrame makeFrame(std::vector<uint8_t> &pixels, uint8_t value) {
+        pixels.assign(WIDTH * HEIGHT * 4, value);
+        enc::RawFrame frame = {pixels.data(), WIDTH, HEIGHT, enc::PIXEL_FORMAT_RGBA_8888, 0, 0};
+        enc::resolveStrides(&frame);
+        return frame;
+    }
+}
+
+TEST(FrameQueueTest, EncodesFramesInOrder) {
+    MemoryTracker tracker;
+    std::vector<long> timestamps;
+    std::vector<uint8_t> values;
+    FrameQueue queue;
+    ASSERT_EQ(RESULT_SUCCESS, queue.start(2, [&](const QueuedFrame &frame) {
+        timestamps.push_back(frame.timestamp);
+        values.push_back(frame.frame.data[0]);
+        return RESULT_SUCCESS;
+    }, &tracker));
+    EXPECT_TRUE(queue.isStarted());
+
+    std::vector<uint8_t> pixels;
+    for (int i = 0; i < 5; i++) {
+        ASSERT_EQ(RESULT_SUCCESS, queue.push(makeFrame(pixels, static_cast<uint8_t>(i)), i * 100));
+    }
+    EXPECT_EQ(RESULT_SUCCESS, queue.drain());
+    EXPECT_EQ((std::vector<long>{0, 100, 200, 300, 400}), timestamps);
+    EXPECT_EQ((std::vector<uint8_t>{0, 1, 2, 3, 4}), values);
+    EXPECT_GT(tracker.getPeak(), 0u);
+
+    queue.stop();
+    EXPECT_FALSE(queue.isStarted());
+    EXPECT_EQ(0u, tracker.getCurrent());
+}
+
+TEST(FrameQueueTest, ReportsFirstConsumerError) {
+    int consumed = 0;
+    FrameQueue queue;
+    ASSERT_EQ(RESULT_SUCCESS, queue.start(1, [&consumed](const QueuedFrame &) {
+        return ++consumed == 2 ? ERROR_BAD_WRITE : RESULT_SUCCESS;
+    }));
+
+    std::vector<uint8_t> pixels;
+    ResultCode result = RESULT_SUCCESS;
+    for (int i = 0; i < 10 && result == RESULT_SUCCESS; i++) {
+        result = queue.push(makeFrame(pixels, 0), i);
+    }
+    EXPECT_EQ(ERROR_BAD_WRITE, queue.drain());
+    EXPECT_EQ(ERROR_BAD_WRITE, queue.push(makeFrame(pixels, 0), 10));
+    EXPECT_EQ(2, consumed);
+}
+
+TEST(FrameQueueTest, RunsHooksOnWorkerThread) {
+    std::vector<std::thread::id> threads;
+    FrameQueue queue;
+    ASSERT_EQ(RESULT_SUCCESS, queue.start(1, [&threads](const QueuedFrame &) {
+        threads.push_back(std::this_thread::get_id());
+        return RESULT_SUCCESS;
+    }, nullptr, WorkerHooks{
+            [&threads]() {
+                threads.push_back(std::this_thread::get_id());
+                return RESULT_SUCCESS;
+            },
+            [&threads]() { threads.push_back(std::this_thread::get_id()); }
+    }));
+
+    std::vector<uint8_t> pixels;
+    ASSERT_EQ(RESULT_SUCCESS, queue.push(makeFrame(pixels, 0), 0));
+    EXPECT_EQ(RESULT_SUCCESS, queue.drain());
+    queue.stop();
+    ASSERT_EQ(3u, threads.size());
+    EXPECT_NE(std::this_thread::get_id(), threads[0]);
+    EXPECT_EQ(threads[0], threads[1]);
+    EXPECT_EQ(threads[0], threads[2]);
+}
+
+TEST(FrameQueueTest, FailedAttachDoesNotBlock) {
+    bool consumed = false;
+    FrameQueue queue;
+    EXPECT_EQ(ERROR_MEMORY_ERROR, queue.start(1, [&consumed](const QueuedFrame &) {
+        consumed = true;
+        return RESULT_SUCCESS;
+    }, nullptr, WorkerHooks{[]() { return ERROR_MEMORY_ERROR; }, nullptr}));
+    EXPECT_FALSE(queue.isStarted());
+
+    std::vector<uint8_t> pixels;
+    EXPECT_EQ(ERROR_MEMORY_ERROR, queue.push(makeFrame(pixels, 0), 0));
+    EXPECT_EQ(ERROR_MEMORY_ERROR, queue.drain());
+    EXPECT_FALSE(consumed);
+}
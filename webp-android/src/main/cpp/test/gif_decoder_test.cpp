@@ -0,0 +1,93 @@
+//
+// Created by udara on 10/19/26.
+//
+
+#include <gtest/gtest.h>
+#include <vector>
+
+#include "gif_decoder.h"
+
+namespace {
+    void appendLE16(std::vector<uint8_t> &gif, int value) {
+        gif.push_back(static_cast<uint8_t>(value & 0xff));
+        gif.push_back(static_cast<uint8_t>(value >> 8));
+    }
+
+    /**
+     * Builds a GIF with a red and blue color table and a single frame of color index 0.
+     *
+     * @param repetitions The NETSCAPE2.0 repetition count, or -1 to leave the extension out.
+     */
+    std::vector<uint8_t> makeGif(int width, int height, int repetitions, int frame_width = 1, int frame_height = 1) {
+        std::vector<uint8_t> gif = {'G', 'I', 'F', '8', '9', 'a'};
+        appendLE16(gif, width);
+        appendLE16(gif, height);
+        gif.insert(gif.end(), {0x80, 0x00, 0x00});
+        gif.insert(gif.end(), {0xff, 0x00, 0x00, 0x00, 0x00, 0xff});
+        if (repetitions >= 0) {
+            gif.insert(gif.end(), {0x21, 0xff, 0x0b, 'N', 'E', 'T', 'S', 'C', 'A', 'P', 'E', '2', '.', '0', 0x03, 0x01});
+            appendLE16(gif, repetitions);
+            gif.push_back(0x00);
+        }
+        gif.push_back(0x2c);
+        appendLE16(gif, 0);
+        appendLE16(gif, 0);
+        appendLE16(gif, frame_width);
+        appendLE16(gif, frame_height);
+        gif.push_back(0x00);
+        // Minimum code size 2: clear, index 0, end
+        gif.insert(gif.end(), {0x02, 0x02, 0x44, 0x01, 0x00});
+        gif.push_back(0x3b);
+        return gif;
+    }
+
+    int loopCountOf(int repetitions) {
+        std::vector<uint8_t> gif = makeGif(1, 1, repetitions);
+        GifDecoder decoder;
+        EXPECT_EQ(RESULT_SUCCESS, decoder.open(gif.data(), gif.size()));
+        return decoder.getLoopCount();
+    }
+}
+
+TEST(GifDecoderTest, DecodesSingleFrame) {
+    std::vector<uint8_t> gif = makeGif(1, 1, -1);
+    GifDecoder decoder;
+    ASSERT_EQ(RESULT_SUCCESS, decoder.open(gif.data(), gif.size()));
+    EXPECT_EQ(1, decoder.getFrameCount());
+    uint8_t *canvas = nullptr;
+    int end_timestamp = -1;
+    ASSERT_EQ(RESULT_SUCCESS, decoder.getNext(&canvas, &end_timestamp));
+    EXPECT_EQ(0xff, canvas[0]);
+    EXPECT_EQ(0x00, canvas[2]);
+    EXPECT_EQ(0xff, canvas[3]);
+    EXPECT_FALSE(decoder.hasMoreFrames());
+}
+
+TEST(GifDecoderTest, PlaysOnceWithoutLoopExtension) {
+    EXPECT_EQ(1, loopCountOf(-1));
+}
+
+TEST(GifDecoderTest, LoopsForeverWithZeroRepetitions) {
+    EXPECT_EQ(0, loopCountOf(0));
+}
+
+TEST(GifDecoderTest, PlaysRepetitionsPlusOne) {
+    EXPECT_EQ(2, loopCountOf(1));
+    EXPECT_EQ(4, loopCountOf(3));
+}
+
+TEST(GifDecoderTest, KeepsMaximumRepetitions) {
+    EXPECT_EQ(65535, loopCountOf(65535));
+}
+
+TEST(GifDecoderTest, RejectsOversizedCanvas) {
+    std::vector<uint8_t> gif = makeGif(65535, 65535, -1);
+    GifDecoder decoder;
+    EXPECT_EQ(ERROR_BAD_DIMENSION, decoder.open(gif.data(), gif.size()));
+}
+
+TEST(GifDecoderTest, RejectsOversizedFrame) {
+    std::vector<uint8_t> gif = makeGif(1, 1, -1, 65535, 65535);
+    GifDecoder decoder;
+    EXPECT_EQ(ERROR_BAD_DIMENSION, decoder.open(gif.data(), gif.size()));
+}
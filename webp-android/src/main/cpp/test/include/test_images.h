@@ -0,0 +1,26 @@
+//
+// Created by udara on 10/19/26.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <webp/mux_types.h>
+
+/**
+ * Synthetic images for the host tests.
+ */
+namespace test {
+    /**
+     * Creates an opaque RGBA gradient. Frames with different indices differ in every row.
+     */
+    std::vector<uint8_t> makeGradient(int width, int height, int frame_index = 0);
+
+    /**
+     * Encodes RGBA pixels as a lossless still WebP image.
+     *
+     * @param output Receives the image. Free with WebPDataClear.
+     */
+    bool encodeLossless(const std::vector<uint8_t> &pixels, int width, int height, WebPData *output);
+}
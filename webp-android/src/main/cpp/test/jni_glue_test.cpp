@@ -0,0 +1,109 @@
+//
+// Created by udara on 10/19/26.
+//
+
+#include <android/bitmap.h>
+#include <cstring>
+#include <gtest/gtest.h>
+#include <webp/mux_types.h>
+
+#include "include/test_images.h"
+#include "fake_jni.h"
+#include "native_loader.h"
+#include "result_codes.h"
+
+namespace {
+    constexpr const char *DECODER_CLASS = "com/aureusapps/android/webpandroid/decoder/WebPDecoder";
+
+    template<typename F>
+    F findDecoderNative(const char *name, const char *signature) {
+        return reinterpret_cast<F>(fake::findNative(DECODER_CLASS, name, signature));
+    }
+
+    class JniGlueTest : public testing::Test {
+    protected:
+        static void SetUpTestSuite() {
+            ASSERT_EQ(JNI_VERSION_1_6, JNI_OnLoad(fake::getJavaVM(), nullptr));
+        }
+
+        void TearDown() override {
+            fake::releaseObjects();
+        }
+    };
+}
+
+TEST_F(JniGlueTest, DecodesFrameIntoBitmap) {
+    constexpr int WIDTH = 32;
+    constexpr int HEIGHT = 24;
+    auto native_create = findDecoderNative<jlong (*)(JNIEnv *, jobject)>("nativeCreate", "()J");
+    auto native_set_data_buffer = findDecoderNative<jint (*)(JNIEnv *, jobject, jobject)>(
+            "nativeSetDataBuffer",
+            "(Ljava/nio/Buffer;)I"
+    );
+    auto native_decode_next_frame = findDecoderNative<jlong (*)(JNIEnv *, jobject)>(
+            "nativeDecodeNextFrame",
+            "()J"
+    );
+    auto native_get_frame_bitmap = findDecoderNative<jobject (*)(JNIEnv *, jobject)>(
+            "nativeGetFrameBitmap",
+            "()Landroid/graphics/Bitmap;"
+    );
+    auto native_release = findDecoderNative<void (*)(JNIEnv *, jobject)>("nativeRelease", "()V");
+    ASSERT_NE(nullptr, native_create);
+    ASSERT_NE(nullptr, native_set_data_buffer);
+    ASSERT_NE(nullptr, native_decode_next_frame);
+    ASSERT_NE(nullptr, native_get_frame_bitmap);
+    ASSERT_NE(nullptr, native_release);
+
+    std::vector<uint8_t> pixels = test::makeGradient(WIDTH, HEIGHT);
+    WebPData webp;
+    ASSERT_TRUE(test::encodeLossless(pixels, WIDTH, HEIGHT, &webp));
+
+    JNIEnv *env = fake::getEnv();
+    jobject jdecoder = fake::newObject(DECODER_CLASS);
+    env->SetLongField(jdecoder, ClassRegistry::webPDecoderPointerFieldID.get(env), native_create(env, jdecoder));
+    jobject jbuffer = env->NewDirectByteBuffer(const_cast<uint8_t *>(webp.bytes), static_cast<jlong>(webp.size));
+    ASSERT_EQ(RESULT_SUCCESS, native_set_data_buffer(env, jdecoder, jbuffer));
+
+    // The result code is packed into the top byte, the frame index + 1 below it
+    auto packed = static_cast<uint64_t>(native_decode_next_frame(env, jdecoder));
+    EXPECT_EQ(RESULT_SUCCESS, static_cast<int>(packed >> 56));
+    EXPECT_EQ(1, static_cast<int>((packed >> 32) & 0xFFFFFF));
+    EXPECT_TRUE(fake::getExceptionMessage().empty());
+
+    jobject jbitmap = native_get_frame_bitmap(env, jdecoder);
+    ASSERT_NE(nullptr, jbitmap);
+    AndroidBitmapInfo info;
+    ASSERT_EQ(ANDROID_BITMAP_RESULT_SUCCESS, AndroidBitmap_getInfo(env, jbitmap, &info));
+    EXPECT_EQ(static_cast<uint32_t>(WIDTH), info.width);
+    EXPECT_EQ(static_cast<uint32_t>(HEIGHT), info.height);
+    void *bitmap_pixels = nullptr;
+    ASSERT_EQ(ANDROID_BITMAP_RESULT_SUCCESS, AndroidBitmap_lockPixels(env, jbitmap, &bitmap_pixels));
+    EXPECT_EQ(0, std::memcmp(pixels.data(), bitmap_pixels, pixels.size()));
+    AndroidBitmap_unlockPixels(env, jbitmap);
+
+    native_release(env, jdecoder);
+    WebPDataClear(&webp);
+}
+
+TEST_F(JniGlueTest, ResolvesRegistryAgainAfterRelease) {
+    JNIEnv *env = fake::getEnv();
+    ASSERT_NE(nullptr, ClassRegistry::webPDecoderClass.get(env));
+    ClassRegistry::release(env);
+    // JNI_OnLoad after JNI_OnUnload, lazy entries resolve again on their next get
+    ClassRegistry::load(env);
+    EXPECT_NE(nullptr, ClassRegistry::webPDecoderClass.get(env));
+    EXPECT_NE(nullptr, ClassRegistry::webPDecoderPointerFieldID.get(env));
+}
+
+TEST_F(JniGlueTest, FailsToLoadWithoutRegistryClass) {
+    JNIEnv *env = fake::getEnv();
+    ClassRegistry::release(env);
+    fake::setMissingClass("com/aureusapps/android/webpandroid/transcoder/WebPTranscoder");
+    EXPECT_EQ(JNI_ERR, JNI_OnLoad(fake::getJavaVM(), nullptr));
+    EXPECT_FALSE(env->ExceptionCheck());
+
+    fake::setMissingClass("");
+    ClassRegistry::release(env);
+    EXPECT_EQ(JNI_VERSION_1_6, JNI_OnLoad(fake::getJavaVM(), nullptr));
+}
@@ -0,0 +1,117 @@
+//
+// Created by udara on 10/19/26.
+//
+
+#include <gtest/gtest.h>
+#include <utility>
+#include <vector>
+
+#include "include/test_images.h"
+#include "parallel_anim_encoder.h"
+
+namespace {
+    constexpr int WIDTH = 64;
+    constexpr int HEIGHT = 48;
+    constexpr int FRAME_COUNT = 6;
+    constexpr int FRAME_DURATION = 100;
+
+    /**
+     * Imports a gradient frame as the full canvas ARGB picture the engine expects.
+     */
+    bool makeFramePicture(int frame_index, WebPPicture *pic) {
+        if (!WebPPictureInit(pic)) return false;
+        pic->use_argb = true;
+        pic->width = WIDTH;
+        pic->height = HEIGHT;
+        std::vector<uint8_t> pixels = test::makeGradient(WIDTH, HEIGHT, frame_index);
+        return WebPPictureImportRGBA(pic, pixels.data(), WIDTH * 4) != 0;
+    }
+
+    WebPAnimEncoderOptions makeOptions() {
+        WebPAnimEncoderOptions options;
+        WebPAnimEncoderOptionsInit(&options);
+        return options;
+    }
+
+    WebPConfig makeConfig(bool lossless) {
+        WebPConfig config;
+        WebPConfigInit(&config);
+        config.lossless = lossless;
+        config.method = 0;
+        return config;
+    }
+
+    /**
+     * Adds FRAME_COUNT gradient frames.
+     */
+    ResultCode addFrames(ParallelAnimEncoder *encoder, const WebPConfig &config, MemoryTracker *tracker = nullptr) {
+        for (int i = 0; i < FRAME_COUNT; i++) {
+            WebPPicture pic;
+            if (!makeFramePicture(i, &pic)) return ERROR_MEMORY_ERROR;
+            ResultCode result = encoder->addFrame(&pic, i * FRAME_DURATION, config, i);
+            WebPPictureFree(&pic);
+            if (result != RESULT_SUCCESS) return result;
+            // Counters are unsigned, a release of more than was allocated wraps around
+            if (tracker != nullptr && tracker->getCurrent() > tracker->getPeak()) return ERROR_MEMORY_ERROR;
+        }
+        return RESULT_SUCCESS;
+    }
+}
+
+TEST(ParallelAnimEncoderTest, ReportsEachFrameInOrder) {
+    ProgressReporter reporter;
+    std::vector<std::pair<int, int>> progress;
+    reporter.attach([&progress](int frame_index, int percent) {
+        progress.emplace_back(frame_index, percent);
+        return true;
+    });
+
+    ParallelAnimEncoder encoder(WIDTH, HEIGHT, makeOptions(), 3, &reporter);
+    ASSERT_EQ(RESULT_SUCCESS, addFrames(&encoder, makeConfig(true)));
+    WebPData data;
+    ASSERT_EQ(RESULT_SUCCESS, encoder.assemble(FRAME_COUNT * FRAME_DURATION, &data));
+    reporter.detach();
+    WebPDataClear(&data);
+
+    ASSERT_EQ(static_cast<size_t>(FRAME_COUNT), progress.size());
+    for (int i = 0; i < FRAME_COUNT; i++) {
+        EXPECT_EQ(std::make_pair(i, 100), progress[i]);
+    }
+}
+
+TEST(ParallelAnimEncoderTest, ReleasesLossyPicturesExactly) {
+    ProgressReporter reporter;
+    MemoryTracker tracker;
+    {
+        ParallelAnimEncoder encoder(WIDTH, HEIGHT, makeOptions(), 3, &reporter, nullptr, nullptr, &tracker);
+        ASSERT_EQ(RESULT_SUCCESS, addFrames(&encoder, makeConfig(false), &tracker));
+        WebPData data;
+        ASSERT_EQ(RESULT_SUCCESS, encoder.assemble(FRAME_COUNT * FRAME_DURATION, &data));
+        WebPDataClear(&data);
+        EXPECT_LE(tracker.getCurrent(), tracker.getPeak());
+    }
+    EXPECT_GT(tracker.getPeak(), 0u);
+    EXPECT_EQ(0u, tracker.getCurrent());
+}
+
+TEST(ParallelAnimEncoderTest, ReduceMemoryFreesRetainedPictures) {
+    ProgressReporter reporter;
+    MemoryTracker tracker;
+    RateController rate_controller;
+    rate_controller.setBudget(1024 * 1024, FRAME_COUNT);
+    {
+        // The rate controller keeps lossy pictures, with their YUV planes, for corrections
+        ParallelAnimEncoder encoder(WIDTH, HEIGHT, makeOptions(), 3, &reporter, nullptr, &rate_controller, &tracker);
+        ASSERT_EQ(RESULT_SUCCESS, addFrames(&encoder, makeConfig(false), &tracker));
+        const size_t retained = tracker.getCurrent();
+        ASSERT_TRUE(encoder.reduceMemory());
+        EXPECT_LT(tracker.getCurrent(), retained);
+        EXPECT_FALSE(encoder.reduceMemory());
+
+        WebPData data;
+        ASSERT_EQ(RESULT_SUCCESS, encoder.assemble(FRAME_COUNT * FRAME_DURATION, &data));
+        WebPDataClear(&data);
+        EXPECT_LE(tracker.getCurrent(), tracker.getPeak());
+    }
+    EXPECT_EQ(0u, tracker.getCurrent());
+}
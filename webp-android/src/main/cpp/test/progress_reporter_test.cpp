@@ -0,0 +1,100 @@
+//
+// Created by udara on 10/19/26.
+//
+
+#include <gtest/gtest.h>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "progress_reporter.h"
+
+namespace {
+    typedef std::vector<std::pair<int, int>> Deliveries;
+
+    ProgressReporter::Listener recordTo(Deliveries *deliveries, bool proceed = true) {
+        return [deliveries, proceed](int frame_index, int percent) {
+            deliveries->emplace_back(frame_index, percent);
+            return proceed;
+        };
+    }
+}
+
+TEST(ProgressReporterTest, CoalescesByPercentStep) {
+    ProgressReporter reporter;
+    reporter.setInterval(0, 25);
+    Deliveries deliveries;
+    reporter.attach(recordTo(&deliveries));
+    for (int percent = 0; percent <= 100; percent += 5) {
+        EXPECT_EQ(1, reporter.update(0, percent));
+    }
+    reporter.detach();
+    EXPECT_EQ((Deliveries{{0, 0}, {0, 25}, {0, 50}, {0, 75}, {0, 100}}), deliveries);
+}
+
+TEST(ProgressReporterTest, DeliversFrameChangesAndCompletion) {
+    ProgressReporter reporter;
+    reporter.setInterval(0, 50);
+    Deliveries deliveries;
+    reporter.attach(recordTo(&deliveries));
+    reporter.update(0, 0);
+    reporter.update(0, 60);
+    reporter.update(0, 90);
+    reporter.update(1, 10);
+    reporter.update(1, 100);
+    reporter.detach();
+    EXPECT_EQ((Deliveries{{0, 0}, {0, 60}, {1, 10}, {1, 100}}), deliveries);
+}
+
+TEST(ProgressReporterTest, HoldsBackTicksWithinInterval) {
+    ProgressReporter reporter;
+    reporter.setInterval(60 * 60 * 1000, 1);
+    Deliveries deliveries;
+    reporter.attach(recordTo(&deliveries));
+    for (int percent = 0; percent < 100; percent++) {
+        reporter.update(0, percent);
+    }
+    EXPECT_EQ((Deliveries{{0, 0}}), deliveries);
+    reporter.update(0, 100);
+    reporter.detach();
+    EXPECT_EQ((Deliveries{{0, 0}, {0, 100}}), deliveries);
+}
+
+TEST(ProgressReporterTest, DetachDeliversTicksFromOtherThreads) {
+    ProgressReporter reporter;
+    Deliveries deliveries;
+    reporter.attach(recordTo(&deliveries));
+    std::thread worker([&reporter] {
+        for (int percent = 0; percent <= 80; percent++) {
+            reporter.update(0, percent);
+        }
+    });
+    worker.join();
+    EXPECT_TRUE(deliveries.empty());
+    reporter.detach();
+    EXPECT_EQ((Deliveries{{0, 80}}), deliveries);
+
+    // Not attached, nothing is delivered
+    reporter.update(0, 100);
+    reporter.detach();
+    EXPECT_EQ(1u, deliveries.size());
+}
+
+TEST(ProgressReporterTest, ListenerAbortsEncode) {
+    ProgressReporter reporter;
+    Deliveries deliveries;
+    reporter.attach(recordTo(&deliveries, false));
+    EXPECT_EQ(0, reporter.update(0, 10));
+    EXPECT_TRUE(reporter.isCancelled());
+    reporter.detach();
+
+    // A new session clears the abort, unlike cancel
+    reporter.attach(recordTo(&deliveries));
+    EXPECT_FALSE(reporter.isCancelled());
+    reporter.cancel();
+    EXPECT_EQ(0, reporter.update(0, 20));
+    reporter.detach();
+    reporter.attach(recordTo(&deliveries));
+    EXPECT_TRUE(reporter.isCancelled());
+    reporter.detach();
+}
@@ -0,0 +1,85 @@
+//
+// Created by udara on 10/19/26.
+//
+
+#include <gtest/gtest.h>
+#include <webp/encode.h>
+
+#include "speed_model.h"
+
+namespace {
+    constexpr size_t PIXEL_COUNT = 1000 * 1000;
+
+    /**
+     * Lossy method m costs (m + 1) ns per pixel, lossless method m costs 10 * (m + 1).
+     */
+    void setLinearModel() {
+        float model[speed::MODEL_SIZE];
+        for (int method = 0; method < speed::METHOD_COUNT; method++) {
+            model[method] = static_cast<float>(method + 1);
+            model[speed::METHOD_COUNT + method] = static_cast<float>(10 * (method + 1));
+        }
+        speed::setModel(model);
+    }
+
+    WebPConfig makeConfig(bool lossless, int method) {
+        WebPConfig config;
+        WebPConfigInit(&config);
+        config.lossless = lossless;
+        config.method = method;
+        config.quality = 80;
+        return config;
+    }
+}
+
+TEST(SpeedModelTest, SetModelRoundTrips) {
+    setLinearModel();
+    EXPECT_TRUE(speed::isCalibrated());
+    float model[speed::MODEL_SIZE];
+    speed::getModel(model);
+    EXPECT_FLOAT_EQ(1, model[0]);
+    EXPECT_FLOAT_EQ(7, model[speed::METHOD_COUNT - 1]);
+    EXPECT_FLOAT_EQ(70, model[speed::MODEL_SIZE - 1]);
+}
+
+TEST(SpeedModelTest, PicksHighestMethodWithinDeadline) {
+    setLinearModel();
+    // 1 Mpix at 4 ns per pixel is 4 ms, method 3
+    speed::DeadlinePlan plan = speed::planForDeadline(makeConfig(false, 6), PIXEL_COUNT, 4);
+    EXPECT_EQ(3, plan.method);
+    EXPECT_FLOAT_EQ(80, plan.quality);
+    EXPECT_DOUBLE_EQ(4, plan.predicted_millis);
+}
+
+TEST(SpeedModelTest, ConfiguredMethodIsUpperBound) {
+    setLinearModel();
+    speed::DeadlinePlan plan = speed::planForDeadline(makeConfig(false, 2), PIXEL_COUNT, 1000);
+    EXPECT_EQ(2, plan.method);
+    EXPECT_FLOAT_EQ(80, plan.quality);
+}
+
+TEST(SpeedModelTest, LowersLosslessQualityWhenNoMethodFits) {
+    setLinearModel();
+    // Lossless method 0 needs 10 ms, half of it is available
+    speed::DeadlinePlan plan = speed::planForDeadline(makeConfig(true, 6), PIXEL_COUNT, 5);
+    EXPECT_EQ(0, plan.method);
+    EXPECT_FLOAT_EQ(40, plan.quality);
+}
+
+TEST(SpeedModelTest, KeepsLossyQualityWhenNoMethodFits) {
+    setLinearModel();
+    speed::DeadlinePlan plan = speed::planForDeadline(makeConfig(false, 6), PIXEL_COUNT, 0);
+    EXPECT_EQ(0, plan.method);
+    EXPECT_FLOAT_EQ(80, plan.quality);
+}
+
+TEST(SpeedModelTest, ObserveMovesTowardsMeasurement) {
+    setLinearModel();
+    // 1 Mpix in 11 ms is 11 ns per pixel for lossy method 0
+    speed::observe(false, 0, PIXEL_COUNT, 11);
+    float model[speed::MODEL_SIZE];
+    speed::getModel(model);
+    EXPECT_GT(model[0], 1);
+    EXPECT_LT(model[0], 11);
+    EXPECT_FLOAT_EQ(10, model[speed::METHOD_COUNT]);
+}
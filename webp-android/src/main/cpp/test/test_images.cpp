@@ -0,0 +1,31 @@
+//
+// Created by udara on 10/19/26.
+//
+
+#include <webp/encode.h>
+
+#include "include/test_images.h"
+
+std::vector<uint8_t> test::makeGradient(int width, int height, int frame_index) {
+    std::vector<uint8_t> pixels(static_cast<size_t>(width) * height * 4);
+    uint8_t *pixel = pixels.data();
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            pixel[0] = static_cast<uint8_t>(x * 255 / width);
+            pixel[1] = static_cast<uint8_t>(y * 255 / height);
+            pixel[2] = static_cast<uint8_t>((x + y + frame_index * 37) & 0xFF);
+            pixel[3] = 255;
+            pixel += 4;
+        }
+    }
+    return pixels;
+}
+
+bool test::encodeLossless(const std::vector<uint8_t> &pixels, int width, int height, WebPData *output) {
+    WebPDataInit(output);
+    uint8_t *bytes = nullptr;
+    size_t size = WebPEncodeLosslessRGBA(pixels.data(), width, height, width * 4, &bytes);
+    output->bytes = bytes;
+    output->size = size;
+    return size > 0;
+}
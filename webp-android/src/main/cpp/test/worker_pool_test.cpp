@@ -0,0 +1,49 @@
+//
+// Created by udara on 10/19/26.
+//
+
+#include <atomic>
+#include <gtest/gtest.h>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "worker_pool.h"
+
+TEST(WorkerPoolTest, RunsEveryJobOnce) {
+    WorkerPool pool(3);
+    for (size_t job_count: {0u, 1u, 2u, 17u}) {
+        std::vector<std::atomic<int>> runs(job_count);
+        pool.run(job_count, [&runs](size_t index) {
+            runs[index]++;
+        });
+        for (size_t i = 0; i < job_count; i++) {
+            EXPECT_EQ(1, runs[i].load()) << "job " << i << " of " << job_count;
+        }
+    }
+}
+
+TEST(WorkerPoolTest, ReusesThreadsAcrossBatches) {
+    WorkerPool pool(2);
+    std::mutex mutex;
+    std::set<std::thread::id> thread_ids;
+    for (int batch = 0; batch < 20; batch++) {
+        pool.run(8, [&](size_t) {
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+            std::lock_guard<std::mutex> lock(mutex);
+            thread_ids.insert(std::this_thread::get_id());
+        });
+    }
+    // Two pool threads and the calling thread
+    EXPECT_LE(thread_ids.size(), 3u);
+    EXPECT_TRUE(thread_ids.count(std::this_thread::get_id()));
+}
+
+TEST(WorkerPoolTest, SingleJobRunsOnCallingThread) {
+    WorkerPool pool(2);
+    std::thread::id job_thread;
+    pool.run(1, [&job_thread](size_t) {
+        job_thread = std::this_thread::get_id();
+    });
+    EXPECT_EQ(std::this_thread::get_id(), job_thread);
+}
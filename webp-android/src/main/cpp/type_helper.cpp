@@ -2,42 +2,46 @@
 // Created by udara on 6/4/23.
 //
 
+#include <cstring>
 #include <stdexcept>
 
 #include "include/type_helper.h"
-#include "include/native_loader.h"
 
-int type::getIntegerValue(
+void type::readPackedValues(
         JNIEnv *env,
-        jobject object
+        jobject object,
+        jfieldID field_id,
+        int value_count,
+        PackedValues *packed
 ) {
-    if (!env->IsInstanceOf(object, ClassRegistry::integerClass.get(env))) {
-        throw std::runtime_error("The given object is not of type Integer.");
+    auto jpacked = (jintArray) env->GetObjectField(object, field_id);
+    if (jpacked == nullptr || env->GetArrayLength(jpacked) != value_count + 1 || value_count > MAX_PACKED_VALUES) {
+        throw std::runtime_error("The given object has no packed values of the expected length.");
     }
-    jint value = env->CallIntMethod(object, ClassRegistry::integerValueMethodID.get(env));
-    return static_cast<int>(value);
+    auto *values = static_cast<jint *>(env->GetPrimitiveArrayCritical(jpacked, nullptr));
+    if (values == nullptr) {
+        throw std::runtime_error("Failed to access the packed values.");
+    }
+    packed->mask = static_cast<uint32_t>(values[0]);
+    std::memcpy(packed->values, values + 1, value_count * sizeof(jint));
+    env->ReleasePrimitiveArrayCritical(jpacked, values, JNI_ABORT);
+    env->DeleteLocalRef(jpacked);
 }
 
-bool type::getBooleanValue(
-        JNIEnv *env,
-        jobject object
-) {
-    if (!env->IsInstanceOf(object, ClassRegistry::booleanClass.get(env))) {
-        throw std::runtime_error("The given object is not of type Boolean.");
+bool type::hasPackedValue(const PackedValues &packed, int index) {
+    return (packed.mask >> index) & 1u;
+}
+
+void type::unpackInt(const PackedValues &packed, int index, int *value) {
+    if (hasPackedValue(packed, index)) {
+        *value = packed.values[index];
     }
-    jboolean value = env->CallBooleanMethod(object, ClassRegistry::booleanValueMethodID.get(env));
-    return static_cast<bool>(value);
 }
 
-float type::getFloatValue(
-        JNIEnv *env,
-        jobject object
-) {
-    if (!env->IsInstanceOf(object, ClassRegistry::floatClass.get(env))) {
-        throw std::runtime_error("The given object is not of type Float.");
+void type::unpackFloat(const PackedValues &packed, int index, float *value) {
+    if (hasPackedValue(packed, index)) {
+        std::memcpy(value, &packed.values[index], sizeof(float));
     }
-    jfloat value = env->CallFloatMethod(object, ClassRegistry::floatValueMethodID.get(env));
-    return static_cast<float>(value);
 }
 
 bool type::isObjectNull(JNIEnv *env, jobject obj) {
@@ -10,99 +10,31 @@
 #include "include/type_helper.h"
 #include "include/bitmap_utils.h"
 #include "include/file_utils.h"
-
-namespace {
-    struct UserData {
-        int frameIndex = -1;
-    };
-}
-
-WebPAnimationEncoder::WebPAnimationEncoder(int width, int height, WebPAnimEncoderOptions options) {
-    this->imageWidth = width;
-    this->imageHeight = height;
-    this->frameCount = 0;
-    this->encoderOptions = options;
-    this->webPAnimEncoder = nullptr;
-    WebPConfigInit(&webPConfig);
-}
-
-void WebPAnimationEncoder::configure(WebPConfig config) {
-    webPConfig = config;
-}
-
-ResultCode WebPAnimationEncoder::addFrame(
-        uint8_t *pixels,
-        int image_width,
-        int image_height,
-        int output_width,
-        int output_height,
-        long timestamp
-) {
-    // Init picture
-    WebPPicture pic;
-    if (!WebPPictureInit(&pic)) {
-        return ERROR_VERSION_MISMATCH;
-    }
-    pic.use_argb = true;
-    pic.width = image_width;
-    pic.height = image_height;
-
-    // Allocate memory
-    if (!WebPPictureAlloc(&pic)) {
-        return ERROR_MEMORY_ERROR;
-    }
-
-    // Import pixel data
-    if (!WebPPictureImportRGBA(&pic, pixels, image_width * 4)) {
-        WebPPictureFree(&pic);
-        return ERROR_MEMORY_ERROR;
-    }
-
-    // Resize if output size doesn't match
-    if ((image_width != output_width || image_height != output_height) && !WebPPictureRescale(&pic, output_width, output_height)) {
-        WebPPictureFree(&pic);
-        return ERROR_BITMAP_RESIZE_FAILED;
-    }
-
-    auto user_data = UserData{};
-    user_data.frameIndex = frameCount++;
-    pic.user_data = reinterpret_cast<void *>(&user_data);
-    pic.progress_hook = &notifyProgressChanged;
-
-    // Create encoder if not created
-    if (webPAnimEncoder == nullptr) {
-        webPAnimEncoder = WebPAnimEncoderNew(output_width, output_height, &encoderOptions);
+#include "include/buffer_utils.h"
+#include "include/exception_helper.h"
+#include "include/progress_listener.h"
+
+void WebPAnimationEncoder::stopFrameQueue(JNIEnv *env) {
+    frameQueue.stop();
+    if (asyncObserver != nullptr) {
+        env->DeleteGlobalRef(asyncObserver);
+        asyncObserver = nullptr;
     }
-
-    // Add frame
-    if (!WebPAnimEncoderAdd(webPAnimEncoder, &pic, timestamp, &webPConfig)) {
-        WebPPictureFree(&pic);
-        return res::encodingErrorToResultCode(pic.error_code);
-    }
-
-    // Release picture
-    WebPPictureFree(&pic);
-    return RESULT_SUCCESS;
-}
-
-ResultCode WebPAnimationEncoder::assemble(long timestamp, WebPData *data) {
-    if (!WebPAnimEncoderAdd(webPAnimEncoder, nullptr, timestamp, nullptr)) {
-        return ERROR_MARK_ANIMATION_END_FAILED;
-    }
-    WebPDataInit(data);
-    ResultCode result;
-    if (WebPAnimEncoderAssemble(webPAnimEncoder, data) != 0) {
-        result = RESULT_SUCCESS;
-    } else {
-        result = ERROR_ANIMATION_ASSEMBLE_FAILED;
-    }
-    return result;
 }
 
-void WebPAnimationEncoder::release() {
-    if (webPAnimEncoder != nullptr) {
-        WebPAnimEncoderDelete(webPAnimEncoder);
-        webPAnimEncoder = nullptr;
+void WebPAnimationEncoder::closeStream(JNIEnv *env, ResultCode result) {
+    // The engine writes to the stream writer, neither can be used after closing
+    streamFinished = streamFinished || streamWriter != nullptr;
+    parallelEncoder.reset();
+    streamWriter.reset();
+    if (streamParcelFd != nullptr) {
+        if (result == RESULT_SUCCESS) {
+            file::closeFileDescriptor(env, streamParcelFd);
+        } else {
+            file::closeFileDescriptorWithError(env, streamParcelFd, "Failed to write the animation");
+        }
+        env->DeleteGlobalRef(streamParcelFd);
+        streamParcelFd = nullptr;
     }
 }
 
@@ -119,71 +51,13 @@ WebPAnimationEncoder *WebPAnimationEncoder::getInstance(JNIEnv *env, jobject jen
     return reinterpret_cast<WebPAnimationEncoder *>(native_pointer);
 }
 
-void WebPAnimationEncoder::setProgressNotifier(JNIEnv *env, jobject jencoder) {
-    jweak observer = progressObserver;
-    if (observer != nullptr) {
-        env->DeleteWeakGlobalRef(observer);
-    }
-    progressObserver = env->NewWeakGlobalRef(jencoder);
-}
-
-int WebPAnimationEncoder::notifyProgressChanged(int percent, const WebPPicture *picture) {
-    if (progressObserver == nullptr) return 1;
-    // Get current jvm environment
-    JNIEnv *env;
-    int env_stat = jvm->GetEnv((void **) &env, JNI_VERSION_1_6);
-    // Attach to the current thread if not attached.
-    bool is_attached = false;
-    switch (env_stat) {
-        case JNI_EDETACHED:
-            if (jvm->AttachCurrentThread(&env, nullptr) != 0) {
-                // failed to attach
-                return 0;
-            } else {
-                is_attached = true;
-            }
-            break;
-        case JNI_EVERSION:
-            // version not supported
-            return 0;
-        case JNI_OK:
-            break;
-        default:
-            return 0;
-    }
-    auto *frame_data = reinterpret_cast<UserData *>(picture->user_data);
-    int frame_index = frame_data->frameIndex;
-    jboolean continue_encoding = env->CallBooleanMethod(
-            progressObserver,
-            ClassRegistry::animEncoderNotifyProgressMethodID.get(env),
-            frame_index,
-            percent
-    );
-    // Detach from current thread if attached.
-    if (is_attached) {
-        jvm->DetachCurrentThread();
-    }
-    // Check continue and cancel flags.
-    return continue_encoding && !cancelFlag;
-}
-
-void WebPAnimationEncoder::clearProgressNotifier(JNIEnv *env) {
-    jweak data = progressObserver;
-    if (data != nullptr) {
-        env->DeleteWeakGlobalRef(data);
-        progressObserver = nullptr;
-    }
-}
-
 jlong WebPAnimationEncoder::nativeCreate(
         JNIEnv *env,
-        jobject thiz,
+        jobject,
         jint jwidth,
         jint jheight,
         jobject joptions
 ) {
-    env->GetJavaVM(&jvm);
-    setProgressNotifier(env, thiz);
     WebPAnimEncoderOptions options;
     if (!WebPAnimEncoderOptionsInit(&options)) {
         return 0;
@@ -206,42 +80,108 @@ void WebPAnimationEncoder::nativeConfigure(
         jobject jconfig,
         jobject jpreset
 ) {
-    ResultCode result = RESULT_SUCCESS;
     WebPConfig config;
-    if (WebPConfigInit(&config)) {
-        bool is_config_null = type::isObjectNull(env, jconfig);
-        bool is_preset_null = type::isObjectNull(env, jpreset);
-        if (!is_preset_null) {
-            float quality;
-            if (is_config_null) {
-                quality = 70.0f;
-            } else {
-                quality = enc::parseWebPQuality(env, jconfig);
-            }
-            WebPPreset preset = enc::parseWebPPreset(env, jpreset);
-            if (!WebPConfigPreset(&config, preset, quality)) {
-                result = ERROR_INVALID_WEBP_CONFIG;
-            }
+    ResultCode result = enc::buildWebPConfig(env, jconfig, jpreset, &config);
+    if (result == RESULT_SUCCESS) {
+        auto *encoder = WebPAnimationEncoder::getInstance(env, thiz);
+        if (encoder == nullptr) {
+            result = ERROR_NULL_ENCODER;
+        } else {
+            encoder->configure(config);
         }
-        if (result == RESULT_SUCCESS) {
-            if (!is_config_null) {
-                enc::applyWebPConfig(env, jconfig, &config);
+    }
+    res::handleResult(env, result);
+}
+
+ResultCode WebPAnimationEncoder::addRawFrame(
+        JNIEnv *env,
+        jobject thiz,
+        WebPAnimationEncoder *encoder,
+        const enc::RawFrame &frame,
+        long timestamp
+) {
+    // Frames after finishStreaming would silently start a new animation that is never written
+    if (encoder->streamFinished) {
+        return ERROR_STREAM_FINISHED;
+    }
+    // Settings are checked against it, frames still queued or held by the decimator count as added
+    encoder->submittedFrameCount++;
+
+    // Get output size
+    if (encoder->imageWidth <= 0) {
+        encoder->imageWidth = frame.width;
+    }
+    if (encoder->imageHeight <= 0) {
+        encoder->imageHeight = frame.height;
+    }
+    if (!encoder->frameDecimator.isEnabled()) {
+        return addSampledFrame(env, thiz, encoder, frame, timestamp);
+    }
+
+    // Drop or hold the frame before anything is imported, the candidate copy counts as resident
+    const size_t retained_bytes = encoder->frameDecimator.getRetainedBytes();
+    ResultCode result = encoder->frameDecimator.submit(
+            frame,
+            timestamp,
+            [env, thiz, encoder](const enc::RawFrame &kept, long kept_timestamp) {
+                return addSampledFrame(env, thiz, encoder, kept, kept_timestamp);
             }
-            if (WebPValidateConfig(&config)) {
-                auto *encoder = WebPAnimationEncoder::getInstance(env, thiz);
-                if (encoder == nullptr) {
-                    result = ERROR_NULL_ENCODER;
-                } else {
-                    encoder->configure(config);
-                }
-            } else {
-                result = ERROR_INVALID_WEBP_CONFIG;
+    );
+    encoder->memoryTracker.release(retained_bytes);
+    encoder->memoryTracker.allocate(encoder->frameDecimator.getRetainedBytes());
+    return result;
+}
+
+ResultCode WebPAnimationEncoder::addSampledFrame(
+        JNIEnv *env,
+        jobject thiz,
+        WebPAnimationEncoder *encoder,
+        const enc::RawFrame &frame,
+        long timestamp
+) {
+    // Drop frames that repeat the previous one, the kept frame lasts until the next timestamp
+    const size_t retained_bytes = encoder->frameDeduplicator.getRetainedBytes();
+    const bool duplicate = encoder->frameDeduplicator.isDuplicate(frame);
+    encoder->memoryTracker.release(retained_bytes);
+    encoder->memoryTracker.allocate(encoder->frameDeduplicator.getRetainedBytes());
+    if (duplicate) {
+        return RESULT_SUCCESS;
+    }
+
+    // Copy the frame and let the worker encode it
+    if (encoder->frameQueue.isStarted()) {
+        return encoder->frameQueue.push(frame, timestamp);
+    }
+
+    encoder->progressReporter.attach(prog::javaListener(
+            env,
+            thiz,
+            ClassRegistry::animEncoderNotifyProgressMethodID.get(env),
+            true
+    ));
+    ResultCode result = encoder->addFrame(
+            frame,
+            encoder->imageWidth,
+            encoder->imageHeight,
+            timestamp
+    );
+    encoder->progressReporter.detach();
+    return result;
+}
+
+ResultCode WebPAnimationEncoder::finishFrames(JNIEnv *env, jobject thiz, WebPAnimationEncoder *encoder) {
+    if (encoder->streamFinished) {
+        return ERROR_STREAM_FINISHED;
+    }
+    ResultCode result = encoder->frameDecimator.flush(
+            [env, thiz, encoder](const enc::RawFrame &kept, long kept_timestamp) {
+                return addSampledFrame(env, thiz, encoder, kept, kept_timestamp);
             }
-        }
-    } else {
-        result = ERROR_VERSION_MISMATCH;
+    );
+    if (result == RESULT_SUCCESS && encoder->frameQueue.isStarted()) {
+        result = encoder->frameQueue.drain();
     }
-    res::handleResult(env, result);
+    return result;
 }
 
 void WebPAnimationEncoder::nativeAddFrame(
@@ -267,42 +207,71 @@ void WebPAnimationEncoder::nativeAddFrame(
         return;
     }
 
-    // Get output size
-    int output_width = encoder->imageWidth;
-    if (output_width <= 0) {
-        output_width = static_cast<int>(info.width);
-        encoder->imageWidth = output_width;
-    }
-    int output_height = encoder->imageHeight;
-    if (output_height <= 0) {
-        output_height = static_cast<int>(info.height);
-        encoder->imageHeight = output_height;
-    }
-
     void *pixels;
     if (AndroidBitmap_lockPixels(env, jsrc_bitmap, &pixels) != ANDROID_BITMAP_RESULT_SUCCESS) {
         res::handleResult(env, ERROR_LOCK_BITMAP_PIXELS_FAILED);
         return;
     }
 
-    ResultCode result = encoder->addFrame(
+    enc::RawFrame frame = {
             static_cast<uint8_t *>(pixels),
             static_cast<int>(info.width),
             static_cast<int>(info.height),
-            output_width,
-            output_height,
-            static_cast<long>(jtimestamp)
-    );
+            enc::PIXEL_FORMAT_RGBA_8888,
+            static_cast<int>(info.stride),
+            0
+    };
+    ResultCode result = addRawFrame(env, thiz, encoder, frame, static_cast<long>(jtimestamp));
 
-    if (result != RESULT_SUCCESS) {
-        AndroidBitmap_unlockPixels(env, jsrc_bitmap);
-        res::handleResult(env, result);
+    if (AndroidBitmap_unlockPixels(env, jsrc_bitmap) != ANDROID_BITMAP_RESULT_SUCCESS && result == RESULT_SUCCESS) {
+        result = ERROR_UNLOCK_BITMAP_PIXELS_FAILED;
+    }
+    res::handleResult(env, result);
+}
+
+void WebPAnimationEncoder::nativeAddFrameBuffer(
+        JNIEnv *env,
+        jobject thiz,
+        jlong jtimestamp,
+        jobject jbuffer,
+        jint jwidth,
+        jint jheight,
+        jint jformat,
+        jint jrow_stride,
+        jint juv_row_stride
+) {
+    auto *encoder = WebPAnimationEncoder::getInstance(env, thiz);
+    if (encoder == nullptr) {
+        res::handleResult(env, ERROR_NULL_ENCODER);
         return;
     }
 
-    if (AndroidBitmap_unlockPixels(env, jsrc_bitmap) != ANDROID_BITMAP_RESULT_SUCCESS) {
-        res::handleResult(env, result);
+    // Validate the buffer against the declared layout
+    auto *data = static_cast<const uint8_t *>(env->GetDirectBufferAddress(jbuffer));
+    jlong capacity = env->GetDirectBufferCapacity(jbuffer);
+    if (data == nullptr || jwidth <= 0 || jheight <= 0 || jformat < enc::PIXEL_FORMAT_RGBA_8888 || jformat > enc::PIXEL_FORMAT_I420) {
+        res::handleResult(env, ERROR_INVALID_FRAME_BUFFER);
+        return;
+    }
+    enc::RawFrame frame = {
+            data,
+            static_cast<int>(jwidth),
+            static_cast<int>(jheight),
+            static_cast<enc::PixelFormat>(jformat),
+            static_cast<int>(jrow_stride),
+            static_cast<int>(juv_row_stride)
+    };
+    enc::resolveStrides(&frame);
+    const int min_row_stride = frame.format == enc::PIXEL_FORMAT_RGBA_8888 ? frame.width * 4 : frame.width;
+    const int min_uv_row_stride = frame.format == enc::PIXEL_FORMAT_NV21 ? (frame.width + 1) / 2 * 2 : (frame.width + 1) / 2;
+    if (frame.row_stride < min_row_stride ||
+        (frame.format != enc::PIXEL_FORMAT_RGBA_8888 && frame.uv_row_stride < min_uv_row_stride) ||
+        capacity < 0 || enc::rawFrameByteCount(frame) > static_cast<size_t>(capacity)) {
+        res::handleResult(env, ERROR_INVALID_FRAME_BUFFER);
+        return;
     }
+
+    res::handleResult(env, addRawFrame(env, thiz, encoder, frame, static_cast<long>(jtimestamp)));
 }
 
 void WebPAnimationEncoder::nativeAssemble(
@@ -319,7 +288,18 @@ void WebPAnimationEncoder::nativeAssemble(
         result = ERROR_NULL_ENCODER;
     } else {
         WebPData data;
-        result = encoder->assemble(static_cast<long>(jtimestamp), &data);
+        result = finishFrames(env, thiz, encoder);
+        if (result == RESULT_SUCCESS) {
+            // The parallel engine reports the frames that finish while it waits
+            encoder->progressReporter.attach(prog::javaListener(
+                    env,
+                    thiz,
+                    ClassRegistry::animEncoderNotifyProgressMethodID.get(env),
+                    true
+            ));
+            result = encoder->assemble(encoder->frameDecimator.endTimestamp(static_cast<long>(jtimestamp)), &data);
+            encoder->progressReporter.detach();
+        }
         if (result == RESULT_SUCCESS) {
             result = file::writeToUri(env, jcontext, jdst_uri, data.bytes, data.size);
             WebPDataClear(&data);
@@ -329,8 +309,363 @@ void WebPAnimationEncoder::nativeAssemble(
     res::handleResult(env, result);
 }
 
-void WebPAnimationEncoder::nativeCancel(JNIEnv *, jobject) {
-    cancelFlag = true;
+jobject WebPAnimationEncoder::nativeAssembleToBuffer(
+        JNIEnv *env,
+        jobject thiz,
+        jlong jtimestamp
+) {
+    ResultCode result;
+    jobject jbuffer = nullptr;
+
+    auto *encoder = WebPAnimationEncoder::getInstance(env, thiz);
+    if (encoder == nullptr) {
+        result = ERROR_NULL_ENCODER;
+    } else {
+        WebPData data;
+        result = finishFrames(env, thiz, encoder);
+        if (result == RESULT_SUCCESS) {
+            // The parallel engine reports the frames that finish while it waits
+            encoder->progressReporter.attach(prog::javaListener(
+                    env,
+                    thiz,
+                    ClassRegistry::animEncoderNotifyProgressMethodID.get(env),
+                    true
+            ));
+            result = encoder->assemble(encoder->frameDecimator.endTimestamp(static_cast<long>(jtimestamp)), &data);
+            encoder->progressReporter.detach();
+        }
+        if (result == RESULT_SUCCESS) {
+            jbuffer = buf::wrapWebPData(env, data.bytes, data.size);
+            if (jbuffer == nullptr) {
+                result = ERROR_MEMORY_ERROR;
+            }
+        }
+    }
+
+    res::handleResult(env, result);
+    return jbuffer;
+}
+
+void WebPAnimationEncoder::nativeSetParallelEncoding(
+        JNIEnv *env,
+        jobject thiz,
+        jint jthread_count
+) {
+    auto *encoder = WebPAnimationEncoder::getInstance(env, thiz);
+    if (encoder == nullptr) {
+        res::handleResult(env, ERROR_NULL_ENCODER);
+        return;
+    }
+    if (!encoder->setParallelEncoding(static_cast<int>(jthread_count))) {
+        exc::throwRuntimeException(env, "Parallel encoding must be set before adding frames.");
+    }
+}
+
+void WebPAnimationEncoder::nativeSetSizeBudget(
+        JNIEnv *env,
+        jobject thiz,
+        jlong jbudget_bytes,
+        jint jexpected_frames
+) {
+    auto *encoder = WebPAnimationEncoder::getInstance(env, thiz);
+    if (encoder == nullptr) {
+        res::handleResult(env, ERROR_NULL_ENCODER);
+        return;
+    }
+    size_t budget_bytes = jbudget_bytes > 0 ? static_cast<size_t>(jbudget_bytes) : 0;
+    if (!encoder->setSizeBudget(budget_bytes, static_cast<int>(jexpected_frames))) {
+        exc::throwRuntimeException(env, "Size budget must be set before adding frames.");
+    }
+}
+
+jobject WebPAnimationEncoder::nativeGetSeekReport(JNIEnv *env, jobject thiz) {
+    auto *encoder = WebPAnimationEncoder::getInstance(env, thiz);
+    if (encoder == nullptr || !encoder->hasKeyFrameTable) return nullptr;
+    const KeyFrameTable &table = encoder->keyFrameTable;
+
+    std::vector<int> key_frames = table.getKeyFrames();
+    std::vector<jint> indices(key_frames.begin(), key_frames.end());
+    std::vector<jlong> timestamps;
+    for (int index: key_frames) {
+        timestamps.push_back(static_cast<jlong>(table.getTimestamp(index)));
+    }
+    const auto count = static_cast<jsize>(key_frames.size());
+    jintArray jindices = env->NewIntArray(count);
+    jlongArray jtimestamps = env->NewLongArray(count);
+    if (jindices == nullptr || jtimestamps == nullptr) return nullptr;
+    env->SetIntArrayRegion(jindices, 0, count, indices.data());
+    env->SetLongArrayRegion(jtimestamps, 0, count, timestamps.data());
+
+    jobject jreport = env->NewObject(
+            ClassRegistry::webPSeekReportClass.get(env),
+            ClassRegistry::webPSeekReportConstructorID.get(env),
+            jindices,
+            jtimestamps,
+            static_cast<jint>(table.getFrameCount()),
+            static_cast<jint>(table.getMaxSeekFrames()),
+            static_cast<jlong>(table.getKeyFrameBytes()),
+            static_cast<jlong>(table.getDeltaFrameBytes()),
+            static_cast<jlong>(table.estimateKeyFrameOverhead())
+    );
+    env->DeleteLocalRef(jindices);
+    env->DeleteLocalRef(jtimestamps);
+    return jreport;
+}
+
+void WebPAnimationEncoder::nativeSetMemoryLimit(
+        JNIEnv *env,
+        jobject thiz,
+        jlong jlimit_bytes,
+        jint jpolicy
+) {
+    auto *encoder = WebPAnimationEncoder::getInstance(env, thiz);
+    if (encoder == nullptr) {
+        res::handleResult(env, ERROR_NULL_ENCODER);
+        return;
+    }
+    size_t limit_bytes = jlimit_bytes > 0 ? static_cast<size_t>(jlimit_bytes) : 0;
+    auto policy = jpolicy == MEMORY_POLICY_REDUCE ? MEMORY_POLICY_REDUCE : MEMORY_POLICY_FAIL;
+    if (!encoder->setMemoryLimit(limit_bytes, policy)) {
+        exc::throwRuntimeException(env, "Memory limit must be set before adding frames.");
+    }
+}
+
+jlong WebPAnimationEncoder::nativeGetMemoryUsage(JNIEnv *env, jobject thiz) {
+    auto *encoder = WebPAnimationEncoder::getInstance(env, thiz);
+    if (encoder == nullptr) return 0;
+    return static_cast<jlong>(encoder->memoryTracker.getCurrent());
+}
+
+jlong WebPAnimationEncoder::nativeGetPeakMemoryUsage(JNIEnv *env, jobject thiz) {
+    auto *encoder = WebPAnimationEncoder::getInstance(env, thiz);
+    if (encoder == nullptr) return 0;
+    return static_cast<jlong>(encoder->memoryTracker.getPeak());
+}
+
+void WebPAnimationEncoder::nativeSetAppendSource(
+        JNIEnv *env,
+        jobject thiz,
+        jobject jcontext,
+        jobject jsrc_uri,
+        jboolean jreuse_last_canvas
+) {
+    auto *encoder = WebPAnimationEncoder::getInstance(env, thiz);
+    if (encoder == nullptr) {
+        res::handleResult(env, ERROR_NULL_ENCODER);
+        return;
+    }
+    if (encoder->submittedFrameCount > 0 || encoder->streamWriter != nullptr) {
+        exc::throwRuntimeException(env, "Append source must be set before adding frames and cannot be streamed.");
+        return;
+    }
+
+    uint8_t *file_data = nullptr;
+    size_t file_size = 0;
+    auto read_result = file::readFromUri(env, jcontext, jsrc_uri, &file_data, &file_size);
+    if (read_result.result_code != RESULT_SUCCESS) {
+        res::handleResult(env, read_result.result_code);
+        return;
+    }
+    WebPData data = {file_data, file_size};
+    ResultCode result = encoder->setAppendSource(data, jreuse_last_canvas == JNI_TRUE);
+    env->DeleteLocalRef(read_result.data_buffer);
+    res::handleResult(env, result);
+}
+
+void WebPAnimationEncoder::nativeSetStreamingOutput(
+        JNIEnv *env,
+        jobject thiz,
+        jobject jcontext,
+        jobject jdst_uri
+) {
+    auto *encoder = WebPAnimationEncoder::getInstance(env, thiz);
+    if (encoder == nullptr) {
+        res::handleResult(env, ERROR_NULL_ENCODER);
+        return;
+    }
+    if (encoder->submittedFrameCount > 0 || encoder->streamWriter != nullptr) {
+        exc::throwRuntimeException(env, "Streaming output must be set once before adding frames.");
+        return;
+    }
+    if (encoder->appendBase.bytes != nullptr) {
+        exc::throwRuntimeException(env, "Appended animations cannot be streamed.");
+        return;
+    }
+
+    auto open_result = file::openFileDescriptor(env, jcontext, jdst_uri, "wt");
+    if (open_result.fd == -1) {
+        res::handleResult(env, ERROR_WRITE_TO_URI_FAILED);
+        return;
+    }
+    encoder->streamParcelFd = env->NewGlobalRef(open_result.parcel_fd);
+    env->DeleteLocalRef(open_result.parcel_fd);
+    encoder->streamWriter = std::make_unique<AnimStreamWriter>(
+            open_result.fd,
+            encoder->encoderOptions.anim_params
+    );
+    // Streaming needs independently encoded frames
+    if (encoder->parallelThreadCount < 0) {
+        encoder->parallelThreadCount = 1;
+    }
+}
+
+void WebPAnimationEncoder::nativeFinishStreaming(
+        JNIEnv *env,
+        jobject thiz,
+        jlong jtimestamp
+) {
+    auto *encoder = WebPAnimationEncoder::getInstance(env, thiz);
+    if (encoder == nullptr) {
+        res::handleResult(env, ERROR_NULL_ENCODER);
+        return;
+    }
+    if (encoder->streamWriter == nullptr) {
+        exc::throwRuntimeException(env, "Streaming output is not set.");
+        return;
+    }
+    ResultCode result = finishFrames(env, thiz, encoder);
+    if (result == RESULT_SUCCESS && encoder->parallelEncoder != nullptr) {
+        encoder->progressReporter.attach(prog::javaListener(
+                env,
+                thiz,
+                ClassRegistry::animEncoderNotifyProgressMethodID.get(env),
+                true
+        ));
+        result = encoder->parallelEncoder->finish(encoder->frameDecimator.endTimestamp(static_cast<long>(jtimestamp)));
+        encoder->progressReporter.detach();
+    } else if (result == RESULT_SUCCESS) {
+        result = ERROR_ANIMATION_ASSEMBLE_FAILED;
+    }
+    encoder->closeStream(env, result);
+    res::handleResult(env, result);
+}
+
+void WebPAnimationEncoder::nativeSetDuplicateTolerance(
+        JNIEnv *env,
+        jobject thiz,
+        jint jtolerance
+) {
+    auto *encoder = WebPAnimationEncoder::getInstance(env, thiz);
+    if (encoder == nullptr) return;
+    encoder->frameDeduplicator.setTolerance(static_cast<int>(jtolerance));
+}
+
+void WebPAnimationEncoder::nativeSetFrameResampling(
+        JNIEnv *env,
+        jobject thiz,
+        jfloat jframe_duration,
+        jboolean jmeasure_difference
+) {
+    auto *encoder = WebPAnimationEncoder::getInstance(env, thiz);
+    if (encoder == nullptr) {
+        res::handleResult(env, ERROR_NULL_ENCODER);
+        return;
+    }
+    if (encoder->submittedFrameCount > 0 || encoder->frameDecimator.isStarted()) {
+        exc::throwRuntimeException(env, "Frame resampling must be set before adding frames.");
+        return;
+    }
+    encoder->memoryTracker.release(encoder->frameDecimator.getRetainedBytes());
+    encoder->frameDecimator.configure(static_cast<double>(jframe_duration), jmeasure_difference == JNI_TRUE);
+}
+
+jint WebPAnimationEncoder::nativeGetDecimatedFrameCount(JNIEnv *env, jobject thiz) {
+    auto *encoder = WebPAnimationEncoder::getInstance(env, thiz);
+    if (encoder == nullptr) return 0;
+    return static_cast<jint>(encoder->frameDecimator.getDroppedCount());
+}
+
+jint WebPAnimationEncoder::nativeGetDroppedFrameCount(JNIEnv *env, jobject thiz) {
+    auto *encoder = WebPAnimationEncoder::getInstance(env, thiz);
+    if (encoder == nullptr) return 0;
+    return static_cast<jint>(encoder->frameDeduplicator.getDroppedCount());
+}
+
+void WebPAnimationEncoder::nativeSetAsyncQueue(
+        JNIEnv *env,
+        jobject thiz,
+        jint jcapacity
+) {
+    auto *encoder = WebPAnimationEncoder::getInstance(env, thiz);
+    if (encoder == nullptr) {
+        res::handleResult(env, ERROR_NULL_ENCODER);
+        return;
+    }
+
+    // Finish the frames queued so far before switching modes
+    ResultCode result = encoder->frameQueue.isStarted() ? encoder->frameQueue.drain() : RESULT_SUCCESS;
+    encoder->stopFrameQueue(env);
+    if (result != RESULT_SUCCESS || jcapacity <= 0) {
+        res::handleResult(env, result);
+        return;
+    }
+
+    JavaVM *jvm;
+    if (env->GetJavaVM(&jvm) != JNI_OK) {
+        res::handleResult(env, ERROR_MEMORY_ERROR);
+        return;
+    }
+    // Resolved here, class lookups from the worker thread cannot see app classes
+    jmethodID notify_method_id = ClassRegistry::animEncoderNotifyProgressMethodID.get(env);
+    jobject observer = env->NewGlobalRef(thiz);
+    encoder->asyncObserver = observer;
+    result = encoder->frameQueue.start(
+            static_cast<size_t>(jcapacity),
+            [encoder, jvm, observer, notify_method_id](const QueuedFrame &frame) {
+                // The worker is attached by the hooks below
+                JNIEnv *worker_env = nullptr;
+                jvm->GetEnv(reinterpret_cast<void **>(&worker_env), JNI_VERSION_1_6);
+                encoder->progressReporter.attach(prog::javaListener(worker_env, observer, notify_method_id, true));
+                ResultCode frame_result = encoder->addFrame(
+                        frame.frame,
+                        encoder->imageWidth,
+                        encoder->imageHeight,
+                        frame.timestamp
+                );
+                encoder->progressReporter.detach();
+                if (worker_env->ExceptionCheck()) {
+                    // Listener threw on the worker thread, there is no Java caller to receive it
+                    worker_env->ExceptionDescribe();
+                    worker_env->ExceptionClear();
+                }
+                return frame_result;
+            },
+            &encoder->memoryTracker,
+            WorkerHooks{
+                    [jvm]() {
+                        JNIEnv *worker_env;
+                        return jvm->AttachCurrentThread(&worker_env, nullptr) == JNI_OK
+                               ? RESULT_SUCCESS
+                               : ERROR_MEMORY_ERROR;
+                    },
+                    [jvm]() { jvm->DetachCurrentThread(); }
+            }
+    );
+    if (result != RESULT_SUCCESS) {
+        encoder->stopFrameQueue(env);
+        res::handleResult(env, result);
+    }
+}
+
+void WebPAnimationEncoder::nativeSetProgressInterval(
+        JNIEnv *env,
+        jobject thiz,
+        jlong jinterval_millis,
+        jint jpercent_step
+) {
+    auto *encoder = WebPAnimationEncoder::getInstance(env, thiz);
+    if (encoder == nullptr) return;
+    encoder->progressReporter.setInterval(
+            static_cast<long>(jinterval_millis),
+            static_cast<int>(jpercent_step)
+    );
+}
+
+void WebPAnimationEncoder::nativeCancel(JNIEnv *env, jobject thiz) {
+    auto *encoder = WebPAnimationEncoder::getInstance(env, thiz);
+    if (encoder == nullptr) return;
+    encoder->progressReporter.cancel();
+    encoder->frameQueue.clear();
 }
 
 void WebPAnimationEncoder::nativeRelease(JNIEnv *env, jobject thiz) {
@@ -341,8 +676,8 @@ void WebPAnimationEncoder::nativeRelease(JNIEnv *env, jobject thiz) {
             ClassRegistry::webPAnimEncoderPointerFieldID.get(env),
             static_cast<jlong>(0)
     );
-    clearProgressNotifier(env);
+    encoder->stopFrameQueue(env);
     encoder->release();
+    encoder->closeStream(env, ERROR_USER_ABORT);
     delete encoder;
-    jvm = nullptr;
 }
\ No newline at end of file
@@ -0,0 +1,302 @@
+//
+// Created by udara on 10/19/26.
+//
+
+#include <webp/demux.h>
+
+#include "include/webp_anim_encoder_core.h"
+
+namespace {
+    // libwebp's WebPAnimEncoder keeps a copy of the current canvas, the previous canvas and its disposed version
+    constexpr size_t SEQUENTIAL_CANVAS_COUNT = 3;
+
+    // WebPMemoryWrite grows its buffer by half and to at least 8 KB, and lossless output of noise is about
+    // as large as the ARGB canvas, so an encoded frame stays under two canvases plus the minimum buffer
+    constexpr size_t MIN_WRITER_BYTES = 8192;
+
+    struct UserData {
+        int frameIndex = -1;
+        ProgressReporter *reporter = nullptr;
+    };
+
+    ResultCode decodeLastCanvas(const WebPData &data, std::vector<uint32_t> *canvas) {
+        WebPAnimDecoderOptions options;
+        if (!WebPAnimDecoderOptionsInit(&options)) {
+            return ERROR_VERSION_MISMATCH;
+        }
+        // BGRA bytes read as the ARGB words the parallel engine diffs on little-endian devices
+        options.color_mode = MODE_BGRA;
+        WebPAnimDecoder *decoder = WebPAnimDecoderNew(&data, &options);
+        if (decoder == nullptr) {
+            return ERROR_ANIM_DECODER_CREATE_FAILED;
+        }
+        WebPAnimInfo info;
+        ResultCode result = WebPAnimDecoderGetInfo(decoder, &info) ? RESULT_SUCCESS : ERROR_ANIM_INFO_GET_FAILED;
+        uint8_t *buffer = nullptr;
+        int timestamp;
+        while (result == RESULT_SUCCESS && WebPAnimDecoderHasMoreFrames(decoder)) {
+            if (!WebPAnimDecoderGetNext(decoder, &buffer, &timestamp)) {
+                result = ERROR_WEBP_DECODE_FAILED;
+            }
+        }
+        if (result == RESULT_SUCCESS && buffer != nullptr) {
+            const auto *pixels = reinterpret_cast<const uint32_t *>(buffer);
+            canvas->assign(pixels, pixels + static_cast<size_t>(info.canvas_width) * info.canvas_height);
+        }
+        WebPAnimDecoderDelete(decoder);
+        return result;
+    }
+}
+
+WebPAnimationEncoderCore::WebPAnimationEncoderCore(int width, int height, WebPAnimEncoderOptions options) {
+    this->imageWidth = width;
+    this->imageHeight = height;
+    this->frameCount = 0;
+    this->encoderOptions = options;
+    this->webPAnimEncoder = nullptr;
+    WebPConfigInit(&webPConfig);
+}
+
+void WebPAnimationEncoderCore::configure(WebPConfig config) {
+    webPConfig = config;
+}
+
+bool WebPAnimationEncoderCore::setParallelEncoding(int thread_count) {
+    if (submittedFrameCount > 0) {
+        return false;
+    }
+    parallelThreadCount = thread_count;
+    return true;
+}
+
+bool WebPAnimationEncoderCore::setMemoryLimit(size_t limit_bytes, MemoryPolicy policy) {
+    if (submittedFrameCount > 0) {
+        return false;
+    }
+    memoryTracker.setLimit(limit_bytes);
+    memoryPolicy = policy;
+    if (limit_bytes > 0 && parallelThreadCount < 0) {
+        parallelThreadCount = 0;
+    }
+    return true;
+}
+
+ResultCode WebPAnimationEncoderCore::reserveMemory(size_t bytes, size_t output_bytes) {
+    // Frames still being encoded report their output later, wait for them if it could take us over the limit
+    if (parallelEncoder != nullptr &&
+        !memoryTracker.fits(bytes + parallelEncoder->getEncodingCount() * output_bytes)) {
+        parallelEncoder->waitForEncodes();
+    }
+    if (memoryTracker.fits(bytes)) {
+        return RESULT_SUCCESS;
+    }
+    // Give up size budget corrections and concurrent frames once before failing
+    if (memoryPolicy == MEMORY_POLICY_REDUCE &&
+        parallelEncoder != nullptr &&
+        parallelEncoder->reduceMemory() &&
+        memoryTracker.fits(bytes)) {
+        return RESULT_SUCCESS;
+    }
+    return ERROR_MEMORY_LIMIT_EXCEEDED;
+}
+
+bool WebPAnimationEncoderCore::setSizeBudget(size_t budget_bytes, int expected_frames) {
+    if (submittedFrameCount > 0) {
+        return false;
+    }
+    rateController.setBudget(budget_bytes, expected_frames);
+    if (budget_bytes > 0 && parallelThreadCount < 0) {
+        parallelThreadCount = 0;
+    }
+    return true;
+}
+
+ResultCode WebPAnimationEncoderCore::setAppendSource(const WebPData &data, bool reuse_last_canvas) {
+    WebPDemuxer *demuxer = WebPDemux(&data);
+    if (demuxer == nullptr) {
+        return ERROR_WEBP_INFO_EXTRACT_FAILED;
+    }
+    const bool animated = (WebPDemuxGetI(demuxer, WEBP_FF_FORMAT_FLAGS) & ANIMATION_FLAG) != 0;
+    const int canvas_width = static_cast<int>(WebPDemuxGetI(demuxer, WEBP_FF_CANVAS_WIDTH));
+    const int canvas_height = static_cast<int>(WebPDemuxGetI(demuxer, WEBP_FF_CANVAS_HEIGHT));
+    bool disposed = false;
+    WebPIterator last;
+    if (animated && WebPDemuxGetFrame(demuxer, 0, &last)) {
+        disposed = last.dispose_method == WEBP_MUX_DISPOSE_BACKGROUND;
+        WebPDemuxReleaseIterator(&last);
+    }
+    WebPDemuxDelete(demuxer);
+    if (!animated) {
+        return ERROR_NOT_AN_ANIMATION;
+    }
+
+    // Keyframe distances continue across the appended frames
+    KeyFrameTable table;
+    if (!table.parse(data)) {
+        return ERROR_WEBP_INFO_EXTRACT_FAILED;
+    }
+    const int frames_since_keyframe = table.getFrameCount() - 1 - table.getKeyFrames().back();
+
+    // A last frame disposed to the background does not leave its canvas for the next frame
+    std::vector<uint32_t> canvas;
+    if (reuse_last_canvas && !disposed) {
+        ResultCode result = decodeLastCanvas(data, &canvas);
+        if (result != RESULT_SUCCESS) {
+            return result;
+        }
+    }
+
+    memoryTracker.release(appendBase.size);
+    WebPDataClear(&appendBase);
+    if (!WebPDataCopy(&data, &appendBase)) {
+        return ERROR_MEMORY_ERROR;
+    }
+    memoryTracker.allocate(appendBase.size);
+    memoryTracker.release(appendCanvas.size() * sizeof(uint32_t));
+    memoryTracker.allocate(canvas.size() * sizeof(uint32_t));
+    appendCanvas.swap(canvas);
+    appendFramesSinceKeyframe = frames_since_keyframe;
+    imageWidth = canvas_width;
+    imageHeight = canvas_height;
+    if (parallelThreadCount < 0) {
+        parallelThreadCount = 0;
+    }
+    return RESULT_SUCCESS;
+}
+
+ResultCode WebPAnimationEncoderCore::addFrame(
+        const enc::RawFrame &frame,
+        int output_width,
+        int output_height,
+        long timestamp
+) {
+    // The imported picture, its copy in the engine and its encoded output, plus the diff canvas of the first frame
+    const size_t canvas_bytes = static_cast<size_t>(output_width) * output_height * 4;
+    const size_t output_bytes = 2 * canvas_bytes + MIN_WRITER_BYTES;
+    ResultCode result = reserveMemory(canvas_bytes * (frameCount == 0 ? 3 : 2) + output_bytes, output_bytes);
+    if (result != RESULT_SUCCESS) {
+        return result;
+    }
+
+    // Init picture
+    WebPPicture pic;
+    if (!WebPPictureInit(&pic)) {
+        return ERROR_VERSION_MISMATCH;
+    }
+    size_t picture_bytes = 0;
+    auto free_picture = [this, &pic, &picture_bytes]() {
+        memoryTracker.release(picture_bytes);
+        WebPPictureFree(&pic);
+    };
+
+    // Import pixel data at the output size
+    result = enc::importRawFrame(frame, output_width, output_height, &pic);
+    if (result != RESULT_SUCCESS) {
+        WebPPictureFree(&pic);
+        return result;
+    }
+    picture_bytes = MemoryTracker::pictureByteCount(pic);
+    memoryTracker.allocate(picture_bytes);
+
+    // Diff and queue the frame on the parallel engine
+    if (parallelThreadCount >= 0) {
+        // The engine diffs frames in ARGB
+        if (!pic.use_argb) {
+            if (!WebPPictureYUVAToARGB(&pic)) {
+                free_picture();
+                return ERROR_MEMORY_ERROR;
+            }
+            const size_t argb_bytes = MemoryTracker::pictureByteCount(pic) - picture_bytes;
+            memoryTracker.allocate(argb_bytes);
+            picture_bytes += argb_bytes;
+        }
+        if (parallelEncoder == nullptr) {
+            parallelEncoder = std::make_unique<ParallelAnimEncoder>(
+                    output_width,
+                    output_height,
+                    encoderOptions,
+                    parallelThreadCount,
+                    &progressReporter,
+                    streamWriter.get(),
+                    &rateController,
+                    &memoryTracker
+            );
+            if (appendBase.bytes != nullptr) {
+                parallelEncoder->setBaseAnimation(&appendBase, appendCanvas, appendFramesSinceKeyframe);
+                memoryTracker.release(appendCanvas.size() * sizeof(uint32_t));
+                std::vector<uint32_t>().swap(appendCanvas);
+            }
+        }
+        result = parallelEncoder->addFrame(&pic, timestamp, webPConfig, frameCount++);
+        free_picture();
+        return result;
+    }
+
+    auto user_data = UserData{};
+    user_data.frameIndex = frameCount++;
+    user_data.reporter = &progressReporter;
+    pic.user_data = reinterpret_cast<void *>(&user_data);
+    pic.progress_hook = &notifyProgressChanged;
+
+    // Create encoder if not created
+    if (webPAnimEncoder == nullptr) {
+        webPAnimEncoder = WebPAnimEncoderNew(output_width, output_height, &encoderOptions);
+        if (webPAnimEncoder == nullptr) {
+            free_picture();
+            return ERROR_MEMORY_ERROR;
+        }
+        // Only its current, previous and disposed canvases are known, encoded frames are not visible
+        sequentialCanvasBytes = SEQUENTIAL_CANVAS_COUNT * canvas_bytes;
+        memoryTracker.allocate(sequentialCanvasBytes);
+    }
+
+    // Add frame
+    if (!WebPAnimEncoderAdd(webPAnimEncoder, &pic, timestamp, &webPConfig)) {
+        free_picture();
+        return res::encodingErrorToResultCode(pic.error_code);
+    }
+
+    // Release picture
+    free_picture();
+    return RESULT_SUCCESS;
+}
+
+ResultCode WebPAnimationEncoderCore::assemble(long timestamp, WebPData *data) {
+    ResultCode result;
+    if (parallelEncoder != nullptr) {
+        result = parallelEncoder->assemble(timestamp, data);
+    } else if (!WebPAnimEncoderAdd(webPAnimEncoder, nullptr, timestamp, nullptr)) {
+        result = ERROR_MARK_ANIMATION_END_FAILED;
+    } else {
+        WebPDataInit(data);
+        if (WebPAnimEncoderAssemble(webPAnimEncoder, data) != 0) {
+            result = RESULT_SUCCESS;
+        } else {
+            result = ERROR_ANIMATION_ASSEMBLE_FAILED;
+        }
+    }
+    hasKeyFrameTable = result == RESULT_SUCCESS && keyFrameTable.parse(*data);
+    if (result == RESULT_SUCCESS) {
+        // Owned by the caller, but part of the peak
+        memoryTracker.allocate(data->size);
+        memoryTracker.release(data->size);
+    }
+    return result;
+}
+
+void WebPAnimationEncoderCore::release() {
+    parallelEncoder.reset();
+    memoryTracker.release(appendBase.size);
+    WebPDataClear(&appendBase);
+    if (webPAnimEncoder != nullptr) {
+        WebPAnimEncoderDelete(webPAnimEncoder);
+        webPAnimEncoder = nullptr;
+        memoryTracker.release(sequentialCanvasBytes);
+        sequentialCanvasBytes = 0;
+    }
+}
+
+int WebPAnimationEncoderCore::notifyProgressChanged(int percent, const WebPPicture *picture) {
+    auto *frame_data = reinterpret_cast<UserData *>(picture->user_data);
+    return frame_data->reporter->update(frame_data->frameIndex, percent);
+}
@@ -2,9 +2,12 @@
 // Created by udara on 11/5/21.
 //
 
+#include <vector>
+
 #include "include/webp_decoder.h"
 #include "include/native_loader.h"
 #include "include/bitmap_utils.h"
+#include "include/encoder_helper.h"
 #include "include/file_utils.h"
 #include "include/type_helper.h"
 
@@ -19,34 +22,19 @@ namespace dec {
         std::string name_prefix(prefix_cstr);
         env->ReleaseStringUTFChars(jprefix, prefix_cstr);
 
-        // image name repeat character
-        char repeat_character = (char) env->GetCharField(
-                jconfig,
-                ClassRegistry::decoderConfigRepeatCharacterFieldID.get(env)
-        );
-
-        // image name character count
-        int repeat_character_count = env->GetIntField(
-                jconfig,
-                ClassRegistry::decoderConfigRepeatCharacterCountFieldID.get(env)
-        );
-
-        // image compress format
-        auto jcompress_format = env->GetObjectField(
-                jconfig,
-                ClassRegistry::decoderConfigCompressFormatFieldID.get(env)
-        );
-        int compress_format_ordinal = env->CallIntMethod(
-                jcompress_format,
-                ClassRegistry::bitmapCompressFormatOrdinalMethodID.get(env)
-        );
-        env->DeleteLocalRef(jcompress_format);
-
-        // image compress quality
-        int compress_quality = env->GetIntField(
+        // packed fields
+        type::PackedValues packed;
+        type::readPackedValues(
+                env,
                 jconfig,
-                ClassRegistry::decoderConfigCompressQualityFieldID.get(env)
+                ClassRegistry::decoderConfigPackedFieldID.get(env),
+                DECODER_CONFIG_VALUE_COUNT,
+                &packed
         );
+        auto repeat_character = static_cast<char>(packed.values[DECODER_CONFIG_REPEAT_CHARACTER]);
+        int repeat_character_count = packed.values[DECODER_CONFIG_REPEAT_CHARACTER_COUNT];
+        int compress_format_ordinal = packed.values[DECODER_CONFIG_COMPRESS_FORMAT];
+        int compress_quality = packed.values[DECODER_CONFIG_COMPRESS_QUALITY];
 
         return {
                 name_prefix,
@@ -158,42 +146,45 @@ namespace dec {
         );
     }
 
-    jboolean nativeHasNextFrame(JNIEnv *env, jobject jdecoder) {
-        auto *decoder = WebPDecoder::getInstance(env, jdecoder);
+    jlong packFrameDecodeResult(const FrameDecodeResult &result) {
+        const auto timestamp = static_cast<uint32_t>(result.timestamp);
+        const auto frame_index = static_cast<uint64_t>(result.frame_index + 1) & 0xFFFFFF;
+        const auto result_code = static_cast<uint64_t>(result.result_code) & 0xFF;
+        return static_cast<jlong>(result_code << 56 | frame_index << 32 | timestamp);
+    }
+
+    jboolean criticalHasNextFrame(jlong jpointer) {
+        auto *decoder = reinterpret_cast<WebPDecoder *>(jpointer);
         if (decoder == nullptr) return false;
         return static_cast<jboolean>(decoder->hasNextFrame());
     }
 
-    jint nativeNextFrameIndex(JNIEnv *env, jobject jdecoder) {
-        auto *decoder = WebPDecoder::getInstance(env, jdecoder);
+    jint criticalNextFrameIndex(jlong jpointer) {
+        auto *decoder = reinterpret_cast<WebPDecoder *>(jpointer);
         if (decoder == nullptr) return -1;
         return static_cast<jint>(decoder->nextFrameIndex());
     }
 
-    jobject nativeDecodeNextFrame(JNIEnv *env, jobject jdecoder) {
-        auto *decoder = WebPDecoder::getInstance(env, jdecoder);
-        jobject bitmap_frame;
-        int timestamp;
-        ResultCode result_code;
+    jboolean nativeHasNextFrame(JNIEnv *, jclass, jlong jpointer) {
+        return criticalHasNextFrame(jpointer);
+    }
+
+    jint nativeNextFrameIndex(JNIEnv *, jclass, jlong jpointer) {
+        return criticalNextFrameIndex(jpointer);
+    }
 
+    jlong nativeDecodeNextFrame(JNIEnv *env, jobject jdecoder) {
+        auto *decoder = WebPDecoder::getInstance(env, jdecoder);
         if (decoder == nullptr) {
-            bitmap_frame = nullptr;
-            timestamp = 0;
-            result_code = ERROR_NULL_DECODER;
-        } else {
-            auto decode_result = decoder->decodeNextFrame(env);
-            bitmap_frame = decode_result.bitmap_frame;
-            timestamp = decode_result.timestamp;
-            result_code = decode_result.result_code;
+            return packFrameDecodeResult({ERROR_NULL_DECODER, -1, nullptr, 0});
         }
+        return packFrameDecodeResult(decoder->decodeNextFrame(env));
+    }
 
-        return env->NewObject(
-                ClassRegistry::frameDecodeResultClass.get(env),
-                ClassRegistry::frameDecodeResultConstructorID.get(env),
-                bitmap_frame,
-                static_cast<jint>(timestamp),
-                static_cast<jint>(result_code)
-        );
+    jobject nativeGetFrameBitmap(JNIEnv *env, jobject jdecoder) {
+        auto *decoder = WebPDecoder::getInstance(env, jdecoder);
+        if (decoder == nullptr) return nullptr;
+        return decoder->getFrameBitmap(env);
     }
 
     jint nativeDecodeFrames(
@@ -207,6 +198,79 @@ namespace dec {
         return decoder->decodeFrames(env, jdecoder, jcontext, jdst_uri);
     }
 
+    jlong nativeDecodeFrameBatch(
+            JNIEnv *env,
+            jobject jdecoder,
+            jint jcount,
+            jobject jdst_buffer,
+            jintArray jtimestamps
+    ) {
+        ResultCode result_code = RESULT_SUCCESS;
+        int decoded = 0;
+        auto *decoder = WebPDecoder::getInstance(env, jdecoder);
+        auto *dst = static_cast<uint8_t *>(env->GetDirectBufferAddress(jdst_buffer));
+        if (decoder == nullptr) {
+            result_code = ERROR_NULL_DECODER;
+        } else if (dst == nullptr || jcount < 0 || env->GetArrayLength(jtimestamps) < jcount) {
+            result_code = ERROR_INVALID_FRAME_BUFFER;
+        } else {
+            std::vector<int> timestamps(jcount);
+            result_code = decoder->decodeFrameBatch(
+                    jcount,
+                    dst,
+                    static_cast<size_t>(env->GetDirectBufferCapacity(jdst_buffer)),
+                    timestamps.data(),
+                    &decoded
+            );
+            if (decoded > 0) {
+                env->SetIntArrayRegion(jtimestamps, 0, decoded, timestamps.data());
+            }
+        }
+        return static_cast<jlong>(static_cast<uint64_t>(result_code) << 32 | static_cast<uint32_t>(decoded));
+    }
+
+    jobject nativeExtractFrame(
+            JNIEnv *env,
+            jobject jdecoder,
+            jobject jcontext,
+            jint jindex,
+            jobject jdst_uri,
+            jobject jconfig,
+            jobject jpreset
+    ) {
+        auto *decoder = WebPDecoder::getInstance(env, jdecoder);
+        ResultCode result_code;
+        bool copied = false;
+
+        // Frames that cannot be copied are kept lossless unless configured otherwise
+        WebPConfig config;
+        if (type::isObjectNull(env, jconfig) && type::isObjectNull(env, jpreset)) {
+            result_code = WebPConfigInit(&config) ? RESULT_SUCCESS : ERROR_VERSION_MISMATCH;
+            config.lossless = 1;
+            config.exact = 1;
+        } else {
+            result_code = enc::buildWebPConfig(env, jconfig, jpreset, &config);
+        }
+
+        if (decoder == nullptr) {
+            result_code = ERROR_NULL_DECODER;
+        } else if (result_code == RESULT_SUCCESS) {
+            WebPData webp_data;
+            result_code = decoder->extractFrame(static_cast<int>(jindex), config, &webp_data, &copied);
+            if (result_code == RESULT_SUCCESS) {
+                result_code = file::writeToUri(env, jcontext, jdst_uri, webp_data.bytes, webp_data.size);
+            }
+            WebPDataClear(&webp_data);
+        }
+
+        return env->NewObject(
+                ClassRegistry::frameExtractResultClass.get(env),
+                ClassRegistry::frameExtractResultConstructorID.get(env),
+                static_cast<jboolean>(copied),
+                static_cast<jint>(result_code)
+        );
+    }
+
     void nativeReset(JNIEnv *env, jobject jdecoder) {
         auto *decoder = WebPDecoder::getInstance(env, jdecoder);
         if (decoder == nullptr) return;
@@ -252,56 +316,16 @@ void WebPDecoder::configure(dec::DecoderConfig *config) {
 ResultCode WebPDecoder::setDataBuffer(JNIEnv *env, jobject jbuffer) {
     fullReset(env);
 
-    ResultCode result_code = RESULT_SUCCESS;
-
     // get buffer pointer and the size
     const uint8_t *file_data = static_cast<uint8_t *>(env->GetDirectBufferAddress(jbuffer));
     const size_t file_size = env->GetDirectBufferCapacity(jbuffer);
 
-    // read webp features
-    VP8StatusCode features_get_status = WebPGetFeatures(file_data, file_size, &webp_features_);
-    if (features_get_status == VP8_STATUS_OK) {
-        // create frame bitmap
+    ResultCode result_code = setData(file_data, file_size);
+    if (result_code == RESULT_SUCCESS) {
+        // create frame bitmap and keep the data alive
         jobject jbitmap = bmp::createBitmap(env, webp_features_.width, webp_features_.height);
         bitmap_frame_ = env->NewGlobalRef(jbitmap);
-    } else {
-        result_code = res::vp8StatusCodeToResultCode(features_get_status);
-    }
-
-    // init decoders
-    if (result_code == RESULT_SUCCESS) {
-        if (webp_features_.has_animation) {
-            // init decoder and get animation info
-            WebPAnimDecoderOptions options;
-            if (WebPAnimDecoderOptionsInit(&options)) {
-                options.color_mode = MODE_RGBA;
-                options.use_threads = true;
-
-                WebPData webp_data;
-                WebPDataInit(&webp_data);
-                webp_data.size = file_size;
-                webp_data.bytes = file_data;
-                decoder_ = WebPAnimDecoderNew(&webp_data, &options);
-
-                // get anim info
-                if (decoder_ != nullptr) {
-                    if (!WebPAnimDecoderGetInfo(decoder_, &anim_info_)) {
-                        result_code = ERROR_ANIM_INFO_GET_FAILED;
-                    }
-                } else {
-                    result_code = ERROR_ANIM_DECODER_CREATE_FAILED;
-                }
-            } else {
-                result_code = ERROR_VERSION_MISMATCH;
-            }
-        }
-    }
-
-    // set webp data
-    if (result_code == RESULT_SUCCESS) {
         data_buffer_ = env->NewGlobalRef(jbuffer);
-    } else {
-        fullReset(env);
     }
 
     return result_code;
@@ -343,64 +367,23 @@ dec::InfoDecodeResult WebPDecoder::decodeWebPInfo(JNIEnv *env) {
     return {result_code, webp_info};
 }
 
-bool WebPDecoder::hasNextFrame() {
-    if (data_buffer_ == nullptr) return false;
-    if (webp_features_.has_animation) {
-        return WebPAnimDecoderHasMoreFrames(decoder_);
-    } else {
-        return current_frame_index_ < 1;
-    }
-}
-
-int WebPDecoder::nextFrameIndex() {
-    return current_frame_index_;
+jobject WebPDecoder::getFrameBitmap(JNIEnv *env) {
+    if (bitmap_frame_ == nullptr) return nullptr;
+    return env->NewLocalRef(bitmap_frame_);
 }
 
 dec::FrameDecodeResult WebPDecoder::decodeNextFrame(JNIEnv *env) {
-    ResultCode result_code;
-    int frame_index = -1;
-    jobject bitmap_frame = nullptr;
-    int timestamp = 0;
-
-    if (data_buffer_ == nullptr) {
-        result_code = ERROR_DATA_SOURCE_NOT_SET;
-    } else if (webp_features_.has_animation) {
-        uint8_t *pixels;
-        if (current_frame_index_ >= anim_info_.frame_count) {
-            result_code = ERROR_NO_MORE_FRAMES;
-        } else if (WebPAnimDecoderGetNext(decoder_, &pixels, &timestamp)) {
-            result_code = bmp::copyPixels(env, pixels, bitmap_frame_);
-            if (result_code == RESULT_SUCCESS) {
-                frame_index = current_frame_index_;
-                bitmap_frame = bitmap_frame_;
-            }
-            current_frame_index_++;
-        } else {
-            result_code = ERROR_WEBP_DECODE_FAILED;
-        }
-    } else {
-        if (current_frame_index_ >= 1) {
-            result_code = ERROR_NO_MORE_FRAMES;
-        } else {
-            const uint8_t *file_data = static_cast<uint8_t *>(env->GetDirectBufferAddress(data_buffer_));
-            int width;
-            int height;
-            const size_t file_size = env->GetDirectBufferCapacity(data_buffer_);
-            uint8_t *pixels = WebPDecodeRGBA(file_data, file_size, &width, &height);
-            if (pixels == nullptr) {
-                result_code = ERROR_WEBP_DECODE_FAILED;
-            } else {
-                result_code = bmp::copyPixels(env, pixels, bitmap_frame_);
-                if (result_code == RESULT_SUCCESS) {
-                    frame_index = current_frame_index_;
-                    bitmap_frame = bitmap_frame_;
-                }
-                current_frame_index_++;
-            }
-        }
+    const int frame_index = current_frame_index_;
+    const uint8_t *pixels;
+    int timestamp;
+    ResultCode result_code = WebPDecoderCore::decodeNextFrame(&pixels, &timestamp);
+    if (result_code == RESULT_SUCCESS) {
+        result_code = bmp::copyPixels(env, pixels, bitmap_frame_);
     }
-
-    return {result_code, frame_index, bitmap_frame, timestamp};
+    if (result_code != RESULT_SUCCESS) {
+        return {result_code, -1, nullptr, timestamp};
+    }
+    return {result_code, frame_index, bitmap_frame_, timestamp};
 }
 
 ResultCode WebPDecoder::decodeFrames(
@@ -500,19 +483,8 @@ ResultCode WebPDecoder::decodeFrames(
     return result_code;
 }
 
-void WebPDecoder::reset() {
-    current_frame_index_ = 0;
-    if (decoder_ != nullptr) {
-        WebPAnimDecoderReset(decoder_);
-    }
-}
-
 void WebPDecoder::fullReset(JNIEnv *env) {
-    // delete previous decoder if exists
-    if (decoder_ != nullptr) {
-        WebPAnimDecoderDelete(decoder_);
-        decoder_ = nullptr;
-    }
+    clearData();
     // recycle bitmap
     if (bitmap_frame_ != nullptr) {
         bmp::recycleBitmap(env, bitmap_frame_);
@@ -524,12 +496,4 @@ void WebPDecoder::fullReset(JNIEnv *env) {
         env->DeleteGlobalRef(data_buffer_);
         data_buffer_ = nullptr;
     }
-    // reset data
-    webp_features_ = {0};
-    anim_info_ = {0};
-    current_frame_index_ = 0;
 }
-
-void WebPDecoder::cancel() {
-    cancel_flag_ = true;
-}
\ No newline at end of file
@@ -0,0 +1,313 @@
+//
+// Created by udara on 10/19/26.
+//
+
+#include <cstring>
+#include <webp/mux.h>
+
+#include "include/webp_decoder_core.h"
+#include "include/picture_import.h"
+
+namespace {
+    ResultCode copyFrame(const WebPMux *mux, const WebPData &bitstream, WebPData *output) {
+        WebPMux *still = WebPMuxNew();
+        if (still == nullptr) {
+            return ERROR_MEMORY_ERROR;
+        }
+        bool ok = WebPMuxSetImage(still, &bitstream, 1) == WEBP_MUX_OK;
+        WebPData icc_profile;
+        if (ok && WebPMuxGetChunk(mux, "ICCP", &icc_profile) == WEBP_MUX_OK) {
+            ok = WebPMuxSetChunk(still, "ICCP", &icc_profile, 1) == WEBP_MUX_OK;
+        }
+        ok = ok && WebPMuxAssemble(still, output) == WEBP_MUX_OK;
+        WebPMuxDelete(still);
+        return ok ? RESULT_SUCCESS : ERROR_ANIMATION_ASSEMBLE_FAILED;
+    }
+
+    ResultCode reencodeFrame(const WebPData &data, int index, const WebPConfig &config, WebPData *output) {
+        WebPAnimDecoderOptions options;
+        if (!WebPAnimDecoderOptionsInit(&options)) {
+            return ERROR_VERSION_MISMATCH;
+        }
+        options.color_mode = MODE_RGBA;
+        WebPAnimDecoder *decoder = WebPAnimDecoderNew(&data, &options);
+        if (decoder == nullptr) {
+            return ERROR_ANIM_DECODER_CREATE_FAILED;
+        }
+        WebPAnimInfo info;
+        ResultCode result = WebPAnimDecoderGetInfo(decoder, &info) ? RESULT_SUCCESS : ERROR_ANIM_INFO_GET_FAILED;
+
+        // Compose the canvas up to the frame
+        uint8_t *canvas = nullptr;
+        int timestamp;
+        for (int i = 0; i <= index && result == RESULT_SUCCESS; i++) {
+            if (!WebPAnimDecoderGetNext(decoder, &canvas, &timestamp)) {
+                result = ERROR_WEBP_DECODE_FAILED;
+            }
+        }
+
+        WebPPicture picture;
+        WebPMemoryWriter writer;
+        WebPMemoryWriterInit(&writer);
+        if (result == RESULT_SUCCESS && !WebPPictureInit(&picture)) {
+            result = ERROR_VERSION_MISMATCH;
+        } else if (result == RESULT_SUCCESS) {
+            const int width = static_cast<int>(info.canvas_width);
+            const int height = static_cast<int>(info.canvas_height);
+            enc::RawFrame frame = {canvas, width, height, enc::PIXEL_FORMAT_RGBA_8888, width * 4, 0};
+            result = enc::importRawFrame(frame, width, height, &picture);
+            if (result == RESULT_SUCCESS) {
+                picture.writer = WebPMemoryWrite;
+                picture.custom_ptr = &writer;
+                if (!WebPEncode(&config, &picture)) {
+                    result = res::encodingErrorToResultCode(picture.error_code);
+                }
+            }
+            WebPPictureFree(&picture);
+        }
+        WebPAnimDecoderDelete(decoder);
+
+        if (result == RESULT_SUCCESS) {
+            output->bytes = writer.mem;
+            output->size = writer.size;
+        } else {
+            WebPMemoryWriterClear(&writer);
+        }
+        return result;
+    }
+}
+
+WebPDecoderCore::~WebPDecoderCore() {
+    clearData();
+}
+
+ResultCode WebPDecoderCore::setData(const uint8_t *data, size_t size) {
+    clearData();
+
+    // read webp features
+    ResultCode result_code = RESULT_SUCCESS;
+    VP8StatusCode features_get_status = WebPGetFeatures(data, size, &webp_features_);
+    if (features_get_status != VP8_STATUS_OK) {
+        result_code = res::vp8StatusCodeToResultCode(features_get_status);
+    }
+
+    // init decoders
+    if (result_code == RESULT_SUCCESS && webp_features_.has_animation) {
+        // init decoder and get animation info
+        WebPAnimDecoderOptions options;
+        if (WebPAnimDecoderOptionsInit(&options)) {
+            options.color_mode = MODE_RGBA;
+            options.use_threads = true;
+
+            WebPData webp_data;
+            WebPDataInit(&webp_data);
+            webp_data.size = size;
+            webp_data.bytes = data;
+            decoder_ = WebPAnimDecoderNew(&webp_data, &options);
+
+            // get anim info
+            if (decoder_ != nullptr) {
+                if (!WebPAnimDecoderGetInfo(decoder_, &anim_info_)) {
+                    result_code = ERROR_ANIM_INFO_GET_FAILED;
+                }
+            } else {
+                result_code = ERROR_ANIM_DECODER_CREATE_FAILED;
+            }
+        } else {
+            result_code = ERROR_VERSION_MISMATCH;
+        }
+    }
+
+    // set webp data
+    if (result_code == RESULT_SUCCESS) {
+        data_ = data;
+        data_size_ = size;
+    } else {
+        clearData();
+    }
+
+    return result_code;
+}
+
+void WebPDecoderCore::clearData() {
+    // delete previous decoder if exists
+    if (decoder_ != nullptr) {
+        WebPAnimDecoderDelete(decoder_);
+        decoder_ = nullptr;
+    }
+    // reset data
+    data_ = nullptr;
+    data_size_ = 0;
+    webp_features_ = {0};
+    anim_info_ = {0};
+    std::vector<uint8_t>().swap(still_frame_);
+    current_frame_index_ = 0;
+}
+
+const WebPBitstreamFeatures &WebPDecoderCore::getFeatures() const {
+    return webp_features_;
+}
+
+const WebPAnimInfo &WebPDecoderCore::getAnimInfo() const {
+    return anim_info_;
+}
+
+bool WebPDecoderCore::hasNextFrame() {
+    if (data_ == nullptr) return false;
+    if (webp_features_.has_animation) {
+        return WebPAnimDecoderHasMoreFrames(decoder_);
+    } else {
+        return current_frame_index_ < 1;
+    }
+}
+
+int WebPDecoderCore::nextFrameIndex() {
+    return current_frame_index_;
+}
+
+ResultCode WebPDecoderCore::decodeNextFrame(const uint8_t **pixels, int *timestamp) {
+    *pixels = nullptr;
+    *timestamp = 0;
+    if (data_ == nullptr) {
+        return ERROR_DATA_SOURCE_NOT_SET;
+    }
+
+    if (webp_features_.has_animation) {
+        if (current_frame_index_ >= anim_info_.frame_count) {
+            return ERROR_NO_MORE_FRAMES;
+        }
+        uint8_t *canvas;
+        if (!WebPAnimDecoderGetNext(decoder_, &canvas, timestamp)) {
+            return ERROR_WEBP_DECODE_FAILED;
+        }
+        *pixels = canvas;
+    } else {
+        if (current_frame_index_ >= 1) {
+            return ERROR_NO_MORE_FRAMES;
+        }
+        // Kept until the data changes, there is no canvas to decode into
+        const int stride = webp_features_.width * 4;
+        still_frame_.resize(static_cast<size_t>(stride) * webp_features_.height);
+        if (WebPDecodeRGBAInto(data_, data_size_, still_frame_.data(), still_frame_.size(), stride) == nullptr) {
+            return ERROR_WEBP_DECODE_FAILED;
+        }
+        *pixels = still_frame_.data();
+    }
+    current_frame_index_++;
+    return RESULT_SUCCESS;
+}
+
+ResultCode WebPDecoderCore::decodeFrameBatch(
+        int count,
+        uint8_t *dst,
+        size_t dst_size,
+        int *timestamps,
+        int *decoded
+) {
+    *decoded = 0;
+    if (data_ == nullptr) {
+        return ERROR_DATA_SOURCE_NOT_SET;
+    }
+    const int stride = webp_features_.width * 4;
+    const size_t frame_size = static_cast<size_t>(stride) * webp_features_.height;
+    if (dst_size < frame_size * count) {
+        return ERROR_INVALID_FRAME_BUFFER;
+    }
+
+    if (!webp_features_.has_animation) {
+        if (current_frame_index_ >= 1 || count == 0) {
+            return RESULT_SUCCESS;
+        }
+        // Decode in place, there is no canvas to copy from
+        if (WebPDecodeRGBAInto(data_, data_size_, dst, frame_size, stride) == nullptr) {
+            return ERROR_WEBP_DECODE_FAILED;
+        }
+        timestamps[0] = 0;
+        current_frame_index_++;
+        *decoded = 1;
+        return RESULT_SUCCESS;
+    }
+
+    while (*decoded < count && current_frame_index_ < anim_info_.frame_count) {
+        if (cancel_flag_) {
+            return ERROR_USER_ABORT;
+        }
+        uint8_t *pixels;
+        int timestamp;
+        if (!WebPAnimDecoderGetNext(decoder_, &pixels, &timestamp)) {
+            return ERROR_WEBP_DECODE_FAILED;
+        }
+        memcpy(dst + frame_size * *decoded, pixels, frame_size);
+        timestamps[*decoded] = timestamp;
+        current_frame_index_++;
+        (*decoded)++;
+    }
+    return RESULT_SUCCESS;
+}
+
+ResultCode WebPDecoderCore::extractFrame(
+        int index,
+        const WebPConfig &config,
+        WebPData *output,
+        bool *copied
+) {
+    WebPDataInit(output);
+    *copied = false;
+    if (data_ == nullptr) {
+        return ERROR_DATA_SOURCE_NOT_SET;
+    }
+    const WebPData data = {data_, data_size_};
+
+    WebPMux *mux = WebPMuxCreate(&data, 0);
+    if (mux == nullptr) {
+        return ERROR_WEBP_INFO_EXTRACT_FAILED;
+    }
+    int canvas_width = 0;
+    int canvas_height = 0;
+    WebPMuxFrameInfo frame;
+    ResultCode result_code = RESULT_SUCCESS;
+    if (index < 0 || WebPMuxGetFrame(mux, index + 1, &frame) != WEBP_MUX_OK) {
+        WebPMuxDelete(mux);
+        return ERROR_INVALID_FRAME_RANGE;
+    }
+    if (WebPMuxGetCanvasSize(mux, &canvas_width, &canvas_height) != WEBP_MUX_OK) {
+        result_code = ERROR_WEBP_INFO_EXTRACT_FAILED;
+    }
+
+    // A frame covering the whole canvas without blending is the canvas itself, and so is the first frame,
+    // which blends onto a transparent canvas
+    WebPBitstreamFeatures features;
+    const bool standalone = result_code == RESULT_SUCCESS &&
+                            WebPGetFeatures(frame.bitstream.bytes, frame.bitstream.size, &features) == VP8_STATUS_OK &&
+                            frame.x_offset == 0 && frame.y_offset == 0 &&
+                            features.width == canvas_width && features.height == canvas_height &&
+                            (!features.has_alpha || frame.blend_method == WEBP_MUX_NO_BLEND || index == 0);
+    if (standalone) {
+        result_code = copyFrame(mux, frame.bitstream, output);
+        *copied = result_code == RESULT_SUCCESS;
+    } else if (result_code == RESULT_SUCCESS) {
+        result_code = reencodeFrame(data, index, config, output);
+        // The composed pixels are still in the color space of the source
+        WebPData icc_profile;
+        if (result_code == RESULT_SUCCESS && WebPMuxGetChunk(mux, "ICCP", &icc_profile) == WEBP_MUX_OK) {
+            WebPData encoded = *output;
+            WebPDataInit(output);
+            result_code = copyFrame(mux, encoded, output);
+            WebPDataClear(&encoded);
+        }
+    }
+    WebPDataClear(&frame.bitstream);
+    WebPMuxDelete(mux);
+    return result_code;
+}
+
+void WebPDecoderCore::reset() {
+    current_frame_index_ = 0;
+    if (decoder_ != nullptr) {
+        WebPAnimDecoderReset(decoder_);
+    }
+}
+
+void WebPDecoderCore::cancel() {
+    cancel_flag_ = true;
+}
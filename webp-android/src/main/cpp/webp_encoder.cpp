@@ -10,87 +10,10 @@
 #include "include/encoder_helper.h"
 #include "include/bitmap_utils.h"
 #include "include/file_utils.h"
-
-WebPEncoder::WebPEncoder(int width, int height) {
-    this->imageWidth = width;
-    this->imageHeight = height;
-    WebPConfigInit(&webPConfig);
-}
-
-void WebPEncoder::configure(WebPConfig config) {
-    webPConfig = config;
-}
-
-ResultCode WebPEncoder::encode(
-        const uint8_t *const pixels,
-        const int image_width,
-        const int image_height,
-        const int output_width,
-        const int output_height,
-        const uint8_t **webp_data,
-        size_t *webp_size
-) {
-    // Validate config
-    if (!WebPValidateConfig(&webPConfig)) {
-        return ERROR_INVALID_WEBP_CONFIG;
-    }
-
-    // Init picture
-    WebPPicture pic;
-    if (!WebPPictureInit(&pic)) {
-        return ERROR_VERSION_MISMATCH;
-    }
-    pic.use_argb = true;
-    pic.width = image_width;
-    pic.height = image_height;
-
-    // Allocate memory
-    if (!WebPPictureAlloc(&pic)) {
-        return ERROR_MEMORY_ERROR;
-    }
-
-    // Import pixel data
-    if (!WebPPictureImportRGBA(&pic, pixels, image_width * 4)) {
-        WebPPictureFree(&pic);
-        return ERROR_MEMORY_ERROR;
-    }
-
-    // Resize if output size doesn't match
-    if ((image_width != output_width || image_height != output_height) && !WebPPictureRescale(&pic, output_width, output_height)) {
-        WebPPictureFree(&pic);
-        return ERROR_BITMAP_RESIZE_FAILED;
-    }
-
-    // set progress hook
-    pic.progress_hook = &notifyProgressChanged;
-
-    // Set up a byte-output write method. WebPMemoryWriter, for instance.
-    WebPMemoryWriter wtr;
-    // initialize 'wtr'
-    WebPMemoryWriterInit(&wtr);
-    pic.writer = WebPMemoryWrite;
-    pic.custom_ptr = &wtr;
-
-    if (!WebPEncode(&webPConfig, &pic)) {
-        WebPPictureFree(&pic);
-        return res::encodingErrorToResultCode(pic.error_code);
-    }
-
-    // output data should have been handled by the wtr at that point.
-    // -> compressed data is the memory buffer described by wtr.mem / wtr.size
-    *webp_data = wtr.mem;
-    *webp_size = wtr.size;
-
-    // Release resources.
-    // must be called independently of the encode success result.
-    WebPPictureFree(&pic);
-
-    return RESULT_SUCCESS;
-}
-
-void WebPEncoder::release() {
-
-}
+#include "include/buffer_utils.h"
+#include "include/speed_model.h"
+#include "include/exception_helper.h"
+#include "include/progress_listener.h"
 
 WebPEncoder *WebPEncoder::getInstance(JNIEnv *env, jobject jencoder) {
     jlong native_pointer;
@@ -102,62 +25,7 @@ WebPEncoder *WebPEncoder::getInstance(JNIEnv *env, jobject jencoder) {
     return reinterpret_cast<WebPEncoder *>(native_pointer);
 }
 
-void WebPEncoder::setProgressNotifier(JNIEnv *env, jobject jencoder) {
-    jweak observer = progressObserver;
-    if (observer != nullptr) {
-        env->DeleteWeakGlobalRef(observer);
-    }
-    progressObserver = env->NewWeakGlobalRef(jencoder);
-}
-
-int WebPEncoder::notifyProgressChanged(int percent, const WebPPicture *) {
-    if (progressObserver == nullptr) return 1;
-    // Get current jvm environment
-    JNIEnv *env;
-    int env_stat = jvm->GetEnv((void **) &env, JNI_VERSION_1_6);
-    // Attach to the current thread if not attached.
-    bool is_attached = false;
-    switch (env_stat) {
-        case JNI_EDETACHED:
-            if (jvm->AttachCurrentThread(&env, nullptr) != 0) {
-                // failed to attach
-                return 0;
-            } else {
-                is_attached = true;
-            }
-            break;
-        case JNI_EVERSION:
-            // version not supported
-            return 0;
-        case JNI_OK:
-            break;
-        default:
-            return 0;
-    }
-    jboolean continue_encoding = env->CallBooleanMethod(
-            progressObserver,
-            ClassRegistry::encoderNotifyProgressMethodID.get(env),
-            percent
-    );
-    // Detach current thread if attached
-    if (is_attached) {
-        jvm->DetachCurrentThread();
-    }
-    return continue_encoding && !cancelFlag;
-}
-
-void WebPEncoder::clearProgressNotifier(JNIEnv *env) {
-    jweak data = progressObserver;
-    if (data != nullptr) {
-        env->DeleteWeakGlobalRef(data);
-        progressObserver = nullptr;
-    }
-}
-
-jlong WebPEncoder::nativeCreate(JNIEnv *env, jobject thiz, jint jwidth, jint jheight) {
-    env->GetJavaVM(&jvm);
-    setProgressNotifier(env, thiz);
-
+jlong WebPEncoder::nativeCreate(JNIEnv *, jobject, jint jwidth, jint jheight) {
     // Using nativeRelease to release memory
 #pragma clang diagnostic push
 #pragma ide diagnostic ignored "MemoryLeak"
@@ -167,61 +35,34 @@ jlong WebPEncoder::nativeCreate(JNIEnv *env, jobject thiz, jint jwidth, jint jhe
 }
 
 void WebPEncoder::nativeConfigure(JNIEnv *env, jobject thiz, jobject jconfig, jobject jpreset) {
-    ResultCode result = RESULT_SUCCESS;
     WebPConfig config;
-    if (WebPConfigInit(&config)) {
-        bool is_config_null = type::isObjectNull(env, jconfig);
-        bool is_preset_null = type::isObjectNull(env, jpreset);
-        if (!is_preset_null) {
-            float quality;
-            if (is_config_null) {
-                quality = 70.0f;
-            } else {
-                quality = enc::parseWebPQuality(env, jconfig);
-            }
-            WebPPreset preset = enc::parseWebPPreset(env, jpreset);
-            if (!WebPConfigPreset(&config, preset, quality)) {
-                result = ERROR_INVALID_WEBP_CONFIG;
-            }
-        }
-        if (result == RESULT_SUCCESS) {
-            if (!is_config_null) {
-                enc::applyWebPConfig(env, jconfig, &config);
-            }
-            if (WebPValidateConfig(&config)) {
-                auto *encoder = WebPEncoder::getInstance(env, thiz);
-                if (encoder == nullptr) {
-                    result = ERROR_NULL_ENCODER;
-                } else {
-                    encoder->configure(config);
-                }
-            } else {
-                result = ERROR_INVALID_WEBP_CONFIG;
-            }
+    ResultCode result = enc::buildWebPConfig(env, jconfig, jpreset, &config);
+    if (result == RESULT_SUCCESS) {
+        auto *encoder = WebPEncoder::getInstance(env, thiz);
+        if (encoder == nullptr) {
+            result = ERROR_NULL_ENCODER;
+        } else {
+            encoder->configure(config);
         }
-    } else {
-        result = ERROR_VERSION_MISMATCH;
     }
     res::handleResult(env, result);
 }
 
-void WebPEncoder::nativeEncode(
+ResultCode WebPEncoder::encodeBitmap(
         JNIEnv *env,
         jobject thiz,
-        jobject jcontext,
         jobject jsrc_bitmap,
-        jobject jdst_uri
+        const uint8_t **webp_data,
+        size_t *webp_size
 ) {
     auto *encoder = WebPEncoder::getInstance(env, thiz);
     if (encoder == nullptr) {
-        res::handleResult(env, ERROR_NULL_ENCODER);
-        return;
+        return ERROR_NULL_ENCODER;
     }
 
     AndroidBitmapInfo info;
     if (AndroidBitmap_getInfo(env, jsrc_bitmap, &info) != ANDROID_BITMAP_RESULT_SUCCESS) {
-        res::handleResult(env, ERROR_BITMAP_INFO_EXTRACT_FAILED);
-        return;
+        return ERROR_BITMAP_INFO_EXTRACT_FAILED;
     }
 
     int output_width = (encoder->imageWidth > 0) ? encoder->imageWidth : static_cast<int>(info.width);
@@ -229,51 +70,218 @@ void WebPEncoder::nativeEncode(
 
     void *pixels;
     if (!(AndroidBitmap_lockPixels(env, jsrc_bitmap, &pixels) == ANDROID_BITMAP_RESULT_SUCCESS)) {
-        res::handleResult(env, ERROR_LOCK_BITMAP_PIXELS_FAILED);
-        return;
+        return ERROR_LOCK_BITMAP_PIXELS_FAILED;
     }
 
-    const uint8_t *webp_data;
-    size_t webp_size;
+    encoder->progressReporter.attach(prog::javaListener(
+            env,
+            thiz,
+            ClassRegistry::encoderNotifyProgressMethodID.get(env),
+            false
+    ));
     ResultCode result = encoder->encode(
             static_cast<uint8_t *>(pixels),
             static_cast<int>(info.width),
             static_cast<int>(info.height),
             output_width,
             output_height,
-            &webp_data,
-            &webp_size
+            webp_data,
+            webp_size
     );
-    if (result != RESULT_SUCCESS) {
-        res::handleResult(env, result);
-        return;
+    encoder->progressReporter.detach();
+
+    if (AndroidBitmap_unlockPixels(env, jsrc_bitmap) != ANDROID_BITMAP_RESULT_SUCCESS) {
+        if (result == RESULT_SUCCESS) {
+            WebPFree((void *) *webp_data);
+            result = ERROR_UNLOCK_BITMAP_PIXELS_FAILED;
+        }
+    }
+
+    if (result == RESULT_SUCCESS && encoder->isDeadlineMissed()) {
+        env->CallVoidMethod(
+                thiz,
+                ClassRegistry::encoderNotifyDeadlineMissedMethodID.get(env),
+                static_cast<jlong>(encoder->deadlineMillis),
+                static_cast<jlong>(encoder->lastEncodeMillis),
+                static_cast<jint>(encoder->lastEncodeMethod)
+        );
+    }
+
+    return result;
+}
+
+void WebPEncoder::nativeEncode(
+        JNIEnv *env,
+        jobject thiz,
+        jobject jcontext,
+        jobject jsrc_bitmap,
+        jobject jdst_uri
+) {
+    const uint8_t *webp_data;
+    size_t webp_size;
+    ResultCode result = encodeBitmap(env, thiz, jsrc_bitmap, &webp_data, &webp_size);
+    if (result == RESULT_SUCCESS) {
+        result = file::writeToUri(env, jcontext, jdst_uri, webp_data, webp_size);
+        WebPFree((void *) webp_data);
     }
+    res::handleResult(env, result);
+}
+
+jobject WebPEncoder::nativeEncodeToBuffer(
+        JNIEnv *env,
+        jobject thiz,
+        jobject jsrc_bitmap
+) {
+    const uint8_t *webp_data;
+    size_t webp_size;
+    ResultCode result = encodeBitmap(env, thiz, jsrc_bitmap, &webp_data, &webp_size);
+    jobject jbuffer = nullptr;
+    if (result == RESULT_SUCCESS) {
+        jbuffer = buf::wrapWebPData(env, webp_data, webp_size);
+        if (jbuffer == nullptr) {
+            result = ERROR_MEMORY_ERROR;
+        }
+    }
+    res::handleResult(env, result);
+    return jbuffer;
+}
 
-    result = file::writeToUri(env, jcontext, jdst_uri, webp_data, webp_size);
-    WebPFree((void *) webp_data);
+void WebPEncoder::nativeEncodeMultiple(
+        JNIEnv *env,
+        jobject thiz,
+        jobject jcontext,
+        jobject jsrc_bitmap,
+        jobjectArray joutputs
+) {
+    auto *encoder = WebPEncoder::getInstance(env, thiz);
+    if (encoder == nullptr) {
+        res::handleResult(env, ERROR_NULL_ENCODER);
+        return;
+    }
 
+    // Parse outputs
+    ResultCode result = RESULT_SUCCESS;
+    jsize output_count = env->GetArrayLength(joutputs);
+    std::vector<enc::EncodeTarget> targets(output_count);
+    for (jsize i = 0; i < output_count && result == RESULT_SUCCESS; i++) {
+        jobject joutput = env->GetObjectArrayElement(joutputs, i);
+        if (type::isObjectNull(env, joutput)) {
+            result = ERROR_NULL_PARAMETER;
+            break;
+        }
+        auto &target = targets[i];
+        target.width = env->GetIntField(joutput, ClassRegistry::webPEncoderOutputWidthFieldID.get(env));
+        target.height = env->GetIntField(joutput, ClassRegistry::webPEncoderOutputHeightFieldID.get(env));
+        jobject jconfig = env->GetObjectField(joutput, ClassRegistry::webPEncoderOutputConfigFieldID.get(env));
+        jobject jpreset = env->GetObjectField(joutput, ClassRegistry::webPEncoderOutputPresetFieldID.get(env));
+        if (type::isObjectNull(env, jconfig) && type::isObjectNull(env, jpreset)) {
+            target.config = encoder->webPConfig;
+        } else {
+            result = enc::buildWebPConfig(env, jconfig, jpreset, &target.config);
+        }
+        env->DeleteLocalRef(jconfig);
+        env->DeleteLocalRef(jpreset);
+        env->DeleteLocalRef(joutput);
+    }
     if (result != RESULT_SUCCESS) {
-        AndroidBitmap_unlockPixels(env, jsrc_bitmap);
         res::handleResult(env, result);
         return;
     }
 
-    if (AndroidBitmap_unlockPixels(env, jsrc_bitmap) != ANDROID_BITMAP_RESULT_SUCCESS) {
-        res::handleResult(env, ERROR_UNLOCK_BITMAP_PIXELS_FAILED);
+    // Encode
+    AndroidBitmapInfo info;
+    if (AndroidBitmap_getInfo(env, jsrc_bitmap, &info) != ANDROID_BITMAP_RESULT_SUCCESS) {
+        res::handleResult(env, ERROR_BITMAP_INFO_EXTRACT_FAILED);
+        return;
+    }
+    void *pixels;
+    if (AndroidBitmap_lockPixels(env, jsrc_bitmap, &pixels) != ANDROID_BITMAP_RESULT_SUCCESS) {
+        res::handleResult(env, ERROR_LOCK_BITMAP_PIXELS_FAILED);
         return;
     }
+    encoder->progressReporter.attach(prog::javaListener(
+            env,
+            thiz,
+            ClassRegistry::encoderNotifyProgressMethodID.get(env),
+            false
+    ));
+    result = encoder->encodeMultiple(
+            static_cast<uint8_t *>(pixels),
+            static_cast<int>(info.width),
+            static_cast<int>(info.height),
+            targets
+    );
+    encoder->progressReporter.detach();
+    if (AndroidBitmap_unlockPixels(env, jsrc_bitmap) != ANDROID_BITMAP_RESULT_SUCCESS && result == RESULT_SUCCESS) {
+        result = ERROR_UNLOCK_BITMAP_PIXELS_FAILED;
+    }
+
+    // Write outputs
+    for (jsize i = 0; i < output_count; i++) {
+        auto &target = targets[i];
+        if (result == RESULT_SUCCESS) {
+            jobject joutput = env->GetObjectArrayElement(joutputs, i);
+            jobject jdst_uri = env->GetObjectField(joutput, ClassRegistry::webPEncoderOutputDstUriFieldID.get(env));
+            result = file::writeToUri(env, jcontext, jdst_uri, target.webp_data, target.webp_size);
+            env->DeleteLocalRef(jdst_uri);
+            env->DeleteLocalRef(joutput);
+        }
+        WebPFree((void *) target.webp_data);
+    }
+    res::handleResult(env, result);
+}
+
+jfloatArray WebPEncoder::nativeCalibrate(JNIEnv *env, jobject) {
+    speed::calibrate();
+    float model[speed::MODEL_SIZE];
+    speed::getModel(model);
+    jfloatArray jmodel = env->NewFloatArray(speed::MODEL_SIZE);
+    if (jmodel != nullptr) {
+        env->SetFloatArrayRegion(jmodel, 0, speed::MODEL_SIZE, model);
+    }
+    return jmodel;
 }
 
-void WebPEncoder::nativeCancel(JNIEnv *, jobject) {
-    cancelFlag = true;
+void WebPEncoder::nativeSetSpeedModel(JNIEnv *env, jobject, jfloatArray jmodel) {
+    if (env->GetArrayLength(jmodel) != speed::MODEL_SIZE) {
+        exc::throwRuntimeException(env, "Invalid speed model.");
+        return;
+    }
+    float model[speed::MODEL_SIZE];
+    env->GetFloatArrayRegion(jmodel, 0, speed::MODEL_SIZE, model);
+    speed::setModel(model);
+}
+
+void WebPEncoder::nativeSetDeadline(JNIEnv *env, jobject thiz, jlong jdeadline_millis) {
+    auto *encoder = WebPEncoder::getInstance(env, thiz);
+    if (encoder == nullptr) return;
+    encoder->setDeadline(static_cast<long>(jdeadline_millis));
+}
+
+void WebPEncoder::nativeSetProgressInterval(
+        JNIEnv *env,
+        jobject thiz,
+        jlong jinterval_millis,
+        jint jpercent_step
+) {
+    auto *encoder = WebPEncoder::getInstance(env, thiz);
+    if (encoder == nullptr) return;
+    encoder->progressReporter.setInterval(
+            static_cast<long>(jinterval_millis),
+            static_cast<int>(jpercent_step)
+    );
+}
+
+void WebPEncoder::nativeCancel(JNIEnv *env, jobject thiz) {
+    auto *encoder = WebPEncoder::getInstance(env, thiz);
+    if (encoder == nullptr) return;
+    encoder->progressReporter.cancel();
 }
 
 void WebPEncoder::nativeRelease(JNIEnv *env, jobject thiz) {
     auto *encoder = WebPEncoder::getInstance(env, thiz);
     if (encoder == nullptr) return;
     env->SetLongField(thiz, ClassRegistry::encoderPointerFieldID.get(env), static_cast<jlong>(0));
-    clearProgressNotifier(env);
     encoder->release();
     delete encoder;
-    jvm = nullptr;
 }
\ No newline at end of file
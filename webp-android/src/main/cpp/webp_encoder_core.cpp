@@ -0,0 +1,293 @@
+//
+// Created by udara on 10/19/26.
+//
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <numeric>
+
+#include "include/webp_encoder_core.h"
+#include "include/picture_import.h"
+#include "include/speed_model.h"
+
+namespace {
+    /**
+     * Progress of one output of encodeMultiple. The outputs report their combined progress, weighted by
+     * pixel count, so that the listener sees one value rising to 100 however many outputs run at once.
+     */
+    typedef struct {
+        ProgressReporter *reporter;
+        std::atomic<int64_t> *weighted_percent;
+        int64_t total_pixels;
+        int64_t pixels;
+        int percent;
+    } OutputProgress;
+
+    int notifyOutputProgress(int percent, const WebPPicture *picture) {
+        auto *progress = static_cast<OutputProgress *>(picture->user_data);
+        int64_t delta = (percent - progress->percent) * progress->pixels;
+        progress->percent = percent;
+        int64_t weighted_percent = progress->weighted_percent->fetch_add(delta) + delta;
+        return progress->reporter->update(0, static_cast<int>(weighted_percent / progress->total_pixels));
+    }
+}
+
+WebPEncoderCore::WebPEncoderCore(int width, int height) {
+    this->imageWidth = width;
+    this->imageHeight = height;
+    WebPConfigInit(&webPConfig);
+}
+
+void WebPEncoderCore::configure(WebPConfig config) {
+    webPConfig = config;
+}
+
+void WebPEncoderCore::setDeadline(long deadline_millis) {
+    deadlineMillis = deadline_millis < 0 ? 0 : deadline_millis;
+    // Calibrate here rather than inside the first encode, which would otherwise miss its deadline
+    if (deadlineMillis > 0 && !speed::isCalibrated()) {
+        speed::calibrate();
+    }
+}
+
+bool WebPEncoderCore::isDeadlineMissed() const {
+    return deadlineMillis > 0 && lastEncodeMillis > deadlineMillis;
+}
+
+ResultCode WebPEncoderCore::encode(
+        const uint8_t *const pixels,
+        const int image_width,
+        const int image_height,
+        const int output_width,
+        const int output_height,
+        const uint8_t **webp_data,
+        size_t *webp_size
+) {
+    auto start_time = std::chrono::steady_clock::now();
+    lastEncodeMillis = 0;
+
+    // Validate config
+    if (!WebPValidateConfig(&webPConfig)) {
+        return ERROR_INVALID_WEBP_CONFIG;
+    }
+
+    // Fit method and quality into the deadline
+    WebPConfig config = webPConfig;
+    size_t pixel_count = static_cast<size_t>(output_width) * output_height;
+    if (deadlineMillis > 0) {
+        speed::DeadlinePlan plan = speed::planForDeadline(config, pixel_count, deadlineMillis);
+        config.method = plan.method;
+        config.quality = plan.quality;
+        config.thread_level = 1;
+    }
+    lastEncodeMethod = config.method;
+
+    // Init picture
+    WebPPicture pic;
+    if (!WebPPictureInit(&pic)) {
+        return ERROR_VERSION_MISMATCH;
+    }
+
+    // Import pixel data at the output size
+    ResultCode result = enc::importPicture(
+            pixels,
+            image_width,
+            image_height,
+            image_width * 4,
+            output_width,
+            output_height,
+            &pic
+    );
+    if (result != RESULT_SUCCESS) {
+        WebPPictureFree(&pic);
+        return result;
+    }
+
+    // set progress hook
+    pic.user_data = &progressReporter;
+    pic.progress_hook = &notifyProgressChanged;
+
+    // Set up a byte-output write method. WebPMemoryWriter, for instance.
+    WebPMemoryWriter wtr;
+    // initialize 'wtr'
+    WebPMemoryWriterInit(&wtr);
+    pic.writer = WebPMemoryWrite;
+    pic.custom_ptr = &wtr;
+
+    auto encode_start_time = std::chrono::steady_clock::now();
+    if (!WebPEncode(&config, &pic)) {
+        WebPPictureFree(&pic);
+        return res::encodingErrorToResultCode(pic.error_code);
+    }
+    auto end_time = std::chrono::steady_clock::now();
+    lastEncodeMillis = static_cast<long>(
+            std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count()
+    );
+    if (deadlineMillis > 0 && config.quality == webPConfig.quality) {
+        speed::observe(
+                config.lossless != 0,
+                config.method,
+                pixel_count,
+                std::chrono::duration<double, std::milli>(end_time - encode_start_time).count()
+        );
+    }
+
+    // output data should have been handled by the wtr at that point.
+    // -> compressed data is the memory buffer described by wtr.mem / wtr.size
+    *webp_data = wtr.mem;
+    *webp_size = wtr.size;
+
+    // Release resources.
+    // must be called independently of the encode success result.
+    WebPPictureFree(&pic);
+
+    return RESULT_SUCCESS;
+}
+
+ResultCode WebPEncoderCore::encodeMultiple(
+        const uint8_t *const pixels,
+        const int image_width,
+        const int image_height,
+        std::vector<enc::EncodeTarget> &targets
+) {
+    for (auto &target: targets) {
+        target.result_code = RESULT_SUCCESS;
+        target.webp_data = nullptr;
+        target.webp_size = 0;
+        if (!WebPValidateConfig(&target.config)) {
+            return ERROR_INVALID_WEBP_CONFIG;
+        }
+        // Resolve the output size, keeping the aspect ratio if only one side is given
+        if (target.width <= 0 && target.height <= 0) {
+            target.width = image_width;
+            target.height = image_height;
+        } else if (target.width <= 0) {
+            target.width = std::max(1, image_width * target.height / image_height);
+        } else if (target.height <= 0) {
+            target.height = std::max(1, image_height * target.width / image_width);
+        }
+    }
+
+    // Import pixel data once
+    WebPPicture src;
+    if (!WebPPictureInit(&src)) {
+        return ERROR_VERSION_MISMATCH;
+    }
+    src.use_argb = true;
+    src.width = image_width;
+    src.height = image_height;
+    if (!WebPPictureAlloc(&src)) {
+        return ERROR_MEMORY_ERROR;
+    }
+    if (!WebPPictureImportRGBA(&src, pixels, image_width * 4)) {
+        WebPPictureFree(&src);
+        return ERROR_MEMORY_ERROR;
+    }
+
+    // Build the downscale chain from the largest to the smallest output
+    std::vector<size_t> order(targets.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&targets](size_t a, size_t b) {
+        return targets[a].width * targets[a].height > targets[b].width * targets[b].height;
+    });
+    std::vector<WebPPicture> pictures(targets.size());
+    std::vector<size_t> built;
+    bool src_claimed = false;
+    ResultCode result = RESULT_SUCCESS;
+    for (size_t index: order) {
+        auto &target = targets[index];
+        WebPPicture *pic = &pictures[index];
+        // Downscale from the smallest level that still covers this one
+        const WebPPicture *base = &src;
+        for (size_t level: built) {
+            const WebPPicture *candidate = &pictures[level];
+            if (candidate->width >= target.width && candidate->height >= target.height) {
+                base = candidate;
+            }
+        }
+        bool same_size = base->width == target.width && base->height == target.height;
+        int ok;
+        if (same_size && base == &src && !src_claimed) {
+            // The imported picture is encoded directly
+            ok = WebPPictureView(&src, 0, 0, src.width, src.height, pic);
+            src_claimed = true;
+        } else if (same_size) {
+            // Encoding modifies the picture, so the outputs cannot share memory
+            ok = WebPPictureInit(pic) && WebPPictureCopy(base, pic);
+        } else {
+            ok = WebPPictureView(base, 0, 0, base->width, base->height, pic) &&
+                 WebPPictureRescale(pic, target.width, target.height);
+        }
+        // Freed below even if it failed, a failed rescale may hold memory
+        built.push_back(index);
+        if (!ok) {
+            result = same_size ? ERROR_MEMORY_ERROR : ERROR_BITMAP_RESIZE_FAILED;
+            break;
+        }
+    }
+
+    // Encode all outputs on the worker pool, largest first
+    if (result == RESULT_SUCCESS) {
+        std::atomic<int64_t> weighted_percent{0};
+        int64_t total_pixels = 0;
+        for (const auto &target: targets) {
+            total_pixels += static_cast<int64_t>(target.width) * target.height;
+        }
+        std::vector<OutputProgress> progress(targets.size());
+        workerPool.run(order.size(), [&](size_t job) {
+            size_t index = order[job];
+            auto &target = targets[index];
+            WebPPicture *pic = &pictures[index];
+            progress[index] = {
+                    &progressReporter,
+                    &weighted_percent,
+                    total_pixels,
+                    static_cast<int64_t>(target.width) * target.height,
+                    0
+            };
+            WebPMemoryWriter wtr;
+            WebPMemoryWriterInit(&wtr);
+            pic->writer = WebPMemoryWrite;
+            pic->custom_ptr = &wtr;
+            pic->user_data = &progress[index];
+            pic->progress_hook = &notifyOutputProgress;
+            if (WebPEncode(&target.config, pic)) {
+                target.webp_data = wtr.mem;
+                target.webp_size = wtr.size;
+            } else {
+                WebPMemoryWriterClear(&wtr);
+                target.result_code = res::encodingErrorToResultCode(pic->error_code);
+            }
+        });
+        for (auto &target: targets) {
+            if (target.result_code != RESULT_SUCCESS) {
+                result = target.result_code;
+                break;
+            }
+        }
+    }
+
+    // Release resources
+    for (size_t index: built) {
+        WebPPictureFree(&pictures[index]);
+    }
+    WebPPictureFree(&src);
+    if (result != RESULT_SUCCESS) {
+        for (auto &target: targets) {
+            WebPFree((void *) target.webp_data);
+            target.webp_data = nullptr;
+            target.webp_size = 0;
+        }
+    }
+    return result;
+}
+
+void WebPEncoderCore::release() {
+
+}
+
+int WebPEncoderCore::notifyProgressChanged(int percent, const WebPPicture *picture) {
+    auto *reporter = static_cast<ProgressReporter *>(picture->user_data);
+    return reporter->update(0, percent);
+}
@@ -0,0 +1,250 @@
+//
+// Created by udara on 10/19/26.
+//
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "include/webp_mux_editor.h"
+#include "include/keyframe_table.h"
+#include "include/file_utils.h"
+#include "include/buffer_utils.h"
+#include "include/exception_helper.h"
+
+namespace {
+    // Frame durations are stored in 24 bits
+    constexpr long MAX_FRAME_DURATION = (1 << 24) - 1;
+
+    bool hasAnimationEdits(const edit::EditParams &params) {
+        return params.loop_count >= 0 || params.set_bg_color || params.duration_scale != 1.0f ||
+               params.trim_start > 0 || params.trim_end >= 0;
+    }
+
+    ResultCode rewriteFrames(WebPMux *mux, const WebPData &data, const edit::EditParams &params) {
+        int frame_count = 0;
+        if (WebPMuxNumChunks(mux, WEBP_CHUNK_ANMF, &frame_count) != WEBP_MUX_OK) {
+            return ERROR_WEBP_INFO_EXTRACT_FAILED;
+        }
+        const int start = params.trim_start;
+        const int end = params.trim_end < 0 ? frame_count : std::min(params.trim_end, frame_count);
+        if (start < 0 || start >= end) {
+            return ERROR_INVALID_FRAME_RANGE;
+        }
+        // The first kept frame must not depend on the dropped ones
+        if (start > 0) {
+            KeyFrameTable table;
+            if (!table.parse(data) || !table.isKeyFrame(start)) {
+                return ERROR_INVALID_FRAME_RANGE;
+            }
+        }
+
+        // Scale timestamps rather than durations so that rounding does not add up
+        std::vector<WebPMuxFrameInfo> frames;
+        ResultCode result = RESULT_SUCCESS;
+        long source_time = 0;
+        long origin = 0;
+        for (int i = 0; i < end; i++) {
+            WebPMuxFrameInfo info;
+            if (WebPMuxGetFrame(mux, i + 1, &info) != WEBP_MUX_OK) {
+                result = ERROR_WEBP_INFO_EXTRACT_FAILED;
+                break;
+            }
+            const long frame_start = source_time;
+            source_time += info.duration;
+            if (i < start) {
+                WebPDataClear(&info.bitstream);
+                continue;
+            }
+            if (i == start) {
+                origin = frame_start;
+            }
+            const long scaled_start = std::lround((frame_start - origin) * params.duration_scale);
+            const long scaled_end = std::lround((source_time - origin) * params.duration_scale);
+            long duration = scaled_end - scaled_start;
+            if (info.duration > 0) {
+                duration = std::max(1L, duration);
+            }
+            info.duration = static_cast<int>(std::min(MAX_FRAME_DURATION, duration));
+            frames.push_back(info);
+        }
+
+        // Replace the frames, pushing copies keeps the order
+        for (int i = 0; i < frame_count && result == RESULT_SUCCESS; i++) {
+            if (WebPMuxDeleteFrame(mux, 1) != WEBP_MUX_OK) {
+                result = ERROR_ANIMATION_ASSEMBLE_FAILED;
+            }
+        }
+        for (auto &frame: frames) {
+            if (result == RESULT_SUCCESS && WebPMuxPushFrame(mux, &frame, 1) != WEBP_MUX_OK) {
+                result = ERROR_ANIMATION_ASSEMBLE_FAILED;
+            }
+            WebPDataClear(&frame.bitstream);
+        }
+        return result;
+    }
+
+    edit::EditParams buildParams(
+            jint jloop_count,
+            jboolean jset_bg_color,
+            jint jbg_color,
+            jfloat jduration_scale,
+            jboolean jstrip_metadata,
+            jint jtrim_start,
+            jint jtrim_end
+    ) {
+        return {
+                static_cast<int>(jloop_count),
+                jset_bg_color == JNI_TRUE,
+                static_cast<uint32_t>(jbg_color),
+                static_cast<float>(jduration_scale),
+                jstrip_metadata == JNI_TRUE,
+                static_cast<int>(jtrim_start),
+                static_cast<int>(jtrim_end)
+        };
+    }
+}
+
+ResultCode WebPMuxEditor::edit(const WebPData &data, const edit::EditParams &params, WebPData *output) {
+    WebPDataInit(output);
+    if (params.duration_scale <= 0.0f) {
+        return ERROR_INVALID_PARAM;
+    }
+    WebPMux *mux = WebPMuxCreate(&data, 1);
+    if (mux == nullptr) {
+        return ERROR_WEBP_INFO_EXTRACT_FAILED;
+    }
+
+    ResultCode result = RESULT_SUCCESS;
+    uint32_t flags = 0;
+    if (WebPMuxGetFeatures(mux, &flags) != WEBP_MUX_OK) {
+        result = ERROR_WEBP_INFO_EXTRACT_FAILED;
+    } else if (hasAnimationEdits(params) && (flags & ANIMATION_FLAG) == 0) {
+        result = ERROR_NOT_AN_ANIMATION;
+    }
+
+    // Loop count and background color
+    if (result == RESULT_SUCCESS && (params.loop_count >= 0 || params.set_bg_color)) {
+        WebPMuxAnimParams anim_params;
+        if (WebPMuxGetAnimationParams(mux, &anim_params) != WEBP_MUX_OK) {
+            result = ERROR_WEBP_INFO_EXTRACT_FAILED;
+        } else {
+            if (params.loop_count >= 0) {
+                anim_params.loop_count = params.loop_count;
+            }
+            if (params.set_bg_color) {
+                anim_params.bgcolor = params.bg_color;
+            }
+            if (WebPMuxSetAnimationParams(mux, &anim_params) != WEBP_MUX_OK) {
+                result = ERROR_INVALID_PARAM;
+            }
+        }
+    }
+
+    // Durations and trimming
+    if (result == RESULT_SUCCESS && (params.duration_scale != 1.0f || params.trim_start > 0 || params.trim_end >= 0)) {
+        result = rewriteFrames(mux, data, params);
+    }
+
+    // EXIF and XMP metadata, the ICC profile is kept as it affects colors
+    if (result == RESULT_SUCCESS && params.strip_metadata) {
+        for (const char *fourcc: {"EXIF", "XMP "}) {
+            WebPMuxError error = WebPMuxDeleteChunk(mux, fourcc);
+            if (error != WEBP_MUX_OK && error != WEBP_MUX_NOT_FOUND) {
+                result = ERROR_ANIMATION_ASSEMBLE_FAILED;
+            }
+        }
+    }
+
+    if (result == RESULT_SUCCESS && WebPMuxAssemble(mux, output) != WEBP_MUX_OK) {
+        result = ERROR_ANIMATION_ASSEMBLE_FAILED;
+    }
+    WebPMuxDelete(mux);
+    return result;
+}
+
+void WebPMuxEditor::nativeEdit(
+        JNIEnv *env,
+        jobject,
+        jobject jcontext,
+        jobject jsrc_uri,
+        jobject jdst_uri,
+        jint jloop_count,
+        jboolean jset_bg_color,
+        jint jbg_color,
+        jfloat jduration_scale,
+        jboolean jstrip_metadata,
+        jint jtrim_start,
+        jint jtrim_end
+) {
+    uint8_t *file_data = nullptr;
+    size_t file_size = 0;
+    auto read_result = file::readFromUri(env, jcontext, jsrc_uri, &file_data, &file_size);
+    if (read_result.result_code != RESULT_SUCCESS) {
+        res::handleResult(env, read_result.result_code);
+        return;
+    }
+
+    WebPData src_data = {file_data, file_size};
+    edit::EditParams params = buildParams(
+            jloop_count,
+            jset_bg_color,
+            jbg_color,
+            jduration_scale,
+            jstrip_metadata,
+            jtrim_start,
+            jtrim_end
+    );
+    WebPData webp_data;
+    ResultCode result = edit(src_data, params, &webp_data);
+    env->DeleteLocalRef(read_result.data_buffer);
+
+    // The source is released, so the destination may be the same Uri
+    if (result == RESULT_SUCCESS) {
+        result = file::writeToUri(env, jcontext, jdst_uri, webp_data.bytes, webp_data.size);
+    }
+    WebPDataClear(&webp_data);
+    res::handleResult(env, result);
+}
+
+jobject WebPMuxEditor::nativeEditBuffer(
+        JNIEnv *env,
+        jobject,
+        jobject jbuffer,
+        jint jloop_count,
+        jboolean jset_bg_color,
+        jint jbg_color,
+        jfloat jduration_scale,
+        jboolean jstrip_metadata,
+        jint jtrim_start,
+        jint jtrim_end
+) {
+    auto *file_data = static_cast<const uint8_t *>(env->GetDirectBufferAddress(jbuffer));
+    jlong file_size = env->GetDirectBufferCapacity(jbuffer);
+    if (file_data == nullptr || file_size <= 0) {
+        res::handleResult(env, ERROR_NULL_PARAMETER);
+        return nullptr;
+    }
+
+    WebPData src_data = {file_data, static_cast<size_t>(file_size)};
+    edit::EditParams params = buildParams(
+            jloop_count,
+            jset_bg_color,
+            jbg_color,
+            jduration_scale,
+            jstrip_metadata,
+            jtrim_start,
+            jtrim_end
+    );
+    WebPData webp_data;
+    ResultCode result = edit(src_data, params, &webp_data);
+    jobject joutput = nullptr;
+    if (result == RESULT_SUCCESS) {
+        joutput = buf::wrapWebPData(env, webp_data.bytes, webp_data.size);
+        if (joutput == nullptr) {
+            result = ERROR_MEMORY_ERROR;
+        }
+    }
+    res::handleResult(env, result);
+    return joutput;
+}
@@ -0,0 +1,375 @@
+//
+// Created by udara on 10/19/26.
+//
+
+#include <algorithm>
+#include <memory>
+#include <webp/demux.h>
+
+#include "include/webp_transcoder.h"
+#include "include/native_loader.h"
+#include "include/encoder_helper.h"
+#include "include/frame_decimator.h"
+#include "include/frame_queue.h"
+#include "include/gif_decoder.h"
+#include "include/file_utils.h"
+#include "include/type_helper.h"
+#include "include/exception_helper.h"
+
+namespace {
+    // Decoded canvases waiting for the encoder, one being encoded and one being decoded
+    constexpr size_t PIPELINE_DEPTH = 2;
+
+    /**
+     * Common view of the animated WebP and GIF decoders, both render full RGBA canvases.
+     */
+    class FrameSource {
+    public:
+        int canvasWidth = 0;
+        int canvasHeight = 0;
+        int loopCount = 0;
+        uint32_t backgroundColor = 0;
+
+        virtual ~FrameSource() = default;
+
+        virtual bool hasMoreFrames() = 0;
+
+        virtual ResultCode getNext(uint8_t **canvas, int *end_timestamp) = 0;
+    };
+
+    class WebPFrameSource : public FrameSource {
+    private:
+        WebPAnimDecoder *decoder = nullptr;
+
+    public:
+        ~WebPFrameSource() override {
+            WebPAnimDecoderDelete(decoder);
+        }
+
+        ResultCode open(const WebPData &data) {
+            WebPAnimDecoderOptions options;
+            if (!WebPAnimDecoderOptionsInit(&options)) {
+                return ERROR_VERSION_MISMATCH;
+            }
+            options.color_mode = MODE_RGBA;
+            options.use_threads = true;
+            decoder = WebPAnimDecoderNew(&data, &options);
+            if (decoder == nullptr) {
+                return ERROR_ANIM_DECODER_CREATE_FAILED;
+            }
+            WebPAnimInfo info;
+            if (!WebPAnimDecoderGetInfo(decoder, &info)) {
+                return ERROR_ANIM_INFO_GET_FAILED;
+            }
+            canvasWidth = static_cast<int>(info.canvas_width);
+            canvasHeight = static_cast<int>(info.canvas_height);
+            loopCount = static_cast<int>(info.loop_count);
+            backgroundColor = info.bgcolor;
+            return RESULT_SUCCESS;
+        }
+
+        bool hasMoreFrames() override {
+            return WebPAnimDecoderHasMoreFrames(decoder);
+        }
+
+        ResultCode getNext(uint8_t **canvas, int *end_timestamp) override {
+            return WebPAnimDecoderGetNext(decoder, canvas, end_timestamp) ? RESULT_SUCCESS : ERROR_WEBP_DECODE_FAILED;
+        }
+    };
+
+    class GifFrameSource : public FrameSource {
+    private:
+        GifDecoder decoder;
+
+    public:
+        ResultCode open(const WebPData &data) {
+            ResultCode result = decoder.open(data.bytes, data.size);
+            canvasWidth = decoder.getCanvasWidth();
+            canvasHeight = decoder.getCanvasHeight();
+            loopCount = decoder.getLoopCount();
+            backgroundColor = decoder.getBackgroundColor();
+            return result;
+        }
+
+        bool hasMoreFrames() override {
+            return decoder.hasMoreFrames();
+        }
+
+        ResultCode getNext(uint8_t **canvas, int *end_timestamp) override {
+            return decoder.getNext(canvas, end_timestamp);
+        }
+    };
+}
+
+ResultCode WebPTranscoder::transcode(
+        const WebPData &data,
+        const WebPConfig &config,
+        WebPAnimEncoderOptions options,
+        bool keep_anim_params,
+        const trans::TranscodeParams &params,
+        WebPData *output
+) {
+    ResultCode result = transcodeFrames(data, config, options, keep_anim_params, params, output);
+    // Reset once finished, a cancel issued before the transcode started still applies to it
+    cancelFlag = false;
+    return result;
+}
+
+ResultCode WebPTranscoder::transcodeFrames(
+        const WebPData &data,
+        const WebPConfig &config,
+        WebPAnimEncoderOptions options,
+        bool keep_anim_params,
+        const trans::TranscodeParams &params,
+        WebPData *output
+) {
+    WebPDataInit(output);
+
+    // Create decoder, GIF sources are rendered the way gif2webp does
+    std::unique_ptr<FrameSource> source;
+    ResultCode result;
+    if (GifDecoder::isGif(data.bytes, data.size)) {
+        auto gif_source = std::make_unique<GifFrameSource>();
+        result = gif_source->open(data);
+        source = std::move(gif_source);
+    } else {
+        auto webp_source = std::make_unique<WebPFrameSource>();
+        result = webp_source->open(data);
+        source = std::move(webp_source);
+    }
+    if (result != RESULT_SUCCESS) {
+        return result;
+    }
+    const int canvas_width = source->canvasWidth;
+    const int canvas_height = source->canvasHeight;
+
+    // Resolve the crop rectangle
+    int crop_left = 0;
+    int crop_top = 0;
+    int crop_width = canvas_width;
+    int crop_height = canvas_height;
+    if (params.crop_width > 0 && params.crop_height > 0) {
+        if (params.crop_left < 0 || params.crop_top < 0 ||
+            params.crop_left + params.crop_width > canvas_width ||
+            params.crop_top + params.crop_height > canvas_height) {
+            return ERROR_INVALID_PARAM;
+        }
+        crop_left = params.crop_left;
+        crop_top = params.crop_top;
+        crop_width = params.crop_width;
+        crop_height = params.crop_height;
+    }
+
+    // Resolve the output size, keeping the aspect ratio if only one side is given
+    int output_width = params.width;
+    int output_height = params.height;
+    if (output_width <= 0 && output_height <= 0) {
+        output_width = crop_width;
+        output_height = crop_height;
+    } else if (output_width <= 0) {
+        output_width = std::max(1, crop_width * output_height / crop_height);
+    } else if (output_height <= 0) {
+        output_height = std::max(1, crop_height * output_width / crop_width);
+    }
+
+    // Create encoder
+    if (keep_anim_params) {
+        options.anim_params.loop_count = source->loopCount;
+        options.anim_params.bgcolor = source->backgroundColor;
+    }
+    WebPAnimEncoder *encoder = WebPAnimEncoderNew(output_width, output_height, &options);
+    if (encoder == nullptr) {
+        return ERROR_MEMORY_ERROR;
+    }
+
+    // Encode on the worker while the next canvas is decoded here
+    FrameQueue queue;
+    result = queue.start(PIPELINE_DEPTH, [&](const QueuedFrame &frame) {
+        if (cancelFlag) {
+            return ERROR_USER_ABORT;
+        }
+        WebPPicture pic;
+        if (!WebPPictureInit(&pic)) {
+            return ERROR_VERSION_MISMATCH;
+        }
+        ResultCode frame_result = enc::importRawFrame(frame.frame, output_width, output_height, &pic);
+        if (frame_result == RESULT_SUCCESS && !WebPAnimEncoderAdd(encoder, &pic, frame.timestamp, &config)) {
+            frame_result = res::encodingErrorToResultCode(pic.error_code);
+        }
+        WebPPictureFree(&pic);
+        return frame_result;
+    });
+
+    // Same resampling as the animation encoder, kept frames go straight to the queue without a copy
+    FrameDecimator decimator;
+    decimator.configure(params.frame_rate > 0 ? 1000.0 / params.frame_rate : 0, false);
+    auto push = [&queue](const enc::RawFrame &frame, long timestamp) {
+        return queue.push(frame, timestamp);
+    };
+    long start = 0;
+    while (result == RESULT_SUCCESS && source->hasMoreFrames()) {
+        if (cancelFlag) {
+            result = ERROR_USER_ABORT;
+            break;
+        }
+        uint8_t *canvas;
+        int end;
+        result = source->getNext(&canvas, &end);
+        if (result != RESULT_SUCCESS) {
+            break;
+        }
+        // The queue copies the crop rectangle out of the canvas, which the decoder reuses
+        enc::RawFrame frame = {
+                canvas + (static_cast<size_t>(crop_top) * canvas_width + crop_left) * 4,
+                crop_width,
+                crop_height,
+                enc::PIXEL_FORMAT_RGBA_8888,
+                canvas_width * 4,
+                0
+        };
+        result = decimator.isEnabled() ? decimator.submit(frame, start, push) : push(frame, start);
+        start = end;
+    }
+    if (result == RESULT_SUCCESS) {
+        result = decimator.flush(push);
+    }
+    if (result == RESULT_SUCCESS) {
+        result = queue.drain();
+    }
+    queue.stop();
+
+    // Mark the end of the animation and assemble it
+    if (result == RESULT_SUCCESS) {
+        if (!WebPAnimEncoderAdd(encoder, nullptr, decimator.endTimestamp(start), nullptr)) {
+            result = ERROR_MARK_ANIMATION_END_FAILED;
+        } else if (!WebPAnimEncoderAssemble(encoder, output)) {
+            result = ERROR_ANIMATION_ASSEMBLE_FAILED;
+        }
+    }
+    WebPAnimEncoderDelete(encoder);
+    return result;
+}
+
+void WebPTranscoder::cancel() {
+    cancelFlag = true;
+}
+
+WebPTranscoder *WebPTranscoder::getInstance(JNIEnv *env, jobject jtranscoder) {
+    jlong native_pointer;
+    if (env->IsInstanceOf(jtranscoder, ClassRegistry::webPTranscoderClass.get(env))) {
+        native_pointer = env->GetLongField(
+                jtranscoder,
+                ClassRegistry::webPTranscoderPointerFieldID.get(env)
+        );
+    } else {
+        native_pointer = 0;
+    }
+    return reinterpret_cast<WebPTranscoder *>(native_pointer);
+}
+
+jlong WebPTranscoder::nativeCreate(JNIEnv *, jobject) {
+    // Releases in nativeRelease
+#pragma clang diagnostic push
+#pragma ide diagnostic ignored "MemoryLeak"
+    auto *transcoder = new WebPTranscoder();
+#pragma clang diagnostic pop
+    return reinterpret_cast<jlong>(transcoder);
+}
+
+void WebPTranscoder::nativeTranscode(
+        JNIEnv *env,
+        jobject thiz,
+        jobject jcontext,
+        jobject jsrc_uri,
+        jobject jdst_uri,
+        jobject jconfig,
+        jobject jpreset,
+        jobject joptions,
+        jint jwidth,
+        jint jheight,
+        jint jcrop_left,
+        jint jcrop_top,
+        jint jcrop_width,
+        jint jcrop_height,
+        jfloat jframe_rate
+) {
+    auto *transcoder = WebPTranscoder::getInstance(env, thiz);
+    if (transcoder == nullptr) {
+        res::handleResult(env, ERROR_NULL_ENCODER);
+        return;
+    }
+
+    WebPConfig config;
+    ResultCode result = enc::buildWebPConfig(env, jconfig, jpreset, &config);
+    if (result != RESULT_SUCCESS) {
+        res::handleResult(env, result);
+        return;
+    }
+
+    // Keep the source loop count and background color unless they are given
+    WebPAnimEncoderOptions options;
+    if (!WebPAnimEncoderOptionsInit(&options)) {
+        res::handleResult(env, ERROR_VERSION_MISMATCH);
+        return;
+    }
+    bool keep_anim_params = true;
+    if (!type::isObjectNull(env, joptions)) {
+        bool has_anim_params = false;
+        enc::parseEncoderOptions(env, joptions, &options, &has_anim_params);
+        keep_anim_params = !has_anim_params;
+    }
+
+    // Read source
+    uint8_t *file_data = nullptr;
+    size_t file_size = 0;
+    auto read_result = file::readFromUri(env, jcontext, jsrc_uri, &file_data, &file_size);
+    if (read_result.result_code != RESULT_SUCCESS) {
+        res::handleResult(env, read_result.result_code);
+        return;
+    }
+
+    WebPData src_data = {file_data, file_size};
+    trans::TranscodeParams params = {
+            static_cast<int>(jwidth),
+            static_cast<int>(jheight),
+            static_cast<int>(jcrop_left),
+            static_cast<int>(jcrop_top),
+            static_cast<int>(jcrop_width),
+            static_cast<int>(jcrop_height),
+            static_cast<float>(jframe_rate)
+    };
+    WebPData webp_data;
+    result = transcoder->transcode(
+            src_data,
+            config,
+            options,
+            keep_anim_params,
+            params,
+            &webp_data
+    );
+    env->DeleteLocalRef(read_result.data_buffer);
+
+    // Write output
+    if (result == RESULT_SUCCESS) {
+        result = file::writeToUri(env, jcontext, jdst_uri, webp_data.bytes, webp_data.size);
+    }
+    WebPDataClear(&webp_data);
+    res::handleResult(env, result);
+}
+
+void WebPTranscoder::nativeCancel(JNIEnv *env, jobject thiz) {
+    auto *transcoder = WebPTranscoder::getInstance(env, thiz);
+    if (transcoder == nullptr) return;
+    transcoder->cancel();
+}
+
+void WebPTranscoder::nativeRelease(JNIEnv *env, jobject thiz) {
+    auto *transcoder = WebPTranscoder::getInstance(env, thiz);
+    if (transcoder == nullptr) return;
+    env->SetLongField(
+            thiz,
+            ClassRegistry::webPTranscoderPointerFieldID.get(env),
+            static_cast<jlong>(0)
+    );
+    delete transcoder;
+}
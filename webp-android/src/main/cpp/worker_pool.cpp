@@ -0,0 +1,63 @@
+//
+// Created by udara on 10/19/26.
+//
+
+#include <algorithm>
+
+#include "include/worker_pool.h"
+
+WorkerPool::WorkerPool(size_t thread_count)
+        : threadCount(thread_count > 0 ? thread_count : std::max(1u, std::thread::hardware_concurrency()) - 1) {
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopWorkers = true;
+        workAvailable.notify_all();
+    }
+    for (auto &worker: workers) {
+        worker.join();
+    }
+}
+
+void WorkerPool::run(size_t job_count, const std::function<void(size_t)> &fn) {
+    if (job_count > 1 && workers.empty()) {
+        for (size_t i = 0; i < threadCount; i++) {
+            workers.emplace_back(&WorkerPool::runWorker, this);
+        }
+    }
+    std::unique_lock<std::mutex> lock(mutex);
+    job = &fn;
+    jobCount = job_count;
+    nextJob = 0;
+    workAvailable.notify_all();
+    runJobs(lock);
+    workFinished.wait(lock, [this] { return runningCount == 0; });
+    job = nullptr;
+    jobCount = 0;
+}
+
+void WorkerPool::runJobs(std::unique_lock<std::mutex> &lock) {
+    while (nextJob < jobCount) {
+        size_t index = nextJob++;
+        const auto *fn = job;
+        runningCount++;
+        lock.unlock();
+        (*fn)(index);
+        lock.lock();
+        runningCount--;
+    }
+    if (runningCount == 0) {
+        workFinished.notify_all();
+    }
+}
+
+void WorkerPool::runWorker() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        workAvailable.wait(lock, [this] { return stopWorkers || nextJob < jobCount; });
+        if (stopWorkers) break;
+        runJobs(lock);
+    }
+}
@@ -42,5 +42,11 @@ enum class CodecResult(val message: String) {
     ERROR_ANIM_INFO_GET_FAILED("Failed to animation info"),
     ERROR_SET_DATA_SOURCE_FAILED("Failed to set decoder data"),
     ERROR_DATA_SOURCE_NOT_SET("Decoder data source not set"),
-    ERROR_NO_MORE_FRAMES("No more frames to decode")
+    ERROR_NO_MORE_FRAMES("No more frames to decode"),
+    ERROR_INVALID_FRAME_BUFFER("Frame buffer does not match the declared size or format"),
+    ERROR_SIZE_BUDGET_EXCEEDED("Animation does not fit in the size budget"),
+    ERROR_NOT_AN_ANIMATION("Source is not an animated WebP image"),
+    ERROR_INVALID_FRAME_RANGE("Frame range is empty or does not start at a keyframe"),
+    ERROR_MEMORY_LIMIT_EXCEEDED("Encoder memory limit exceeded"),
+    ERROR_STREAM_FINISHED("Streaming output is finished")
 }
\ No newline at end of file
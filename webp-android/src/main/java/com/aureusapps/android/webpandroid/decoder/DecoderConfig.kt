@@ -1,6 +1,7 @@
 package com.aureusapps.android.webpandroid.decoder
 
 import android.graphics.Bitmap
+import com.aureusapps.android.webpandroid.utils.ConfigPacker
 
 /**
  * Configuration data class for the webp decoder.
@@ -18,4 +19,17 @@ data class DecoderConfig(
     val repeatCharacterCount: Int = 4,
     val compressFormat: Bitmap.CompressFormat = Bitmap.CompressFormat.PNG,
     val compressQuality: Int = 100
-)
\ No newline at end of file
+) {
+
+    /**
+     * The fields other than [namePrefix] packed for the native decoder, in the order of dec::DecoderConfigValue.
+     */
+    @JvmField
+    internal val packed: IntArray = ConfigPacker(4)
+        .put(repeatCharacter.code)
+        .put(repeatCharacterCount)
+        .put(compressFormat.ordinal)
+        .put(compressQuality)
+        .toIntArray()
+
+}
\ No newline at end of file
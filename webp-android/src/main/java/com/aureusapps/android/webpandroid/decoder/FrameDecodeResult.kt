@@ -3,14 +3,17 @@ package com.aureusapps.android.webpandroid.decoder
 import android.graphics.Bitmap
 import com.aureusapps.android.webpandroid.CodecResult
 
-internal data class InternalFrameDecodeResult(
-    val frame: Bitmap?,
-    val timestamp: Int,
-    val resultCode: Int,
-)
-
+/**
+ * The result of [WebPDecoder.decodeNextFrame].
+ *
+ * @param frame The decoded frame, or null if decoding did not succeed. The same bitmap is reused for every frame.
+ * @param timestamp The end timestamp of the frame in milliseconds.
+ * @param codecResult [CodecResult.SUCCESS], or [CodecResult.ERROR_NO_MORE_FRAMES] at the end of the content.
+ * @param frameIndex Zero based index of the decoded frame, or -1 if no frame was decoded.
+ */
 data class FrameDecodeResult(
     val frame: Bitmap?,
     val timestamp: Int,
     val codecResult: CodecResult,
+    val frameIndex: Int = -1,
 )
\ No newline at end of file
@@ -0,0 +1,21 @@
+package com.aureusapps.android.webpandroid.decoder
+
+internal data class InternalFrameExtractResult(
+    val copied: Boolean,
+    val resultCode: Int,
+)
+
+/**
+ * How [WebPDecoder.extractFrame] produced a still image.
+ */
+enum class FrameExtractPath {
+    /**
+     * The frame bitstream was copied into a still image without decoding.
+     */
+    COPY,
+
+    /**
+     * The frame depends on earlier frames, so the composed canvas was decoded and encoded again.
+     */
+    REENCODE,
+}
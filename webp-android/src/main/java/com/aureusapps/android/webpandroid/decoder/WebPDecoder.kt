@@ -6,9 +6,15 @@ import android.graphics.Bitmap
 import android.net.Uri
 import com.aureusapps.android.webpandroid.CodecException
 import com.aureusapps.android.webpandroid.CodecResult
+import com.aureusapps.android.webpandroid.encoder.WebPBuffer
+import com.aureusapps.android.webpandroid.encoder.WebPConfig
+import com.aureusapps.android.webpandroid.encoder.WebPPreset
 import com.aureusapps.android.webpandroid.utils.CodecHelper
 import com.getkeepsafe.relinker.ReLinker
+import dalvik.annotation.optimization.CriticalNative
+import dalvik.annotation.optimization.FastNative
 import java.nio.Buffer
+import java.nio.ByteBuffer
 
 /**
  * The [WebPDecoder] class provides functionality for decoding WebP images.
@@ -19,12 +25,30 @@ class WebPDecoder(private val context: Context) {
         private const val TAG = "WebPDecoder"
     }
 
+    /**
+     * Decoder queries that only read an int. Static and primitive only, so they qualify for
+     * @CriticalNative, which skips the JNIEnv and the class argument on Android 8.0 and later.
+     */
+    private object CriticalNatives {
+
+        @JvmStatic
+        @CriticalNative
+        external fun nativeHasNextFrame(nativePointer: Long): Boolean
+
+        @JvmStatic
+        @CriticalNative
+        external fun nativeNextFrameIndex(nativePointer: Long): Int
+
+    }
+
     init {
         ReLinker.loadLibrary(context, "webpcodec_jni")
     }
 
     private val nativePointer: Long
     private val decodeListeners = mutableSetOf<WebPDecodeListener>()
+    private var frameBitmap: Bitmap? = null
+    private var dataOwner: WebPBuffer? = null
 
     init {
         nativePointer = nativeCreate()
@@ -40,16 +64,30 @@ class WebPDecoder(private val context: Context) {
 
     private external fun nativeDecodeInfo(): InfoDecodeResult
 
-    private external fun nativeHasNextFrame(): Boolean
+    private external fun nativeDecodeNextFrame(): Long
 
-    private external fun nativeNextFrameIndex(): Int
-
-    private external fun nativeDecodeNextFrame(): InternalFrameDecodeResult
+    @FastNative
+    private external fun nativeGetFrameBitmap(): Bitmap?
 
     private external fun nativeDecodeFrames(context: Context, dstUri: Uri?): Int
 
+    private external fun nativeDecodeFrameBatch(
+        count: Int,
+        dstBuffer: ByteBuffer,
+        timestamps: IntArray,
+    ): Long
+
+    private external fun nativeExtractFrame(
+        context: Context,
+        index: Int,
+        dstUri: Uri,
+        config: WebPConfig?,
+        preset: WebPPreset?,
+    ): InternalFrameExtractResult
+
     private external fun nativeReset()
 
+    @FastNative
     private external fun nativeCancel()
 
     private external fun nativeRelease()
@@ -71,6 +109,20 @@ class WebPDecoder(private val context: Context) {
         }
     }
 
+    // The native decoder packs the result code, frame index + 1 and timestamp of a frame into one Long
+    private fun decodeNextFramePacked(): Long {
+        val packed = nativeDecodeNextFrame()
+        val codecResult = packedCodecResult(packed)
+        if (codecResult != CodecResult.SUCCESS && codecResult != CodecResult.ERROR_NO_MORE_FRAMES) {
+            throw CodecException(codecResult)
+        }
+        return packed
+    }
+
+    private fun packedCodecResult(packed: Long): CodecResult {
+        return CodecHelper.resultCodeToCodecResult((packed ushr 56).toInt())
+    }
+
     private inline fun <T> handleResultCode(
         resultCode: Int,
         onSuccess: () -> T,
@@ -121,12 +173,25 @@ class WebPDecoder(private val context: Context) {
      * @param buffer The Java buffer containing the data to be processed.
      */
     fun setDataBuffer(buffer: Buffer) {
+        dataOwner = null
         val resultCode = nativeSetDataBuffer(buffer)
+        frameBitmap = nativeGetFrameBitmap()
         handleResultCode(resultCode) {
 
         }
     }
 
+    /**
+     * Sets a WebP image encoded into memory by this library as the data for processing.
+     * The decoder keeps the [WebPBuffer] reachable until the data is replaced or the decoder is released.
+     *
+     * @param webPBuffer The WebP image.
+     */
+    fun setDataBuffer(webPBuffer: WebPBuffer) {
+        setDataBuffer(webPBuffer.buffer)
+        dataOwner = webPBuffer
+    }
+
     /**
      * Sets the data source of the decoder.
      *
@@ -134,7 +199,9 @@ class WebPDecoder(private val context: Context) {
      * @throws CodecException if failed to set data source.
      */
     fun setDataSource(srcUri: Uri) {
+        dataOwner = null
         val resultCode = nativeSetDataSource(context, srcUri)
+        frameBitmap = nativeGetFrameBitmap()
         handleResultCode(resultCode) {
 
         }
@@ -157,14 +224,14 @@ class WebPDecoder(private val context: Context) {
      * Return true if frames are available to decode.
      */
     fun hasNextFrame(): Boolean {
-        return nativeHasNextFrame()
+        return CriticalNatives.nativeHasNextFrame(nativePointer)
     }
 
     /**
      * Returns index of the next frame.
      */
     fun nextFrameIndex(): Int {
-        return nativeNextFrameIndex()
+        return CriticalNatives.nativeNextFrameIndex(nativePointer)
     }
 
     /**
@@ -177,18 +244,36 @@ class WebPDecoder(private val context: Context) {
      * @throws CodecException if the decoding of the next frame fails.
      */
     fun decodeNextFrame(): FrameDecodeResult {
-        val decodeResult = nativeDecodeNextFrame()
-        val codecResult = CodecHelper.resultCodeToCodecResult(decodeResult.resultCode)
-        if (codecResult != CodecResult.SUCCESS && codecResult != CodecResult.ERROR_NO_MORE_FRAMES) {
-            throw CodecException(codecResult)
-        }
+        val packed = decodeNextFramePacked()
+        val codecResult = packedCodecResult(packed)
         return FrameDecodeResult(
-            frame = decodeResult.frame,
-            timestamp = decodeResult.timestamp,
-            codecResult = codecResult
+            frame = if (codecResult == CodecResult.SUCCESS) frameBitmap else null,
+            timestamp = packed.toInt(),
+            codecResult = codecResult,
+            frameIndex = ((packed ushr 32) and 0xFFFFFF).toInt() - 1
         )
     }
 
+    /**
+     * Decodes the next frame into [currentFrame] without allocating a result object, for playback loops
+     * that draw every frame.
+     *
+     * @return The timestamp of the decoded frame in milliseconds, or -1 if the decoder reached the end of the content.
+     *
+     * @throws CodecException if the decoding of the next frame fails.
+     */
+    fun decodeNextFrameInPlace(): Int {
+        val packed = decodeNextFramePacked()
+        return if (packedCodecResult(packed) == CodecResult.SUCCESS) packed.toInt() else -1
+    }
+
+    /**
+     * The bitmap every frame is decoded into. Replaced when the data source changes, and recycled
+     * when the data source changes or the decoder is released.
+     */
+    val currentFrame: Bitmap?
+        get() = frameBitmap
+
     /**
      * Decodes all frames of a WebP image and optionally saves them to a destination [Uri].
      *
@@ -203,6 +288,53 @@ class WebPDecoder(private val context: Context) {
         }
     }
 
+    /**
+     * Decodes up to [count] consecutive frames from the current position into a frame stack in one native call,
+     * without going through [currentFrame]. Frame `i` of the batch is stored at offset `i * width * height * 4`
+     * of [dstBuffer] as non-premultiplied RGBA_8888 rows of `width * 4` bytes, where width and height are the
+     * canvas size reported by [decodeInfo]. The position of [dstBuffer] is ignored.
+     *
+     * @param count Maximum number of frames to decode.
+     * @param dstBuffer A direct buffer of at least `count * width * height * 4` bytes.
+     *
+     * @return The end timestamps of the decoded frames in milliseconds. Shorter than [count] near the end of
+     * the content, and empty once all frames are decoded.
+     * @throws CodecException with [CodecResult.ERROR_INVALID_FRAME_BUFFER] if [dstBuffer] is not direct or too small.
+     */
+    fun decodeFrames(count: Int, dstBuffer: ByteBuffer): IntArray {
+        val timestamps = IntArray(count.coerceAtLeast(0))
+        val packed = nativeDecodeFrameBatch(count, dstBuffer, timestamps)
+        return handleResultCode((packed ushr 32).toInt()) {
+            val decoded = packed.toInt()
+            if (decoded == timestamps.size) timestamps else timestamps.copyOf(decoded)
+        }
+    }
+
+    /**
+     * Saves a frame of the data source as a still WebP image, keeping its ICC profile. The first frame and
+     * frames that cover the whole canvas and replace it are copied without decoding. Other frames are
+     * composed with the frames before them and encoded again. The position of [decodeNextFrame] is not changed.
+     *
+     * @param index Zero based index of the frame.
+     * @param dstUri The [Uri] of the still image.
+     * @param config The encoding configuration used if the frame cannot be copied. Lossless if both [config] and [preset] are null.
+     * @param preset The encoding preset used if the frame cannot be copied.
+     *
+     * @return [FrameExtractPath.COPY] if the frame was copied or [FrameExtractPath.REENCODE] if it was encoded again.
+     * @throws CodecException with [CodecResult.ERROR_INVALID_FRAME_RANGE] if there is no frame at [index].
+     */
+    fun extractFrame(
+        index: Int,
+        dstUri: Uri,
+        config: WebPConfig? = null,
+        preset: WebPPreset? = null,
+    ): FrameExtractPath {
+        val extractResult = nativeExtractFrame(context, index, dstUri, config, preset)
+        return handleResultCode(extractResult.resultCode) {
+            if (extractResult.copied) FrameExtractPath.COPY else FrameExtractPath.REENCODE
+        }
+    }
+
     /**
      * Resets the decoder's state to its initial configuration and sets the current frame index to 0.
      */
@@ -221,7 +353,9 @@ class WebPDecoder(private val context: Context) {
      * Releases the resources used by the [WebPDecoder] object.
      */
     fun release() {
+        frameBitmap = null
         nativeRelease()
+        dataOwner = null
     }
 
 }
\ No newline at end of file
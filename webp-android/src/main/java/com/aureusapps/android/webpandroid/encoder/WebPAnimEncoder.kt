@@ -6,6 +6,7 @@ import android.graphics.Bitmap
 import android.net.Uri
 import com.aureusapps.android.webpandroid.utils.BitmapUtils
 import com.getkeepsafe.relinker.ReLinker
+import java.nio.ByteBuffer
 
 /**
  * Constructs a WebP animation encoder with the specified width, height, and options.
@@ -53,12 +54,83 @@ class WebPAnimEncoder(
         srcBitmap: Bitmap,
     )
 
+    private external fun nativeAddFrameBuffer(
+        timestamp: Long,
+        buffer: ByteBuffer,
+        width: Int,
+        height: Int,
+        format: Int,
+        rowStride: Int,
+        uvRowStride: Int,
+    )
+
     private external fun nativeAssemble(
         context: Context,
         timestamp: Long,
         dstUri: Uri,
     )
 
+    private external fun nativeAssembleToBuffer(
+        timestamp: Long,
+    ): WebPBuffer
+
+    private external fun nativeSetParallelEncoding(
+        threadCount: Int,
+    )
+
+    private external fun nativeSetSizeBudget(
+        budgetBytes: Long,
+        expectedFrameCount: Int,
+    )
+
+    private external fun nativeSetAppendSource(
+        context: Context,
+        srcUri: Uri,
+        reuseLastCanvas: Boolean,
+    )
+
+    private external fun nativeGetSeekReport(): WebPSeekReport?
+
+    private external fun nativeSetMemoryLimit(
+        limitBytes: Long,
+        policy: Int,
+    )
+
+    private external fun nativeGetMemoryUsage(): Long
+
+    private external fun nativeGetPeakMemoryUsage(): Long
+
+    private external fun nativeSetStreamingOutput(
+        context: Context,
+        dstUri: Uri,
+    )
+
+    private external fun nativeFinishStreaming(
+        timestamp: Long,
+    )
+
+    private external fun nativeSetDuplicateTolerance(
+        tolerance: Int,
+    )
+
+    private external fun nativeGetDroppedFrameCount(): Int
+
+    private external fun nativeSetFrameResampling(
+        frameDuration: Float,
+        measureDifference: Boolean,
+    )
+
+    private external fun nativeGetDecimatedFrameCount(): Int
+
+    private external fun nativeSetAsyncQueue(
+        capacity: Int,
+    )
+
+    private external fun nativeSetProgressInterval(
+        intervalMillis: Long,
+        percentStep: Int,
+    )
+
     private external fun nativeCancel()
 
     private external fun nativeRelease()
@@ -95,6 +167,232 @@ class WebPAnimEncoder(
         return progressListeners.remove(listener)
     }
 
+    /**
+     * Limits how often progress listeners are notified.
+     * Progress reported by libwebp worker threads is coalesced and delivered from the encoding thread.
+     *
+     * @param intervalMillis Minimum time between two notifications in milliseconds.
+     * @param percentStep Minimum progress change in percent between two notifications.
+     *
+     * @return this encoder instance.
+     */
+    fun setProgressInterval(intervalMillis: Long = 0L, percentStep: Int = 1): WebPAnimEncoder {
+        nativeSetProgressInterval(intervalMillis, percentStep)
+        return this
+    }
+
+    /**
+     * Switches to the parallel encoding engine. Frames are diffed against the previous frame in the
+     * order they are added, and the changed rectangles are encoded concurrently on a worker pool and
+     * muxed in order. Keyframes follow [WebPAnimEncoderOptions.kmin] and [WebPAnimEncoderOptions.kmax].
+     * [WebPAnimEncoderOptions.minimizeSize] and [WebPAnimEncoderOptions.allowMixed] are not used by this engine.
+     * Progress listeners receive 100 for each frame, in frame order, once it is encoded, from [addFrame] or assemble.
+     * Must be called before the first frame is added.
+     *
+     * @param threadCount Number of worker threads, 0 to use one per CPU core, or a negative value to use the default sequential engine.
+     *
+     * @return this animation encoder instance.
+     */
+    fun setParallelEncoding(threadCount: Int = 0): WebPAnimEncoder {
+        nativeSetParallelEncoding(threadCount)
+        return this
+    }
+
+    /**
+     * Keeps the assembled animation under a total size in a single encoding pass. The quality of each
+     * lossy frame is picked from the bytes spent so far, using the configured quality as the upper bound.
+     * If the animation still overshoots, lossy frames are re-encoded at a lower quality at most twice,
+     * after which [assemble] fails with [CodecResult.ERROR_SIZE_BUDGET_EXCEEDED].
+     * Lossless frames are not rate controlled. Selects the parallel engine if it is not selected.
+     * With [setStreamingOutput], frames are written as they are encoded and are not corrected.
+     * Must be called before the first frame is added.
+     *
+     * @param budgetBytes Maximum size of the animation in bytes, or 0 to disable the budget.
+     * @param expectedFrameCount Expected number of frames, used to share the budget between them.
+     *
+     * @return this animation encoder instance.
+     */
+    fun setSizeBudget(budgetBytes: Long, expectedFrameCount: Int): WebPAnimEncoder {
+        nativeSetSizeBudget(budgetBytes, expectedFrameCount)
+        return this
+    }
+
+    /**
+     * Limits the native memory held by this encoder, so that long sessions fail or reduce their memory
+     * use instead of getting the process killed. Counted are the imported frames, the frames waiting in
+     * the [setAsyncQueue] queue, the diff canvas, the frame pictures and the encoded frames kept until
+     * they are assembled or streamed. Each frame reserves room for two full canvases and its largest encoded
+     * size before it is imported, after waiting for the frames being encoded if their output could take the
+     * encoder over the limit, so [peakMemoryUsage] stays within the limit until the animation is assembled.
+     * Selects the parallel engine if it is not selected, since the frames kept inside the sequential engine
+     * cannot be measured. Must be called before the first frame is added.
+     *
+     * @param limitBytes Maximum number of bytes, or 0 to remove the limit.
+     * @param policy What to do when a frame does not fit.
+     *
+     * @return this animation encoder instance.
+     *
+     * @see memoryUsage
+     * @see peakMemoryUsage
+     */
+    fun setMemoryLimit(limitBytes: Long, policy: WebPMemoryPolicy = WebPMemoryPolicy.FAIL): WebPAnimEncoder {
+        nativeSetMemoryLimit(limitBytes, policy.value)
+        return this
+    }
+
+    /**
+     * The number of native bytes currently held by this encoder.
+     *
+     * @see setMemoryLimit
+     */
+    val memoryUsage: Long
+        get() = nativeGetMemoryUsage()
+
+    /**
+     * The highest [memoryUsage] since the encoder was created, including the assembled animation.
+     */
+    val peakMemoryUsage: Long
+        get() = nativeGetPeakMemoryUsage()
+
+    /**
+     * Continues an existing animated WebP image instead of starting a new one. Only the added frames are
+     * encoded, the existing frames are copied into the assembled animation as they are, together with its
+     * loop count, background color and metadata. Timestamps of the added frames, including the end timestamp
+     * passed to [assemble], are relative to the end of the existing animation, and a positive first timestamp
+     * extends its last frame. Frames are scaled to the canvas size of the existing animation.
+     * Selects the parallel engine if it is not selected, and cannot be combined with [setStreamingOutput].
+     * Must be called before the first frame is added.
+     *
+     * @param srcUri The existing animation. The assembled animation can be written back to the same Uri.
+     * @param reuseLastCanvas If true, the existing frames are decoded once to rebuild the last canvas, and the
+     * first added frame only stores what changed. If false, nothing is decoded and the first added frame is a keyframe.
+     *
+     * @return this animation encoder instance.
+     */
+    fun appendTo(srcUri: Uri, reuseLastCanvas: Boolean = true): WebPAnimEncoder {
+        nativeSetAppendSource(context, srcUri, reuseLastCanvas)
+        return this
+    }
+
+    /**
+     * Streams the animation to the destination while frames are added. Each frame is written as soon as
+     * it is encoded and the next frame's timestamp is known, so memory use depends on the frame size
+     * instead of the animation length. Streaming uses the parallel engine, with a single worker thread
+     * unless [setParallelEncoding] was called. Must be called before the first frame is added, and the
+     * animation must be completed with [finishStreaming] instead of [assemble].
+     *
+     * @param dstUri The destination Uri where the WebP animation will be written. If it is not seekable, such as a pipe,
+     * the animation is held in memory until [finishStreaming].
+     *
+     * @return this animation encoder instance.
+     */
+    fun setStreamingOutput(dstUri: Uri): WebPAnimEncoder {
+        nativeSetStreamingOutput(context, dstUri)
+        return this
+    }
+
+    /**
+     * Writes the remaining frames of a streamed animation and closes the destination.
+     * Frames cannot be added afterwards, they fail with [com.aureusapps.android.webpandroid.CodecResult.ERROR_STREAM_FINISHED].
+     *
+     * @param timestamp The end timestamp of the animation.
+     *
+     * @return this animation encoder instance.
+     */
+    fun finishStreaming(timestamp: Long): WebPAnimEncoder {
+        nativeFinishStreaming(timestamp)
+        return this
+    }
+
+    /**
+     * Drops frames that repeat the previously kept frame before they are imported and encoded.
+     * The kept frame is shown until the timestamp of the next kept frame, so its duration includes the dropped frames.
+     *
+     * @param tolerance Maximum difference of each color channel, or each Y, U and V sample of YUV frames, for a frame to count as a repeat, 0 to drop only exact repeats, or a negative value to keep all frames.
+     *
+     * @return this animation encoder instance.
+     */
+    fun setDuplicateTolerance(tolerance: Int): WebPAnimEncoder {
+        nativeSetDuplicateTolerance(tolerance)
+        return this
+    }
+
+    /**
+     * The number of frames dropped as repeats of the previous frame.
+     *
+     * @see setDuplicateTolerance
+     */
+    val droppedFrameCount: Int
+        get() = nativeGetDroppedFrameCount()
+
+    /**
+     * Resamples added frames to a fixed frame rate in native code, so a 60 fps recording can be published
+     * at 15 fps without dropping frames in Java. Frame timestamps are moved to multiples of the frame
+     * duration and one frame is kept per output frame. Dropped frames are never imported or encoded.
+     * The end timestamp passed to [assemble] or [finishStreaming] is rounded up to an output frame time.
+     * Must be called before the first frame is added.
+     *
+     * @param frameRate Output frames per second, or 0 to keep every frame.
+     * @param pickByDifference If true, the frame that changed the most since the last kept frame is kept,
+     * measured on a grid of luma samples. The leading frame is copied until the output frame is complete.
+     * If false, the first frame of each output frame is kept without copying.
+     *
+     * @return this animation encoder instance.
+     */
+    fun setFrameRate(frameRate: Float, pickByDifference: Boolean = true): WebPAnimEncoder {
+        require(frameRate >= 0f) { "Frame rate must not be negative." }
+        nativeSetFrameResampling(if (frameRate > 0f) 1000f / frameRate else 0f, pickByDifference)
+        return this
+    }
+
+    /**
+     * Resamples added frames so that no frame is shorter than [durationMillis].
+     * Same as [setFrameRate] with a frame rate of 1000 / [durationMillis].
+     *
+     * @param durationMillis Minimum frame duration in milliseconds, or 0 to keep every frame.
+     * @param pickByDifference See [setFrameRate].
+     *
+     * @return this animation encoder instance.
+     */
+    fun setMinFrameDuration(durationMillis: Float, pickByDifference: Boolean = true): WebPAnimEncoder {
+        require(durationMillis >= 0f) { "Frame duration must not be negative." }
+        nativeSetFrameResampling(durationMillis, pickByDifference)
+        return this
+    }
+
+    /**
+     * The number of frames dropped by frame rate resampling.
+     *
+     * @see setFrameRate
+     */
+    val decimatedFrameCount: Int
+        get() = nativeGetDecimatedFrameCount()
+
+    /**
+     * The keyframes of the animation from the last [assemble] or [assembleToBuffer] call, or null if the
+     * animation was not assembled. Not available for streamed animations.
+     *
+     * @see WebPAnimEncoderOptions.maxSeekFrames
+     */
+    val seekReport: WebPSeekReport?
+        get() = nativeGetSeekReport()
+
+    /**
+     * Enables asynchronous frame encoding. [addFrame] copies the bitmap into a pooled buffer and
+     * returns, while a native worker thread encodes the queued frames in order. [addFrame] blocks only
+     * when [capacity] frames are already waiting, and [assemble] waits until the queue is drained.
+     * Progress listeners are called from the worker thread in this mode. An error of a queued frame is
+     * thrown by the next [addFrame] or [assemble] call.
+     *
+     * @param capacity Maximum number of frames waiting to be encoded, or 0 to encode frames synchronously.
+     *
+     * @return this animation encoder instance.
+     */
+    fun setAsyncQueue(capacity: Int): WebPAnimEncoder {
+        nativeSetAsyncQueue(capacity)
+        return this
+    }
+
     /**
      * Configures the WebP encoder with the specified configuration.
      *
@@ -137,6 +435,33 @@ class WebPAnimEncoder(
         return this
     }
 
+    /**
+     * Adds a frame from a raw pixel buffer, such as a camera or video decoder output, without creating a bitmap.
+     * YUV frames are imported directly into the encoder picture, skipping the RGB conversion.
+     *
+     * @param timestamp The timestamp of the frame.
+     * @param buffer The direct buffer holding the frame, starting at its first row.
+     * @param width The width of the frame in pixels.
+     * @param height The height of the frame in pixels.
+     * @param format The layout of the pixels in the buffer.
+     * @param rowStride The number of bytes between rows of the RGBA or Y plane. If zero, rows are tightly packed.
+     * @param uvRowStride The number of bytes between rows of the chroma planes. If zero, chroma rows are tightly packed.
+     * @return this animation encoder instance.
+     */
+    fun addFrame(
+        timestamp: Long,
+        buffer: ByteBuffer,
+        width: Int,
+        height: Int,
+        format: WebPPixelFormat,
+        rowStride: Int = 0,
+        uvRowStride: Int = 0,
+    ): WebPAnimEncoder {
+        require(buffer.isDirect) { "Frame buffer must be a direct buffer." }
+        nativeAddFrameBuffer(timestamp, buffer, width, height, format.value, rowStride, uvRowStride)
+        return this
+    }
+
     /**
      * Assembles the WebP animation and saves it to the specified destination Uri.
      *
@@ -149,6 +474,16 @@ class WebPAnimEncoder(
         return this
     }
 
+    /**
+     * Assembles the WebP animation into memory.
+     *
+     * @param timestamp The end timestamp of the animation.
+     * @return A [WebPBuffer] wrapping the assembled WebP data without copying. The native memory is released when it is garbage collected.
+     */
+    fun assembleToBuffer(timestamp: Long): WebPBuffer {
+        return nativeAssembleToBuffer(timestamp)
+    }
+
     /**
      * Cancels the ongoing WebP animation encoding process.
      */
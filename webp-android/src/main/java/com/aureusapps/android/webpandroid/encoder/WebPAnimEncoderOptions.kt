@@ -1,5 +1,7 @@
 package com.aureusapps.android.webpandroid.encoder
 
+import com.aureusapps.android.webpandroid.utils.ConfigPacker
+
 /**
  * Options for configuring the WebP animation encoder.
  *
@@ -9,6 +11,7 @@ package com.aureusapps.android.webpandroid.encoder
  * @param allowMixed If true, uses mixed compression mode, allowing lossy and lossless frames.
  * @param verbose If true, enables printing info and warning messages to stderr.
  * @param animParams Animation parameters for the WebP animation.
+ * @param maxSeekFrames Seek-optimized mode. Places keyframes so that at most this many frames are decoded to show any frame, overriding [kmin], [kmax] and [minimizeSize]. 1 makes every frame a keyframe. Use [WebPAnimEncoder.seekReport] to see the resulting keyframes and their size overhead.
  */
 data class WebPAnimEncoderOptions(
     val minimizeSize: Boolean? = null,
@@ -16,5 +19,24 @@ data class WebPAnimEncoderOptions(
     val kmax: Int? = null,
     val allowMixed: Boolean? = null,
     val verbose: Boolean? = null,
-    val animParams: WebPMuxAnimParams? = null
-)
\ No newline at end of file
+    val animParams: WebPMuxAnimParams? = null,
+    val maxSeekFrames: Int? = null,
+) {
+
+    /**
+     * The options packed for the native encoder, in the order of enc::AnimEncoderOptionsValue.
+     */
+    @JvmField
+    internal val packed: IntArray = ConfigPacker(9)
+        .put(minimizeSize)
+        .put(kmin)
+        .put(kmax)
+        .put(allowMixed)
+        .put(verbose)
+        .put(animParams != null)
+        .put(animParams?.backgroundColor)
+        .put(animParams?.loopCount)
+        .put(maxSeekFrames)
+        .toIntArray()
+
+}
\ No newline at end of file
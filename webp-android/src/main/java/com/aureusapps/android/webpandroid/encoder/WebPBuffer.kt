@@ -0,0 +1,36 @@
+package com.aureusapps.android.webpandroid.encoder
+
+import java.nio.ByteBuffer
+
+/**
+ * The `WebPBuffer` class owns a WebP image in native memory, as returned by [WebPEncoder.encodeToBuffer],
+ * [WebPAnimEncoder.assembleToBuffer] and [com.aureusapps.android.webpandroid.mux.WebPMuxEditor.editBuffer].
+ *
+ * The native memory is released once this object is garbage collected, not when [buffer] is.
+ * Keep this object reachable while [buffer], or any view of it created with `slice`, `duplicate` or
+ * `asReadOnlyBuffer`, is in use. Pass this object instead of [buffer] to
+ * [com.aureusapps.android.webpandroid.decoder.WebPDecoder.setDataBuffer] so that the decoder keeps it.
+ */
+class WebPBuffer internal constructor(
+    /**
+     * A direct buffer wrapping the WebP image, without copying it.
+     */
+    val buffer: ByteBuffer
+) {
+
+    /**
+     * The size of the WebP image in bytes.
+     */
+    val size: Int
+        get() = buffer.capacity()
+
+    /**
+     * Copies the WebP image into a byte array that does not depend on this object.
+     */
+    fun toByteArray(): ByteArray {
+        val bytes = ByteArray(size)
+        buffer.duplicate().apply { clear() }.get(bytes)
+        return bytes
+    }
+
+}
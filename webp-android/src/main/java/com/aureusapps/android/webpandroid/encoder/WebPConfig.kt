@@ -3,6 +3,7 @@ package com.aureusapps.android.webpandroid.encoder
 import androidx.annotation.FloatRange
 import androidx.annotation.IntDef
 import androidx.annotation.IntRange
+import com.aureusapps.android.webpandroid.utils.ConfigPacker
 
 /**
  * Configuration options for the WebP encoder.
@@ -131,6 +132,41 @@ data class WebPConfig(
     val qmax: Int? = null
 ) {
 
+    /**
+     * The fields packed for the native encoder, in the order of enc::WebPConfigValue.
+     */
+    @JvmField
+    internal val packed: IntArray = ConfigPacker(28)
+        .put(lossless)
+        .put(quality)
+        .put(method)
+        .put(targetSize)
+        .put(targetPSNR)
+        .put(segments)
+        .put(snsStrength)
+        .put(filterStrength)
+        .put(filterSharpness)
+        .put(filterType)
+        .put(autoFilter)
+        .put(alphaCompression)
+        .put(alphaFiltering)
+        .put(alphaQuality)
+        .put(pass)
+        .put(showCompressed)
+        .put(preprocessing)
+        .put(partitions)
+        .put(partitionLimit)
+        .put(emulateJPEGSize)
+        .put(threadLevel)
+        .put(lowMemory)
+        .put(nearLossless)
+        .put(exact)
+        .put(useDeltaPalette)
+        .put(useSharpYUV)
+        .put(qmin)
+        .put(qmax)
+        .toIntArray()
+
     companion object {
         // Constants for options with predefined values
         const val COMPRESSION_LOSSY = 0
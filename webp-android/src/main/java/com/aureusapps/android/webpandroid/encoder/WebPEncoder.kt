@@ -22,6 +22,7 @@ class WebPEncoder(private val context: Context, width: Int = -1, height: Int = -
     }
 
     private val progressListeners = mutableSetOf<WebPEncoderProgressListener>()
+    private var deadlineListener: WebPEncoderDeadlineListener? = null
     private val nativePointer: Long
 
     init {
@@ -47,6 +48,31 @@ class WebPEncoder(private val context: Context, width: Int = -1, height: Int = -
         dstUri: Uri,
     )
 
+    private external fun nativeEncodeMultiple(
+        context: Context,
+        srcBitmap: Bitmap,
+        outputs: Array<WebPEncoderOutput>,
+    )
+
+    private external fun nativeEncodeToBuffer(
+        srcBitmap: Bitmap,
+    ): WebPBuffer
+
+    private external fun nativeCalibrate(): FloatArray
+
+    private external fun nativeSetSpeedModel(
+        model: FloatArray,
+    )
+
+    private external fun nativeSetDeadline(
+        deadlineMillis: Long,
+    )
+
+    private external fun nativeSetProgressInterval(
+        intervalMillis: Long,
+        percentStep: Int,
+    )
+
     private external fun nativeCancel()
 
     private external fun nativeRelease()
@@ -61,6 +87,10 @@ class WebPEncoder(private val context: Context, width: Int = -1, height: Int = -
         return encode
     }
 
+    private fun notifyDeadlineMissed(deadlineMillis: Long, elapsedMillis: Long, method: Int) {
+        deadlineListener?.onDeadlineMissed(deadlineMillis, elapsedMillis, method)
+    }
+
     /**
      * Adds a progress listener to receive encoding progress updates.
      *
@@ -83,6 +113,60 @@ class WebPEncoder(private val context: Context, width: Int = -1, height: Int = -
         return progressListeners.remove(listener)
     }
 
+    /**
+     * Limits how often progress listeners are notified.
+     * Progress reported by libwebp worker threads is coalesced and delivered from the encoding thread.
+     *
+     * @param intervalMillis Minimum time between two notifications in milliseconds.
+     * @param percentStep Minimum progress change in percent between two notifications.
+     *
+     * @return this encoder instance.
+     */
+    fun setProgressInterval(intervalMillis: Long = 0L, percentStep: Int = 1): WebPEncoder {
+        nativeSetProgressInterval(intervalMillis, percentStep)
+        return this
+    }
+
+    /**
+     * Measures the encoding speed of every compression method on this device.
+     * The measured speed model is shared by all encoders in the process and is used by [setDeadline].
+     * Calibration takes a few hundred milliseconds on slow devices, so run it off the main thread.
+     *
+     * @return The speed model, which can be persisted and restored with [setSpeedModel].
+     */
+    fun calibrate(): FloatArray {
+        return nativeCalibrate()
+    }
+
+    /**
+     * Restores a speed model previously returned by [calibrate] to skip calibration.
+     *
+     * @param model The speed model returned by [calibrate].
+     *
+     * @return this encoder instance.
+     */
+    fun setSpeedModel(model: FloatArray): WebPEncoder {
+        nativeSetSpeedModel(model)
+        return this
+    }
+
+    /**
+     * Sets a time budget for each encode. The configured method is treated as an upper bound and
+     * the highest method, and for lossless encoding the highest quality, expected to fit into the
+     * budget is used. If [calibrate] or [setSpeedModel] was not called before, the device is
+     * calibrated by this call, so call it off the main thread.
+     *
+     * @param deadlineMillis The time budget in milliseconds, or 0 to disable.
+     * @param listener Optional listener notified when an encode took longer than the budget.
+     *
+     * @return this encoder instance.
+     */
+    fun setDeadline(deadlineMillis: Long, listener: WebPEncoderDeadlineListener? = null): WebPEncoder {
+        nativeSetDeadline(deadlineMillis)
+        deadlineListener = listener
+        return this
+    }
+
     /**
      * Configures the WebP encoder.
      *
@@ -135,6 +219,77 @@ class WebPEncoder(private val context: Context, width: Int = -1, height: Int = -
         return this
     }
 
+    /**
+     * Encodes an image file from the given source [Uri] into several outputs of different sizes.
+     * The image is imported once, smaller outputs are downscaled from the closest larger one,
+     * and the outputs are encoded in parallel.
+     *
+     * @param srcUri The source [Uri] of the image file to encode. This could be a content provider [Uri], file [Uri], Android resource [Uri] or a http [Uri].
+     * @param outputs The outputs to produce.
+     *
+     * @return this encoder instance.
+     *
+     * @throws [RuntimeException] If encoding error occurred.
+     * @throws [CancellationException] If encoding process cancelled.
+     */
+    fun encode(srcUri: Uri, outputs: List<WebPEncoderOutput>): WebPEncoder {
+        val srcBitmap = BitmapUtils.decodeUri(context, srcUri)
+            ?: throw RuntimeException("Failed to decode bitmap from uri.")
+        nativeEncodeMultiple(context, srcBitmap, outputs.toTypedArray())
+        srcBitmap.recycle()
+        return this
+    }
+
+    /**
+     * Encodes a [Bitmap] image into several outputs of different sizes.
+     * The bitmap is imported once, smaller outputs are downscaled from the closest larger one,
+     * and the outputs are encoded in parallel.
+     *
+     * @param srcBitmap The source [Bitmap] image to encode.
+     * @param outputs The outputs to produce.
+     *
+     * @return this encoder instance.
+     *
+     * @throws [RuntimeException] If encoding error occurred.
+     * @throws [CancellationException] If encoding process cancelled.
+     */
+    fun encode(srcBitmap: Bitmap, outputs: List<WebPEncoderOutput>): WebPEncoder {
+        nativeEncodeMultiple(context, srcBitmap, outputs.toTypedArray())
+        return this
+    }
+
+    /**
+     * Encodes an image file from the given source [Uri] into memory.
+     *
+     * @param srcUri The source [Uri] of the image file to encode. This could be a content provider [Uri], file [Uri], Android resource [Uri] or a http [Uri].
+     *
+     * @return A [WebPBuffer] wrapping the encoded WebP data without copying. The native memory is released when it is garbage collected.
+     *
+     * @throws [RuntimeException] If encoding error occurred.
+     * @throws [CancellationException] If encoding process cancelled.
+     */
+    fun encodeToBuffer(srcUri: Uri): WebPBuffer {
+        val srcBitmap = BitmapUtils.decodeUri(context, srcUri)
+            ?: throw RuntimeException("Failed to decode bitmap from uri.")
+        val buffer = nativeEncodeToBuffer(srcBitmap)
+        srcBitmap.recycle()
+        return buffer
+    }
+
+    /**
+     * Encodes a [Bitmap] image into memory.
+     *
+     * @param srcBitmap The source [Bitmap] image to encode.
+     *
+     * @return A [WebPBuffer] wrapping the encoded WebP data without copying. The native memory is released when it is garbage collected.
+     *
+     * @throws [RuntimeException] If encoding error occurred.
+     * @throws [CancellationException] If encoding process cancelled.
+     */
+    fun encodeToBuffer(srcBitmap: Bitmap): WebPBuffer {
+        return nativeEncodeToBuffer(srcBitmap)
+    }
+
     /**
      * Cancels the ongoing encoding process.
      */
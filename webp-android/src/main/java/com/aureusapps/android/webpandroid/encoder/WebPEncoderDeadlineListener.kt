@@ -0,0 +1,17 @@
+package com.aureusapps.android.webpandroid.encoder
+
+/**
+ * The [WebPEncoderDeadlineListener] interface defines a callback that is invoked when an encode exceeds the deadline set with [WebPEncoder.setDeadline].
+ */
+fun interface WebPEncoderDeadlineListener {
+
+    /**
+     * This function is called after an encode that took longer than the deadline.
+     *
+     * @param deadlineMillis The time budget in milliseconds.
+     * @param elapsedMillis The time the encode actually took in milliseconds.
+     * @param method The compression method chosen for the encode.
+     */
+    fun onDeadlineMissed(deadlineMillis: Long, elapsedMillis: Long, method: Int)
+
+}
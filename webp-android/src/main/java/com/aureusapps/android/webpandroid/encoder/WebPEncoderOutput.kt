@@ -0,0 +1,36 @@
+package com.aureusapps.android.webpandroid.encoder
+
+import android.net.Uri
+
+/**
+ * The `WebPEncoderOutput` class describes one output of a multi-resolution encode.
+ */
+data class WebPEncoderOutput(
+    /**
+     * The destination [Uri] to save the encoded image.
+     */
+    val dstUri: Uri,
+
+    /**
+     * The width of the output image. If negative, it is derived from [height] keeping the aspect ratio,
+     * or the source width is used if both are negative.
+     */
+    val width: Int = -1,
+
+    /**
+     * The height of the output image. If negative, it is derived from [width] keeping the aspect ratio,
+     * or the source height is used if both are negative.
+     */
+    val height: Int = -1,
+
+    /**
+     * The WebP configuration for this output. If both [config] and [preset] are null,
+     * the configuration set with [WebPEncoder.configure] is used.
+     */
+    val config: WebPConfig? = null,
+
+    /**
+     * The optional WebP preset for this output.
+     */
+    val preset: WebPPreset? = null
+)
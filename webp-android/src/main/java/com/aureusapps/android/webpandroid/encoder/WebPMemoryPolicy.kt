@@ -0,0 +1,23 @@
+package com.aureusapps.android.webpandroid.encoder
+
+import com.aureusapps.android.webpandroid.CodecResult
+
+/**
+ * The [WebPMemoryPolicy] enum class selects what [WebPAnimEncoder] does when adding a frame would take
+ * it over the limit set with [WebPAnimEncoder.setMemoryLimit].
+ *
+ * @param value The integer value associated with each policy.
+ */
+enum class WebPMemoryPolicy(val value: Int) {
+    /**
+     * The frame is rejected with [CodecResult.ERROR_MEMORY_LIMIT_EXCEEDED].
+     */
+    FAIL(0),
+
+    /**
+     * The first time the limit is reached, the encoder waits for the queued frames, stops keeping frame
+     * pictures for [WebPAnimEncoder.setSizeBudget] corrections and encodes one frame at a time. If the
+     * frame still does not fit, it is rejected as with [FAIL].
+     */
+    REDUCE(1)
+}
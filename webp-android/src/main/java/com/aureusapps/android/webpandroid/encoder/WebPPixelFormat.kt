@@ -0,0 +1,23 @@
+package com.aureusapps.android.webpandroid.encoder
+
+/**
+ * The [WebPPixelFormat] enum class represents the layouts of raw frame buffers accepted by the animation encoder.
+ *
+ * @param value The integer value associated with each format.
+ */
+enum class WebPPixelFormat(val value: Int) {
+    /**
+     * Interleaved 8-bit R, G, B and A samples, as used by [android.graphics.Bitmap.Config.ARGB_8888].
+     */
+    RGBA_8888(0),
+
+    /**
+     * Full resolution Y plane followed by an interleaved V/U plane subsampled by 2, the default camera preview format.
+     */
+    NV21(1),
+
+    /**
+     * Full resolution Y plane followed by separate U and V planes subsampled by 2.
+     */
+    I420(2)
+}
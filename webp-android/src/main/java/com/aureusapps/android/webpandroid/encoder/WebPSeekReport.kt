@@ -0,0 +1,32 @@
+package com.aureusapps.android.webpandroid.encoder
+
+/**
+ * The [WebPSeekReport] class describes the keyframes of an assembled animation.
+ * A keyframe is decoded without the frames before it, so showing any frame costs decoding it and the frames back to the previous keyframe.
+ *
+ * @param keyFrameIndices Zero based indices of the keyframes.
+ * @param keyFrameTimestamps Start timestamps of the keyframes in milliseconds.
+ * @param frameCount The number of frames in the animation.
+ * @param maxSeekFrames The largest number of frames decoded to show any frame.
+ * @param keyFrameBytes Total size of the keyframe bitstreams in bytes.
+ * @param deltaFrameBytes Total size of the other frame bitstreams in bytes.
+ * @param sizeOverhead Estimated bytes spent on keyframes after the first one, compared with encoding them as average delta frames.
+ */
+class WebPSeekReport(
+    val keyFrameIndices: IntArray,
+    val keyFrameTimestamps: LongArray,
+    val frameCount: Int,
+    val maxSeekFrames: Int,
+    val keyFrameBytes: Long,
+    val deltaFrameBytes: Long,
+    val sizeOverhead: Long,
+) {
+
+    override fun toString(): String {
+        return "WebPSeekReport(keyFrameIndices=${keyFrameIndices.contentToString()}, " +
+                "keyFrameTimestamps=${keyFrameTimestamps.contentToString()}, frameCount=$frameCount, " +
+                "maxSeekFrames=$maxSeekFrames, keyFrameBytes=$keyFrameBytes, " +
+                "deltaFrameBytes=$deltaFrameBytes, sizeOverhead=$sizeOverhead)"
+    }
+
+}
@@ -0,0 +1,183 @@
+package com.aureusapps.android.webpandroid.mux
+
+import android.content.Context
+import android.net.Uri
+import com.aureusapps.android.webpandroid.encoder.WebPBuffer
+import com.getkeepsafe.relinker.ReLinker
+import java.nio.ByteBuffer
+
+/**
+ * Edits WebP images at the container level without decoding them.
+ * Frame bitstreams are copied as they are, so edits run in the time it takes to read and write the image.
+ * Set the edits with the builder methods and apply them with [edit] or [editBuffer].
+ *
+ * @param context The Android context.
+ */
+class WebPMuxEditor(
+    private val context: Context,
+) {
+
+    init {
+        ReLinker.loadLibrary(context, "webpcodec_jni")
+    }
+
+    private var loopCount: Int = -1
+    private var backgroundColor: Int? = null
+    private var durationScale: Float = 1f
+    private var stripMetadata: Boolean = false
+    private var trimStart: Int = 0
+    private var trimEnd: Int = -1
+
+    private external fun nativeEdit(
+        context: Context,
+        srcUri: Uri,
+        dstUri: Uri,
+        loopCount: Int,
+        setBackgroundColor: Boolean,
+        backgroundColor: Int,
+        durationScale: Float,
+        stripMetadata: Boolean,
+        trimStart: Int,
+        trimEnd: Int,
+    )
+
+    private external fun nativeEditBuffer(
+        buffer: ByteBuffer,
+        loopCount: Int,
+        setBackgroundColor: Boolean,
+        backgroundColor: Int,
+        durationScale: Float,
+        stripMetadata: Boolean,
+        trimStart: Int,
+        trimEnd: Int,
+    ): WebPBuffer
+
+    /**
+     * Sets the number of times the animation is played.
+     *
+     * @param loopCount The number of loops, 0 for infinite looping.
+     *
+     * @return this editor instance.
+     */
+    fun setLoopCount(loopCount: Int): WebPMuxEditor {
+        require(loopCount >= 0) { "Loop count must not be negative." }
+        this.loopCount = loopCount
+        return this
+    }
+
+    /**
+     * Sets the background color of the animation canvas.
+     *
+     * @param backgroundColor The color in the layout of [com.aureusapps.android.webpandroid.encoder.WebPMuxAnimParams.backgroundColor].
+     *
+     * @return this editor instance.
+     */
+    fun setBackgroundColor(backgroundColor: Int): WebPMuxEditor {
+        this.backgroundColor = backgroundColor
+        return this
+    }
+
+    /**
+     * Multiplies the frame durations. Frame timestamps are scaled and rounded, so rounding errors do not add up over the animation.
+     *
+     * @param scale The duration multiplier, for example 0.5 plays the animation twice as fast.
+     *
+     * @return this editor instance.
+     */
+    fun scaleDurations(scale: Float): WebPMuxEditor {
+        require(scale > 0f) { "Duration scale must be positive." }
+        durationScale = scale
+        return this
+    }
+
+    /**
+     * Removes the EXIF and XMP metadata. The ICC profile is kept since it affects how colors are shown.
+     *
+     * @param strip true to remove the metadata.
+     *
+     * @return this editor instance.
+     */
+    fun stripMetadata(strip: Boolean = true): WebPMuxEditor {
+        stripMetadata = strip
+        return this
+    }
+
+    /**
+     * Keeps a range of frames of the animation. The first kept frame must be a keyframe, so that it does not depend on the dropped frames.
+     * Keyframes of an encoded animation are listed by [com.aureusapps.android.webpandroid.encoder.WebPAnimEncoder.seekReport].
+     *
+     * @param startFrame Zero based index of the first kept frame.
+     * @param endFrame Index after the last kept frame, or -1 to keep frames until the end.
+     *
+     * @return this editor instance.
+     */
+    fun trim(startFrame: Int, endFrame: Int = -1): WebPMuxEditor {
+        require(startFrame >= 0) { "Start frame must not be negative." }
+        trimStart = startFrame
+        trimEnd = endFrame
+        return this
+    }
+
+    /**
+     * Applies the edits to an image and writes the result to the destination.
+     * Edits of the loop count, background color, durations and frame range need an animated image.
+     *
+     * @param srcUri The source Uri of the WebP image. This could be an Android content provider Uri, file Uri, Android resource Uri or a http Uri.
+     * @param dstUri The destination Uri of the edited image. This could be a content provider Uri or a file Uri, and may be the same as [srcUri].
+     *
+     * @return this editor instance.
+     */
+    fun edit(srcUri: Uri, dstUri: Uri): WebPMuxEditor {
+        val color = backgroundColor
+        nativeEdit(
+            context,
+            srcUri,
+            dstUri,
+            loopCount,
+            color != null,
+            color ?: 0,
+            durationScale,
+            stripMetadata,
+            trimStart,
+            trimEnd
+        )
+        return this
+    }
+
+    /**
+     * Applies the edits to an image in memory.
+     *
+     * @param buffer A direct buffer holding the WebP image.
+     *
+     * @return A [WebPBuffer] wrapping the edited image without copying. The native memory is released when it is garbage collected.
+     */
+    fun editBuffer(buffer: ByteBuffer): WebPBuffer {
+        require(buffer.isDirect) { "WebP buffer must be a direct buffer." }
+        val color = backgroundColor
+        return nativeEditBuffer(
+            buffer,
+            loopCount,
+            color != null,
+            color ?: 0,
+            durationScale,
+            stripMetadata,
+            trimStart,
+            trimEnd
+        )
+    }
+
+    /**
+     * Applies the edits to an image encoded into memory by this library.
+     *
+     * @param webPBuffer The WebP image. It is kept reachable until the edit completes.
+     *
+     * @return A [WebPBuffer] wrapping the edited image without copying. The native memory is released when it is garbage collected.
+     */
+    fun editBuffer(webPBuffer: WebPBuffer): WebPBuffer {
+        // The monitor keeps the owner reachable while native code reads its memory
+        return synchronized(webPBuffer) {
+            editBuffer(webPBuffer.buffer)
+        }
+    }
+
+}
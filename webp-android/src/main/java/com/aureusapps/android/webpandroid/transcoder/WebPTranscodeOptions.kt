@@ -0,0 +1,21 @@
+package com.aureusapps.android.webpandroid.transcoder
+
+import android.graphics.Rect
+import com.aureusapps.android.webpandroid.encoder.WebPAnimEncoderOptions
+
+/**
+ * Changes applied to a WebP image while it is transcoded.
+ *
+ * @param width The width of the output in pixels. If not positive, it is derived from [height] keeping the aspect ratio, or taken from the source.
+ * @param height The height of the output in pixels. If not positive, it is derived from [width] keeping the aspect ratio, or taken from the source.
+ * @param cropRect The region of the source canvas to keep, applied before resizing. If null, the whole canvas is kept.
+ * @param frameRate The frame rate of the output in frames per second. Of the frames that start within one output frame, only the first is kept and moved to the output frame time, the same resampling as [com.aureusapps.android.webpandroid.encoder.WebPAnimEncoder.setFrameRate] without picking by difference. If not positive, source timestamps are kept.
+ * @param encoderOptions The animation encoder options. Loop count and background color are copied from the source unless [WebPAnimEncoderOptions.animParams] is set.
+ */
+data class WebPTranscodeOptions(
+    val width: Int = -1,
+    val height: Int = -1,
+    val cropRect: Rect? = null,
+    val frameRate: Float = 0f,
+    val encoderOptions: WebPAnimEncoderOptions? = null,
+)
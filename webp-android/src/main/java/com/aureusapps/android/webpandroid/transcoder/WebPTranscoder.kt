@@ -0,0 +1,107 @@
+package com.aureusapps.android.webpandroid.transcoder
+
+import android.content.Context
+import android.net.Uri
+import com.aureusapps.android.webpandroid.encoder.WebPAnimEncoderOptions
+import com.aureusapps.android.webpandroid.encoder.WebPConfig
+import com.aureusapps.android.webpandroid.encoder.WebPPreset
+import com.getkeepsafe.relinker.ReLinker
+
+/**
+ * Re-encodes animated WebP and GIF images without copying frames into Java bitmaps.
+ * Frames are decoded and encoded natively, with decoding of the next frame overlapping encoding of the current one.
+ *
+ * @param context The Android context.
+ */
+class WebPTranscoder(
+    private val context: Context,
+) {
+
+    init {
+        ReLinker.loadLibrary(context, "webpcodec_jni")
+    }
+
+    private val nativePointer: Long
+
+    init {
+        nativePointer = nativeCreate()
+        if (nativePointer == 0L) {
+            throw RuntimeException("Failed to create native transcoder")
+        }
+    }
+
+    private external fun nativeCreate(): Long
+
+    private external fun nativeTranscode(
+        context: Context,
+        srcUri: Uri,
+        dstUri: Uri,
+        config: WebPConfig?,
+        preset: WebPPreset?,
+        encoderOptions: WebPAnimEncoderOptions?,
+        width: Int,
+        height: Int,
+        cropLeft: Int,
+        cropTop: Int,
+        cropWidth: Int,
+        cropHeight: Int,
+        frameRate: Float,
+    )
+
+    private external fun nativeCancel()
+
+    private external fun nativeRelease()
+
+    /**
+     * Decodes the source WebP or GIF image, applies the options and encodes it to the destination.
+     * Still images are transcoded as a single frame. GIF frames are composed the way gif2webp does,
+     * keeping the GIF loop count and background color.
+     *
+     * @param srcUri The source Uri of the WebP or GIF image. This could be an Android content provider Uri, file Uri, Android resource Uri or a http Uri.
+     * @param dstUri The destination Uri where the WebP image will be saved. This could be a content provider Uri or a file Uri.
+     * @param config The encoding configuration of the output frames.
+     * @param preset The optional preset applied before the configuration.
+     * @param options The geometry and timing changes to apply.
+     * @return this transcoder instance.
+     */
+    fun transcode(
+        srcUri: Uri,
+        dstUri: Uri,
+        config: WebPConfig? = null,
+        preset: WebPPreset? = null,
+        options: WebPTranscodeOptions = WebPTranscodeOptions(),
+    ): WebPTranscoder {
+        val cropRect = options.cropRect
+        nativeTranscode(
+            context,
+            srcUri,
+            dstUri,
+            config,
+            preset,
+            options.encoderOptions,
+            options.width,
+            options.height,
+            cropRect?.left ?: 0,
+            cropRect?.top ?: 0,
+            cropRect?.width() ?: 0,
+            cropRect?.height() ?: 0,
+            options.frameRate
+        )
+        return this
+    }
+
+    /**
+     * Cancels the ongoing transcode, or the next one if none is running.
+     */
+    fun cancel() {
+        nativeCancel()
+    }
+
+    /**
+     * Releases any resources associated with the transcoder.
+     */
+    fun release() {
+        nativeRelease()
+    }
+
+}
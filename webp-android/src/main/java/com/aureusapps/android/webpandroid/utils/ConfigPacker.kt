@@ -0,0 +1,39 @@
+package com.aureusapps.android.webpandroid.utils
+
+/**
+ * Packs the fields of a config class into one int array, so the native code reads a config
+ * with a single array access instead of a boxed read per field.
+ *
+ * Index 0 holds a bitmask of the present values and value i is stored at index i + 1.
+ * Floats are stored as their raw bits and booleans as 0 or 1. Values must be put in the order
+ * of the matching enum on the native side.
+ */
+internal class ConfigPacker(valueCount: Int) {
+
+    private val values = IntArray(valueCount + 1)
+    private var index = 0
+
+    fun put(value: Int?): ConfigPacker {
+        check(index < values.size - 1) { "Too many values packed." }
+        if (value != null) {
+            values[0] = values[0] or (1 shl index)
+            values[index + 1] = value
+        }
+        index++
+        return this
+    }
+
+    fun put(value: Float?): ConfigPacker {
+        return put(value?.toRawBits())
+    }
+
+    fun put(value: Boolean?): ConfigPacker {
+        return put(value?.let { if (it) 1 else 0 })
+    }
+
+    fun toIntArray(): IntArray {
+        check(index == values.size - 1) { "Expected ${values.size - 1} values, packed $index." }
+        return values
+    }
+
+}
@@ -0,0 +1,75 @@
+package com.aureusapps.android.webpandroid.utils
+
+import com.aureusapps.android.webpandroid.encoder.WebPBuffer
+import java.lang.ref.PhantomReference
+import java.lang.ref.ReferenceQueue
+import java.nio.ByteBuffer
+
+/**
+ * Frees native memory wrapped by direct byte buffers once their [WebPBuffer] owners become unreachable.
+ * Buffers are registered from native code together with the pointer returned by libwebp.
+ *
+ * The owner is tracked rather than the buffer, since views created with `slice` or `duplicate` share
+ * the memory without keeping the buffer they were created from reachable.
+ */
+internal object NativeBufferCleaner {
+
+    private const val TAG = "NativeBufferCleaner"
+
+    private val referenceQueue = ReferenceQueue<WebPBuffer>()
+    private val references = mutableSetOf<BufferReference>()
+
+    private class BufferReference(
+        owner: WebPBuffer,
+        val pointer: Long,
+        queue: ReferenceQueue<WebPBuffer>,
+    ) : PhantomReference<WebPBuffer>(owner, queue)
+
+    private val cleanerThread by lazy {
+        Thread({
+            while (true) {
+                try {
+                    val reference = referenceQueue.remove() as BufferReference
+                    release(reference)
+                } catch (_: InterruptedException) {
+                    Logger.w(TAG, "Cleaner thread interrupted")
+                }
+            }
+        }, "WebPBufferCleaner").apply {
+            isDaemon = true
+            start()
+        }
+    }
+
+    @JvmStatic
+    private external fun nativeFree(pointer: Long)
+
+    private fun release(reference: BufferReference) {
+        val removed = synchronized(references) {
+            references.remove(reference)
+        }
+        if (removed) {
+            nativeFree(reference.pointer)
+        }
+    }
+
+    /**
+     * Registers a direct buffer that wraps native memory allocated by libwebp.
+     * If this throws, the memory has not been registered and the caller still owns it.
+     *
+     * @param buffer The direct buffer wrapping the native memory.
+     * @param pointer Address of the native memory to free when the owner is collected.
+     *
+     * @return the owner of the buffer.
+     */
+    @JvmStatic
+    fun register(buffer: ByteBuffer, pointer: Long): WebPBuffer {
+        cleanerThread
+        val owner = WebPBuffer(buffer)
+        synchronized(references) {
+            references.add(BufferReference(owner, pointer, referenceQueue))
+        }
+        return owner
+    }
+
+}
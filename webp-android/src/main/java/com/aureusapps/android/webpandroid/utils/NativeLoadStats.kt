@@ -0,0 +1,28 @@
+package com.aureusapps.android.webpandroid.utils
+
+/**
+ * Reports what loading the native codec library cost. Available once any encoder, decoder,
+ * transcoder or editor has been created, which loads the library.
+ */
+object NativeLoadStats {
+
+    @JvmStatic
+    private external fun nativeGetRegistryLoadNanos(): Long
+
+    @JvmStatic
+    private external fun nativeGetOnLoadNanos(): Long
+
+    /**
+     * Time spent in JNI_OnLoad resolving the classes, fields and methods used by the native code,
+     * in nanoseconds. Close to zero if the library was built with lazy resolution.
+     */
+    val registryLoadNanos: Long
+        get() = nativeGetRegistryLoadNanos()
+
+    /**
+     * Total time spent in JNI_OnLoad, including native method registration, in nanoseconds.
+     */
+    val onLoadNanos: Long
+        get() = nativeGetOnLoadNanos()
+
+}